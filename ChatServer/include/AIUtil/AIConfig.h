@@ -1,5 +1,6 @@
 #pragma once
 
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -25,6 +26,7 @@ enum class LogLevel {
 // 添加语音服务提供商枚举
 enum class SpeechServiceProvider {
     BAIDU,
+    MOCK,       // 本地模拟，不访问网络
     UNKNOWN
 };
 
@@ -59,6 +61,11 @@ struct DatabaseConfig {
 // 日志配置结构
 struct LogConfig {
     LogLevel level;
+    bool async = false;                 // 是否写入后台线程的滚动日志文件
+    std::string file = "chat_server";   // 日志文件名前缀
+    int rollSizeMb = 64;                // 单个日志文件大小上限
+    int flushInterval = 3;              // 后台刷盘间隔（秒）
+    std::map<std::string, LogLevel> modules; // 模块级别，如 {"ai": DEBUG}
 };
 
 // RabbitMQ配置结构
@@ -72,6 +79,78 @@ struct RabbitMQConfig {
     int threadNum;
 };
 
+// 会话配置结构
+struct SessionConfig {
+    std::string mode = "server";   // server: 服务端会话存储；token: 无状态签名令牌
+    std::string tokenSecret;       // 令牌签名密钥，至少 32 字节，为空时读取环境变量 SESSION_TOKEN_SECRET
+    bool tokenEncrypt = false;     // 是否加密令牌载荷
+    int maxAge = 3600;             // 会话有效期（秒）
+};
+
+// 请求追踪配置结构
+struct TraceConfig {
+    double sampleRate = 0;                  // 采样比例 0 ~ 1，0 为关闭
+    std::string file = "chat_trace.json";   // Chrome trace 导出文件
+    double flushInterval = 10;              // 导出间隔（秒）
+};
+
+// 连接限制配置结构，超时单位为秒，0 表示不限
+struct ConnectionConfig {
+    int idleTimeout = 60;           // keep-alive 空闲超时
+    int headerTimeout = 10;         // 读取请求头超时
+    int bodyTimeout = 30;           // 读取请求体超时
+    int maxConnections = 10000;     // 全局并发连接数
+    int maxConnectionsPerIp = 256;  // 单 IP 并发连接数
+    int maxHeaderKb = 16;           // 请求行加请求头上限
+    int maxBodyMb = 16;             // 请求体上限
+};
+
+// 过载保护配置结构，阈值取 0 表示不检查该项
+struct AdmissionConfig {
+    bool enabled = true;
+    int maxQueueDepth = 64;         // 业务线程池排队任务数
+    int maxQueueAgeMs = 2000;       // 队首任务已排队时间
+    int maxLoopLagMs = 200;         // 主循环定时器延迟
+    int maxDbWaiters = 8;           // 等待数据库连接的线程数
+    int retryAfter = 2;             // 拒绝时建议客户端重试的间隔（秒）
+};
+
+// 限流配置结构，rate 为每秒补充的请求数，burst 为允许的突发请求数，rate 取 0 表示不限
+struct RateLimitConfig {
+    bool enabled = true;
+    double chatRate = 0.5;          // 对话、语音等调用大模型的接口，按用户计
+    double chatBurst = 5;
+    double defaultRate = 20;        // 其余接口
+    double defaultBurst = 50;
+};
+
+// 语音合成任务配置，时间单位为秒
+struct SpeechConfig {
+    int threads = 2;                // 调用语音接口的线程数
+    int maxJobs = 256;              // 同时进行的合成任务上限
+    double pollInterval = 0.5;      // 首次查询任务状态前的等待，之后逐次加长
+    double timeout = 60;            // 单个合成任务的最长等待时间
+    double cacheTtl = 3600;         // 相同文本合成结果的缓存时间，取 0 不缓存
+    int cacheCapacity = 1024;       // 缓存条目上限
+    int pipelineWindow = 3;         // 流式回答边生成边合成时同时在途的句子数
+    double mockLatency = 0.3;       // 模拟语音服务的合成耗时
+};
+
+// 口令哈希线程池配置，登录注册的 PBKDF2 在该线程池中批量计算
+struct AuthConfig {
+    int threads = 2;                // 哈希线程数
+    int maxPending = 256;           // 排队上限，超出时返回 503
+};
+
+// 工具执行配置，时间单位为秒
+struct ToolConfig {
+    int threads = 4;                        // 执行工具的线程数
+    double timeout = 8;                     // 单次工具调用（含重试）的截止时间
+    double retryBackoff = 0.5;              // 网络错误重试前的等待，逐次加长
+    int cacheCapacity = 256;                // 结果缓存条目上限
+    std::map<std::string, double> cacheTtl; // 按工具名覆盖结果缓存时间，如 {"get_weather": 600}
+};
+
 // API密钥配置结构
 struct ApiKeysConfig {
     std::string dashscopeApiKey;
@@ -102,6 +181,9 @@ struct ModelConfig {
     struct AliyunMcpConfig {
         std::string apiUrl;
         std::string modelName;
+        // prompt: 工具列表写入提示词，先非流式请求一次判断是否调用工具；
+        // native: 工具定义放入请求的 tools 字段，首次请求即流式返回，不调用工具时省去一次请求
+        std::string toolMode = "prompt";
     };
     
     AliyunConfig aliyun;
@@ -117,6 +199,8 @@ public:
     bool loadFromFile(const std::string& path);
     std::string buildPrompt(const std::string& userInput) const;
     AIToolCall parseAIResponse(const std::string& response) const;
+    // 解析一次回复中的全部工具调用，支持单个对象、对象数组和 {"tool_calls": [...]}，不是工具调用时为空
+    std::vector<AIToolCall> parseAIToolCalls(const std::string& response) const;
     std::string buildToolResultPrompt(
         const std::string& userInput,
         const std::string& toolName,
@@ -130,8 +214,17 @@ public:
     const ApiKeysConfig& getApiKeysConfig() const { return apiKeysConfig_; }
     const ModelConfig& getModelConfig() const { return modelConfig_; }
     const LimitsConfig& getLimitsConfig() const { return limitsConfig_; }
+    const SessionConfig& getSessionConfig() const { return sessionConfig_; }
+    const TraceConfig& getTraceConfig() const { return traceConfig_; }
+    const ConnectionConfig& getConnectionConfig() const { return connectionConfig_; }
+    const AdmissionConfig& getAdmissionConfig() const { return admissionConfig_; }
+    const RateLimitConfig& getRateLimitConfig() const { return rateLimitConfig_; }
+    const AuthConfig& getAuthConfig() const { return authConfig_; }
     SpeechServiceProvider getSpeechServiceProvider() const { return speechServiceProvider_; }
+    const SpeechConfig& getSpeechConfig() const { return speechConfig_; }
+    const ToolConfig& getToolConfig() const { return toolConfig_; }
     const AIToolRegistry& getToolRegistry() const { return toolRegistry_; }
+    AIToolRegistry& getToolRegistry() { return toolRegistry_; }
 
 private:
     AIConfig(); // 私有构造函数
@@ -151,7 +244,15 @@ private:
     ApiKeysConfig apiKeysConfig_;
     ModelConfig modelConfig_;
     LimitsConfig limitsConfig_;
+    SessionConfig sessionConfig_;
+    TraceConfig traceConfig_;
+    ConnectionConfig connectionConfig_;
+    AdmissionConfig admissionConfig_;
+    RateLimitConfig rateLimitConfig_;
+    AuthConfig authConfig_;
     SpeechServiceProvider speechServiceProvider_;
+    SpeechConfig speechConfig_;
+    ToolConfig toolConfig_;
 
     std::string buildToolList() const;
 };
\ No newline at end of file
@@ -8,6 +8,8 @@
 #include <sstream>
 #include <functional>
 #include <future>
+#include <atomic>
+#include <chrono>
 
 #include "utils/JsonUtil.h"
 #include "utils/MysqlUtil.h"
@@ -16,6 +18,7 @@
 #include "AIConfig.h"
 #include "AIFactory.h"
 #include "AIToolRegistry.h"
+#include "LLMParser.h"
 
 // 定义回调类型
 using StreamCallback = std::function<void(const std::string&)>;
@@ -32,7 +35,10 @@ public:
     void addMessage(int userId, const std::string& userName, bool is_user, const std::string& userInput, std::string sessionId);
     // 发送聊天消息，返回AI的响应内容
     // messages: [{"role":"system","content":"..."}, {"role":"user","content":"..."}]
-    std::string chat(int userId, std::string userName, std::string sessionId, std::string userQuestion, std::string modelType);
+    // callback 非空时以流式方式生成，每个增量片段回调一次
+    // cancelled 非空且被置为 true 时中止正在进行的请求，已生成的部分照常保存
+    std::string chat(int userId, std::string userName, std::string sessionId, std::string userQuestion, std::string modelType,
+                     StreamCallback callback = nullptr, std::shared_ptr<std::atomic<bool>> cancelled = nullptr);
 
     // 异步发送聊天消息，支持流式回调
     std::future<std::string> chatAsync(std::shared_ptr<ThreadPool> pool, int userId, std::string userName, std::string sessionId, std::string userQuestion, std::string modelType, StreamCallback callback = nullptr);
@@ -46,18 +52,23 @@ private:
 
     // 根据token数量截断消息
     std::string truncateMessageByTokens(const std::string& message);
-    
-    // 计算文本的token数量
-    int calculateTokens(const std::string& text);
 
     // 执行 curl 请求，返回原始 JSON
-    json executeCurl(const json& payload, StreamCallback callback = nullptr);
+    // 流式请求时 toolCalls 非空则收集增量中的工具调用，每收到工具调用增量后调用 onToolCalls
+    json executeCurl(const json& payload, StreamCallback callback = nullptr,
+                     std::vector<LLMToolCall>* toolCalls = nullptr, std::function<void()> onToolCalls = nullptr);
     // curl 回调函数，把返回的数据写到 string buffer
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
+    // curl 进度回调，用于在等待上游数据时响应取消
+    static int ProgressCallback(void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
 
     // 实际执行聊天逻辑的方法
     std::string chatImpl(int userId, std::string userName, std::string sessionId, std::string userQuestion, std::string modelType, StreamCallback callback = nullptr);
 
+    // MCP 模型的原生函数调用模式：首次请求即流式返回，需要调用工具时执行后再请求
+    std::string chatNativeTools(int userId, const std::string& userName, const std::string& sessionId,
+                                const std::string& userQuestion, StreamCallback callback);
+
 private:
     std::shared_ptr<AIStrategy> strategy;
 
@@ -65,10 +76,25 @@ private:
     //偶数下标代表用户的信息，奇数下标是ai返回的内容
     //后者代表时间戳
     std::vector<std::pair<std::string, long long>> messages;
+
+    // 当前请求的取消标记，由 chat 设置，executeCurl 读取
+    std::shared_ptr<std::atomic<bool>> cancelled_;
     
     // 辅助结构体
     struct CurlContext {
         std::string* buffer;
         StreamCallback callback;
+        // 尚未收到换行符的半行数据，SSE 事件可能被拆分到多个数据块中
+        std::string pending;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        // 指标：请求开始时间与已收到的增量事件数
+        std::chrono::steady_clock::time_point start;
+        size_t deltas = 0;
+        // 原生函数调用模式下收集的工具调用
+        std::vector<LLMToolCall>* toolCalls = nullptr;
+        std::function<void()> onToolCalls;
     };
+
+    // 解析 pending 中所有完整的行并回调，flush 为 true 时连同剩余的半行一起处理
+    static void consumeStreamLines(CurlContext* ctx, bool flush);
 };
\ No newline at end of file
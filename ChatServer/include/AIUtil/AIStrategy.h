@@ -26,6 +26,9 @@ public:
     virtual std::string parseResponse(const json& response) const = 0;
 
     bool isMCPModel = false;
+
+    // MCP 模型使用原生函数调用：请求带 tools 字段，工具调用从流式增量中解析
+    bool nativeToolCalls = false;
 };
 
 class AliyunStrategy : public AIStrategy {
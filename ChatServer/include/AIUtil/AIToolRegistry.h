@@ -3,12 +3,14 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <future>
 #include <stdexcept>
 #include <iostream>
 #include <memory>
 
 #include "utils/JsonUtil.h"
 #include "Tool.h"
+#include "ToolExecutor.h"
 
 class AIToolRegistry {
 public:
@@ -24,12 +26,21 @@ public:
     
     // 调用工具
     json invoke(const std::string& name, const json& args) const;
+
+    // 设置执行引擎，服务启动时调用一次；未设置时 invokeAsync 在调用线程中同步执行
+    void setExecutor(std::shared_ptr<ToolExecutor> executor) { executor_ = std::move(executor); }
+
+    // 异步调用工具，timeout 取 0 使用执行引擎的默认截止时间；多个调用先全部提交再等待即可并行执行
+    std::future<ToolResult> invokeAsync(const std::string& name, const json& args, double timeout = 0) const;
     
     // 检查是否存在某个工具
     bool hasTool(const std::string& name) const;
     
     // 获取工具列表信息（用于构建提示词）
     std::string getToolListDescription() const;
+
+    // OpenAI 格式的工具定义数组，原生函数调用模式下放入请求的 tools 字段；注册时生成，不必每次请求重建
+    const json& getToolSchemas() const { return toolSchemas_; }
     
     // 获取工具实例
     std::shared_ptr<Tool> getTool(const std::string& name) const;
@@ -40,4 +51,6 @@ public:
 private:
     std::unordered_map<std::string, ToolFunc> functionTools_;
     std::unordered_map<std::string, std::shared_ptr<Tool>> classTools_;
+    std::shared_ptr<ToolExecutor> executor_;
+    json toolSchemas_ = json::array();
 };
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <curl/curl.h>
 #include <memory>
+#include <mutex>
 
 #include "utils/base64.h"
 #include "SpeechService.h"
@@ -10,6 +12,8 @@
 /**
  * 百度语音服务实现类
  * 实现SpeechService接口，提供百度语音识别和合成功能
+ * 访问令牌在首次使用时获取并缓存，临近过期时由下一个调用者提前刷新，其余调用者继续使用旧令牌；
+ * 同一实例可被多个线程共享
  */
 class BaiduSpeechService : public SpeechService {
 public:
@@ -33,14 +37,38 @@ public:
                           int pitch = 5,
                           int volume = 5) override;
 
+    std::string createSynthesisTask(const std::string& text,
+                                    const std::string& format = "mp3-16k",
+                                    const std::string& lang = "zh",
+                                    int speed = 5,
+                                    int pitch = 5,
+                                    int volume = 5) override;
+
+    SynthesisTaskStatus querySynthesisTask(const std::string& taskId) override;
+
 private:
+    using Clock = std::chrono::steady_clock;
+
     std::string client_id_;
     std::string client_secret_;
     std::string cuid_;
+
+    // 令牌缓存，tokenMutex_ 只保护下面几个成员，网络请求期间不持有
+    std::mutex tokenMutex_;
+    std::mutex fetchMutex_;             // 令牌过期时只让一个线程去获取
     std::string token_;
+    Clock::time_point tokenExpiresAt_;
+    Clock::time_point tokenRefreshAt_;  // 过了该时间点开始提前刷新
+    bool refreshing_ = false;
+
+    // 返回缓存的令牌，必要时获取或刷新；获取失败时返回空串
+    std::string accessToken();
+    // 向鉴权接口请求新令牌，expiresIn 为有效期（秒）
+    std::string fetchAccessToken(long* expiresIn);
+    void storeToken(const std::string& token, long expiresIn);
 
-    // 获取访问令牌
-    std::string getAccessToken();
+    // POST JSON 并读取响应体，网络错误时返回 false
+    static bool postJson(const std::string& url, const std::string& body, std::string* response);
     
     // CURL回调函数
     static size_t onWriteData(void* buffer, size_t size, size_t nmemb, void* userp);
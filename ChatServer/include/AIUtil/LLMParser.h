@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 原生函数调用模式下模型返回的一个工具调用，流式响应中 arguments 是逐块拼接的 JSON 文本
+struct LLMToolCall {
+    std::string id;
+    std::string name;
+    std::string arguments;
+};
+
+// 从上游返回的 SSE 数据块（或完整 JSON 响应）中提取增量文本，兼容 OpenAI 与阿里百炼格式
+// deltas 非空时累加产生内容的事件数；toolCalls 非空时把 delta.tool_calls 按 index 合并进去
+std::string parseLLMChunk(const std::string& chunk, size_t* deltas = nullptr,
+                          std::vector<LLMToolCall>* toolCalls = nullptr);
+
+// 估算文本的 token 数：中文字符按 1 token，英文按 4 字符 1 token
+int calculateTokens(const std::string& text);
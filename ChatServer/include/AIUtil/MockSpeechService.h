@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "SpeechService.h"
+
+/**
+ * 本地模拟语音服务，不访问网络
+ * 合成任务在创建 latency 秒后完成，返回可预测的音频地址，用于压测和调试语音流水线
+ */
+class MockSpeechService : public SpeechService {
+public:
+    explicit MockSpeechService(double latency = 0.3, double failureRate = 0);
+
+    std::string recognize(const std::string& speechData,
+                          const std::string& format = "pcm",
+                          int rate = 16000,
+                          int channel = 1) override;
+
+    std::string synthesize(const std::string& text,
+                           const std::string& format = "mp3-16k",
+                           const std::string& lang = "zh",
+                           int speed = 5,
+                           int pitch = 5,
+                           int volume = 5) override;
+
+    std::string createSynthesisTask(const std::string& text,
+                                    const std::string& format = "mp3-16k",
+                                    const std::string& lang = "zh",
+                                    int speed = 5,
+                                    int pitch = 5,
+                                    int volume = 5) override;
+
+    SynthesisTaskStatus querySynthesisTask(const std::string& taskId) override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Task {
+        Clock::time_point readyAt;
+        bool fail;
+    };
+
+    std::chrono::microseconds latency_;
+    double failureRate_;
+    std::atomic<uint64_t> seq_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, Task> tasks_;
+};
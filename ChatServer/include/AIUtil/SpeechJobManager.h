@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/EventLoop.h>
+
+#include "utils/ThreadPool.h"
+#include "SpeechService.h"
+
+namespace http {
+namespace metrics {
+class Counter;
+} // namespace metrics
+} // namespace http
+
+struct SpeechJobOptions {
+    size_t threads = 2;             // 调用语音接口的线程数
+    size_t maxJobs = 256;           // 同时进行的合成任务上限，超出时直接失败
+    double pollInterval = 0.5;      // 创建任务后首次查询的等待（秒），之后每次乘 1.5
+    double maxPollInterval = 2;     // 查询间隔上限（秒）
+    double timeout = 60;            // 单个任务从提交到完成的最长时间（秒）
+    double cacheTtl = 3600;         // 合成结果缓存时间（秒），取 0 不缓存
+    size_t cacheCapacity = 1024;    // 缓存条目上限，超出时淘汰最久未用的
+};
+
+struct SpeechRequest {
+    std::string text;
+    std::string format = "mp3-16k";
+    std::string lang = "zh";
+    int speed = 5;
+    int pitch = 5;
+    int volume = 5;
+};
+
+struct SpeechResult {
+    bool success = false;
+    bool busy = false;              // 因任务数达到上限被拒绝
+    bool cached = false;            // 来自缓存
+    std::string url;
+    std::string error;
+};
+
+// 语音合成任务管理：任务状态和定时器都在 loop 所在线程中维护，创建 / 查询任务的阻塞 HTTP 调用
+// 交给内部线程池，两次查询之间用 runAfter 等待而不是 sleep，不占用任何线程。
+// 文本和参数完全相同的请求合并为一个任务，结果按内容哈希缓存
+class SpeechJobManager {
+public:
+    using Callback = std::function<void(const SpeechResult& result)>;
+
+    SpeechJobManager(muduo::net::EventLoop* loop, std::shared_ptr<SpeechService> service,
+                     const SpeechJobOptions& options);
+
+    SpeechJobManager(const SpeechJobManager&) = delete;
+    SpeechJobManager& operator=(const SpeechJobManager&) = delete;
+
+    // 可在任意线程调用，callback 在 loop 所在线程中执行，应尽快返回
+    void submit(const SpeechRequest& request, Callback callback);
+
+    size_t inflight() const
+    { return inflightCount_.load(std::memory_order_relaxed); }
+
+private:
+    struct Job {
+        std::string key;
+        SpeechRequest request;
+        std::string taskId;
+        double interval;
+        muduo::Timestamp deadline;
+        bool done = false;          // 已交付结果，之后返回的创建 / 查询结果直接丢弃
+        std::vector<Callback> waiters;
+    };
+    using JobPtr = std::shared_ptr<Job>;
+
+    struct CacheEntry {
+        std::string url;
+        muduo::Timestamp expiresAt;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    static std::string contentKey(const SpeechRequest& request);
+
+    void submitInLoop(const SpeechRequest& request, Callback callback);
+    void onCreated(const JobPtr& job, const std::string& taskId);
+    void schedulePoll(const JobPtr& job);
+    void onPolled(const JobPtr& job, const SynthesisTaskStatus& status);
+    void finish(const JobPtr& job, const SpeechResult& result, http::metrics::Counter* outcome);
+
+    bool lookupCache(const std::string& key, std::string* url);
+    void storeCache(const std::string& key, const std::string& url);
+
+    muduo::net::EventLoop* loop_;
+    std::shared_ptr<SpeechService> service_;
+    SpeechJobOptions options_;
+    ThreadPool pool_;
+
+    // 以下成员只在 loop 所在线程中访问
+    std::unordered_map<std::string, JobPtr> jobs_;
+    std::unordered_map<std::string, CacheEntry> cache_;
+    std::list<std::string> lru_;    // 最近使用的在前
+
+    std::atomic<size_t> inflightCount_;
+
+    http::metrics::Counter* succeeded_;
+    http::metrics::Counter* failed_;
+    http::metrics::Counter* timedOut_;
+    http::metrics::Counter* rejected_;
+    http::metrics::Counter* cacheHits_;
+    http::metrics::Counter* deduplicated_;
+    http::metrics::Counter* pollErrors_;
+};
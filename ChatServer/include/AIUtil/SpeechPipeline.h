@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SpeechJobManager.h"
+
+struct SpeechPipelineOptions {
+    size_t window = 3;              // 已提交但尚未按序交付的句子数上限
+    size_t minSentenceBytes = 12;   // 短于该长度的句子与下一句合并，避免为“好的。”单独合成
+    size_t maxSentenceBytes = 300;  // 一直没有句末标点时在逗号等处强制切分
+};
+
+// 一段已合成（或合成失败）的语音，index 从 0 开始按文本顺序递增
+struct SpeechSegment {
+    size_t index = 0;
+    std::string text;
+    bool success = false;
+    std::string url;
+    std::string error;
+};
+
+// 流式回答的语音流水线：接收大模型的增量文本，按句切分后提交给 SpeechJobManager 并行合成，
+// 同时在途的句子数受 window 限制；合成结果按句子顺序交付，第一句合成完即可开始播放，
+// 不必等整段回答生成完毕
+class SpeechPipeline : public std::enable_shared_from_this<SpeechPipeline> {
+public:
+    using SegmentCallback = std::function<void(const SpeechSegment& segment)>;
+    using DoneCallback = std::function<void()>;
+
+    // onSegment 可能在调用 feed 的线程或 SpeechJobManager 的 loop 线程中执行，调用之间不会并发，
+    // 应尽快返回且不能再调用本对象
+    SpeechPipeline(std::shared_ptr<SpeechJobManager> jobs, const SpeechPipelineOptions& options,
+                   SegmentCallback onSegment);
+
+    SpeechPipeline(const SpeechPipeline&) = delete;
+    SpeechPipeline& operator=(const SpeechPipeline&) = delete;
+
+    // 追加一段增量文本
+    void feed(const std::string& delta);
+
+    // 文本结束，剩余内容作为最后一句；所有句子交付后调用 onDone（可能就在本次调用中）
+    void finish(DoneCallback onDone);
+
+    // 丢弃尚未提交的句子，已提交的结果不再交付；onDone 仍会在在途任务结束后调用
+    void cancel();
+
+    // 从 text 开头取出一个完整句子，没有完整句子时返回 false；flush 为 true 时剩余内容整体作为一句
+    static bool nextSentence(std::string* text, const SpeechPipelineOptions& options, bool flush,
+                             std::string* sentence);
+
+private:
+    struct Submission {
+        size_t index;
+        std::string text;
+    };
+
+    void splitLocked(bool flush);
+    // 取出窗口允许提交的句子
+    void takeSubmissionsLocked(std::vector<Submission>* submissions);
+    void onResult(size_t index, const SpeechResult& result);
+    // 提交句子、按序交付结果并在全部结束时调用 onDone；同一时刻只有一个线程在执行，
+    // 其余线程只更新状态，由正在执行的线程接着处理
+    void drain();
+
+    std::shared_ptr<SpeechJobManager> jobs_;
+    SpeechPipelineOptions options_;
+    SegmentCallback onSegment_;
+    DoneCallback onDone_;
+
+    std::mutex mutex_;
+    std::string buffer_;                            // 尚未切分的文本
+    std::deque<std::string> queued_;                // 已切分、等待提交的句子
+    std::map<size_t, SpeechSegment> ready_;         // 已完成、等待前面句子的结果
+    std::map<size_t, std::string> submittedText_;   // 在途句子的文本
+    size_t nextSubmit_ = 0;                         // 下一个提交的句子编号
+    size_t nextDeliver_ = 0;                        // 下一个交付的句子编号
+    bool finished_ = false;
+    bool cancelled_ = false;
+    bool draining_ = false;
+};
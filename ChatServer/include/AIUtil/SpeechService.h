@@ -2,6 +2,19 @@
 
 #include <string>
 
+// 异步合成任务的查询结果
+struct SynthesisTaskStatus {
+    enum State {
+        kRunning,   // 仍在合成
+        kSuccess,   // 合成完成，url 为音频地址
+        kFailed,    // 合成失败，error 为原因
+        kRetry,     // 本次查询出错（网络、超时、响应无法解析），任务可能仍在合成，稍后再查
+    };
+    State state = kRunning;
+    std::string url;
+    std::string error;
+};
+
 /**
  * 语音服务接口类
  * 定义统一的语音处理接口，支持不同提供商的实现
@@ -39,4 +52,22 @@ public:
                                   int speed = 5,
                                   int pitch = 5,
                                   int volume = 5) = 0;
+
+    /**
+     * 创建异步合成任务，立即返回，由调用者按需轮询 querySynthesisTask
+     * 参数同 synthesize
+     * @return 任务ID，失败时为空
+     */
+    virtual std::string createSynthesisTask(const std::string& text,
+                                            const std::string& format = "mp3-16k",
+                                            const std::string& lang = "zh",
+                                            int speed = 5,
+                                            int pitch = 5,
+                                            int volume = 5) = 0;
+
+    /**
+     * 查询一次异步合成任务的状态，不等待
+     * @param taskId createSynthesisTask 返回的任务ID
+     */
+    virtual SynthesisTaskStatus querySynthesisTask(const std::string& taskId) = 0;
 };
\ No newline at end of file
@@ -2,8 +2,18 @@
 
 #include <string>
 #include <memory>
+#include <stdexcept>
 #include "utils/JsonUtil.h"
 
+/**
+ * @brief 可重试的临时错误（网络抖动等），由 ToolExecutor 在截止时间内退避重试
+ */
+class ToolRetryableError : public std::runtime_error {
+public:
+    explicit ToolRetryableError(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
 /**
  * @brief 工具基类，所有AI工具都应该继承此类
  */
@@ -33,6 +43,23 @@ public:
      * @brief 执行工具
      * @param args 工具参数
      * @return 执行结果
+     * @note 在 ToolExecutor 的线程池中执行，可以阻塞，但不应自行 sleep 重试，
+     *       临时错误抛出 ToolRetryableError 即可
      */
     virtual json execute(const json& args) const = 0;
+
+    /**
+     * @brief 结果缓存时间（秒），0 表示不缓存；可被配置文件中的 tools.cache_ttl 覆盖
+     */
+    virtual double cacheTtl() const { return 0; }
+
+    /**
+     * @brief 缓存键，参数等价的调用应返回相同的键
+     */
+    virtual std::string cacheKey(const json& args) const { return args.dump(); }
+
+    /**
+     * @brief 遇到 ToolRetryableError 时的最大重试次数
+     */
+    virtual int maxRetries() const { return 0; }
 };
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/EventLoop.h>
+
+#include "utils/JsonUtil.h"
+#include "utils/ThreadPool.h"
+#include "Tool.h"
+
+namespace http {
+namespace metrics {
+class Counter;
+} // namespace metrics
+} // namespace http
+
+struct ToolExecutorOptions {
+    size_t threads = 4;                     // 执行工具的线程数
+    double timeout = 8;                     // 单次工具调用（含重试）的默认截止时间（秒）
+    double retryBackoff = 0.5;              // 第 n 次重试前等待 n 倍该时间（秒）
+    size_t cacheCapacity = 256;             // 缓存条目上限，超出时淘汰最久未用的
+    std::map<std::string, double> cacheTtl; // 按工具名覆盖 Tool::cacheTtl()，取 0 不缓存
+};
+
+struct ToolResult {
+    bool success = false;
+    bool cached = false;            // 来自缓存
+    bool timedOut = false;          // 截止时间内没有完成
+    json value;                     // 工具返回的结果，success 为 true 时有效
+    std::string error;
+};
+
+// 工具执行引擎：调用状态、重试定时器和结果缓存都在 loop 所在线程中维护，工具的阻塞调用
+// 交给内部线程池；重试之间用 runAfter 等待而不是 sleep。每次调用都有截止时间，到期即以超时
+// 交付，同一次模型回复中的多个调用并行执行。可缓存工具的相同调用合并为一次，成功结果按
+// 工具各自的缓存时间保存，如天气按城市缓存 10 分钟
+class ToolExecutor {
+public:
+    using Callback = std::function<void(const ToolResult& result)>;
+
+    ToolExecutor(muduo::net::EventLoop* loop, const ToolExecutorOptions& options);
+
+    ToolExecutor(const ToolExecutor&) = delete;
+    ToolExecutor& operator=(const ToolExecutor&) = delete;
+
+    // 可在任意线程调用，callback 在 loop 所在线程中执行，应尽快返回；timeout 取 0 使用默认值
+    void submit(std::shared_ptr<Tool> tool, const json& args, double timeout, Callback callback);
+
+    // 同上，结果经 future 返回，不能在 loop 所在线程中等待
+    std::future<ToolResult> submit(std::shared_ptr<Tool> tool, const json& args, double timeout = 0);
+
+    size_t inflight() const
+    { return inflightCount_.load(std::memory_order_relaxed); }
+
+private:
+    struct Call {
+        std::string key;            // 可缓存时为缓存键，否则为空
+        std::shared_ptr<Tool> tool;
+        json args;
+        int attempts = 0;
+        bool done = false;
+        muduo::Timestamp deadline;
+        std::vector<Callback> waiters;
+    };
+    using CallPtr = std::shared_ptr<Call>;
+
+    struct CacheEntry {
+        json value;
+        muduo::Timestamp expiresAt;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    double ttlOf(const Tool& tool) const;
+
+    void submitInLoop(const std::shared_ptr<Tool>& tool, const json& args, double timeout, Callback callback);
+    void runAttempt(const CallPtr& call);
+    void onAttempt(const CallPtr& call, const ToolResult& result, bool retryable);
+    void finish(const CallPtr& call, const ToolResult& result, http::metrics::Counter* outcome);
+
+    bool lookupCache(const std::string& key, json* value);
+    void storeCache(const std::string& key, const json& value, double ttl);
+
+    muduo::net::EventLoop* loop_;
+    ToolExecutorOptions options_;
+    ThreadPool pool_;
+
+    // 以下成员只在 loop 所在线程中访问
+    std::unordered_map<std::string, CallPtr> calls_;   // 在途的可缓存调用，用于合并
+    std::unordered_map<std::string, CacheEntry> cache_;
+    std::list<std::string> lru_;    // 最近使用的在前
+
+    std::atomic<size_t> inflightCount_;
+
+    http::metrics::Counter* succeeded_;
+    http::metrics::Counter* failed_;
+    http::metrics::Counter* timedOut_;
+    http::metrics::Counter* retries_;
+    http::metrics::Counter* cacheHits_;
+    http::metrics::Counter* deduplicated_;
+};
@@ -12,6 +12,9 @@ public:
     std::string getDescription() const override;
     json getParameters() const override;
     json execute(const json& args) const override;
+    double cacheTtl() const override { return 600; }
+    std::string cacheKey(const json& args) const override;
+    int maxRetries() const override { return 3; }
 
 private:
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* output);
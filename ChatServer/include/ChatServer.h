@@ -8,6 +8,8 @@
 #include <vector>
 
 #include "http/HttpServer.h"
+#include "session/SessionToken.h"
+#include "staticfile/StaticFileCache.h"
 #include "utils/MysqlUtil.h"
 #include "utils/FileUtil.h"
 #include "utils/JsonUtil.h"
@@ -15,7 +17,10 @@
 #include "utils/base64.h"
 #include "utils/MQManager.h"
 #include "utils/ThreadPool.h"
+#include "utils/AuthPool.h"
 #include "AIUtil/AIHelper.h"
+#include "AIUtil/SpeechJobManager.h"
+#include "AIUtil/ToolExecutor.h"
 
 class ChatLoginHandler;
 class ChatRegisterHandler;
@@ -28,9 +33,17 @@ class ChatSessionsHandler;
 class ChatHistoryHandler;
 class ChatCreateAndSendHandler;
 class SSEChatHandler;
+class ChatStreamSendHandler;
+class ChatWebSocketHandler;
 
 class AIMenuHandler;
 
+// 已登录用户的身份信息
+struct AuthUser {
+	int userId = -1;
+	std::string username;
+};
+
 class ChatServer {
 public:
 	ChatServer(int port,
@@ -51,6 +64,13 @@ public:
 		httpServer_.setSessionManager(std::move(manager));
 	}
 	
+	// 鉴权：根据会话模式校验服务端会话或签名令牌，未登录时返回 false
+	bool authenticate(const http::HttpRequest& req, http::HttpResponse* resp, AuthUser* user);
+	// 登录成功后建立会话（服务端会话或签发令牌）
+	void establishLogin(const http::HttpRequest& req, http::HttpResponse* resp, int userId, const std::string& username);
+	// 注销当前会话，返回注销的用户ID，未登录时返回 -1
+	int revokeLogin(const http::HttpRequest& req, http::HttpResponse* resp);
+
 	// 添加获取server指针的方法，供SSEChatHandler使用
 	ChatServer* getServer() { return this; }
 	
@@ -86,6 +106,12 @@ public:
 	
 	// 获取业务线程池引用，供Handlers使用
 	std::shared_ptr<ThreadPool> getBusinessThreadPool() { return businessThreadPool_; }
+
+	// 登录注册的口令哈希线程池
+	std::shared_ptr<AuthPool> getAuthPool() { return authPool_; }
+
+	// 语音合成任务管理，未配置语音服务时为空
+	std::shared_ptr<SpeechJobManager> getSpeechJobs() { return speechJobs_; }
 	
 private:
 	friend class ChatLoginHandler;
@@ -99,6 +125,8 @@ private:
 	friend class ChatSessionsHandler;
 	friend class ChatCreateAndSendHandler;
 	friend class SSEChatHandler;
+	friend class ChatStreamSendHandler;
+	friend class ChatWebSocketHandler;
 	friend class AIMenuHandler;
 
 private:
@@ -106,9 +134,19 @@ private:
 	void initializeSession();
 	void initializeRouter();
 	void initializeMiddleware();
+	void initializeAdmission();
+	void initializeStaticFiles();
+	void initializeSpeech();
+	void initializeTools();
 	
 	void loadSessionsFromDatabase();
 
+	// 注册开销大的 POST 接口，开启过载保护时挂上准入中间件
+	void postExpensive(const std::string& path, http::router::Router::HandlerPtr handler);
+
+	// 从静态资源缓存返回页面，文件不存在时返回 404 页面
+	void serveStaticFile(const http::HttpRequest& req, http::HttpResponse* resp, const std::string& path);
+
 	void packageResp(const std::string& version, http::HttpResponse::HttpStatusCode statusCode,
 		const std::string& statusMsg, bool close, const std::string& contentType,
 		int contentLen, const std::string& body, http::HttpResponse* resp);
@@ -117,6 +155,12 @@ private:
 
 	http::MysqlUtil mysqlUtil_;
 
+	// 令牌会话模式下的编解码器，服务端会话模式下为空
+	std::unique_ptr<http::session::SessionTokenCodec> tokenCodec_;
+
+	// 页面等静态资源缓存，文件修改后自动重新加载
+	std::unique_ptr<http::staticfile::StaticFileCache> staticFiles_;
+
 	// 在线用户管理 (无锁实现)
 	std::unordered_map<int, bool> onlineUsers_;
 	
@@ -128,6 +172,18 @@ private:
 	
 	// 添加业务线程池，用于处理AI请求
 	std::shared_ptr<ThreadPool> businessThreadPool_;
+
+	// 登录注册专用线程池，PBKDF2 不占用 IO 线程
+	std::shared_ptr<AuthPool> authPool_;
+
+	// 语音合成任务管理，共享同一个语音服务实例及其访问令牌
+	std::shared_ptr<SpeechJobManager> speechJobs_;
+
+	// AI 工具执行引擎，注册到 AIConfig 的工具注册中心
+	std::shared_ptr<ToolExecutor> toolExecutor_;
+
+	// 过载保护，未开启时为空
+	http::middleware::AdmissionControllerPtr admission_;
 	
 	// 存储聊天结果的容器 (无锁实现)
 	std::unordered_map<std::string, std::string> chatResults;
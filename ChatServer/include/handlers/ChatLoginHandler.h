@@ -15,7 +15,12 @@ public:
     void handle(const http::HttpRequest& req, http::HttpResponse* resp) override;
 
 private:
-    int queryUserId(const std::string& username, const std::string& password);
+    // 在鉴权线程池中查询用户并提交口令哈希
+    void verifyLogin(const std::shared_ptr<http::HttpRequest>& request, const std::string& username,
+                     const std::string& password, const http::DeferredResponsePtr& pending);
+    // 口令校验通过后建立会话并回复
+    void completeLogin(const http::HttpRequest& req, int userId, const std::string& username,
+                       const http::DeferredResponsePtr& pending);
 
     ChatServer* server_;
     http::MysqlUtil mysqlUtil_;
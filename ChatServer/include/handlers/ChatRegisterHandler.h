@@ -15,7 +15,11 @@ public:
     void handle(const http::HttpRequest& req, http::HttpResponse* resp) override;
 
 private:
-    int insertUser(const std::string& username, const std::string& password);
+    // 口令哈希完成后在鉴权线程池中写入用户并回复
+    void completeRegister(const std::string& version, const std::string& username,
+                          const std::string& hashedPassword, const std::string& salt,
+                          const http::DeferredResponsePtr& pending);
+    int insertUser(const std::string& username, const std::string& hashedPassword, const std::string& salt);
     bool isUserExist(const std::string& username);
 
     ChatServer* server_;
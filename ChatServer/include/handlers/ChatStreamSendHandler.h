@@ -0,0 +1,20 @@
+#pragma once
+
+#include "utils/MysqlUtil.h"
+
+#include "router/RouterHandler.h"
+#include "utils/ParseJsonUtil.h"
+#include "AIUtil/AISessionIdGenerator.h"
+#include "ChatServer.h"
+
+// 单请求流式对话：POST 响应本身即为 text/event-stream，生成的 token 直接写回该连接
+class ChatStreamSendHandler : public http::router::RouterHandler
+{
+public:
+	ChatStreamSendHandler(ChatServer* server) :server_(server) {}
+	void handle(const http::HttpRequest& req, http::HttpResponse* resp) override;
+
+private:
+	ChatServer* server_;
+	http::MysqlUtil mysqlUtil_;
+};
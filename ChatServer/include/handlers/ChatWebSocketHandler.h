@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "utils/MysqlUtil.h"
+
+#include "websocket/WebSocketHandler.h"
+#include "AIUtil/AISessionIdGenerator.h"
+#include "ChatServer.h"
+
+// 聊天 WebSocket：握手时鉴权一次，之后同一连接上可并发处理多个会话的 send/cancel 操作
+//
+// 客户端消息：
+//   {"op":"send","id":"<请求ID>","sessionId":"<可选，缺省时新建会话>","question":"...","modelType":"1"}
+//   {"op":"cancel","id":"<请求ID>"}
+// 服务端消息：
+//   {"op":"session","id":...,"sessionId":...}   开始处理，返回实际使用的会话ID
+//   {"op":"delta","id":...,"sessionId":...,"text":...}
+//   {"op":"done","id":...,"sessionId":...}
+//   {"op":"cancelled","id":...,"sessionId":...}
+//   {"op":"error","id":...,"message":...}
+class ChatWebSocketHandler : public http::websocket::WebSocketHandler
+{
+public:
+	ChatWebSocketHandler(ChatServer* server) :server_(server) {}
+
+	bool onUpgrade(const http::HttpRequest& req, http::HttpResponse* resp,
+		const http::websocket::WebSocketConnectionPtr& ws) override;
+	void onMessage(const http::websocket::WebSocketConnectionPtr& ws, const std::string& message, bool binary) override;
+	void onClose(const http::websocket::WebSocketConnectionPtr& ws, uint16_t code) override;
+
+private:
+	// 每个连接的状态，握手成功后保存在连接上下文中
+	struct SocketState {
+		int userId;
+		std::string username;
+		std::mutex mutex;
+		// 请求ID -> 取消标记
+		std::unordered_map<std::string, std::shared_ptr<std::atomic<bool>>> operations;
+		// 正在生成回复的会话，同一会话不允许并发提问
+		std::unordered_set<std::string> busySessions;
+	};
+	using SocketStatePtr = std::shared_ptr<SocketState>;
+
+	// 单个连接上同时进行的操作上限
+	static const size_t kMaxOperationsPerSocket = 8;
+
+	void handleSend(const http::websocket::WebSocketConnectionPtr& ws, const SocketStatePtr& state, const json& j);
+	void handleCancel(const http::websocket::WebSocketConnectionPtr& ws, const SocketStatePtr& state, const json& j);
+	void sendError(const http::websocket::WebSocketConnectionPtr& ws, const std::string& id, const std::string& message);
+
+	static SocketStatePtr getState(const http::websocket::WebSocketConnectionPtr& ws);
+
+	ChatServer* server_;
+	http::MysqlUtil mysqlUtil_;
+};
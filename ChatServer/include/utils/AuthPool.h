@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/Pbkdf2.h"
+
+namespace http {
+namespace metrics {
+class Counter;
+} // namespace metrics
+} // namespace http
+
+// 登录、注册专用的线程池，与 IO 线程和业务线程池分开，登录风暴时不影响其它连接和对话请求。
+// 队列有上限；口令哈希任务单独排队，工作线程每次取出最多 Pbkdf2::lanes() 个一起计算
+class AuthPool {
+public:
+    using Task = std::function<void()>;
+    // hash 为十六进制哈希，盐值非法时为空串；在池中线程调用
+    using HashCallback = std::function<void(const std::string& hash)>;
+
+    AuthPool(size_t threads, size_t maxPending);
+    ~AuthPool();
+
+    AuthPool(const AuthPool&) = delete;
+    AuthPool& operator=(const AuthPool&) = delete;
+
+    // 查询数据库等准备工作，优先于哈希任务执行；队列已满时返回 false
+    bool post(Task task);
+
+    // 计算 PBKDF2-HMAC-SHA256(password, saltHex)，队列已满时返回 false，不会调用 callback
+    bool hash(const std::string& password, const std::string& saltHex, HashCallback callback,
+              int iterations = 10000);
+
+    size_t pending();
+
+private:
+    struct HashJob {
+        Pbkdf2Task task;
+        int iterations;
+        bool valid;
+        HashCallback callback;
+    };
+
+    void workerLoop();
+    void runHashBatch(std::vector<HashJob>& batch);
+
+    std::vector<std::thread> workers_;
+    std::deque<Task> tasks_;
+    std::deque<HashJob> hashJobs_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stop_;
+    size_t maxPending_;
+    http::metrics::Counter* rejected_;
+};
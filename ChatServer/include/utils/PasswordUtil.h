@@ -42,4 +42,15 @@ public:
                               const std::string& hashedPassword,
                               int iterations = 10000,
                               size_t keyLength = 32);
+
+    /**
+     * @brief 以与内容无关的耗时比较两个哈希字符串
+     */
+    static bool equals(const std::string& a, const std::string& b);
+
+    /**
+     * @brief 二进制与小写十六进制字符串互转，fromHex 遇到非法字符时抛出 std::invalid_argument
+     */
+    static std::string toHex(const unsigned char* data, size_t length);
+    static std::string fromHex(const std::string& hex);
 };
\ No newline at end of file
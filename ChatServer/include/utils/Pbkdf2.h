@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// PBKDF2-HMAC-SHA256 的多缓冲实现：多条口令同时迭代，每条口令占 SIMD 寄存器的一个 32 位通道。
+// 每轮迭代的两次压缩都是单块定长输入，状态在整个迭代过程中保持在寄存器中，无需转置
+struct Pbkdf2Task {
+    std::string password;
+    std::string salt;            // 二进制盐值
+    unsigned char key[32];       // 派生结果
+};
+
+class Pbkdf2 {
+public:
+    enum Backend {
+        kAuto,      // 按 CPU 支持的指令集选择
+        kOpenSsl,   // 逐条调用 OpenSSL，CPU 支持 SHA 扩展指令时单条最快
+        kAvx2,      // 8 通道
+        kAvx512,    // 16 通道
+    };
+
+    // 当前 CPU 上 kAuto 对应的实现一次并行处理的口令数
+    static size_t lanes();
+    static const char* backendName(Backend backend = kAuto);
+
+    // 所有任务使用相同的迭代次数，输出长度固定为 32 字节；count 可超过 lanes()，按批依次计算，
+    // 凑不满 1/4 批的剩余任务逐条用 OpenSSL 计算
+    static void deriveBatch(Pbkdf2Task* tasks, size_t count, int iterations, Backend backend = kAuto);
+};
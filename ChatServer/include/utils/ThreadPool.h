@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <vector>
 #include <queue>
 #include <memory>
@@ -17,11 +18,17 @@ public:
     auto enqueue(F&& f, Args&&... args) 
         -> std::future<typename std::result_of<F(Args...)>::type>;
     ~ThreadPool();
+
+    // 过载判断用：排队中的任务数，以及队首任务已等待的时间（毫秒）
+    size_t pendingTasks();
+    double oldestTaskWaitMs();
 private:
+    using Clock = std::chrono::steady_clock;
+
     // need to keep track of threads so we can join them
     std::vector< std::thread > workers;
-    // the task queue
-    std::queue< std::function<void()> > tasks;
+    // the task queue, with enqueue time
+    std::queue< std::pair<Clock::time_point, std::function<void()>> > tasks;
     
     // synchronization
     std::mutex queue_mutex;
@@ -47,7 +54,7 @@ inline ThreadPool::ThreadPool(size_t threads)
                             [this]{ return this->stop || !this->tasks.empty(); });
                         if(this->stop && this->tasks.empty())
                             return;
-                        task = std::move(this->tasks.front());
+                        task = std::move(this->tasks.front().second);
                         this->tasks.pop();
                     }
 
@@ -76,12 +83,26 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
         if(stop)
             throw std::runtime_error("enqueue on stopped ThreadPool");
 
-        tasks.emplace([task](){ (*task)(); });
+        tasks.emplace(Clock::now(), [task](){ (*task)(); });
     }
     condition.notify_one();
     return res;
 }
 
+inline size_t ThreadPool::pendingTasks()
+{
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    return tasks.size();
+}
+
+inline double ThreadPool::oldestTaskWaitMs()
+{
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    if(tasks.empty())
+        return 0;
+    return std::chrono::duration<double, std::milli>(Clock::now() - tasks.front().first).count();
+}
+
 // the destructor joins all threads
 inline ThreadPool::~ThreadPool()
 {
@@ -19,6 +19,26 @@ std::string base64_encode_mime(std::string const& s);
 std::string base64_decode(std::string const& s, bool remove_linebreaks = false);
 std::string base64_encode(unsigned char const*, size_t len, bool url = false);
 
+//
+// 写入调用者预先分配的缓冲区，避免大块音频数据的额外拷贝。
+// 编码输出恰好 base64_encoded_length(len) 字节（含填充），返回写入的字节数。
+// 解码输出不超过 base64_decoded_max_length(len) 字节，返回实际字节数；
+// out 可以与 in 相同，即原地解码。非法输入抛出 std::runtime_error
+//
+size_t base64_encoded_length(size_t len);
+size_t base64_decoded_max_length(size_t len);
+size_t base64_encode_to(unsigned char const* in, size_t len, char* out, bool url = false);
+size_t base64_decode_to(char const* in, size_t len, unsigned char* out);
+
+//
+// 编解码实现，默认按 CPU 支持的指令集选择 AVX2 / SSE4.1，否则使用查表的标量实现
+//
+enum class Base64Impl { Auto, Scalar, Sse41, Avx2 };
+
+// 强制使用某个实现（用于基准测试对比），CPU 不支持时退回 Auto；返回实际生效的实现
+Base64Impl base64_set_impl(Base64Impl impl);
+Base64Impl base64_impl();
+
 #if __cplusplus >= 201703L
 //
 // Interface with std::string_view rather than const std::string&
@@ -1,7 +1,33 @@
 #include <muduo/base/Logging.h>
+#include <cstdlib>
 
 #include "AIUtil/AIConfig.h"
 
+namespace {
+
+// 不区分大小写解析日志级别，无法识别时使用 WARN
+LogLevel parseLogLevel(std::string levelStr) {
+    std::transform(levelStr.begin(), levelStr.end(), levelStr.begin(), ::toupper);
+    if (levelStr == "TRACE") return LogLevel::TRACE;
+    if (levelStr == "DEBUG") return LogLevel::DEBUG;
+    if (levelStr == "INFO") return LogLevel::INFO;
+    if (levelStr == "WARN") return LogLevel::WARN;
+    if (levelStr == "ERROR") return LogLevel::ERROR;
+    if (levelStr == "FATAL") return LogLevel::FATAL;
+    return LogLevel::WARN;
+}
+
+// 替换全部占位符；替换内容按原样插入，不像 regex_replace 那样解释其中的 $ 序列
+void replaceAll(std::string* text, const std::string& placeholder, const std::string& value) {
+    size_t pos = 0;
+    while ((pos = text->find(placeholder, pos)) != std::string::npos) {
+        text->replace(pos, placeholder.size(), value);
+        pos += value.size();
+    }
+}
+
+} // namespace
+
 AIConfig::AIConfig() : isLoaded_(false) {
     // 设置默认日志级别为WARN
     logConfig_.level = LogLevel::WARN;
@@ -127,6 +153,9 @@ bool AIConfig::loadFromFile(const std::string& path) {
                 if (aliyunMcpConfig.contains("model_name")) {
                     modelConfig_.aliyunMcp.modelName = aliyunMcpConfig["model_name"];
                 }
+                if (aliyunMcpConfig.contains("tool_mode") && aliyunMcpConfig["tool_mode"].is_string()) {
+                    modelConfig_.aliyunMcp.toolMode = aliyunMcpConfig["tool_mode"];
+                }
             }
         }
 
@@ -139,10 +168,30 @@ bool AIConfig::loadFromFile(const std::string& path) {
                 
                 if (provider == "baidu") {
                     speechServiceProvider_ = SpeechServiceProvider::BAIDU;
+                } else if (provider == "mock") {
+                    speechServiceProvider_ = SpeechServiceProvider::MOCK;
                 } else {
                     speechServiceProvider_ = SpeechServiceProvider::UNKNOWN;
                 }
             }
+            auto readInt = [&speechServiceConfig](const char* key, int* value) {
+                if (speechServiceConfig.contains(key) && speechServiceConfig[key].is_number_integer()) {
+                    *value = speechServiceConfig[key];
+                }
+            };
+            auto readDouble = [&speechServiceConfig](const char* key, double* value) {
+                if (speechServiceConfig.contains(key) && speechServiceConfig[key].is_number()) {
+                    *value = speechServiceConfig[key];
+                }
+            };
+            readInt("threads", &speechConfig_.threads);
+            readInt("max_jobs", &speechConfig_.maxJobs);
+            readDouble("poll_interval", &speechConfig_.pollInterval);
+            readDouble("timeout", &speechConfig_.timeout);
+            readDouble("cache_ttl", &speechConfig_.cacheTtl);
+            readInt("cache_capacity", &speechConfig_.cacheCapacity);
+            readInt("pipeline_window", &speechConfig_.pipelineWindow);
+            readDouble("mock_latency", &speechConfig_.mockLatency);
         }
         
         // 加载限制配置
@@ -159,28 +208,135 @@ bool AIConfig::loadFromFile(const std::string& path) {
             }
         }
 
+        // 加载会话配置
+        if (config.contains("session")) {
+            auto sessionConfig = config["session"];
+            if (sessionConfig.contains("mode")) sessionConfig_.mode = sessionConfig["mode"];
+            if (sessionConfig.contains("token_secret")) sessionConfig_.tokenSecret = sessionConfig["token_secret"];
+            if (sessionConfig.contains("token_encrypt")) sessionConfig_.tokenEncrypt = sessionConfig["token_encrypt"];
+            if (sessionConfig.contains("max_age") && sessionConfig["max_age"].is_number_integer()) {
+                sessionConfig_.maxAge = sessionConfig["max_age"];
+            }
+        }
+        // 密钥不应随配置文件提交，配置中为空时从环境变量读取
+        if (sessionConfig_.tokenSecret.empty()) {
+            const char* secret = std::getenv("SESSION_TOKEN_SECRET");
+            if (secret) sessionConfig_.tokenSecret = secret;
+        }
+
+        // 加载请求追踪配置
+        if (config.contains("trace")) {
+            auto traceConfig = config["trace"];
+            if (traceConfig.contains("sample_rate") && traceConfig["sample_rate"].is_number()) {
+                traceConfig_.sampleRate = traceConfig["sample_rate"];
+            }
+            if (traceConfig.contains("file")) traceConfig_.file = traceConfig["file"];
+            if (traceConfig.contains("flush_interval") && traceConfig["flush_interval"].is_number()) {
+                traceConfig_.flushInterval = traceConfig["flush_interval"];
+            }
+        }
+
+        // 加载连接限制配置
+        if (config.contains("connection")) {
+            auto connConfig = config["connection"];
+            auto readInt = [&connConfig](const char* key, int* value) {
+                if (connConfig.contains(key) && connConfig[key].is_number_integer()) {
+                    *value = connConfig[key];
+                }
+            };
+            readInt("idle_timeout", &connectionConfig_.idleTimeout);
+            readInt("header_timeout", &connectionConfig_.headerTimeout);
+            readInt("body_timeout", &connectionConfig_.bodyTimeout);
+            readInt("max_connections", &connectionConfig_.maxConnections);
+            readInt("max_connections_per_ip", &connectionConfig_.maxConnectionsPerIp);
+            readInt("max_header_kb", &connectionConfig_.maxHeaderKb);
+            readInt("max_body_mb", &connectionConfig_.maxBodyMb);
+        }
+
+        // 加载过载保护配置
+        if (config.contains("admission")) {
+            auto admissionConfig = config["admission"];
+            if (admissionConfig.contains("enabled")) admissionConfig_.enabled = admissionConfig["enabled"];
+            auto readInt = [&admissionConfig](const char* key, int* value) {
+                if (admissionConfig.contains(key) && admissionConfig[key].is_number_integer()) {
+                    *value = admissionConfig[key];
+                }
+            };
+            readInt("max_queue_depth", &admissionConfig_.maxQueueDepth);
+            readInt("max_queue_age_ms", &admissionConfig_.maxQueueAgeMs);
+            readInt("max_loop_lag_ms", &admissionConfig_.maxLoopLagMs);
+            readInt("max_db_waiters", &admissionConfig_.maxDbWaiters);
+            readInt("retry_after", &admissionConfig_.retryAfter);
+        }
+
+        // 加载限流配置
+        if (config.contains("rate_limit")) {
+            auto rateConfig = config["rate_limit"];
+            if (rateConfig.contains("enabled")) rateLimitConfig_.enabled = rateConfig["enabled"];
+            auto readLimit = [&rateConfig](const char* key, double* rate, double* burst) {
+                if (!rateConfig.contains(key)) {
+                    return;
+                }
+                auto limit = rateConfig[key];
+                if (limit.contains("rate") && limit["rate"].is_number()) *rate = limit["rate"];
+                if (limit.contains("burst") && limit["burst"].is_number()) *burst = limit["burst"];
+            };
+            readLimit("chat", &rateLimitConfig_.chatRate, &rateLimitConfig_.chatBurst);
+            readLimit("default", &rateLimitConfig_.defaultRate, &rateLimitConfig_.defaultBurst);
+        }
+
+        // 加载口令哈希线程池配置
+        if (config.contains("auth")) {
+            auto authConfig = config["auth"];
+            if (authConfig.contains("threads") && authConfig["threads"].is_number_integer()) {
+                authConfig_.threads = authConfig["threads"];
+            }
+            if (authConfig.contains("max_pending") && authConfig["max_pending"].is_number_integer()) {
+                authConfig_.maxPending = authConfig["max_pending"];
+            }
+        }
+
+        // 加载工具执行配置
+        if (config.contains("tools")) {
+            auto toolsConfig = config["tools"];
+            if (toolsConfig.contains("threads") && toolsConfig["threads"].is_number_integer()) {
+                toolConfig_.threads = toolsConfig["threads"];
+            }
+            if (toolsConfig.contains("timeout") && toolsConfig["timeout"].is_number()) {
+                toolConfig_.timeout = toolsConfig["timeout"];
+            }
+            if (toolsConfig.contains("retry_backoff") && toolsConfig["retry_backoff"].is_number()) {
+                toolConfig_.retryBackoff = toolsConfig["retry_backoff"];
+            }
+            if (toolsConfig.contains("cache_capacity") && toolsConfig["cache_capacity"].is_number_integer()) {
+                toolConfig_.cacheCapacity = toolsConfig["cache_capacity"];
+            }
+            if (toolsConfig.contains("cache_ttl") && toolsConfig["cache_ttl"].is_object()) {
+                for (auto& item : toolsConfig["cache_ttl"].items()) {
+                    if (item.value().is_number()) {
+                        toolConfig_.cacheTtl[item.key()] = item.value();
+                    }
+                }
+            }
+        }
+
         // 加载日志配置
         if (config.contains("log")) {
             auto logConfig = config["log"];
             if (logConfig.contains("level")) {
-                std::string levelStr = logConfig["level"];
-                std::transform(levelStr.begin(), levelStr.end(), levelStr.begin(), ::toupper);
-                
-                if (levelStr == "TRACE") {
-                    logConfig_.level = LogLevel::TRACE;
-                } else if (levelStr == "DEBUG") {
-                    logConfig_.level = LogLevel::DEBUG;
-                } else if (levelStr == "INFO") {
-                    logConfig_.level = LogLevel::INFO;
-                } else if (levelStr == "WARN") {
-                    logConfig_.level = LogLevel::WARN;
-                } else if (levelStr == "ERROR") {
-                    logConfig_.level = LogLevel::ERROR;
-                } else if (levelStr == "FATAL") {
-                    logConfig_.level = LogLevel::FATAL;
-                } else {
-                    // 默认使用WARN级别
-                    logConfig_.level = LogLevel::WARN;
+                logConfig_.level = parseLogLevel(logConfig["level"]);
+            }
+            if (logConfig.contains("async")) logConfig_.async = logConfig["async"];
+            if (logConfig.contains("file")) logConfig_.file = logConfig["file"];
+            if (logConfig.contains("roll_size_mb") && logConfig["roll_size_mb"].is_number_integer()) {
+                logConfig_.rollSizeMb = logConfig["roll_size_mb"];
+            }
+            if (logConfig.contains("flush_interval") && logConfig["flush_interval"].is_number_integer()) {
+                logConfig_.flushInterval = logConfig["flush_interval"];
+            }
+            if (logConfig.contains("modules") && logConfig["modules"].is_object()) {
+                for (auto& item : logConfig["modules"].items()) {
+                    logConfig_.modules[item.key()] = parseLogLevel(item.value());
                 }
             }
         }
@@ -227,8 +383,9 @@ std::string AIConfig::buildPrompt(const std::string& userInput) const {
     }
     
     std::string result = promptTemplate_;
-    result = std::regex_replace(result, std::regex("\\{user_input\\}"), userInput);
-    result = std::regex_replace(result, std::regex("\\{tool_list\\}"), buildToolList());
+    // 先替换工具列表，用户输入中出现的 {tool_list} 不会被展开
+    replaceAll(&result, "{tool_list}", buildToolList());
+    replaceAll(&result, "{user_input}", userInput);
     return result;
 }
 
@@ -251,6 +408,35 @@ AIToolCall AIConfig::parseAIResponse(const std::string& response) const {
     return result;
 }
 
+std::vector<AIToolCall> AIConfig::parseAIToolCalls(const std::string& response) const {
+    std::vector<AIToolCall> calls;
+    try {
+        json j = json::parse(response);
+        if (j.is_object() && j.contains("tool_calls")) {
+            j = j["tool_calls"];
+        }
+        if (!j.is_array()) {
+            j = json::array({j});
+        }
+        for (const auto& item : j) {
+            if (!item.is_object() || !item.contains("tool") || !item["tool"].is_string()) {
+                continue;
+            }
+            AIToolCall call;
+            call.toolName = item["tool"].get<std::string>();
+            if (item.contains("args") && item["args"].is_object()) {
+                call.args = item["args"];
+            }
+            call.isToolCall = true;
+            calls.push_back(std::move(call));
+        }
+    }
+    catch (...) {
+        calls.clear();
+    }
+    return calls;
+}
+
 std::string AIConfig::buildToolResultPrompt(
     const std::string& userInput,
     const std::string& toolName,
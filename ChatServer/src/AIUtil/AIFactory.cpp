@@ -1,5 +1,6 @@
 #include "AIUtil/AIFactory.h"
 #include "AIUtil/BaiduSpeechService.h"
+#include "AIUtil/MockSpeechService.h"
 
 StrategyFactory& StrategyFactory::instance() {
     static StrategyFactory factory;
@@ -24,6 +25,8 @@ std::unique_ptr<SpeechService> SpeechServiceFactory::createSpeechService(SpeechS
     switch (provider) {
         case SpeechServiceProvider::BAIDU:
             return std::make_unique<BaiduSpeechService>(clientId, clientSecret);
+        case SpeechServiceProvider::MOCK:
+            return std::make_unique<MockSpeechService>(AIConfig::getInstance().getSpeechConfig().mockLatency);
         case SpeechServiceProvider::UNKNOWN:
         default:
             return nullptr;
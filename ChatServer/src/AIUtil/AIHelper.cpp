@@ -1,69 +1,121 @@
 #include <chrono>
 #include <muduo/base/Logging.h>
 
+#include "logging/Log.h"
+#include "metrics/MetricsRegistry.h"
+#include "trace/Tracer.h"
 #include "utils/MQManager.h"
 #include "AIUtil/AIHelper.h"
+#include "AIUtil/LLMParser.h"
+
+namespace {
+
+using http::metrics::MetricsRegistry;
+
+// LLM 调用指标，进程内共享
+struct LLMMetrics {
+    http::metrics::Histogram& streamDuration;
+    http::metrics::Histogram& syncDuration;
+    http::metrics::Histogram& firstToken;
+    http::metrics::Histogram& tokensPerSecond;
+    http::metrics::Counter&   outputTokens;
+    http::metrics::Counter&   ok;
+    http::metrics::Counter&   error;
+    http::metrics::Counter&   cancelled;
+
+    static LLMMetrics& instance() {
+        static LLMMetrics metrics{
+            MetricsRegistry::instance().histogram("llm_request_duration_seconds", "Upstream LLM call latency", {{"mode", "stream"}}),
+            MetricsRegistry::instance().histogram("llm_request_duration_seconds", "Upstream LLM call latency", {{"mode", "sync"}}),
+            MetricsRegistry::instance().histogram("llm_time_to_first_token_seconds", "Time from request to first streamed delta"),
+            MetricsRegistry::instance().histogram("llm_output_tokens_per_second", "Streamed output rate per request", {},
+                                                  http::metrics::HistogramOptions::count()),
+            MetricsRegistry::instance().counter("llm_output_tokens_total", "Streamed output deltas"),
+            MetricsRegistry::instance().counter("llm_requests_total", "Upstream LLM calls by result", {{"result", "ok"}}),
+            MetricsRegistry::instance().counter("llm_requests_total", "Upstream LLM calls by result", {{"result", "error"}}),
+            MetricsRegistry::instance().counter("llm_requests_total", "Upstream LLM calls by result", {{"result", "cancelled"}}),
+        };
+        return metrics;
+    }
+};
 
-// 简单的 SSE 数据解析器 (提取 content)
-std::string parseLLMChunk(const std::string& chunk) {
-    std::string content;
-    std::stringstream ss(chunk);
-    std::string line;
-    
-    while (std::getline(ss, line)) {
-        // 去除行尾可能的 \r
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
+uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+int64_t toNanos(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+// 把 curl 记录的各阶段耗时（相对请求开始）还原为 span：DNS、TCP 建连、TLS 握手、首字节
+void recordCurlPhases(CURL* curl, std::chrono::steady_clock::time_point start) {
+    const http::trace::TraceContext& traceCtx = http::trace::Tracer::current();
+    if (!traceCtx.sampled) return;
+
+    curl_off_t dns = 0, connect = 0, tls = 0, firstByte = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &tls);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &firstByte);
+
+    int64_t base = toNanos(start);
+    auto record = [&](const char* name, curl_off_t fromUs, curl_off_t toUs) {
+        if (toUs > fromUs) {
+            http::trace::Tracer::instance().record(traceCtx, name, base + fromUs * 1000, base + toUs * 1000);
         }
+    };
+    record("llm.dns", 0, dns);
+    record("llm.connect", dns, connect);
+    record("llm.tls", connect, tls);     // 复用连接或明文时为 0，不记录
+    record("llm.first_byte", tls > 0 ? tls : connect, firstByte);
+}
 
-        if (line.empty()) continue;
+// 第一个缺失或为空的必需参数名，参数齐全时返回空
+std::string missingRequiredParam(const Tool& tool, const json& args) {
+    json toolParams = tool.getParameters();
+    if (!toolParams.contains("required") || !toolParams["required"].is_array()) {
+        return "";
+    }
+    for (const auto& requiredParam : toolParams["required"]) {
+        if (!requiredParam.is_string()) {
+            continue;
+        }
+        std::string paramName = requiredParam.get<std::string>();
+        if (!args.contains(paramName) || args[paramName].is_null() ||
+            (args[paramName].is_string() && args[paramName].get<std::string>().empty())) {
+            return paramName;
+        }
+    }
+    return "";
+}
 
-        // 情况1：标准的 SSE 格式 "data: {...}"
-        if (line.find("data: ") == 0) {
-            std::string jsonStr = line.substr(6); // 去掉 "data: "
-            if (jsonStr == "[DONE]") continue; // 忽略结束标记
-            
-            try {
-                json j = json::parse(jsonStr);
-                // 1. 兼容 OpenAI 格式结构
-                if (j.contains("choices") && !j["choices"].empty()) {
-                    auto& choice = j["choices"][0];
-                    if (choice.contains("delta") && choice["delta"].contains("content")) {
-                         if (!choice["delta"]["content"].is_null()) {
-                            content += choice["delta"]["content"].get<std::string>();
-                         }
-                    }
-                    else if (choice.contains("message") && choice["message"].contains("content")) {
-                         if (!choice["message"]["content"].is_null()) {
-                            content += choice["message"]["content"].get<std::string>();
-                         }
-                    }
-                }
-                // 2. 兼容 阿里百炼原生/RAG 格式结构 (output -> text) - 流式
-                else if (j.contains("output") && j["output"].contains("text")) {
-                     if (!j["output"]["text"].is_null()) {
-                        content += j["output"]["text"].get<std::string>();
-                     }
-                }
-            } catch (...) {
-                // 忽略解析错误的行
-            }
-        } 
-        // 情况2：非 SSE 的完整 JSON 响应 (例如 RAG 同步返回)
-        else if (line[0] == '{') {
-             try {
-                json j = json::parse(line);
-                if (j.contains("output") && j["output"].contains("text")) {
-                    if (!j["output"]["text"].is_null()) {
-                        content += j["output"]["text"].get<std::string>();
-                    }
-                }
-             } catch (...) {}
+// 原生函数调用模式下最多连续执行几轮工具调用，之后不再提供工具，要求模型直接回答
+const int kMaxToolRounds = 3;
+
+// 提交模型返回的一个工具调用，工具不存在或参数不合法时返回已就绪的错误结果
+std::future<ToolResult> startToolCall(const AIToolRegistry& registry, const LLMToolCall& call) {
+    ToolResult failure;
+    std::shared_ptr<Tool> tool = registry.getTool(call.name);
+    if (!tool) {
+        failure.error = "未找到工具: " + call.name;
+    } else if (!call.arguments.empty() && !json::accept(call.arguments)) {
+        failure.error = "工具参数不是合法的 JSON: " + call.arguments;
+    } else {
+        json args = call.arguments.empty() ? json::object() : json::parse(call.arguments);
+        std::string missing = missingRequiredParam(*tool, args);
+        if (missing.empty()) {
+            return registry.invokeAsync(call.name, args);
         }
+        failure.error = "缺少必要参数: " + missing;
     }
-    return content;
+    std::promise<ToolResult> promise;
+    promise.set_value(failure);
+    return promise.get_future();
 }
 
+} // namespace
+
 enum modelType {
     AliType = 1,
     DouType = 2,
@@ -116,28 +168,6 @@ std::string AIHelper::truncateMessageByTokens(const std::string& message) {
     return message.substr(0, newLength) + "... [消息过长，已被截断]";
 }
 
-int AIHelper::calculateTokens(const std::string& text) {
-    int asciiCount = 0;
-    int nonAsciiTokens = 0;
-    
-    for (size_t i = 0; i < text.length();) {
-        if ((text[i] & 0x80) != 0 && (text[i] & 0xE0) == 0xE0) {
-            // 中文字符 (UTF-8编码，3字节)
-            // 中文按1字符≈1 Token计算
-            nonAsciiTokens += 1;
-            i += 3;
-        } else {
-            // 英文字符或其他ASCII字符
-            // 英文按4字符≈1 Token计算
-            asciiCount++;
-            i += 1;
-        }
-    }
-    
-    // 总token数 = 中文字符数 + (英文字符数+3)/4 (向上取整)
-    return nonAsciiTokens + (asciiCount + 3) / 4;
-}
-
 // 添加一条用户消息
 void AIHelper::addMessage(int userId, const std::string& userName, bool is_user,const std::string& userInput, std::string sessionId) {
     auto now = std::chrono::system_clock::now();
@@ -156,14 +186,32 @@ void AIHelper::addMessage(int userId, const std::string& userName, bool is_user,
 }
 
 // 发送聊天消息
-std::string AIHelper::chat(int userId,std::string userName, std::string sessionId, std::string userQuestion, std::string modelType) {
-    return chatImpl(userId, userName, sessionId, userQuestion, modelType, nullptr);
+std::string AIHelper::chat(int userId,std::string userName, std::string sessionId, std::string userQuestion, std::string modelType,
+                           StreamCallback callback, std::shared_ptr<std::atomic<bool>> cancelled) {
+    cancelled_ = std::move(cancelled);
+    try {
+        std::string result = chatImpl(userId, userName, sessionId, userQuestion, modelType, callback);
+        cancelled_.reset();
+        return result;
+    } catch (...) {
+        cancelled_.reset();
+        throw;
+    }
 }
 
 // 异步发送聊天消息
 std::future<std::string> AIHelper::chatAsync(std::shared_ptr<ThreadPool> pool, int userId, std::string userName, std::string sessionId, std::string userQuestion, std::string modelType, StreamCallback callback) {
+    // 请求上下文随任务带到工作线程，并记录在线程池中排队的时间
+    http::trace::TraceContext traceCtx = http::trace::Tracer::current();
+    int64_t enqueuedNs = traceCtx.sampled ? http::trace::nowNanos() : 0;
+
     // 使用线程池执行任务
     return pool->enqueue([=]() {
+        if (traceCtx.sampled) {
+            http::trace::Tracer::instance().record(traceCtx, "pool.queue", enqueuedNs, http::trace::nowNanos());
+        }
+        http::trace::ScopedTraceContext scopedTrace(traceCtx);
+        http::trace::Span span("ai.chat");
         return chatImpl(userId, userName, sessionId, userQuestion, modelType, callback);
     });
 }
@@ -247,6 +295,10 @@ std::string AIHelper::chatImpl(int userId, std::string userName, std::string ses
         }
     }
     
+    if (strategy->nativeToolCalls) {
+        return chatNativeTools(userId, userName, sessionId, userQuestion, callback);
+    }
+
     // ======== MCP / Tool Call 逻辑 ========
 
     AIConfig& config = AIConfig::getInstance();
@@ -258,42 +310,44 @@ std::string AIHelper::chatImpl(int userId, std::string userName, std::string ses
     std::string aiResult = strategy->parseResponse(firstResp);
     messages.pop_back();
 
-    AIToolCall call = config.parseAIResponse(aiResult);
+    std::vector<AIToolCall> calls = config.parseAIToolCalls(aiResult);
 
-    if (call.isToolCall) {
-        std::shared_ptr<Tool> tool = config.getToolRegistry().getTool(call.toolName);
-        if (tool) {
-            json toolParams = tool->getParameters();
-            bool valid = true;
-            std::string errorMsg;
-            
-            if (toolParams.contains("required") && toolParams["required"].is_array()) {
-                for (const auto& requiredParam : toolParams["required"]) {
-                    if (requiredParam.is_string()) {
-                        std::string paramName = requiredParam.get<std::string>();
-                        if (!call.args.contains(paramName) || 
-                            call.args[paramName].is_null() || 
-                            (call.args[paramName].is_string() && call.args[paramName].get<std::string>().empty())) {
-                            valid = false;
-                            errorMsg = "缺少必要参数: " + paramName;
-                            break;
-                        }
-                    }
-                }
+    if (!calls.empty()) {
+        const AIToolRegistry& registry = config.getToolRegistry();
+
+        // 先提交全部调用再依次等待，多个工具并行执行，每个调用都在执行引擎的截止时间内返回
+        std::vector<std::string> errors(calls.size());
+        std::vector<std::future<ToolResult>> futures(calls.size());
+        for (size_t i = 0; i < calls.size(); ++i) {
+            const AIToolCall& call = calls[i];
+            std::shared_ptr<Tool> tool = registry.getTool(call.toolName);
+            if (!tool) {
+                errors[i] = "[工具调用失败]\n未找到工具: " + call.toolName;
+                continue;
             }
-            
-            if (valid) {
-                try {
-                    json toolResult = tool->execute(call.args);
-                    messages.push_back({ "[工具调用结果]\n" + toolResult.dump(4), 0 });
-                } catch (const std::exception& e) {
-                    messages.push_back({ "[工具执行错误]\n" + std::string(e.what()), 0 });
-                }
+            std::string missing = missingRequiredParam(*tool, call.args);
+            if (!missing.empty()) {
+                errors[i] = "[参数验证失败]\n缺少必要参数: " + missing;
+                continue;
+            }
+            futures[i] = registry.invokeAsync(call.toolName, call.args);
+        }
+
+        for (size_t i = 0; i < calls.size(); ++i) {
+            if (!futures[i].valid()) {
+                messages.push_back({ errors[i], 0 });
+                continue;
+            }
+            // 同一回复中有多个调用时在结果前标明工具名
+            std::string suffix = calls.size() > 1 ? " " + calls[i].toolName : "";
+            ToolResult result = futures[i].get();
+            if (result.success) {
+                messages.push_back({ "[工具调用结果]" + suffix + "\n" + result.value.dump(4), 0 });
+            } else if (result.timedOut) {
+                messages.push_back({ "[工具执行超时]" + suffix + "\n" + result.error, 0 });
             } else {
-                messages.push_back({ "[参数验证失败]\n" + errorMsg, 0 });
+                messages.push_back({ "[工具执行错误]" + suffix + "\n" + result.error, 0 });
             }
-        } else {
-            messages.push_back({ "[工具调用失败]\n未找到工具: " + call.toolName, 0 });
         }
     } else {
         messages.push_back({ aiResult, 0 });
@@ -315,6 +369,82 @@ std::string AIHelper::chatImpl(int userId, std::string userName, std::string ses
     return finalAnswer;
 }
 
+// 原生函数调用：工具定义随请求发送，首次请求即流式返回，模型直接回答时只需这一次请求。
+// 工具调用从流式增量中解析，参数已是完整 JSON 的调用在流结束前就提交执行；
+// 执行结果以 tool 消息追加到本次请求的上下文中再次请求，不写入会话历史
+std::string AIHelper::chatNativeTools(int userId, const std::string& userName, const std::string& sessionId,
+                                      const std::string& userQuestion, StreamCallback callback) {
+    addMessage(userId, userName, true, userQuestion, sessionId);
+    json payload = strategy->buildRequest(this->messages);
+    payload["stream"] = true;
+
+    const AIToolRegistry& registry = AIConfig::getInstance().getToolRegistry();
+    std::string fullResponse;
+    StreamCallback wrappedCallback = [&callback, &fullResponse](const std::string& delta) {
+        fullResponse += delta;
+        if (callback) {
+            callback(delta);
+        }
+    };
+
+    for (int round = 0;; ++round) {
+        std::vector<LLMToolCall> toolCalls;
+        std::vector<std::future<ToolResult>> futures;
+        size_t roundStart = fullResponse.size();
+        // 按顺序提交参数已完整的调用，final 为 true 时提交剩余全部
+        auto submitReady = [&](bool final) {
+            while (futures.size() < toolCalls.size()) {
+                const LLMToolCall& call = toolCalls[futures.size()];
+                if (!final && (call.name.empty() || !json::accept(call.arguments))) {
+                    break;
+                }
+                futures.push_back(startToolCall(registry, call));
+            }
+        };
+
+        executeCurl(payload, wrappedCallback, &toolCalls, [&submitReady]() { submitReady(false); });
+        if (toolCalls.empty() || (cancelled_ && cancelled_->load())) {
+            break;
+        }
+        submitReady(true);
+
+        json assistant = {
+            {"role", "assistant"},
+            {"content", fullResponse.substr(roundStart)},
+            {"tool_calls", json::array()}
+        };
+        json results = json::array();
+        for (size_t i = 0; i < toolCalls.size(); ++i) {
+            const LLMToolCall& call = toolCalls[i];
+            std::string id = call.id.empty() ? "call_" + std::to_string(i) : call.id;
+            assistant["tool_calls"].push_back({
+                {"id", id},
+                {"type", "function"},
+                {"function", {{"name", call.name}, {"arguments", call.arguments.empty() ? "{}" : call.arguments}}}
+            });
+            ToolResult result = futures[i].get();
+            json content = result.success ? result.value : json{{"error", result.error}};
+            results.push_back({{"role", "tool"}, {"tool_call_id", id}, {"content", content.dump()}});
+        }
+        payload["messages"].push_back(assistant);
+        for (auto& result : results) {
+            payload["messages"].push_back(std::move(result));
+        }
+        if (round + 1 >= kMaxToolRounds) {
+            payload.erase("tools");
+        }
+    }
+
+    if (fullResponse.empty() && !(cancelled_ && cancelled_->load())) {
+        fullResponse = "[Error] 无法解析响应或响应为空";
+        if (callback) {
+            callback(fullResponse);
+        }
+    }
+    addMessage(userId, userName, false, fullResponse, sessionId);
+    return fullResponse;
+}
+
 // 发送自定义请求体
 json AIHelper::request(const json& payload) {
     return executeCurl(payload);
@@ -322,13 +452,15 @@ json AIHelper::request(const json& payload) {
 
 
 // 执行 curl 请求
-json AIHelper::executeCurl(const json& payload, StreamCallback callback) {
+json AIHelper::executeCurl(const json& payload, StreamCallback callback,
+                           std::vector<LLMToolCall>* toolCalls, std::function<void()> onToolCalls) {
     CURL* curl = curl_easy_init();
     if (!curl) {
         throw std::runtime_error("Failed to initialize curl");
     }
 
-    LOG_INFO << "AI API invoke " << strategy->getApiUrl().c_str() << ' ' << strategy->getApiKey();
+    LOG_MODULE("ai", DEBUG) << "AI API invoke" << http::logging::kv("url", strategy->getApiUrl())
+                            << http::logging::kv("stream", static_cast<bool>(callback));
 
     std::string readBuffer;
     struct curl_slist* headers = nullptr;
@@ -344,9 +476,15 @@ json AIHelper::executeCurl(const json& payload, StreamCallback callback) {
 
     std::string payloadStr = payload.dump();
 
+    LLMMetrics& metrics = LLMMetrics::instance();
+
     CurlContext ctx;
     ctx.buffer = &readBuffer;
     ctx.callback = callback; // 如果是 RAG 同步调用，这里传入的是 nullptr
+    ctx.cancelled = cancelled_;
+    ctx.start = std::chrono::steady_clock::now();
+    ctx.toolCalls = toolCalls;
+    ctx.onToolCalls = std::move(onToolCalls);
 
     curl_easy_setopt(curl, CURLOPT_URL, strategy->getApiUrl().c_str());
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
@@ -355,18 +493,53 @@ json AIHelper::executeCurl(const json& payload, StreamCallback callback) {
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &ctx);
     curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, 120L); 
+    if (ctx.cancelled) {
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, ProgressCallback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &ctx);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    }
 
+    http::trace::Span requestSpan("llm.request");
     CURLcode res = curl_easy_perform(curl);
+    requestSpan.end();
+    recordCurlPhases(curl, ctx.start);
     curl_slist_free_all(headers);
     curl_easy_cleanup(curl);
 
+    // 处理最后一行未以换行结尾的数据
+    if (callback) {
+        consumeStreamLines(&ctx, true);
+    }
+
+    uint64_t elapsed = microsSince(ctx.start);
+    (callback ? metrics.streamDuration : metrics.syncDuration).observe(elapsed);
+    if (callback && ctx.deltas > 0) {
+        // 上游 SSE 每个增量事件通常对应一个 token，这里以事件数近似 token 数
+        metrics.outputTokens.inc(ctx.deltas);
+        if (elapsed > 0) {
+            metrics.tokensPerSecond.observe(ctx.deltas * 1000000 / elapsed);
+        }
+    }
+
+    if (res != CURLE_OK && ctx.cancelled && ctx.cancelled->load()) {
+        metrics.cancelled.inc();
+        LOG_INFO << "AI request cancelled";
+        if (!callback) throw std::runtime_error("AI request cancelled");
+        return json::object();
+    }
+
     if (res != CURLE_OK) {
+        metrics.error.inc();
         std::string err = "curl_easy_perform() failed: " + std::string(curl_easy_strerror(res));
         LOG_ERROR << err;
         if (!callback) throw std::runtime_error(err);
         return json::object();
     }
 
+    metrics.ok.inc();
+    LOG_MODULE("ai", DEBUG) << "AI response completed" << http::logging::kv("ms", elapsed / 1000)
+                            << http::logging::kv("bytes", readBuffer.size()) << http::logging::kv("deltas", ctx.deltas);
+
     // 如果是流式调用，返回空json
     if (callback) {
         return json::object(); 
@@ -387,30 +560,63 @@ json AIHelper::executeCurl(const json& payload, StreamCallback callback) {
 size_t AIHelper::WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
     size_t totalSize = size * nmemb;
     auto* ctx = static_cast<CurlContext*>(userp);
+    // 返回值与数据长度不一致时 curl 会中止传输
+    if (ctx->cancelled && ctx->cancelled->load()) {
+        return 0;
+    }
     
-    std::string rawData(static_cast<char*>(contents), totalSize);
-    ctx->buffer->append(rawData);
+    const char* data = static_cast<const char*>(contents);
+    ctx->buffer->append(data, totalSize);
     
-    LOG_INFO << "Raw data received (" << totalSize << " bytes): " << rawData;
+    // 原始数据只在 TRACE 下输出，避免每个数据块都拷贝和格式化
+    LOG_MODULE("ai", TRACE) << "Raw data received" << http::logging::kv("bytes", totalSize)
+                            << http::logging::kv("data", std::string(data, totalSize));
     
     // 实时解析并回调
     if (ctx->callback) {
-        std::string deltaText = parseLLMChunk(rawData);
-        if (!deltaText.empty()) {
-            ctx->callback(deltaText);
-        }
-        
-        // 检查是否是流式结束标记
-        if (rawData.find("[DONE]") != std::string::npos) {
-            LOG_INFO << "Streaming AI response completed. ";
-        }
-    } else {
-        // 输出非流式调用结束
-        LOG_INFO << "Full AI response completed. ";
+        ctx->pending.append(data, totalSize);
+        consumeStreamLines(ctx, false);
     }
     return totalSize;
 }
 
+int AIHelper::ProgressCallback(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    auto* ctx = static_cast<CurlContext*>(clientp);
+    return (ctx->cancelled && ctx->cancelled->load()) ? 1 : 0;
+}
+
+void AIHelper::consumeStreamLines(CurlContext* ctx, bool flush) {
+    // 只解析到最后一个换行符为止，剩余的半行留到下一个数据块
+    size_t lastNewline = ctx->pending.rfind('\n');
+    std::string complete;
+    if (flush) {
+        complete.swap(ctx->pending);
+    } else if (lastNewline != std::string::npos) {
+        complete = ctx->pending.substr(0, lastNewline + 1);
+        ctx->pending.erase(0, lastNewline + 1);
+    } else {
+        return;
+    }
+
+    size_t deltas = 0;
+    std::string deltaText = parseLLMChunk(complete, &deltas, ctx->toolCalls);
+    if (ctx->onToolCalls && ctx->toolCalls && !ctx->toolCalls->empty()) {
+        ctx->onToolCalls();
+    }
+    if (!deltaText.empty()) {
+        if (ctx->deltas == 0) {
+            LLMMetrics::instance().firstToken.observe(microsSince(ctx->start));
+            const http::trace::TraceContext& traceCtx = http::trace::Tracer::current();
+            if (traceCtx.sampled) {
+                http::trace::Tracer::instance().record(traceCtx, "llm.first_token",
+                                                       toNanos(ctx->start), http::trace::nowNanos());
+            }
+        }
+        ctx->deltas += deltas;
+        ctx->callback(deltaText);
+    }
+}
+
 void AIHelper::pushMessageToMysql(int userId, const std::string& userName, bool is_user, const std::string& userInput, long long ms, std::string sessionId) {
     // 构造JSON格式的消息
     json messageJson;
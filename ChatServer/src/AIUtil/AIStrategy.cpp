@@ -238,6 +238,7 @@ AliyunMcpStrategy::AliyunMcpStrategy() {
     apiUrl_ = modelConfig.aliyunMcp.apiUrl;
     modelName_ = modelConfig.aliyunMcp.modelName;
     isMCPModel = true;
+    nativeToolCalls = (modelConfig.aliyunMcp.toolMode == "native");
 }
 
 std::string AliyunMcpStrategy::getApiUrl() const {
@@ -264,6 +265,14 @@ json AliyunMcpStrategy::buildRequest(const std::vector<std::pair<std::string, lo
     buildMessages(msgArray, messages, start_index, total_msgs);
 
     payload["messages"] = msgArray;
+
+    // 原生函数调用：直接附上注册中心的工具定义
+    if (nativeToolCalls) {
+        const json& tools = AIConfig::getInstance().getToolRegistry().getToolSchemas();
+        if (!tools.empty()) {
+            payload["tools"] = tools;
+        }
+    }
     return payload;
 }
 
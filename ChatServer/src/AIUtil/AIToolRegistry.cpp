@@ -18,7 +18,24 @@ void AIToolRegistry::registerTool(const std::string& name, ToolFunc func) {
 // 注册基于Tool类的工具
 void AIToolRegistry::registerTool(std::shared_ptr<Tool> tool) {
     std::string name = tool->getName();
+    if (classTools_.count(name) > 0) {
+        // 重复注册时替换原有定义
+        for (auto it = toolSchemas_.begin(); it != toolSchemas_.end(); ++it) {
+            if ((*it)["function"]["name"] == name) {
+                toolSchemas_.erase(it);
+                break;
+            }
+        }
+    }
     classTools_[name] = tool;
+    toolSchemas_.push_back({
+        {"type", "function"},
+        {"function", {
+            {"name", name},
+            {"description", tool->getDescription()},
+            {"parameters", tool->getParameters()}
+        }}
+    });
     
     // 同时注册为函数式工具，保持向后兼容
     functionTools_[name] = [tool](const json& args) -> json {
@@ -35,6 +52,58 @@ json AIToolRegistry::invoke(const std::string& name, const json& args) const {
     return it->second(args);
 }
 
+namespace {
+
+// 以函数注册的工具，包装后交给执行引擎；不缓存、不重试
+class FunctionTool : public Tool {
+public:
+    FunctionTool(std::string name, AIToolRegistry::ToolFunc func)
+        : name_(std::move(name)), func_(std::move(func)) {}
+
+    std::string getName() const override { return name_; }
+    std::string getDescription() const override { return ""; }
+    json getParameters() const override { return json::object(); }
+    json execute(const json& args) const override { return func_(args); }
+
+private:
+    std::string name_;
+    AIToolRegistry::ToolFunc func_;
+};
+
+std::future<ToolResult> readyResult(const ToolResult& result) {
+    std::promise<ToolResult> promise;
+    promise.set_value(result);
+    return promise.get_future();
+}
+
+} // namespace
+
+std::future<ToolResult> AIToolRegistry::invokeAsync(const std::string& name, const json& args, double timeout) const {
+    std::shared_ptr<Tool> tool = getTool(name);
+    if (!tool) {
+        auto it = functionTools_.find(name);
+        if (it == functionTools_.end()) {
+            ToolResult result;
+            result.error = "Tool not found: " + name;
+            return readyResult(result);
+        }
+        tool = std::make_shared<FunctionTool>(name, it->second);
+    }
+
+    if (executor_) {
+        return executor_->submit(tool, args, timeout);
+    }
+
+    ToolResult result;
+    try {
+        result.value = tool->execute(args);
+        result.success = true;
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    return readyResult(result);
+}
+
 bool AIToolRegistry::hasTool(const std::string& name) const {
     return functionTools_.count(name) > 0;
 }
@@ -1,5 +1,5 @@
-
 #include <muduo/base/Logging.h>
+#include <algorithm>
 #include <thread>
 
 #include "utils/JsonUtil.h"
@@ -9,6 +9,14 @@
 static const int MAX_POLLING_LOOPS = 60;          // 最多轮询60次
 static const int POLLING_INTERVAL_SECONDS = 1;    // 每次轮询间隔1秒
 
+// 令牌有效期剩余不足该比例（最多一天）时提前刷新
+static const double TOKEN_REFRESH_AHEAD_RATIO = 0.1;
+static const long TOKEN_REFRESH_AHEAD_MAX_SECONDS = 24 * 3600;
+
+// 鉴权和合成任务接口的超时（秒），应明显短于 SpeechJobOptions::timeout，卡住的调用不会一直占用线程
+static const long HTTP_CONNECT_TIMEOUT_SECONDS = 5;
+static const long HTTP_TIMEOUT_SECONDS = 15;
+
 BaiduSpeechService::BaiduSpeechService(const std::string& clientId,
                                      const std::string& clientSecret,
                                      const std::string& cuid)
@@ -17,7 +25,6 @@ BaiduSpeechService::BaiduSpeechService(const std::string& clientId,
     if (cuid_.empty()) {
         cuid_ = clientId;
     }
-    token_ = getAccessToken();
 }
 
 size_t BaiduSpeechService::onWriteData(void* buffer, size_t size, size_t nmemb, void* userp) {
@@ -26,7 +33,7 @@ size_t BaiduSpeechService::onWriteData(void* buffer, size_t size, size_t nmemb,
     return size * nmemb;
 }
 
-std::string BaiduSpeechService::getAccessToken() {
+std::string BaiduSpeechService::fetchAccessToken(long* expiresIn) {
     std::string result;
     CURL *curl = curl_easy_init();
     if (!curl) return "";
@@ -35,6 +42,9 @@ std::string BaiduSpeechService::getAccessToken() {
     curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "POST");
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
     curl_easy_setopt(curl, CURLOPT_DEFAULT_PROTOCOL, "https");
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, HTTP_CONNECT_TIMEOUT_SECONDS);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, HTTP_TIMEOUT_SECONDS);
 
     struct curl_slist *headers = NULL;
     headers = curl_slist_append(headers, "Content-Type: application/x-www-form-urlencoded");
@@ -56,14 +66,92 @@ std::string BaiduSpeechService::getAccessToken() {
     try {
         auto j = json::parse(result);
         if (j.contains("access_token") && j["access_token"].is_string()) {
+            *expiresIn = j.contains("expires_in") && j["expires_in"].is_number_integer()
+                ? j["expires_in"].get<long>() : 0;
             return j["access_token"].get<std::string>();
         }
     } catch (...) {
         // parse error
     }
+    LOG_ERROR << "Fetch Baidu access token failed, response: " << result;
     return "";
 }
 
+void BaiduSpeechService::storeToken(const std::string& token, long expiresIn) {
+    // 未返回有效期时按 30 天计
+    if (expiresIn <= 0) expiresIn = 30L * 24 * 3600;
+    long ahead = std::min(static_cast<long>(expiresIn * TOKEN_REFRESH_AHEAD_RATIO), TOKEN_REFRESH_AHEAD_MAX_SECONDS);
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(tokenMutex_);
+    token_ = token;
+    tokenExpiresAt_ = now + std::chrono::seconds(expiresIn);
+    tokenRefreshAt_ = tokenExpiresAt_ - std::chrono::seconds(ahead);
+}
+
+std::string BaiduSpeechService::accessToken() {
+    {
+        std::lock_guard<std::mutex> lock(tokenMutex_);
+        Clock::time_point now = Clock::now();
+        if (!token_.empty() && now < tokenExpiresAt_) {
+            // 进入刷新窗口后由第一个发现的调用者刷新，其余调用者照常使用旧令牌
+            if (now < tokenRefreshAt_ || refreshing_) {
+                return token_;
+            }
+            refreshing_ = true;
+        }
+    }
+
+    // 令牌缺失或已过期时，并发的调用者在 fetchMutex_ 上排队，拿到锁后先检查是否已被别人刷新
+    std::lock_guard<std::mutex> fetchLock(fetchMutex_);
+    {
+        std::lock_guard<std::mutex> lock(tokenMutex_);
+        if (!token_.empty() && Clock::now() < tokenRefreshAt_) {
+            return token_;
+        }
+    }
+    long expiresIn = 0;
+    std::string token = fetchAccessToken(&expiresIn);
+    if (!token.empty()) {
+        storeToken(token, expiresIn);
+    }
+    std::lock_guard<std::mutex> lock(tokenMutex_);
+    refreshing_ = false;
+    // 刷新失败时旧令牌只要没过期仍可使用
+    if (token.empty() && Clock::now() < tokenExpiresAt_) {
+        return token_;
+    }
+    return token;
+}
+
+bool BaiduSpeechService::postJson(const std::string& url, const std::string& body, std::string* response) {
+    CURL* curl = curl_easy_init();
+    if (!curl) return false;
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "POST");
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_DEFAULT_PROTOCOL, "https");
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, HTTP_CONNECT_TIMEOUT_SECONDS);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, HTTP_TIMEOUT_SECONDS);
+
+    struct curl_slist* headers = NULL;
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    headers = curl_slist_append(headers, "Accept: application/json");
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+    response->clear();
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, onWriteData);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+
+    CURLcode res = curl_easy_perform(curl);
+
+    curl_easy_cleanup(curl);
+    if (headers) curl_slist_free_all(headers);
+    return res == CURLE_OK;
+}
+
 std::string BaiduSpeechService::recognize(const std::string& speechData,
                                        const std::string& format,
                                        int rate,
@@ -88,7 +176,7 @@ std::string BaiduSpeechService::recognize(const std::string& speechData,
     body["rate"] = rate;
     body["channel"] = channel;
     body["cuid"] = cuid_;
-    body["token"] = token_;
+    body["token"] = accessToken();
     body["len"] = static_cast<int>(speechData.size()); // 原始 PCM/WAV 字节长度
     body["speech"] = speechData;                       // base64 已编码
 
@@ -128,25 +216,32 @@ std::string BaiduSpeechService::synthesize(const std::string& text,
                                         int speed,
                                         int pitch,
                                         int volume) {
-    CURL* curl = nullptr;
-    CURLcode res;
-    std::string response;
-
-    // ----------- 第一步：创建合成任务 -----------
-    curl = curl_easy_init();
-    if (!curl) return "";
-
-    std::string create_url = "https://aip.baidubce.com/rpc/2.0/tts/v1/create?access_token=" + token_;
+    // 阻塞版本，只应在可以等待的线程中调用；服务端请求走 SpeechJobManager 的定时器轮询
+    std::string task_id = createSynthesisTask(text, format, lang, speed, pitch, volume);
+    if (task_id.empty()) return "";
 
-    curl_easy_setopt(curl, CURLOPT_URL, create_url.c_str());
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "POST");
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_DEFAULT_PROTOCOL, "undefined");
+    int loops = 0;
+    while (loops++ < MAX_POLLING_LOOPS) {
+        std::this_thread::sleep_for(std::chrono::seconds(POLLING_INTERVAL_SECONDS));
+        SynthesisTaskStatus status = querySynthesisTask(task_id);
+        if (status.state == SynthesisTaskStatus::kSuccess) {
+            return status.url;
+        }
+        if (status.state == SynthesisTaskStatus::kFailed) {
+            break;
+        }
+    }
+    return "";
+}
 
-    struct curl_slist* headers = NULL;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    headers = curl_slist_append(headers, "Accept: application/json");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+std::string BaiduSpeechService::createSynthesisTask(const std::string& text,
+                                                 const std::string& format,
+                                                 const std::string& lang,
+                                                 int speed,
+                                                 int pitch,
+                                                 int volume) {
+    std::string token = accessToken();
+    if (token.empty()) return "";
 
     json body = {
         {"text", text},
@@ -158,23 +253,11 @@ std::string BaiduSpeechService::synthesize(const std::string& text,
         {"enable_subtitle", 0}
     };
 
-    std::string data = body.dump();
-
-    response.clear();
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, onWriteData);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-
-    res = curl_easy_perform(curl);
-    if (res != CURLE_OK) {
-        curl_easy_cleanup(curl);
-        if (headers) curl_slist_free_all(headers);
+    std::string response;
+    if (!postJson("https://aip.baidubce.com/rpc/2.0/tts/v1/create?access_token=" + token, body.dump(), &response)) {
         return "";
     }
 
-    curl_easy_cleanup(curl);
-    if (headers) curl_slist_free_all(headers);
-
     // 解析 task_id
     std::string task_id;
     try {
@@ -189,63 +272,50 @@ std::string BaiduSpeechService::synthesize(const std::string& text,
     } catch (...) {
         return "";
     }
+    if (task_id.empty()) {
+        LOG_ERROR << "Create synthesis task failed, response: " << response;
+    }
+    return task_id;
+}
 
-    if (task_id.empty()) return "";
+SynthesisTaskStatus BaiduSpeechService::querySynthesisTask(const std::string& taskId) {
+    SynthesisTaskStatus status;
+    std::string token = accessToken();
+    if (token.empty()) {
+        status.state = SynthesisTaskStatus::kRetry;
+        status.error = "access token unavailable";
+        return status;
+    }
 
-    // ----------- 第二步：轮询查询任务状态 -----------
-    std::string speech_url;
     json query;
-    query["task_ids"] = json::array({task_id});
-
-    // 轮询，上限可按需调整（例如超时 30 次）
-    int loops = 0;
-    while (loops++ < MAX_POLLING_LOOPS) {
-        std::this_thread::sleep_for(std::chrono::seconds(POLLING_INTERVAL_SECONDS));
+    query["task_ids"] = json::array({taskId});
+    std::string response;
+    if (!postJson("https://aip.baidubce.com/rpc/2.0/tts/v1/query?access_token=" + token, query.dump(), &response)) {
+        status.state = SynthesisTaskStatus::kRetry;
+        status.error = "query request failed";
+        return status;
+    }
 
-        curl = curl_easy_init();
-        if (!curl) break;
-
-        std::string query_url = "https://aip.baidubce.com/rpc/2.0/tts/v1/query?access_token=" + token_;
-        curl_easy_setopt(curl, CURLOPT_URL, query_url.c_str());
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "POST");
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_DEFAULT_PROTOCOL, "undefined");
-
-        headers = NULL;
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-        headers = curl_slist_append(headers, "Accept: application/json");
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-        data = query.dump();
-        response.clear();
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, onWriteData);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-
-        res = curl_easy_perform(curl);
-        curl_easy_cleanup(curl);
-        
-        if (headers) curl_slist_free_all(headers);
-        if (res != CURLE_OK) break;
-
-        // 解析轮询结果
-        try {
-            json queryResult = json::parse(response);
-            if (queryResult.contains("tasks_info") && queryResult["tasks_info"].is_array()
-                && !queryResult["tasks_info"].empty()) {
-                json task = queryResult["tasks_info"][0];
-                if (task.contains("task_status") && task["task_status"].is_string()) {
-                    std::string status = task["task_status"].get<std::string>();
-                    if (status == "Success" && task.contains("task_result") && task["task_result"].contains("speech_url")) {
-                        speech_url = task["task_result"]["speech_url"].get<std::string>();
-                        break;
-                    }
+    // 解析轮询结果，Running 之外的非 Success 状态都视为失败；查询本身出错时任务可能仍在合成，交由调用方重试
+    try {
+        json queryResult = json::parse(response);
+        if (queryResult.contains("tasks_info") && queryResult["tasks_info"].is_array()
+            && !queryResult["tasks_info"].empty()) {
+            json task = queryResult["tasks_info"][0];
+            if (task.contains("task_status") && task["task_status"].is_string()) {
+                std::string taskStatus = task["task_status"].get<std::string>();
+                if (taskStatus == "Success" && task.contains("task_result") && task["task_result"].contains("speech_url")) {
+                    status.state = SynthesisTaskStatus::kSuccess;
+                    status.url = task["task_result"]["speech_url"].get<std::string>();
+                } else if (taskStatus != "Running") {
+                    status.state = SynthesisTaskStatus::kFailed;
+                    status.error = "synthesis task " + taskStatus;
                 }
             }
-        } catch (...) {
-            break;
         }
+    } catch (...) {
+        status.state = SynthesisTaskStatus::kRetry;
+        status.error = "invalid query response";
     }
-
-    return speech_url;
-}
\ No newline at end of file
+    return status;
+}
@@ -0,0 +1,124 @@
+#include <sstream>
+
+#include "utils/JsonUtil.h"
+#include "AIUtil/LLMParser.h"
+
+namespace {
+
+// 合并 OpenAI 格式的工具调用增量：首个分片带 id 和函数名，之后的分片只带 arguments 的后续文本；
+// 有的服务在后续分片中重复 id 和函数名，这里以第一次出现的为准
+void mergeToolCallDeltas(const json& deltas, std::vector<LLMToolCall>* toolCalls) {
+    for (const auto& delta : deltas) {
+        size_t index = toolCalls->size();
+        if (delta.contains("index") && delta["index"].is_number_unsigned()) {
+            index = delta["index"].get<size_t>();
+        }
+        if (index >= toolCalls->size()) {
+            toolCalls->resize(index + 1);
+        }
+        LLMToolCall& call = (*toolCalls)[index];
+        if (call.id.empty() && delta.contains("id") && delta["id"].is_string()) {
+            call.id = delta["id"].get<std::string>();
+        }
+        if (!delta.contains("function") || !delta["function"].is_object()) {
+            continue;
+        }
+        const json& function = delta["function"];
+        if (call.name.empty() && function.contains("name") && function["name"].is_string()) {
+            call.name = function["name"].get<std::string>();
+        }
+        if (function.contains("arguments") && function["arguments"].is_string()) {
+            call.arguments += function["arguments"].get<std::string>();
+        }
+    }
+}
+
+} // namespace
+
+// 简单的 SSE 数据解析器 (提取 content)，deltas 累加产生内容的事件数
+std::string parseLLMChunk(const std::string& chunk, size_t* deltas, std::vector<LLMToolCall>* toolCalls) {
+    std::string content;
+    std::stringstream ss(chunk);
+    std::string line;
+    
+    while (std::getline(ss, line)) {
+        // 去除行尾可能的 \r
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        if (line.empty()) continue;
+        size_t before = content.size();
+
+        // 情况1：标准的 SSE 格式 "data: {...}"
+        if (line.find("data: ") == 0) {
+            std::string jsonStr = line.substr(6); // 去掉 "data: "
+            if (jsonStr == "[DONE]") continue; // 忽略结束标记
+            
+            try {
+                json j = json::parse(jsonStr);
+                // 1. 兼容 OpenAI 格式结构
+                if (j.contains("choices") && !j["choices"].empty()) {
+                    auto& choice = j["choices"][0];
+                    if (toolCalls && choice.contains("delta") && choice["delta"].contains("tool_calls") &&
+                        choice["delta"]["tool_calls"].is_array()) {
+                        mergeToolCallDeltas(choice["delta"]["tool_calls"], toolCalls);
+                    }
+                    if (choice.contains("delta") && choice["delta"].contains("content")) {
+                         if (!choice["delta"]["content"].is_null()) {
+                            content += choice["delta"]["content"].get<std::string>();
+                         }
+                    }
+                    else if (choice.contains("message") && choice["message"].contains("content")) {
+                         if (!choice["message"]["content"].is_null()) {
+                            content += choice["message"]["content"].get<std::string>();
+                         }
+                    }
+                }
+                // 2. 兼容 阿里百炼原生/RAG 格式结构 (output -> text) - 流式
+                else if (j.contains("output") && j["output"].contains("text")) {
+                     if (!j["output"]["text"].is_null()) {
+                        content += j["output"]["text"].get<std::string>();
+                     }
+                }
+            } catch (...) {
+                // 忽略解析错误的行
+            }
+        } 
+        // 情况2：非 SSE 的完整 JSON 响应 (例如 RAG 同步返回)
+        else if (line[0] == '{') {
+             try {
+                json j = json::parse(line);
+                if (j.contains("output") && j["output"].contains("text")) {
+                    if (!j["output"]["text"].is_null()) {
+                        content += j["output"]["text"].get<std::string>();
+                    }
+                }
+             } catch (...) {}
+        }
+        if (deltas && content.size() > before) ++*deltas;
+    }
+    return content;
+}
+
+int calculateTokens(const std::string& text) {
+    int asciiCount = 0;
+    int nonAsciiTokens = 0;
+    
+    for (size_t i = 0; i < text.length();) {
+        if ((text[i] & 0x80) != 0 && (text[i] & 0xE0) == 0xE0) {
+            // 中文字符 (UTF-8编码，3字节)
+            // 中文按1字符≈1 Token计算
+            nonAsciiTokens += 1;
+            i += 3;
+        } else {
+            // 英文字符或其他ASCII字符
+            // 英文按4字符≈1 Token计算
+            asciiCount++;
+            i += 1;
+        }
+    }
+    
+    // 总token数 = 中文字符数 + (英文字符数+3)/4 (向上取整)
+    return nonAsciiTokens + (asciiCount + 3) / 4;
+}
@@ -0,0 +1,66 @@
+#include <thread>
+
+#include "AIUtil/MockSpeechService.h"
+
+MockSpeechService::MockSpeechService(double latency, double failureRate)
+    : latency_(static_cast<int64_t>(latency * 1000000))
+    , failureRate_(failureRate)
+    , seq_(0) {
+}
+
+std::string MockSpeechService::recognize(const std::string& speechData,
+                                         const std::string& format,
+                                         int rate,
+                                         int channel) {
+    return "mock recognition of " + std::to_string(speechData.size()) + " bytes";
+}
+
+std::string MockSpeechService::synthesize(const std::string& text,
+                                          const std::string& format,
+                                          const std::string& lang,
+                                          int speed,
+                                          int pitch,
+                                          int volume) {
+    std::string taskId = createSynthesisTask(text, format, lang, speed, pitch, volume);
+    std::this_thread::sleep_for(latency_);
+    SynthesisTaskStatus status = querySynthesisTask(taskId);
+    return status.state == SynthesisTaskStatus::kSuccess ? status.url : "";
+}
+
+std::string MockSpeechService::createSynthesisTask(const std::string& text,
+                                                   const std::string& format,
+                                                   const std::string& lang,
+                                                   int speed,
+                                                   int pitch,
+                                                   int volume) {
+    uint64_t seq = seq_.fetch_add(1, std::memory_order_relaxed);
+    std::string taskId = "mock-" + std::to_string(seq);
+    // 按序号均匀地让一部分任务失败，结果可复现
+    bool fail = failureRate_ > 0 && static_cast<double>(seq % 1000) < failureRate_ * 1000;
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_[taskId] = Task{Clock::now() + latency_, fail};
+    return taskId;
+}
+
+SynthesisTaskStatus MockSpeechService::querySynthesisTask(const std::string& taskId) {
+    SynthesisTaskStatus status;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tasks_.find(taskId);
+    if (it == tasks_.end()) {
+        status.state = SynthesisTaskStatus::kFailed;
+        status.error = "unknown task " + taskId;
+        return status;
+    }
+    if (Clock::now() < it->second.readyAt) {
+        return status;
+    }
+    if (it->second.fail) {
+        status.state = SynthesisTaskStatus::kFailed;
+        status.error = "mock failure";
+    } else {
+        status.state = SynthesisTaskStatus::kSuccess;
+        status.url = "http://127.0.0.1/mock-speech/" + taskId + ".mp3";
+    }
+    tasks_.erase(it);
+    return status;
+}
@@ -0,0 +1,213 @@
+#include <muduo/base/Logging.h>
+#include <openssl/sha.h>
+#include <algorithm>
+
+#include "metrics/MetricsRegistry.h"
+#include "AIUtil/SpeechJobManager.h"
+
+SpeechJobManager::SpeechJobManager(muduo::net::EventLoop* loop, std::shared_ptr<SpeechService> service,
+                                   const SpeechJobOptions& options)
+    : loop_(loop)
+    , service_(std::move(service))
+    , options_(options)
+    , pool_(std::max(options.threads, static_cast<size_t>(1)))
+    , inflightCount_(0) {
+    auto& registry = http::metrics::MetricsRegistry::instance();
+    const char* jobsName = "speech_jobs_total";
+    const char* jobsHelp = "Speech synthesis jobs by outcome";
+    succeeded_ = &registry.counter(jobsName, jobsHelp, {{"result", "success"}});
+    failed_ = &registry.counter(jobsName, jobsHelp, {{"result", "failed"}});
+    timedOut_ = &registry.counter(jobsName, jobsHelp, {{"result", "timeout"}});
+    rejected_ = &registry.counter(jobsName, jobsHelp, {{"result", "rejected"}});
+    cacheHits_ = &registry.counter("speech_cache_hits_total", "Speech requests answered from the result cache");
+    deduplicated_ = &registry.counter("speech_requests_deduplicated_total",
+                                      "Speech requests attached to an identical job already in flight");
+    pollErrors_ = &registry.counter("speech_poll_errors_total",
+                                    "Speech task status queries that failed and were retried");
+    registry.gaugeCallback("speech_jobs_inflight", "Speech synthesis jobs waiting for the provider", {},
+                           [this]() { return static_cast<double>(inflight()); });
+}
+
+std::string SpeechJobManager::contentKey(const SpeechRequest& request) {
+    // 各字段以 \0 分隔后取 SHA-256，作为去重和缓存的键
+    std::string material = request.text;
+    material.push_back('\0');
+    material += request.format;
+    material.push_back('\0');
+    material += request.lang;
+    material.push_back('\0');
+    material += std::to_string(request.speed) + ',' + std::to_string(request.pitch) + ',' +
+                std::to_string(request.volume);
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(material.data()), material.size(), digest);
+    return std::string(reinterpret_cast<const char*>(digest), sizeof digest);
+}
+
+void SpeechJobManager::submit(const SpeechRequest& request, Callback callback) {
+    loop_->runInLoop([this, request, callback]() { submitInLoop(request, callback); });
+}
+
+void SpeechJobManager::submitInLoop(const SpeechRequest& request, Callback callback) {
+    std::string key = contentKey(request);
+
+    SpeechResult result;
+    if (lookupCache(key, &result.url)) {
+        cacheHits_->inc();
+        result.success = true;
+        result.cached = true;
+        callback(result);
+        return;
+    }
+
+    auto it = jobs_.find(key);
+    if (it != jobs_.end()) {
+        deduplicated_->inc();
+        it->second->waiters.push_back(std::move(callback));
+        return;
+    }
+
+    if (jobs_.size() >= options_.maxJobs) {
+        rejected_->inc();
+        result.busy = true;
+        result.error = "Too many speech synthesis jobs in flight";
+        callback(result);
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->key = key;
+    job->request = request;
+    job->interval = options_.pollInterval;
+    job->deadline = muduo::addTime(muduo::Timestamp::now(), options_.timeout);
+    job->waiters.push_back(std::move(callback));
+    jobs_[key] = job;
+    inflightCount_.fetch_add(1, std::memory_order_relaxed);
+
+    // 创建或查询调用卡住时 onPolled 不会执行，由定时器保证任务在截止时间结束
+    loop_->runAfter(options_.timeout, [this, job]() {
+        if (job->done) {
+            return;
+        }
+        LOG_WARN << "Speech synthesis task " << job->taskId << " timed out";
+        SpeechResult result;
+        result.error = "Speech synthesis timed out";
+        finish(job, result, timedOut_);
+    });
+
+    pool_.enqueue([this, job]() {
+        const SpeechRequest& r = job->request;
+        std::string taskId = service_->createSynthesisTask(r.text, r.format, r.lang, r.speed, r.pitch, r.volume);
+        loop_->runInLoop([this, job, taskId]() { onCreated(job, taskId); });
+    });
+}
+
+void SpeechJobManager::onCreated(const JobPtr& job, const std::string& taskId) {
+    if (job->done) {
+        return;
+    }
+    if (taskId.empty()) {
+        SpeechResult result;
+        result.error = "Failed to create speech synthesis task";
+        finish(job, result, failed_);
+        return;
+    }
+    job->taskId = taskId;
+    schedulePoll(job);
+}
+
+void SpeechJobManager::schedulePoll(const JobPtr& job) {
+    double delay = job->interval;
+    job->interval = std::min(job->interval * 1.5, options_.maxPollInterval);
+    loop_->runAfter(delay, [this, job]() {
+        if (job->done) {
+            return;
+        }
+        pool_.enqueue([this, job]() {
+            SynthesisTaskStatus status = service_->querySynthesisTask(job->taskId);
+            loop_->runInLoop([this, job, status]() { onPolled(job, status); });
+        });
+    });
+}
+
+void SpeechJobManager::onPolled(const JobPtr& job, const SynthesisTaskStatus& status) {
+    if (job->done) {
+        return;
+    }
+    SpeechResult result;
+    switch (status.state) {
+    case SynthesisTaskStatus::kSuccess:
+        result.success = true;
+        result.url = status.url;
+        storeCache(job->key, status.url);
+        finish(job, result, succeeded_);
+        return;
+    case SynthesisTaskStatus::kFailed:
+        result.error = status.error.empty() ? "Speech synthesis failed" : status.error;
+        finish(job, result, failed_);
+        return;
+    case SynthesisTaskStatus::kRetry:
+        // 查询出错不代表任务失败，按退避间隔继续查询，直到截止时间
+        pollErrors_->inc();
+        LOG_WARN << "Speech synthesis task " << job->taskId << " query failed: " << status.error;
+        break;
+    case SynthesisTaskStatus::kRunning:
+        break;
+    }
+
+    // 下一次查询之前就会超时的任务不再查询
+    if (job->deadline < muduo::addTime(muduo::Timestamp::now(), job->interval)) {
+        LOG_WARN << "Speech synthesis task " << job->taskId << " timed out";
+        result.error = "Speech synthesis timed out";
+        finish(job, result, timedOut_);
+        return;
+    }
+    schedulePoll(job);
+}
+
+void SpeechJobManager::finish(const JobPtr& job, const SpeechResult& result, http::metrics::Counter* outcome) {
+    job->done = true;
+    jobs_.erase(job->key);
+    inflightCount_.fetch_sub(1, std::memory_order_relaxed);
+    outcome->inc();
+    // 截止定时器仍持有 job，先取出回调，以免其捕获的对象一直存活到定时器到期
+    std::vector<Callback> waiters;
+    waiters.swap(job->waiters);
+    for (const auto& waiter : waiters) {
+        waiter(result);
+    }
+}
+
+bool SpeechJobManager::lookupCache(const std::string& key, std::string* url) {
+    auto it = cache_.find(key);
+    if (it == cache_.end()) {
+        return false;
+    }
+    if (it->second.expiresAt < muduo::Timestamp::now()) {
+        lru_.erase(it->second.lruPos);
+        cache_.erase(it);
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+    *url = it->second.url;
+    return true;
+}
+
+void SpeechJobManager::storeCache(const std::string& key, const std::string& url) {
+    if (options_.cacheTtl <= 0 || options_.cacheCapacity == 0) {
+        return;
+    }
+    muduo::Timestamp expiresAt = muduo::addTime(muduo::Timestamp::now(), options_.cacheTtl);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        it->second.url = url;
+        it->second.expiresAt = expiresAt;
+        lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+        return;
+    }
+    lru_.push_front(key);
+    cache_[key] = CacheEntry{url, expiresAt, lru_.begin()};
+    while (cache_.size() > options_.cacheCapacity) {
+        cache_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
@@ -0,0 +1,242 @@
+#include <cctype>
+#include <cstring>
+
+#include "AIUtil/SpeechPipeline.h"
+
+namespace {
+
+// 句末标点，UTF-8 编码
+const char* const kSentenceEnds[] = {"。", "！", "？", "；", "…"};
+// 句子过长时可以切分的位置
+const char* const kSoftBreaks[] = {"，", "、", "：", ",", ":", " "};
+// 只含这些符号和空白的片段不值得合成
+const char* const kSymbols[] = {"。", "！", "？", "；", "…", "，", "、", "：", "“", "”", "‘", "’", "（", "）", "《", "》"};
+
+size_t matchAny(const std::string& text, size_t pos, const char* const* marks, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        size_t len = strlen(marks[i]);
+        if (text.compare(pos, len, marks[i]) == 0) {
+            return len;
+        }
+    }
+    return 0;
+}
+
+// pos 处句末标点的长度，不是句末时返回 0；'.' 后面必须跟空白，以免切开小数和缩写
+size_t sentenceEndAt(const std::string& text, size_t pos, bool flush) {
+    char c = text[pos];
+    if (c == '!' || c == '?' || c == ';' || c == '\n') {
+        return 1;
+    }
+    if (c == '.') {
+        if (pos + 1 < text.size()) {
+            return isspace(static_cast<unsigned char>(text[pos + 1])) ? 1 : 0;
+        }
+        return flush ? 1 : 0;
+    }
+    return matchAny(text, pos, kSentenceEnds, sizeof kSentenceEnds / sizeof kSentenceEnds[0]);
+}
+
+bool speakable(const std::string& text) {
+    const size_t symbolCount = sizeof kSymbols / sizeof kSymbols[0];
+    for (size_t i = 0; i < text.size();) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            if (isalnum(c)) {
+                return true;
+            }
+            ++i;
+            continue;
+        }
+        size_t len = matchAny(text, i, kSymbols, symbolCount);
+        if (len == 0) {
+            return true;
+        }
+        i += len;
+    }
+    return false;
+}
+
+void trim(std::string* text) {
+    size_t begin = 0;
+    while (begin < text->size() && isspace(static_cast<unsigned char>((*text)[begin]))) ++begin;
+    size_t end = text->size();
+    while (end > begin && isspace(static_cast<unsigned char>((*text)[end - 1]))) --end;
+    *text = text->substr(begin, end - begin);
+}
+
+} // namespace
+
+SpeechPipeline::SpeechPipeline(std::shared_ptr<SpeechJobManager> jobs, const SpeechPipelineOptions& options,
+                               SegmentCallback onSegment)
+    : jobs_(std::move(jobs))
+    , options_(options)
+    , onSegment_(std::move(onSegment)) {
+    if (options_.window == 0) {
+        options_.window = 1;
+    }
+}
+
+bool SpeechPipeline::nextSentence(std::string* text, const SpeechPipelineOptions& options, bool flush,
+                                  std::string* sentence) {
+    size_t cut = std::string::npos;
+    for (size_t i = 0; i < text->size();) {
+        size_t len = sentenceEndAt(*text, i, flush);
+        if (len > 0 && i + len >= options.minSentenceBytes) {
+            cut = i + len;
+            break;
+        }
+        i += len > 0 ? len : 1;
+    }
+
+    if (cut == std::string::npos && text->size() > options.maxSentenceBytes) {
+        // 没有句末标点的长句，在最后一个逗号、空格等处切分，找不到时在字符边界处硬切
+        const size_t softCount = sizeof kSoftBreaks / sizeof kSoftBreaks[0];
+        for (size_t i = 0; i < options.maxSentenceBytes;) {
+            size_t len = matchAny(*text, i, kSoftBreaks, softCount);
+            if (len > 0 && i + len <= options.maxSentenceBytes) {
+                cut = i + len;
+            }
+            i += len > 0 ? len : 1;
+        }
+        if (cut == std::string::npos || cut < options.minSentenceBytes) {
+            cut = options.maxSentenceBytes;
+            while (cut > 0 && (static_cast<unsigned char>((*text)[cut]) & 0xC0) == 0x80) --cut;
+        }
+    }
+
+    if (cut == std::string::npos) {
+        if (!flush || text->empty()) {
+            return false;
+        }
+        cut = text->size();
+    }
+
+    *sentence = text->substr(0, cut);
+    text->erase(0, cut);
+    trim(sentence);
+    return true;
+}
+
+void SpeechPipeline::feed(const std::string& delta) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_ || cancelled_) {
+            return;
+        }
+        buffer_ += delta;
+        splitLocked(false);
+    }
+    drain();
+}
+
+void SpeechPipeline::finish(DoneCallback onDone) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) {
+            return;
+        }
+        finished_ = true;
+        onDone_ = std::move(onDone);
+        if (!cancelled_) {
+            splitLocked(true);
+        }
+    }
+    drain();
+}
+
+void SpeechPipeline::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+        buffer_.clear();
+        queued_.clear();
+    }
+    drain();
+}
+
+void SpeechPipeline::splitLocked(bool flush) {
+    std::string sentence;
+    while (nextSentence(&buffer_, options_, flush, &sentence)) {
+        if (speakable(sentence)) {
+            queued_.push_back(std::move(sentence));
+        }
+    }
+}
+
+void SpeechPipeline::takeSubmissionsLocked(std::vector<Submission>* submissions) {
+    while (!cancelled_ && !queued_.empty() && nextSubmit_ - nextDeliver_ < options_.window) {
+        size_t index = nextSubmit_++;
+        submittedText_[index] = queued_.front();
+        submissions->push_back(Submission{index, std::move(queued_.front())});
+        queued_.pop_front();
+    }
+}
+
+void SpeechPipeline::onResult(size_t index, const SpeechResult& result) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SpeechSegment& segment = ready_[index];
+        segment.index = index;
+        segment.text = std::move(submittedText_[index]);
+        submittedText_.erase(index);
+        segment.success = result.success;
+        segment.url = result.url;
+        segment.error = result.error;
+    }
+    drain();
+}
+
+void SpeechPipeline::drain() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (draining_) {
+            return;
+        }
+        draining_ = true;
+    }
+
+    for (;;) {
+        std::vector<Submission> submissions;
+        SpeechSegment segment;
+        bool popped = false;
+        bool deliver = false;
+        DoneCallback done;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            takeSubmissionsLocked(&submissions);
+            auto it = ready_.find(nextDeliver_);
+            if (it != ready_.end()) {
+                segment = std::move(it->second);
+                ready_.erase(it);
+                ++nextDeliver_;
+                popped = true;
+                deliver = !cancelled_;
+            } else if (submissions.empty()) {
+                // 没有可做的事情时退出，检查与清除标记在同一临界区内，之后到达的结果由其线程自行处理
+                if (finished_ && queued_.empty() && nextDeliver_ == nextSubmit_) {
+                    done.swap(onDone_);
+                }
+                draining_ = false;
+            }
+        }
+
+        if (deliver) {
+            onSegment_(segment);
+        }
+        // 缓存命中时回调可能在 submit 中同步执行，此时 onResult 只记录结果，由本循环交付
+        auto self = shared_from_this();
+        for (auto& submission : submissions) {
+            SpeechRequest request;
+            request.text = std::move(submission.text);
+            size_t index = submission.index;
+            jobs_->submit(request, [self, index](const SpeechResult& result) { self->onResult(index, result); });
+        }
+        if (!popped && submissions.empty()) {
+            if (done) {
+                done();
+            }
+            return;
+        }
+    }
+}
@@ -0,0 +1,185 @@
+#include <muduo/base/Logging.h>
+#include <algorithm>
+
+#include "metrics/MetricsRegistry.h"
+#include "AIUtil/ToolExecutor.h"
+
+ToolExecutor::ToolExecutor(muduo::net::EventLoop* loop, const ToolExecutorOptions& options)
+    : loop_(loop)
+    , options_(options)
+    , pool_(std::max(options.threads, static_cast<size_t>(1)))
+    , inflightCount_(0) {
+    auto& registry = http::metrics::MetricsRegistry::instance();
+    const char* callsName = "tool_calls_total";
+    const char* callsHelp = "AI tool calls by outcome";
+    succeeded_ = &registry.counter(callsName, callsHelp, {{"result", "success"}});
+    failed_ = &registry.counter(callsName, callsHelp, {{"result", "failed"}});
+    timedOut_ = &registry.counter(callsName, callsHelp, {{"result", "timeout"}});
+    retries_ = &registry.counter("tool_call_retries_total", "AI tool attempts retried after a transient error");
+    cacheHits_ = &registry.counter("tool_cache_hits_total", "AI tool calls answered from the result cache");
+    deduplicated_ = &registry.counter("tool_calls_deduplicated_total",
+                                      "AI tool calls attached to an identical call already in flight");
+    registry.gaugeCallback("tool_calls_inflight", "AI tool calls waiting for a result", {},
+                           [this]() { return static_cast<double>(inflight()); });
+}
+
+double ToolExecutor::ttlOf(const Tool& tool) const {
+    auto it = options_.cacheTtl.find(tool.getName());
+    return it != options_.cacheTtl.end() ? it->second : tool.cacheTtl();
+}
+
+void ToolExecutor::submit(std::shared_ptr<Tool> tool, const json& args, double timeout, Callback callback) {
+    loop_->runInLoop([this, tool, args, timeout, callback]() { submitInLoop(tool, args, timeout, callback); });
+}
+
+std::future<ToolResult> ToolExecutor::submit(std::shared_ptr<Tool> tool, const json& args, double timeout) {
+    auto promise = std::make_shared<std::promise<ToolResult>>();
+    std::future<ToolResult> future = promise->get_future();
+    submit(std::move(tool), args, timeout, [promise](const ToolResult& result) { promise->set_value(result); });
+    return future;
+}
+
+void ToolExecutor::submitInLoop(const std::shared_ptr<Tool>& tool, const json& args, double timeout,
+                                Callback callback) {
+    std::string key;
+    if (ttlOf(*tool) > 0 && options_.cacheCapacity > 0) {
+        // 工具名与缓存键以 \0 分隔
+        key = tool->getName();
+        key.push_back('\0');
+        key += tool->cacheKey(args);
+
+        ToolResult result;
+        if (lookupCache(key, &result.value)) {
+            cacheHits_->inc();
+            result.success = true;
+            result.cached = true;
+            callback(result);
+            return;
+        }
+
+        // 合并到在途的相同调用，沿用其截止时间
+        auto it = calls_.find(key);
+        if (it != calls_.end()) {
+            deduplicated_->inc();
+            it->second->waiters.push_back(std::move(callback));
+            return;
+        }
+    }
+
+    double limit = timeout > 0 ? timeout : options_.timeout;
+    auto call = std::make_shared<Call>();
+    call->key = key;
+    call->tool = tool;
+    call->args = args;
+    call->deadline = muduo::addTime(muduo::Timestamp::now(), limit);
+    call->waiters.push_back(std::move(callback));
+    if (!key.empty()) {
+        calls_[key] = call;
+    }
+    inflightCount_.fetch_add(1, std::memory_order_relaxed);
+
+    // 到期仍未完成的调用以超时交付，仍在执行的尝试结束后只更新缓存
+    loop_->runAfter(limit, [this, call]() {
+        if (call->done) {
+            return;
+        }
+        LOG_WARN << "Tool " << call->tool->getName() << " timed out after " << call->attempts << " attempt(s)";
+        ToolResult result;
+        result.timedOut = true;
+        result.error = "工具执行超时";
+        finish(call, result, timedOut_);
+    });
+    runAttempt(call);
+}
+
+void ToolExecutor::runAttempt(const CallPtr& call) {
+    ++call->attempts;
+    pool_.enqueue([this, call]() {
+        ToolResult result;
+        bool retryable = false;
+        try {
+            result.value = call->tool->execute(call->args);
+            result.success = true;
+        } catch (const ToolRetryableError& e) {
+            result.error = e.what();
+            retryable = true;
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        loop_->runInLoop([this, call, result, retryable]() { onAttempt(call, result, retryable); });
+    });
+}
+
+void ToolExecutor::onAttempt(const CallPtr& call, const ToolResult& result, bool retryable) {
+    // 工具以 {"error": ...} 表示的业务错误不缓存
+    if (result.success && !call->key.empty() && !(result.value.is_object() && result.value.contains("error"))) {
+        storeCache(call->key, result.value, ttlOf(*call->tool));
+    }
+    if (call->done) {
+        return;
+    }
+
+    if (retryable && call->attempts <= call->tool->maxRetries()) {
+        // 等待结束时已超过截止时间的不再重试
+        double delay = options_.retryBackoff * call->attempts;
+        if (muduo::addTime(muduo::Timestamp::now(), delay) < call->deadline) {
+            retries_->inc();
+            loop_->runAfter(delay, [this, call]() {
+                if (!call->done) {
+                    runAttempt(call);
+                }
+            });
+            return;
+        }
+    }
+    finish(call, result, result.success ? succeeded_ : failed_);
+}
+
+void ToolExecutor::finish(const CallPtr& call, const ToolResult& result, http::metrics::Counter* outcome) {
+    call->done = true;
+    if (!call->key.empty()) {
+        calls_.erase(call->key);
+    }
+    inflightCount_.fetch_sub(1, std::memory_order_relaxed);
+    outcome->inc();
+    std::vector<Callback> waiters;
+    waiters.swap(call->waiters);
+    for (const auto& waiter : waiters) {
+        waiter(result);
+    }
+}
+
+bool ToolExecutor::lookupCache(const std::string& key, json* value) {
+    auto it = cache_.find(key);
+    if (it == cache_.end()) {
+        return false;
+    }
+    if (it->second.expiresAt < muduo::Timestamp::now()) {
+        lru_.erase(it->second.lruPos);
+        cache_.erase(it);
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+    *value = it->second.value;
+    return true;
+}
+
+void ToolExecutor::storeCache(const std::string& key, const json& value, double ttl) {
+    if (ttl <= 0 || options_.cacheCapacity == 0) {
+        return;
+    }
+    muduo::Timestamp expiresAt = muduo::addTime(muduo::Timestamp::now(), ttl);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        it->second.value = value;
+        it->second.expiresAt = expiresAt;
+        lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+        return;
+    }
+    lru_.push_front(key);
+    cache_[key] = CacheEntry{value, expiresAt, lru_.begin()};
+    while (cache_.size() > options_.cacheCapacity) {
+        cache_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
@@ -1,7 +1,7 @@
 #include "AIUtil/WeatherTool.h"
 #include <curl/curl.h>
-#include <thread>
-#include <chrono>
+#include <algorithm>
+#include <cctype>
 
 std::string WeatherTool::getName() const {
     return "get_weather";
@@ -28,6 +28,22 @@ size_t WeatherTool::WriteCallback(void* contents, size_t size, size_t nmemb, std
     return totalSize;
 }
 
+// 同一城市的天气在缓存时间内共用结果，忽略首尾空白和英文大小写
+std::string WeatherTool::cacheKey(const json& args) const {
+    if (!args.contains("city") || !args["city"].is_string()) {
+        return args.dump();
+    }
+    std::string city = args["city"].get<std::string>();
+    size_t begin = 0;
+    while (begin < city.size() && isspace(static_cast<unsigned char>(city[begin]))) ++begin;
+    size_t end = city.size();
+    while (end > begin && isspace(static_cast<unsigned char>(city[end - 1]))) --end;
+    city = city.substr(begin, end - begin);
+    std::transform(city.begin(), city.end(), city.begin(),
+                   [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return city;
+}
+
 json WeatherTool::execute(const json& args) const {
     if (!args.contains("city")) {
         return json{ {"error", "Missing parameter: city"} };
@@ -57,30 +73,16 @@ json WeatherTool::execute(const json& args) const {
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L); // 10秒超时
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L); // 单次请求 5 秒超时，整体时限由调用方的截止时间控制
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36");
 
-    // 尝试发送请求，最多重试3次
-    CURLcode res;
-    int retryCount = 0;
-    const int maxRetries = 3;
-    
-    do {
-        res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            retryCount++;
-            if (retryCount <= maxRetries) {
-                // 等待一段时间再重试
-                std::this_thread::sleep_for(std::chrono::milliseconds(500 * retryCount));
-            }
-        }
-    } while (res != CURLE_OK && retryCount <= maxRetries);
-
+    // 只请求一次，网络错误交给 ToolExecutor 退避重试，不在线程池中 sleep
+    CURLcode res = curl_easy_perform(curl);
     curl_easy_cleanup(curl);
 
     if (res != CURLE_OK) {
-        return json{ {"error", "网络请求失败，请稍后再试"} };
+        throw ToolRetryableError("网络请求失败，请稍后再试");
     }
     
     // 检查响应是否为空或者包含错误信息
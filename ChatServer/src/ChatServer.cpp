@@ -4,6 +4,8 @@
 #include "http/HttpRequest.h"
 #include "http/HttpResponse.h"
 #include "http/HttpServer.h"
+#include "metrics/MetricsRegistry.h"
+#include "utils/db/DbConnectionPool.h"
 
 #include "handlers/ChatEntryHandler.h"
 #include "handlers/ChatLoginHandler.h"
@@ -15,13 +17,23 @@
 #include "handlers/ChatHistoryHandler.h"
 #include "handlers/ChatCreateAndSendHandler.h"
 #include "handlers/SSEChatHandler.h"
+#include "handlers/ChatStreamSendHandler.h"
+#include "handlers/ChatWebSocketHandler.h"
 #include "handlers/ChatSpeechHandler.h"
 #include "handlers/AIMenuHandler.h"
 #include "AIUtil/AIConfig.h"
+#include "AIUtil/AIFactory.h"
 #include "ChatServer.h"
 
 using namespace http;
 
+namespace {
+
+// 早期示例配置中的占位密钥，已公开，不能用于签名
+const char* const kPlaceholderTokenSecret = "change-me-to-a-random-secret-of-at-least-32-bytes";
+
+} // namespace
+
 ChatServer::ChatServer(int port,
     const std::string& name,
     muduo::net::TcpServer::Option option)
@@ -45,9 +57,36 @@ void ChatServer::initialize() {
     // 初始化中间件
     initializeMiddleware();
 
+    // 加载静态页面
+    initializeStaticFiles();
+
+    // 过载保护，需在注册路由前创建
+    initializeAdmission();
+
     // 初始化路由接口，请求通过 Handler 做相应业务处理
     initializeRouter();
 
+    // 空闲、慢速连接的超时回收和连接数限制
+    const auto& connConfig = AIConfig::getInstance().getConnectionConfig();
+    http::ConnectionOptions connOptions;
+    connOptions.idleTimeout = connConfig.idleTimeout;
+    connOptions.headerTimeout = connConfig.headerTimeout;
+    connOptions.bodyTimeout = connConfig.bodyTimeout;
+    connOptions.maxConnections = static_cast<size_t>(std::max(connConfig.maxConnections, 0));
+    connOptions.maxConnectionsPerIp = static_cast<size_t>(std::max(connConfig.maxConnectionsPerIp, 0));
+    connOptions.maxHeaderBytes = static_cast<size_t>(std::max(connConfig.maxHeaderKb, 1)) * 1024;
+    connOptions.maxBodyBytes = static_cast<size_t>(std::max(connConfig.maxBodyMb, 1)) * 1024 * 1024;
+    httpServer_.setConnectionOptions(connOptions);
+
+    // Prometheus 指标抓取端点
+    httpServer_.enableMetrics("/metrics");
+
+    // 请求耗时分解追踪，默认关闭
+    const auto& traceConfig = AIConfig::getInstance().getTraceConfig();
+    if (traceConfig.sampleRate > 0) {
+        httpServer_.enableTracing(traceConfig.sampleRate, traceConfig.file, traceConfig.flushInterval);
+    }
+
     // 初始化业务线程池，用于处理AI请求
     // 线程数设置为CPU核心数+1，但最少4个，最多16个
     size_t threadCount = std::thread::hardware_concurrency() + 1;
@@ -57,9 +96,87 @@ void ChatServer::initialize() {
     LOG_INFO << "Initializing business thread pool with " << threadCount << " threads";
     businessThreadPool_ = std::make_shared<ThreadPool>(threadCount);
 
+    // 口令哈希线程池，同一线程中批量计算多个待处理的登录
+    const auto& authConfig = AIConfig::getInstance().getAuthConfig();
+    size_t authThreads = static_cast<size_t>(std::max(authConfig.threads, 1));
+    size_t authPending = static_cast<size_t>(std::max(authConfig.maxPending, 1));
+    LOG_INFO << "Initializing auth pool with " << authThreads << " threads";
+    authPool_ = std::make_shared<AuthPool>(authThreads, authPending);
+
+    // 语音合成任务管理
+    initializeSpeech();
+
+    // MCP 模式的工具调用
+    initializeTools();
+
     LOG_INFO << "ChatServer initialize success !";
 }
 
+void ChatServer::initializeSpeech() {
+    const auto& apiKeys = AIConfig::getInstance().getApiKeysConfig();
+    auto provider = AIConfig::getInstance().getSpeechServiceProvider();
+    if (provider == SpeechServiceProvider::BAIDU &&
+        (apiKeys.baiduClientId.empty() || apiKeys.baiduClientSecret.empty())) {
+        LOG_WARN << "Baidu speech credentials not configured, /chat/tts and spoken answers disabled";
+        return;
+    }
+    std::shared_ptr<SpeechService> service = SpeechServiceFactory::createSpeechService(
+        provider, apiKeys.baiduClientId, apiKeys.baiduClientSecret);
+    if (!service) {
+        LOG_WARN << "Unknown speech service provider, /chat/tts and spoken answers disabled";
+        return;
+    }
+
+    const auto& speechConfig = AIConfig::getInstance().getSpeechConfig();
+    SpeechJobOptions options;
+    options.threads = static_cast<size_t>(std::max(speechConfig.threads, 1));
+    options.maxJobs = static_cast<size_t>(std::max(speechConfig.maxJobs, 1));
+    options.pollInterval = speechConfig.pollInterval;
+    options.timeout = speechConfig.timeout;
+    options.cacheTtl = speechConfig.cacheTtl;
+    options.cacheCapacity = static_cast<size_t>(std::max(speechConfig.cacheCapacity, 0));
+    // 任务状态和轮询定时器挂在主循环上，不影响处理连接的 IO 线程
+    speechJobs_ = std::make_shared<SpeechJobManager>(httpServer_.getLoop(), std::move(service), options);
+}
+
+void ChatServer::initializeTools() {
+    const auto& toolConfig = AIConfig::getInstance().getToolConfig();
+    ToolExecutorOptions options;
+    options.threads = static_cast<size_t>(std::max(toolConfig.threads, 1));
+    options.timeout = toolConfig.timeout;
+    options.retryBackoff = toolConfig.retryBackoff;
+    options.cacheCapacity = static_cast<size_t>(std::max(toolConfig.cacheCapacity, 0));
+    options.cacheTtl = toolConfig.cacheTtl;
+    // 与语音任务一样，调用状态和重试定时器挂在主循环上
+    toolExecutor_ = std::make_shared<ToolExecutor>(httpServer_.getLoop(), options);
+    AIConfig::getInstance().getToolRegistry().setExecutor(toolExecutor_);
+}
+
+void ChatServer::initializeStaticFiles() {
+    staticFiles_ = std::make_unique<http::staticfile::StaticFileCache>("../ChatServer/resource");
+    staticFiles_->loadAll();
+    staticFiles_->watch(httpServer_.getLoop());
+}
+
+void ChatServer::serveStaticFile(const http::HttpRequest& req, http::HttpResponse* resp, const std::string& path) {
+    if (staticFiles_->serve(req, resp, path)) {
+        return;
+    }
+    LOG_WARN << path << " not exist";
+    resp->setStatusLine(req.getVersion(), http::HttpResponse::k404NotFound, "Not Found");
+    resp->setCloseConnection(false);
+    auto notFound = staticFiles_->find("NotFound.html");
+    if (notFound && notFound->identity) {
+        resp->setContentType(notFound->contentType);
+        resp->setSharedBody(notFound->identity, notFound->identity->data(), notFound->identity->size());
+        return;
+    }
+    std::string body = "404 Not Found";
+    resp->setContentType("text/plain");
+    resp->setContentLength(body.size());
+    resp->setBody(body);
+}
+
 void ChatServer::loadSessionsFromDatabase() {
     LOG_INFO << "Loading sessions from database...";
     
@@ -123,21 +240,83 @@ void ChatServer::initializeRouter() {
     httpServer_.Post("/user/logout", std::make_shared<ChatLogoutHandler>(this));
 
     httpServer_.Get("/chat", std::make_shared<ChatHandler>(this));
-    httpServer_.Post("/chat/send", std::make_shared<ChatSendHandler>(this));
-    httpServer_.Post("/chat/tts", std::make_shared<ChatSpeechHandler>(this));
+    postExpensive("/chat/send", std::make_shared<ChatSendHandler>(this));
+    postExpensive("/chat/tts", std::make_shared<ChatSpeechHandler>(this));
     httpServer_.Get("/chat/sessions", std::make_shared<ChatSessionsHandler>(this));
     httpServer_.Post("/chat/history", std::make_shared<ChatHistoryHandler>(this));
-    httpServer_.Post("/chat/send-new-session", std::make_shared<ChatCreateAndSendHandler>(this));
+    postExpensive("/chat/send-new-session", std::make_shared<ChatCreateAndSendHandler>(this));
     httpServer_.Get("/chat/stream", std::make_shared<SSEChatHandler>(this));
+    // 单请求流式对话，响应体直接携带生成的 token
+    postExpensive("/chat/send-stream", std::make_shared<ChatStreamSendHandler>(this));
+    // WebSocket 通道，一个连接承载多个会话的收发与取消
+    httpServer_.WebSocket("/chat/ws", std::make_shared<ChatWebSocketHandler>(this));
  
     httpServer_.Get("/menu", std::make_shared<AIMenuHandler>(this));
 }
 
+void ChatServer::postExpensive(const std::string& path, http::router::Router::HandlerPtr handler) {
+    if (admission_) {
+        httpServer_.Post(path, handler, {std::make_shared<http::middleware::AdmissionMiddleware>(admission_, path)});
+    } else {
+        httpServer_.Post(path, handler);
+    }
+}
+
+void ChatServer::initializeAdmission() {
+    const auto& config = AIConfig::getInstance().getAdmissionConfig();
+    if (!config.enabled) {
+        return;
+    }
+
+    http::middleware::AdmissionOptions options;
+    options.maxLoopLagMs = config.maxLoopLagMs;
+    options.retryAfter = std::max(config.retryAfter, 1);
+    admission_ = std::make_shared<http::middleware::AdmissionController>(options);
+
+    // 业务线程池在路由注册之后创建，采样时才读取
+    admission_->addSignal("worker_queue_depth", [this]() {
+        return businessThreadPool_ ? static_cast<double>(businessThreadPool_->pendingTasks()) : 0.0;
+    }, config.maxQueueDepth);
+    admission_->addSignal("worker_queue_age_ms", [this]() {
+        return businessThreadPool_ ? businessThreadPool_->oldestTaskWaitMs() : 0.0;
+    }, config.maxQueueAgeMs);
+    admission_->addSignal("db_pool_waiters", []() {
+        return static_cast<double>(http::db::DbConnectionPool::getInstance().waitingThreads());
+    }, config.maxDbWaiters);
+    admission_->start(httpServer_.getLoop());
+}
+
 void ChatServer::initializeSession() {
-    auto sessionStorage = std::make_unique<http::session::MemorySessionStorage>();
+    auto sessionStorage = std::make_unique<http::session::ShardedSessionStorage>();
     auto sessionManager = std::make_unique<http::session::SessionManager>(std::move(sessionStorage));
 
     setSessionManager(std::move(sessionManager));
+
+    const auto& sessionConfig = AIConfig::getInstance().getSessionConfig();
+    if (sessionConfig.mode == "token") {
+        // 令牌模式下密钥无效时拒绝启动，而不是退回服务端会话
+        if (sessionConfig.tokenSecret == kPlaceholderTokenSecret) {
+            LOG_FATAL << "Session token secret is the example placeholder, set SESSION_TOKEN_SECRET";
+        }
+        try {
+            http::session::SessionTokenCodec::Options options;
+            options.secret = sessionConfig.tokenSecret;
+            options.encrypt = sessionConfig.tokenEncrypt;
+            options.maxAge = sessionConfig.maxAge;
+            tokenCodec_ = std::make_unique<http::session::SessionTokenCodec>(options);
+            LOG_INFO << "Session mode: signed token";
+        } catch (const std::exception& e) {
+            LOG_FATAL << "Invalid session token config (set SESSION_TOKEN_SECRET): " << e.what();
+        }
+    }
+
+    // 每秒推进一次时间轮，清理过期会话和吊销记录
+    httpServer_.getLoop()->runEvery(1.0, [this]() {
+        getSessionManager()->cleanExpiredSessions();
+        if (tokenCodec_) {
+            tokenCodec_->cleanRevoked();
+        }
+    });
     loadSessionsFromDatabase();
 }
 
@@ -160,6 +339,9 @@ void ChatServer::updateLRUCache(int userId, const std::string& sessionId) {
 }
 
 void ChatServer::evictLRUCacheIfNeeded() {
+    static http::metrics::Counter& evictions = http::metrics::MetricsRegistry::instance().counter(
+        "chat_lru_evictions_total", "In-memory chat sessions evicted by the LRU cache");
+
     // 从配置中获取最大活跃会话数
     const auto& limitsConfig = AIConfig::getInstance().getLimitsConfig();
     const size_t MAX_ACTIVE_SESSIONS = limitsConfig.maxActiveSessions;
@@ -184,6 +366,7 @@ void ChatServer::evictLRUCacheIfNeeded() {
             }
         }
         
+        evictions.inc();
         LOG_INFO << "LRU Cache Eviction: Removed session '" << sessionId 
                  << "' for user " << userId;
     }
@@ -193,6 +376,99 @@ void ChatServer::initializeMiddleware() {
     // 添加 CORS 中间件
     auto corsMiddleware = std::make_shared<http::middleware::CorsMiddleware>();
     httpServer_.addMiddleware(corsMiddleware);
+
+    // 添加安全响应头中间件
+    auto securityMiddleware = std::make_shared<http::middleware::SecurityHeadersMiddleware>();
+    httpServer_.addMiddleware(securityMiddleware);
+
+    // 添加响应压缩中间件
+    auto compressionMiddleware = std::make_shared<http::middleware::CompressionMiddleware>();
+    httpServer_.addMiddleware(compressionMiddleware);
+
+    // 添加限流中间件，放在最后，429 响应同样带安全头
+    const auto& rateConfig = AIConfig::getInstance().getRateLimitConfig();
+    if (rateConfig.enabled) {
+        http::middleware::RateLimit defaultLimit;
+        defaultLimit.rate = rateConfig.defaultRate;
+        defaultLimit.burst = rateConfig.defaultBurst;
+        // 已登录用户按用户ID计数，同一用户多个连接、多个 IP 共用一个桶
+        auto rateLimitMiddleware = std::make_shared<http::middleware::RateLimitMiddleware>(defaultLimit,
+            [this](const http::HttpRequest& req) -> std::string {
+                if (tokenCodec_) {
+                    http::session::SessionClaims claims;
+                    if (!tokenCodec_->verify(tokenCodec_->getTokenFromCookie(req), &claims)) {
+                        return std::string();
+                    }
+                    return "user:" + std::to_string(claims.userId);
+                }
+                auto session = getSessionManager()->findSession(req);
+                if (!session || session->getValue("isLoggedIn") != "true") {
+                    return std::string();
+                }
+                return "user:" + session->getValue("userId");
+            });
+        http::middleware::RateLimit chatLimit;
+        chatLimit.rate = rateConfig.chatRate;
+        chatLimit.burst = rateConfig.chatBurst;
+        rateLimitMiddleware->addClass("chat", chatLimit,
+            {"/chat/send", "/chat/send-new-session", "/chat/send-stream", "/chat/tts"});
+        rateLimitMiddleware->start(httpServer_.getLoop());
+        httpServer_.addMiddleware(rateLimitMiddleware);
+    }
+}
+
+bool ChatServer::authenticate(const http::HttpRequest& req, http::HttpResponse* resp, AuthUser* user) {
+    http::trace::Span span("session.lookup");
+    if (tokenCodec_) {
+        http::session::SessionClaims claims;
+        if (!tokenCodec_->verify(tokenCodec_->getTokenFromCookie(req), &claims)) {
+            return false;
+        }
+        user->userId = static_cast<int>(claims.userId);
+        user->username = std::move(claims.username);
+        return true;
+    }
+
+    auto session = getSessionManager()->getSession(req, resp);
+    if (session->getValue("isLoggedIn") != "true") {
+        return false;
+    }
+    user->userId = std::stoi(session->getValue("userId"));
+    user->username = session->getValue("username");
+    return true;
+}
+
+void ChatServer::establishLogin(const http::HttpRequest& req, http::HttpResponse* resp, int userId, const std::string& username) {
+    if (tokenCodec_) {
+        tokenCodec_->setTokenCookie(tokenCodec_->issue(userId, username), resp);
+        return;
+    }
+
+    auto session = getSessionManager()->getSession(req, resp);
+    // 一次写入全部字段，只触发一次保存
+    session->setValues({
+        {"userId", std::to_string(userId)},
+        {"username", username},
+        {"isLoggedIn", "true"},
+    });
+}
+
+int ChatServer::revokeLogin(const http::HttpRequest& req, http::HttpResponse* resp) {
+    if (tokenCodec_) {
+        http::session::SessionClaims claims;
+        if (!tokenCodec_->verify(tokenCodec_->getTokenFromCookie(req), &claims)) {
+            return -1;
+        }
+        tokenCodec_->revoke(claims);
+        tokenCodec_->clearTokenCookie(resp);
+        return static_cast<int>(claims.userId);
+    }
+
+    auto session = getSessionManager()->getSession(req, resp);
+    std::string userId = session->getValue("userId");
+    session->clear();
+    getSessionManager()->destroySession(session->getId());
+    return userId.empty() ? -1 : std::stoi(userId);
 }
 
 void ChatServer::packageResp(const std::string& version, http::HttpResponse::HttpStatusCode statusCode,
@@ -219,7 +495,10 @@ void ChatServer::removeSSEConnection(const std::string& sessionId) {
 }
 
 void ChatServer::sendSSEData(const std::string& sessionId, const std::string& data, const std::string& eventType) {
-    httpServer_.getLoop()->runInLoop([this, sessionId, data, eventType]() {
+    // 从投递到写入输出缓冲，包含在 IO 线程中排队的时间
+    const http::trace::TraceContext& traceCtx = http::trace::Tracer::current();
+    int64_t enqueuedNs = traceCtx.sampled ? http::trace::nowNanos() : 0;
+    httpServer_.getLoop()->runInLoop([this, sessionId, data, eventType, traceCtx, enqueuedNs]() {
         auto it = sseConnections_.find(sessionId);
         if (it != sseConnections_.end() && it->second && it->second->connected()) {
             std::ostringstream oss;
@@ -233,7 +512,10 @@ void ChatServer::sendSSEData(const std::string& sessionId, const std::string& da
                 oss << "data: " << data << "\n\n";
             }
             
-            it->second->send(oss.str());
+            http::HttpContext::send(it->second, oss.str());
+        }
+        if (traceCtx.sampled) {
+            http::trace::Tracer::instance().record(traceCtx, "sse.deliver", enqueuedNs, http::trace::nowNanos());
         }
     });
 }
@@ -290,6 +572,7 @@ void ChatServer::removeSessionId(int userId, const std::string& sessionId) {
 }
 
 std::vector<std::string> ChatServer::getSessionIds(int userId) const {
+    http::trace::Span span("loop.roundtrip");
     std::promise<std::vector<std::string>> prom;
     auto fut = prom.get_future();
     
@@ -313,6 +596,7 @@ void ChatServer::addOrUpdateChatSession(int userId, const std::string& sessionId
 }
 
 std::shared_ptr<AIHelper> ChatServer::getChatSession(int userId, const std::string& sessionId) {
+    http::trace::Span span("loop.roundtrip");
     std::promise<std::shared_ptr<AIHelper>> prom;
     auto fut = prom.get_future();
     
@@ -359,14 +643,14 @@ void ChatServer::setChatResult(const std::string& sessionId, const std::string&
             j["result"] = result; 
             resultData << "data: " << j.dump() << "\n\n";
             
-            it->second->send(resultData.str());
+            http::HttpContext::send(it->second, resultData.str());
             
             // 发送结束事件
             std::ostringstream endData;
             endData << "event: end\n";
             endData << "data: {\"message\": \"AI processing completed\"}\n\n";
             
-            it->second->send(endData.str());
+            http::HttpContext::send(it->second, endData.str());
         }
         
         // 移除聊天结果，释放内存
@@ -4,15 +4,14 @@ void AIMenuHandler::handle(const http::HttpRequest& req, http::HttpResponse* res
 {
     try
     {
-        auto session = server_->getSessionManager()->getSession(req, resp);
-        LOG_INFO << "session->getValue(\"isLoggedIn\") = " << session->getValue("isLoggedIn");
-        if (session->getValue("isLoggedIn") != "true")
+        AuthUser user;
+        if (!server_->authenticate(req, resp, &user))
         {
 
             json errorResp;
             errorResp["status"] = "error";
             errorResp["message"] = "Unauthorized";
-            std::string errorBody = errorResp.dump(4);
+            std::string errorBody = errorResp.dump();
 
             server_->packageResp(req.getVersion(), http::HttpResponse::k401Unauthorized,
                 "Unauthorized", true, "application/json", errorBody.size(),
@@ -20,40 +19,14 @@ void AIMenuHandler::handle(const http::HttpRequest& req, http::HttpResponse* res
             return;
         }
 
-        int userId = std::stoi(session->getValue("userId"));
-        std::string username = session->getValue("username");
-
-        std::string reqFile("../ChatServer/resource/menu.html");
-        FileUtil fileOperater(reqFile);
-        if (!fileOperater.isValid())
-        {
-            LOG_WARN << reqFile << "not exist.";
-            fileOperater.resetDefaultFile();
-        }
-
-        std::vector<char> buffer(fileOperater.size());
-        fileOperater.readFile(buffer); // ļ
-        std::string htmlContent(buffer.data(), buffer.size());
-
-        size_t headEnd = htmlContent.find("</head>");
-        if (headEnd != std::string::npos)
-        {
-            std::string script = "<script>const userId = '" + std::to_string(userId) + "';</script>";
-            htmlContent.insert(headEnd, script);
-        }
-
-        resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
-        resp->setCloseConnection(false);
-        resp->setContentType("text/html");
-        resp->setContentLength(htmlContent.size());
-        resp->setBody(htmlContent);
+        server_->serveStaticFile(req, resp, "menu.html");
     }
     catch (const std::exception& e)
     {
         json failureResp;
         failureResp["status"] = "error";
         failureResp["message"] = e.what();
-        std::string failureBody = failureResp.dump(4);
+        std::string failureBody = failureResp.dump();
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
         resp->setCloseConnection(true);
         resp->setContentType("application/json");
@@ -5,13 +5,13 @@ void ChatCreateAndSendHandler::handle(const http::HttpRequest& req, http::HttpRe
 {
 	try
 	{
-		auto session = server_->getSessionManager()->getSession(req, resp);
-		if (session->getValue("isLoggedIn") != "true")
+		AuthUser user;
+		if (!server_->authenticate(req, resp, &user))
 		{
 			json errorResp;
 			errorResp["status"] = "error";
 			errorResp["message"] = "Unauthorized";
-			std::string errorBody = errorResp.dump(4);
+			std::string errorBody = errorResp.dump();
 
 			server_->packageResp(req.getVersion(), http::HttpResponse::k401Unauthorized,
 				"Unauthorized", true, "application/json", errorBody.size(),
@@ -19,8 +19,8 @@ void ChatCreateAndSendHandler::handle(const http::HttpRequest& req, http::HttpRe
 			return;
 		}
 
-		int userId = std::stoi(session->getValue("userId"));
-		std::string username = session->getValue("username");
+		int userId = user.userId;
+		std::string username = user.username;
 		std::string userQuestion;
 		std::string modelType;
 
@@ -71,7 +71,9 @@ void ChatCreateAndSendHandler::handle(const http::HttpRequest& req, http::HttpRe
 		auto future = AIHelperPtr->chatAsync(server_->getBusinessThreadPool(), userId, username, sessionId, userQuestion, modelType);
 		
 		// 在另一个线程中等待结果并处理
-		server_->getBusinessThreadPool()->enqueue([this, sessionId, userId, future = std::move(future)]() mutable {
+		server_->getBusinessThreadPool()->enqueue([this, sessionId, userId, future = std::move(future),
+		                                           traceCtx = http::trace::Tracer::current()]() mutable {
+			http::trace::ScopedTraceContext scopedTrace(traceCtx);
 			try {
 				std::string result = future.get();
 				// 通过SSE推送结果给客户端
@@ -91,7 +93,7 @@ void ChatCreateAndSendHandler::handle(const http::HttpRequest& req, http::HttpRe
 		successResp["message"] = "AI processing started";
 		successResp["sessionId"] = sessionId;
 
-		std::string successBody = successResp.dump(4);
+		std::string successBody = successResp.dump();
 		resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
 		resp->setCloseConnection(false);
 		resp->setContentType("application/json");
@@ -104,7 +106,7 @@ void ChatCreateAndSendHandler::handle(const http::HttpRequest& req, http::HttpRe
 		json failureResp;
 		failureResp["status"] = "error";
 		failureResp["message"] = e.what();
-		std::string failureBody = failureResp.dump(4);
+		std::string failureBody = failureResp.dump();
 		resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
 		resp->setCloseConnection(true);
 		resp->setContentType("application/json");
@@ -2,22 +2,5 @@
 
 void ChatEntryHandler::handle(const http::HttpRequest& req, http::HttpResponse* resp)
 {
-    std::string reqFile;
-    reqFile.append("../ChatServer/resource/entry.html");
-    FileUtil fileOperater(reqFile);
-    if (!fileOperater.isValid())
-    {
-        LOG_WARN << reqFile << " not exist";
-        fileOperater.resetDefaultFile();
-    }
-
-    std::vector<char> buffer(fileOperater.size());
-    fileOperater.readFile(buffer); 
-    std::string bufStr = std::string(buffer.data(), buffer.size());
-
-    resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
-    resp->setCloseConnection(false);
-    resp->setContentType("text/html");
-    resp->setContentLength(bufStr.size());
-    resp->setBody(bufStr);
+    server_->serveStaticFile(req, resp, "entry.html");
 }
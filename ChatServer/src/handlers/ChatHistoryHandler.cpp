@@ -1,19 +1,21 @@
 #include "handlers/ChatHistoryHandler.h"
 #include <muduo/base/Logging.h>
 
+#include "logging/Log.h"
+#include "utils/JsonWriter.h"
+
 void ChatHistoryHandler::handle(const http::HttpRequest& req, http::HttpResponse* resp)
 {
     try
     {
-        auto session = server_->getSessionManager()->getSession(req, resp);
-        LOG_INFO << "session->getValue(\"isLoggedIn\") = " << session->getValue("isLoggedIn");
-        if (session->getValue("isLoggedIn") != "true")
+        AuthUser user;
+        if (!server_->authenticate(req, resp, &user))
         {
 
             json errorResp;
             errorResp["status"] = "error";
             errorResp["message"] = "Unauthorized";
-            std::string errorBody = errorResp.dump(4);
+            std::string errorBody = errorResp.dump();
 
             server_->packageResp(req.getVersion(), http::HttpResponse::k401Unauthorized,
                 "Unauthorized", true, "application/json", errorBody.size(),
@@ -21,8 +23,8 @@ void ChatHistoryHandler::handle(const http::HttpRequest& req, http::HttpResponse
             return;
         }
 
-        int userId = std::stoi(session->getValue("userId"));
-        std::string username = session->getValue("username");
+        int userId = user.userId;
+        std::string username = user.username;
 
         std::string sessionId;
         json j;
@@ -35,7 +37,10 @@ void ChatHistoryHandler::handle(const http::HttpRequest& req, http::HttpResponse
             if (j.contains("sessionId")) sessionId = j["sessionId"];
         }
         
-        json historyArray = json::array();
+        // 结果集逐行写入响应体，不构造 json DOM
+        std::string successBody;
+        http::JsonWriter writer(&successBody);
+        writer.startObject().member("success", true).key("history").startArray();
 
         // 直接从数据库查询历史记录
         try {
@@ -46,29 +51,30 @@ void ChatHistoryHandler::handle(const http::HttpRequest& req, http::HttpResponse
             std::unique_ptr<sql::ResultSet> result(server_->mysqlUtil_.executeQuery(sql, std::to_string(userId), sessionId));
             
             if (result) {
+                size_t count = 0;
                 while (result->next()) {
-                    json msgJson;
-                    msgJson["is_user"] = (result->getInt("is_user") == 1);
-                    msgJson["content"] = result->getString("content");
-                    historyArray.push_back(msgJson);
+                    // 按列序号取值，省去按列名查找
+                    writer.startObject()
+                          .member("is_user", result->getInt(1) == 1)
+                          .member("content", result->getString(2).asStdString())
+                          .endObject();
+                    ++count;
                 }
-                // unique_ptr会自动释放资源，不再需要手动delete
-                LOG_INFO << "Found " << historyArray.size() << " messages for session " << sessionId;
+                LOG_MODULE("chat", DEBUG) << "History loaded" << http::logging::kv("messages", count)
+                                          << http::logging::kv("session", sessionId);
             }
+            writer.endArray().endObject();
         } catch (const std::exception& e) {
             LOG_ERROR << "Failed to query message history: " << e.what();
+            // 查询中途失败时丢弃已写入的部分，返回空历史
+            successBody = "{\"success\":true,\"history\":[]}";
         }
 
-        json successResp;
-        successResp["success"] = true;
-        successResp["history"] = historyArray;
-        std::string successBody = successResp.dump(4);
-
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
         resp->setCloseConnection(false);
         resp->setContentType("application/json");
         resp->setContentLength(successBody.size());
-        resp->setBody(successBody);
+        resp->setBody(std::move(successBody));
         return;
     }
     catch (const std::exception& e)
@@ -76,7 +82,7 @@ void ChatHistoryHandler::handle(const http::HttpRequest& req, http::HttpResponse
         json failureResp;
         failureResp["status"] = "error";
         failureResp["message"] = e.what();
-        std::string failureBody = failureResp.dump(4);
+        std::string failureBody = failureResp.dump();
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
         resp->setCloseConnection(true);
         resp->setContentType("application/json");
@@ -1,6 +1,41 @@
 #include "handlers/ChatLoginHandler.h"
 #include <shared_mutex>
 
+namespace
+{
+
+void reply(const http::DeferredResponsePtr& pending, const std::string& version,
+           http::HttpResponse::HttpStatusCode code, const std::string& statusMsg, bool close, const json& body)
+{
+    std::string content = body.dump();
+    http::HttpResponse* resp = pending->response();
+    resp->setStatusLine(version, code, statusMsg);
+    resp->setCloseConnection(close);
+    resp->setContentType("application/json");
+    resp->setContentLength(content.size());
+    resp->setBody(content);
+    pending->complete();
+}
+
+void replyInvalid(const http::DeferredResponsePtr& pending, const std::string& version)
+{
+    json failureResp;
+    failureResp["status"] = "error";
+    failureResp["message"] = "Invalid username or password";
+    reply(pending, version, http::HttpResponse::k401Unauthorized, "Unauthorized", false, failureResp);
+}
+
+void replyBusy(const http::DeferredResponsePtr& pending, const std::string& version)
+{
+    json failureResp;
+    failureResp["status"] = "error";
+    failureResp["message"] = "Server is busy, please retry later";
+    pending->response()->addHeader("Retry-After", "1");
+    reply(pending, version, http::HttpResponse::k503ServiceUnavailable, "Service Unavailable", false, failureResp);
+}
+
+} // namespace
+
 void ChatLoginHandler::handle(const http::HttpRequest& req, http::HttpResponse* resp)
 { 
     json parsed;
@@ -14,68 +49,24 @@ void ChatLoginHandler::handle(const http::HttpRequest& req, http::HttpResponse*
         std::string username = parsed["username"];
         std::string password = parsed["password"];
 
-        int userId = queryUserId(username, password);
-        if (userId != -1)
-        {
-            auto session = server_->getSessionManager()->getSession(req, resp);
-            session->setValue("userId", std::to_string(userId));
-            session->setValue("username", username);
-            session->setValue("isLoggedIn", "true");
-
-            // 检查在线状态并更新
-            // 使用无锁方法替代 mutexForOnlineUsers_
-            if (!server_->isUserOnline(userId))
+        // 查询用户和口令校验都在鉴权线程池中执行，IO 线程不等待，结果经 DeferredResponse 发回
+        auto request = std::make_shared<http::HttpRequest>(req);
+        resp->defer([this, request, username, password](const http::DeferredResponsePtr& pending) {
+            bool accepted = server_->getAuthPool()->post([this, request, username, password, pending]() {
+                verifyLogin(request, username, password, pending);
+            });
+            if (!accepted)
             {
-                server_->addUser(userId);
-
-                json successResp;
-                successResp["success"] = true;
-                successResp["userId"] = userId;
-                std::string successBody = successResp.dump(4);
-
-                resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
-                resp->setCloseConnection(false);
-                resp->setContentType("application/json");
-                resp->setContentLength(successBody.size());
-                resp->setBody(successBody);
-                return;
-            }
-            else
-            {
-                json failureResp;
-                failureResp["success"] = false;
-                failureResp["error"] = "账号已在其他地方登录";
-                std::string failureBody = failureResp.dump(4);
-
-                resp->setStatusLine(req.getVersion(), http::HttpResponse::k403Forbidden, "Forbidden");
-                resp->setCloseConnection(true);
-                resp->setContentType("application/json");
-                resp->setContentLength(failureBody.size());
-                resp->setBody(failureBody);
-                return;
+                replyBusy(pending, request->getVersion());
             }
-        }
-        else 
-        {
-            json failureResp;
-            failureResp["status"] = "error";
-            failureResp["message"] = "Invalid username or password";
-            std::string failureBody = failureResp.dump(4);
-
-            resp->setStatusLine(req.getVersion(), http::HttpResponse::k401Unauthorized, "Unauthorized");
-            resp->setCloseConnection(false);
-            resp->setContentType("application/json");
-            resp->setContentLength(failureBody.size());
-            resp->setBody(failureBody);
-            return;
-        }
+        });
     }
     catch (const std::exception& e)
     {
         json failureResp;
         failureResp["status"] = "error";
         failureResp["message"] = e.what();
-        std::string failureBody = failureResp.dump(4);
+        std::string failureBody = failureResp.dump();
 
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
         resp->setCloseConnection(true);
@@ -86,24 +77,77 @@ void ChatLoginHandler::handle(const http::HttpRequest& req, http::HttpResponse*
     }
 }
 
-int ChatLoginHandler::queryUserId(const std::string& username, const std::string& password)
+void ChatLoginHandler::verifyLogin(const std::shared_ptr<http::HttpRequest>& request, const std::string& username,
+                                   const std::string& password, const http::DeferredResponsePtr& pending)
 {
-    // 先查询用户的盐值
-    std::string saltSql = "SELECT id, password, salt FROM users WHERE username = ?";
-    auto res = mysqlUtil_.executeQuery(saltSql, username);
-    
-    if (res->next())
+    const http::HttpRequest& req = *request;
+    int userId = -1;
+    std::string storedPassword;
+    std::string salt;
+    try
     {
-        int id = res->getInt("id");
-        std::string storedPassword = res->getString("password");
-        std::string salt = res->getString("salt");
-        
-        // 验证密码
-        if (PasswordUtil::verifyPassword(password, salt, storedPassword))
+        // 先查询用户的盐值
+        std::string saltSql = "SELECT id, password, salt FROM users WHERE username = ?";
+        auto res = mysqlUtil_.executeQuery(saltSql, username);
+        if (res->next())
         {
-            return id;
+            userId = res->getInt("id");
+            storedPassword = res->getString("password");
+            salt = res->getString("salt");
         }
     }
+    catch (const std::exception& e)
+    {
+        json failureResp;
+        failureResp["status"] = "error";
+        failureResp["message"] = e.what();
+        reply(pending, req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request", true, failureResp);
+        return;
+    }
+
+    if (userId == -1)
+    {
+        replyInvalid(pending, req.getVersion());
+        return;
+    }
+
+    // 哈希任务排队后与其它待校验的登录一起计算
+    bool accepted = server_->getAuthPool()->hash(password, salt,
+        [this, request, userId, username, storedPassword, pending](const std::string& hash) {
+            if (hash.empty() || !PasswordUtil::equals(hash, storedPassword))
+            {
+                replyInvalid(pending, request->getVersion());
+                return;
+            }
+            completeLogin(*request, userId, username, pending);
+        });
+    if (!accepted)
+    {
+        replyBusy(pending, req.getVersion());
+    }
+}
 
-    return -1;
-}
\ No newline at end of file
+void ChatLoginHandler::completeLogin(const http::HttpRequest& req, int userId, const std::string& username,
+                                     const http::DeferredResponsePtr& pending)
+{
+    server_->establishLogin(req, pending->response(), userId, username);
+
+    // 检查在线状态并更新
+    // 使用无锁方法替代 mutexForOnlineUsers_
+    if (!server_->isUserOnline(userId))
+    {
+        server_->addUser(userId);
+
+        json successResp;
+        successResp["success"] = true;
+        successResp["userId"] = userId;
+        reply(pending, req.getVersion(), http::HttpResponse::k200Ok, "OK", false, successResp);
+    }
+    else
+    {
+        json failureResp;
+        failureResp["success"] = false;
+        failureResp["error"] = "账号已在其他地方登录";
+        reply(pending, req.getVersion(), http::HttpResponse::k403Forbidden, "Forbidden", true, failureResp);
+    }
+}
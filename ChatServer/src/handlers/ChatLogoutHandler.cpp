@@ -16,18 +16,18 @@ void ChatLogoutHandler::handle(const http::HttpRequest& req, http::HttpResponse*
 
     try
     {
-        auto session = server_->getSessionManager()->getSession(req, resp);
-        int userId = std::stoi(session->getValue("userId"));
-
-        session->clear();
-        server_->getSessionManager()->destroySession(session->getId());
+        int userId = server_->revokeLogin(req, resp);
+        if (userId == -1)
+        {
+            throw std::runtime_error("User not logged in");
+        }
 
         // 使用无锁方法替代 mutexForOnlineUsers_
         server_->removeUser(userId);
 
         json response;
         response["message"] = "logout successful";
-        std::string responseBody = response.dump(4);
+        std::string responseBody = response.dump();
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
         resp->setCloseConnection(true);
         resp->setContentType("application/json");
@@ -39,7 +39,7 @@ void ChatLogoutHandler::handle(const http::HttpRequest& req, http::HttpResponse*
         json failureResp;
         failureResp["status"] = "error";
         failureResp["message"] = e.what();
-        std::string failureBody = failureResp.dump(4);
+        std::string failureBody = failureResp.dump();
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
         resp->setCloseConnection(true);
         resp->setContentType("application/json");
@@ -1,6 +1,24 @@
 
 #include "handlers/ChatRegisterHandler.h"
 
+namespace
+{
+
+void reply(const http::DeferredResponsePtr& pending, const std::string& version,
+           http::HttpResponse::HttpStatusCode code, const std::string& statusMsg, const json& body)
+{
+    std::string content = body.dump();
+    http::HttpResponse* resp = pending->response();
+    resp->setStatusLine(version, code, statusMsg);
+    resp->setCloseConnection(false);
+    resp->setContentType("application/json");
+    resp->setContentLength(content.size());
+    resp->setBody(content);
+    pending->complete();
+}
+
+} // namespace
+
 void ChatRegisterHandler::handle(const http::HttpRequest& req, http::HttpResponse* resp)
 {
     json parsed;
@@ -12,44 +30,64 @@ void ChatRegisterHandler::handle(const http::HttpRequest& req, http::HttpRespons
     std::string username = parsed["username"];
     std::string password = parsed["password"];
 
-    int userId = insertUser(username, password);
+    // 口令哈希在鉴权线程池中计算，完成后在同一线程写入数据库并回复
+    std::string version = req.getVersion();
+    resp->defer([this, version, username, password](const http::DeferredResponsePtr& pending) {
+        // 生成盐值
+        std::string salt = PasswordUtil::generateSalt();
+        bool accepted = server_->getAuthPool()->hash(password, salt,
+            [this, version, username, salt, pending](const std::string& hashedPassword) {
+                completeRegister(version, username, hashedPassword, salt, pending);
+            });
+        if (!accepted)
+        {
+            json failureResp;
+            failureResp["status"] = "error";
+            failureResp["message"] = "Server is busy, please retry later";
+            pending->response()->addHeader("Retry-After", "1");
+            reply(pending, version, http::HttpResponse::k503ServiceUnavailable, "Service Unavailable", failureResp);
+        }
+    });
+}
+
+void ChatRegisterHandler::completeRegister(const std::string& version, const std::string& username,
+                                           const std::string& hashedPassword, const std::string& salt,
+                                           const http::DeferredResponsePtr& pending)
+{
+    int userId = -1;
+    try
+    {
+        userId = insertUser(username, hashedPassword, salt);
+    }
+    catch (const std::exception& e)
+    {
+        json failureResp;
+        failureResp["status"] = "error";
+        failureResp["message"] = e.what();
+        reply(pending, version, http::HttpResponse::k500InternalServerError, "Internal Server Error", failureResp);
+        return;
+    }
+
     if (userId != -1)
     {
         json successResp;
         successResp["status"] = "success";
         successResp["message"] = "Register successful";
         successResp["userId"] = userId;
-        std::string successBody = successResp.dump(4);
-
-        resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
-        resp->setCloseConnection(false);
-        resp->setContentType("application/json");
-        resp->setContentLength(successBody.size());
-        resp->setBody(successBody);
+        reply(pending, version, http::HttpResponse::k200Ok, "OK", successResp);
     }
     else
     {
         json failureResp;
         failureResp["status"] = "error";
         failureResp["message"] = "username already exists";
-        std::string failureBody = failureResp.dump(4);
-
-        resp->setStatusLine(req.getVersion(), http::HttpResponse::k409Conflict, "Conflict");
-        resp->setCloseConnection(false);
-        resp->setContentType("application/json");
-        resp->setContentLength(failureBody.size());
-        resp->setBody(failureBody);
+        reply(pending, version, http::HttpResponse::k409Conflict, "Conflict", failureResp);
     }
 }
 
-int ChatRegisterHandler::insertUser(const std::string& username, const std::string& password)
+int ChatRegisterHandler::insertUser(const std::string& username, const std::string& hashedPassword,
+                                    const std::string& salt)
 {
-    // 生成盐值
-    std::string salt = PasswordUtil::generateSalt();
-    
-    // 使用PBKDF2算法对密码进行哈希
-    std::string hashedPassword = PasswordUtil::hashPassword(password, salt);
-    
     // 使用 INSERT IGNORE 来避免竞态条件
     // 如果用户名已存在，插入会被忽略，返回0行受影响
     std::string sql = "INSERT IGNORE INTO users (username, password, salt) VALUES (?, ?, ?)";
@@ -5,14 +5,13 @@ void ChatSendHandler::handle(const http::HttpRequest& req, http::HttpResponse* r
 {
 	try
 	{
-		auto session = server_->getSessionManager()->getSession(req, resp);
-		LOG_INFO << "session->getValue(\"isLoggedIn\") = " << session->getValue("isLoggedIn");
-		if (session->getValue("isLoggedIn") != "true")
+		AuthUser user;
+		if (!server_->authenticate(req, resp, &user))
 		{
 			json errorResp;
 			errorResp["status"] = "error";
 			errorResp["message"] = "Unauthorized";
-			std::string errorBody = errorResp.dump(4);
+			std::string errorBody = errorResp.dump();
 
 			server_->packageResp(req.getVersion(), http::HttpResponse::k401Unauthorized,
 				"Unauthorized", true, "application/json", errorBody.size(),
@@ -20,8 +19,8 @@ void ChatSendHandler::handle(const http::HttpRequest& req, http::HttpResponse* r
 			return;
 		}
 
-		int userId = std::stoi(session->getValue("userId"));
-		std::string username = session->getValue("username");
+		int userId = user.userId;
+		std::string username = user.username;
 		std::string userQuestion;
 		std::string sessionId;
 		std::string modelType;
@@ -74,7 +73,9 @@ void ChatSendHandler::handle(const http::HttpRequest& req, http::HttpResponse* r
 		auto future = AIHelperPtr->chatAsync(server_->getBusinessThreadPool(), userId, username, sessionId, userQuestion, modelType, streamCallback);
 		
 		// 在另一个线程中等待结果并处理最终结果
-		server_->getBusinessThreadPool()->enqueue([this, sessionId, userId, future = std::move(future)]() mutable {
+		server_->getBusinessThreadPool()->enqueue([this, sessionId, userId, future = std::move(future),
+		                                           traceCtx = http::trace::Tracer::current()]() mutable {
+			http::trace::ScopedTraceContext scopedTrace(traceCtx);
 			try {
 				std::string result = future.get();
 				// 推送结果给客户端 (这里是 SSE)
@@ -99,7 +100,7 @@ void ChatSendHandler::handle(const http::HttpRequest& req, http::HttpResponse* r
 		successResp["message"] = "AI processing started";
 		successResp["sessionId"] = sessionId;
 
-		std::string successBody = successResp.dump(4);
+		std::string successBody = successResp.dump();
 		resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
 		resp->setCloseConnection(false);
 		resp->setContentType("application/json");
@@ -112,7 +113,7 @@ void ChatSendHandler::handle(const http::HttpRequest& req, http::HttpResponse* r
 		json failureResp;
 		failureResp["success"] = false;
 		failureResp["error"] = e.what();
-		std::string failureBody = failureResp.dump(4);
+		std::string failureBody = failureResp.dump();
 
 		resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
 		resp->setCloseConnection(true);
@@ -2,18 +2,19 @@
 #include <muduo/base/Logging.h>
 #include <shared_mutex>
 
+#include "logging/Log.h"
+
 void ChatSessionsHandler::handle(const http::HttpRequest& req, http::HttpResponse* resp)
 {
     try
     {
-        auto session = server_->getSessionManager()->getSession(req, resp);
-        LOG_INFO << "session->getValue(\"isLoggedIn\") = " << session->getValue("isLoggedIn");
-        if (session->getValue("isLoggedIn") != "true")
+        AuthUser user;
+        if (!server_->authenticate(req, resp, &user))
         {
             json errorResp;
             errorResp["status"] = "error";
             errorResp["message"] = "Unauthorized";
-            std::string errorBody = errorResp.dump(4);
+            std::string errorBody = errorResp.dump();
 
             server_->packageResp(req.getVersion(), http::HttpResponse::k401Unauthorized,
                 "Unauthorized", true, "application/json", errorBody.size(),
@@ -21,8 +22,8 @@ void ChatSessionsHandler::handle(const http::HttpRequest& req, http::HttpRespons
             return;
         }
 
-        int userId = std::stoi(session->getValue("userId"));
-        std::string username = session->getValue("username");
+        int userId = user.userId;
+        std::string username = user.username;
         
         json successResp;
         successResp["success"] = true;
@@ -43,10 +44,10 @@ void ChatSessionsHandler::handle(const http::HttpRequest& req, http::HttpRespons
                 s["name"] = "会话 " + sid;
                 sessionArray.push_back(s);
             }
-            LOG_INFO << "Found " << sessionsFromMemory.size() << " sessions in memory";
+            LOG_MODULE("chat", DEBUG) << "Sessions found in memory" << http::logging::kv("count", sessionsFromMemory.size());
         } else {
             // 如果内存中没有会话数据，从数据库查询
-            LOG_INFO << "No sessions in memory, querying from database...";
+            LOG_MODULE("chat", DEBUG) << "No sessions in memory, querying database";
             try {
                 std::string sql = "SELECT session_id, title, created_at, updated_at FROM chat_session WHERE user_id = ? ORDER BY updated_at DESC";
                 
@@ -68,7 +69,7 @@ void ChatSessionsHandler::handle(const http::HttpRequest& req, http::HttpRespons
                         }
                     }
                     // unique_ptr会自动释放资源，不再需要手动delete
-                    LOG_INFO << "Loaded " << sessionArray.size() << " sessions from database";
+                    LOG_MODULE("chat", DEBUG) << "Sessions loaded from database" << http::logging::kv("count", sessionArray.size());
                 }
             } catch (const std::exception& e) {
                 LOG_ERROR << "Failed to query sessions from database: " << e.what();
@@ -76,7 +77,7 @@ void ChatSessionsHandler::handle(const http::HttpRequest& req, http::HttpRespons
         }
 
         successResp["sessions"] = sessionArray;
-        std::string successBody = successResp.dump(4);
+        std::string successBody = successResp.dump();
 
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
         resp->setCloseConnection(false);
@@ -90,7 +91,7 @@ void ChatSessionsHandler::handle(const http::HttpRequest& req, http::HttpRespons
         json failureResp;
         failureResp["status"] = "error";
         failureResp["message"] = e.what();
-        std::string failureBody = failureResp.dump(4);
+        std::string failureBody = failureResp.dump();
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
         resp->setCloseConnection(true);
         resp->setContentType("application/json");
@@ -2,7 +2,25 @@
 #include "utils/JsonUtil.h"
 #include "utils/ParseJsonUtil.h"
 #include "AIUtil/AIConfig.h"
-#include "AIUtil/AIFactory.h"
+#include "AIUtil/SpeechJobManager.h"
+
+namespace
+{
+
+void reply(const http::DeferredResponsePtr& pending, const std::string& version,
+           http::HttpResponse::HttpStatusCode code, const std::string& statusMsg, bool close, const json& body)
+{
+    std::string content = body.dump();
+    http::HttpResponse* resp = pending->response();
+    resp->setStatusLine(version, code, statusMsg);
+    resp->setCloseConnection(close);
+    resp->setContentType("application/json");
+    resp->setContentLength(content.size());
+    resp->setBody(content);
+    pending->complete();
+}
+
+} // namespace
 
 void ChatSpeechHandler::handle(const http::HttpRequest& req, http::HttpResponse* resp)
 {
@@ -14,75 +32,62 @@ void ChatSpeechHandler::handle(const http::HttpRequest& req, http::HttpResponse*
             // 错误响应已经在parseJsonFromBody中设置
             return;
         }
-        
+
         if (!j.empty()) {
             if (j.contains("text")) text = j["text"];
         }
 
-        // 获取百度API密钥
-        auto& apiKeys = AIConfig::getInstance().getApiKeysConfig();
-        std::string clientId, clientSecret;
-        
-        if (!apiKeys.baiduClientSecret.empty()) {
-            clientSecret = apiKeys.baiduClientSecret;
-        } else {
-            throw std::runtime_error("BAIDU_CLIENT_SECRET not found in config!");
-        }
-        
-        if (!apiKeys.baiduClientId.empty()) {
-            clientId = apiKeys.baiduClientId;
-        } else {
-            throw std::runtime_error("BAIDU_CLIENT_ID not found in config!");
-        }
-        
-        // 通过工厂创建语音服务实例
-        auto speechServiceProvider = AIConfig::getInstance().getSpeechServiceProvider();
-        std::unique_ptr<SpeechService> speechService = SpeechServiceFactory::createSpeechService(
-            speechServiceProvider, clientId, clientSecret);
-        
-        if (!speechService) {
-            throw std::runtime_error("Failed to create speech service instance");
+        // 语音服务在启动时按配置创建，缺少百度API密钥时为空
+        std::shared_ptr<SpeechJobManager> speechJobs = server_->getSpeechJobs();
+        if (!speechJobs) {
+            throw std::runtime_error("Speech service not configured, check BAIDU_CLIENT_ID / BAIDU_CLIENT_SECRET");
         }
-        
-        // 获取语音合成后的地址
-        std::string speechUrl = speechService->synthesize(text,
-                                                         "mp3-16k", 
-                                                         "zh", 
-                                                         5,  // speed
-                                                         5,  // pitch
-                                                         5); // volume
-                                                         
-        // 构造响应JSON，与前端JavaScript代码中期望的字段匹配
-        json responseJson;
-        responseJson["success"] = true;
-        responseJson["url"] = speechUrl;
-        responseJson["text"] = text;
 
-        std::string responseBody = responseJson.dump(4);
+        SpeechRequest request;
+        request.text = text;
 
-        server_->packageResp(req.getVersion(), 
-                            http::HttpResponse::k200Ok, 
-                            "OK", 
-                            false, 
-                            "application/json", 
-                            responseBody.length(), 
-                            responseBody, 
-                            resp);
+        // 合成任务的创建和轮询不占用 IO 线程，结果就绪后再回复
+        std::string version = req.getVersion();
+        resp->defer([speechJobs, request, version](const http::DeferredResponsePtr& pending) {
+            speechJobs->submit(request, [pending, version, text = request.text](const SpeechResult& result) {
+                if (result.success) {
+                    // 构造响应JSON，与前端JavaScript代码中期望的字段匹配
+                    json responseJson;
+                    responseJson["success"] = true;
+                    responseJson["url"] = result.url;
+                    responseJson["text"] = text;
+                    reply(pending, version, http::HttpResponse::k200Ok, "OK", false, responseJson);
+                    return;
+                }
+
+                json errorResp;
+                errorResp["success"] = false;
+                errorResp["message"] = result.error;
+                if (result.busy) {
+                    pending->response()->addHeader("Retry-After", "1");
+                    reply(pending, version, http::HttpResponse::k503ServiceUnavailable, "Service Unavailable",
+                          false, errorResp);
+                } else {
+                    reply(pending, version, http::HttpResponse::k500InternalServerError, "Internal Server Error",
+                          true, errorResp);
+                }
+            });
+        });
     }
     catch (const std::exception& e)
     {
         json errorResp;
         errorResp["success"] = false;
         errorResp["message"] = e.what();
-        std::string errorBody = errorResp.dump(4);
+        std::string errorBody = errorResp.dump();
 
-        server_->packageResp(req.getVersion(), 
-                            http::HttpResponse::k500InternalServerError, 
-                            "Internal Server Error", 
-                            true, 
-                            "application/json", 
-                            errorBody.length(), 
-                            errorBody, 
+        server_->packageResp(req.getVersion(),
+                            http::HttpResponse::k500InternalServerError,
+                            "Internal Server Error",
+                            true,
+                            "application/json",
+                            errorBody.length(),
+                            errorBody,
                             resp);
     }
-}
\ No newline at end of file
+}
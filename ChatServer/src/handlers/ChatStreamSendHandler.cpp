@@ -0,0 +1,164 @@
+#include "handlers/ChatStreamSendHandler.h"
+#include "http/StreamWriter.h"
+#include "AIUtil/SpeechPipeline.h"
+#include <muduo/base/Logging.h>
+
+void ChatStreamSendHandler::handle(const http::HttpRequest& req, http::HttpResponse* resp)
+{
+	try
+	{
+		AuthUser user;
+		if (!server_->authenticate(req, resp, &user))
+		{
+			json errorResp;
+			errorResp["status"] = "error";
+			errorResp["message"] = "Unauthorized";
+			std::string errorBody = errorResp.dump();
+
+			server_->packageResp(req.getVersion(), http::HttpResponse::k401Unauthorized,
+				"Unauthorized", true, "application/json", errorBody.size(),
+				errorBody, resp);
+			return;
+		}
+
+		int userId = user.userId;
+		std::string username = user.username;
+		std::string userQuestion;
+		std::string sessionId;
+		std::string modelType;
+
+		json j;
+		if (!ParseJsonUtil::parseJsonFromBody(req, resp, j)) {
+			// 错误响应已经在parseJsonFromBody中设置
+			return;
+		}
+
+		if (j.contains("question")) userQuestion = j["question"];
+		if (j.contains("sessionId")) sessionId = j["sessionId"];
+		modelType = j.contains("modelType") ? j["modelType"].get<std::string>() : "1";
+		// tts 为 true 时边生成边按句合成语音，音频地址以 audio 事件推送
+		bool tts = j.contains("tts") && j["tts"].is_boolean() && j["tts"].get<bool>();
+		std::shared_ptr<SpeechJobManager> speechJobs = tts ? server_->getSpeechJobs() : nullptr;
+
+		// 未携带 sessionId 时创建新会话
+		bool isNewSession = sessionId.empty();
+		if (isNewSession) {
+			AISessionIdGenerator generator;
+			sessionId = generator.generate();
+		}
+
+		std::shared_ptr<AIHelper> AIHelperPtr = server_->getChatSession(userId, sessionId);
+		if (!AIHelperPtr) {
+			AIHelperPtr = std::make_shared<AIHelper>();
+			server_->addOrUpdateChatSession(userId, sessionId, AIHelperPtr);
+			if (isNewSession) {
+				server_->addSessionId(userId, sessionId);
+			}
+		}
+		server_->updateLRUCache(userId, sessionId);
+
+		// 响应头先行发出，之后的 token 以 SSE 事件的形式通过 chunked 编码写回本连接
+		resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
+		resp->setCloseConnection(false);
+		resp->setContentType("text/event-stream");
+		resp->addHeader("Cache-Control", "no-cache");
+		resp->addHeader("X-Accel-Buffering", "no"); // 禁用nginx缓冲
+		resp->setChunked(true);
+
+		auto pool = server_->getBusinessThreadPool();
+		resp->setStreamStartCallback([this, pool, AIHelperPtr, userId, username, sessionId, userQuestion, modelType, isNewSession, speechJobs]
+			(const http::StreamWriterPtr& writer) {
+			json meta;
+			meta["sessionId"] = sessionId;
+			writer->sendEvent("session", meta.dump());
+
+			// 一个线程池任务内完成生成与推送，不再额外占用线程等待结果
+			pool->enqueue([this, writer, AIHelperPtr, userId, username, sessionId, userQuestion, modelType, isNewSession, speechJobs]() {
+				try {
+					if (isNewSession) {
+						std::string insertSessionSql = "INSERT INTO chat_session (user_id, username, session_id, title) VALUES (?, ?, ?, ?)";
+						mysqlUtil_.executeUpdate(insertSessionSql, std::to_string(userId), username, sessionId, "新对话");
+					} else {
+						std::string updateSessionSql = "UPDATE chat_session SET updated_at = CURRENT_TIMESTAMP WHERE session_id = ?";
+						mysqlUtil_.executeUpdate(updateSessionSql, sessionId);
+					}
+				} catch (const std::exception& e) {
+					LOG_ERROR << "Failed to persist session " << sessionId << ": " << e.what();
+				}
+
+				std::shared_ptr<SpeechPipeline> speech;
+				if (speechJobs) {
+					SpeechPipelineOptions speechOptions;
+					speechOptions.window = static_cast<size_t>(
+						std::max(AIConfig::getInstance().getSpeechConfig().pipelineWindow, 1));
+					speech = std::make_shared<SpeechPipeline>(speechJobs, speechOptions,
+						[writer](const SpeechSegment& segment) {
+							json audio;
+							audio["index"] = segment.index;
+							audio["text"] = segment.text;
+							if (segment.success) {
+								audio["url"] = segment.url;
+							} else {
+								audio["error"] = segment.error;
+							}
+							writer->sendEvent("audio", audio.dump());
+						});
+				}
+
+				std::string endEvent = "end";
+				std::string endData = "{\"status\":\"done\"}";
+				// 客户端断开后中止生成，已生成的部分照常保存
+				auto cancelled = std::make_shared<std::atomic<bool>>(false);
+				try {
+					AIHelperPtr->chat(userId, username, sessionId, userQuestion, modelType,
+						[&writer, &speech, &cancelled](const std::string& chunk) {
+							if (!writer->connected()) {
+								cancelled->store(true);
+								if (speech) speech->cancel();
+								return;
+							}
+							if (chunk.empty()) return;
+							json delta;
+							delta["result"] = chunk;
+							writer->sendEvent("result", delta.dump());
+							if (speech) speech->feed(chunk);
+						}, cancelled);
+				} catch (const std::exception& e) {
+					LOG_ERROR << "AI task failed for session " << sessionId << ": " << e.what();
+					endEvent = "error";
+					endData = "{\"error\":\"Processing Failed\"}";
+					if (speech) speech->cancel();
+				}
+
+				if (cancelled->load()) {
+					LOG_INFO << "Client left, stream for session " << sessionId << " cancelled";
+					writer->end();
+					return;
+				}
+				if (!speech) {
+					writer->sendEvent(endEvent, endData);
+					writer->end();
+					return;
+				}
+				// 文本已全部推送，等最后一句语音交付后再结束流
+				speech->finish([writer, endEvent, endData]() {
+					writer->sendEvent(endEvent, endData);
+					writer->end();
+				});
+			});
+		});
+	}
+	catch (const std::exception& e)
+	{
+		json failureResp;
+		failureResp["success"] = false;
+		failureResp["error"] = e.what();
+		std::string failureBody = failureResp.dump();
+
+		resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
+		resp->setCloseConnection(true);
+		resp->setContentType("application/json");
+		resp->setContentLength(failureBody.size());
+		resp->setBody(failureBody);
+	}
+}
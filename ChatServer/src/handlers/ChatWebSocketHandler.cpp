@@ -0,0 +1,186 @@
+#include "handlers/ChatWebSocketHandler.h"
+#include <muduo/base/Logging.h>
+
+bool ChatWebSocketHandler::onUpgrade(const http::HttpRequest& req, http::HttpResponse* resp,
+	const http::websocket::WebSocketConnectionPtr& ws)
+{
+	AuthUser user;
+	if (!server_->authenticate(req, resp, &user))
+	{
+		json errorResp;
+		errorResp["status"] = "error";
+		errorResp["message"] = "Unauthorized";
+		std::string errorBody = errorResp.dump();
+
+		server_->packageResp(req.getVersion(), http::HttpResponse::k401Unauthorized,
+			"Unauthorized", true, "application/json", errorBody.size(),
+			errorBody, resp);
+		return false;
+	}
+
+	auto state = std::make_shared<SocketState>();
+	state->userId = user.userId;
+	state->username = user.username;
+	ws->setContext(state);
+	return true;
+}
+
+void ChatWebSocketHandler::onMessage(const http::websocket::WebSocketConnectionPtr& ws, const std::string& message, bool binary)
+{
+	SocketStatePtr state = getState(ws);
+	if (!state) return;
+
+	json j;
+	try {
+		j = json::parse(message);
+	} catch (const std::exception& e) {
+		sendError(ws, "", "Invalid JSON");
+		return;
+	}
+
+	std::string op = j.value("op", "");
+	if (op == "send") {
+		handleSend(ws, state, j);
+	} else if (op == "cancel") {
+		handleCancel(ws, state, j);
+	} else {
+		sendError(ws, j.value("id", ""), "Unknown op: " + op);
+	}
+}
+
+void ChatWebSocketHandler::onClose(const http::websocket::WebSocketConnectionPtr& ws, uint16_t code)
+{
+	SocketStatePtr state = getState(ws);
+	if (!state) return;
+
+	// 连接关闭后取消所有未完成的生成
+	std::lock_guard<std::mutex> lock(state->mutex);
+	for (auto& operation : state->operations) {
+		operation.second->store(true);
+	}
+}
+
+void ChatWebSocketHandler::handleSend(const http::websocket::WebSocketConnectionPtr& ws, const SocketStatePtr& state, const json& j)
+{
+	std::string id = j.value("id", "");
+	std::string userQuestion = j.value("question", "");
+	std::string sessionId = j.value("sessionId", "");
+	std::string modelType = j.value("modelType", "1");
+
+	if (id.empty() || userQuestion.empty()) {
+		sendError(ws, id, "id and question are required");
+		return;
+	}
+
+	bool isNewSession = sessionId.empty();
+	if (isNewSession) {
+		AISessionIdGenerator generator;
+		sessionId = generator.generate();
+	}
+
+	auto cancelled = std::make_shared<std::atomic<bool>>(false);
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		if (state->operations.size() >= kMaxOperationsPerSocket) {
+			sendError(ws, id, "Too many operations");
+			return;
+		}
+		if (state->operations.count(id)) {
+			sendError(ws, id, "Duplicate id");
+			return;
+		}
+		if (!state->busySessions.insert(sessionId).second) {
+			sendError(ws, id, "Session is busy");
+			return;
+		}
+		state->operations[id] = cancelled;
+	}
+
+	int userId = state->userId;
+	std::string username = state->username;
+
+	std::shared_ptr<AIHelper> AIHelperPtr = server_->getChatSession(userId, sessionId);
+	if (!AIHelperPtr) {
+		AIHelperPtr = std::make_shared<AIHelper>();
+		server_->addOrUpdateChatSession(userId, sessionId, AIHelperPtr);
+		if (isNewSession) {
+			server_->addSessionId(userId, sessionId);
+		}
+	}
+	server_->updateLRUCache(userId, sessionId);
+
+	json started;
+	started["op"] = "session";
+	started["id"] = id;
+	started["sessionId"] = sessionId;
+	ws->sendText(started.dump());
+
+	server_->getBusinessThreadPool()->enqueue([this, ws, state, cancelled, AIHelperPtr, id, userId, username,
+		sessionId, userQuestion, modelType, isNewSession]() {
+		try {
+			if (isNewSession) {
+				std::string insertSessionSql = "INSERT INTO chat_session (user_id, username, session_id, title) VALUES (?, ?, ?, ?)";
+				mysqlUtil_.executeUpdate(insertSessionSql, std::to_string(userId), username, sessionId, "新对话");
+			} else {
+				std::string updateSessionSql = "UPDATE chat_session SET updated_at = CURRENT_TIMESTAMP WHERE session_id = ?";
+				mysqlUtil_.executeUpdate(updateSessionSql, sessionId);
+			}
+		} catch (const std::exception& e) {
+			LOG_ERROR << "Failed to persist session " << sessionId << ": " << e.what();
+		}
+
+		json result;
+		result["id"] = id;
+		result["sessionId"] = sessionId;
+		try {
+			AIHelperPtr->chat(userId, username, sessionId, userQuestion, modelType,
+				[&ws, &id, &sessionId](const std::string& chunk) {
+					if (chunk.empty()) return;
+					json delta;
+					delta["op"] = "delta";
+					delta["id"] = id;
+					delta["sessionId"] = sessionId;
+					delta["text"] = chunk;
+					ws->sendText(delta.dump());
+				}, cancelled);
+			result["op"] = cancelled->load() ? "cancelled" : "done";
+		} catch (const std::exception& e) {
+			LOG_ERROR << "AI task failed for session " << sessionId << ": " << e.what();
+			result["op"] = "error";
+			result["message"] = "Processing Failed";
+		}
+		ws->sendText(result.dump());
+
+		std::lock_guard<std::mutex> lock(state->mutex);
+		state->operations.erase(id);
+		state->busySessions.erase(sessionId);
+	});
+}
+
+void ChatWebSocketHandler::handleCancel(const http::websocket::WebSocketConnectionPtr& ws, const SocketStatePtr& state, const json& j)
+{
+	std::string id = j.value("id", "");
+	std::lock_guard<std::mutex> lock(state->mutex);
+	auto it = state->operations.find(id);
+	if (it == state->operations.end()) {
+		sendError(ws, id, "No such operation");
+		return;
+	}
+	// 生成任务检测到标记后中止请求，并回复 cancelled
+	it->second->store(true);
+}
+
+void ChatWebSocketHandler::sendError(const http::websocket::WebSocketConnectionPtr& ws, const std::string& id, const std::string& message)
+{
+	json error;
+	error["op"] = "error";
+	error["id"] = id;
+	error["message"] = message;
+	ws->sendText(error.dump());
+}
+
+ChatWebSocketHandler::SocketStatePtr ChatWebSocketHandler::getState(const http::websocket::WebSocketConnectionPtr& ws)
+{
+	const SocketStatePtr* state = boost::any_cast<SocketStatePtr>(&ws->getContext());
+	return state ? *state : nullptr;
+}
@@ -7,8 +7,8 @@ void SSEChatHandler::handle(const http::HttpRequest& req, http::HttpResponse* re
 {
     try
     {
-        auto session = server_->getSessionManager()->getSession(req, resp);
-        if (session->getValue("isLoggedIn") != "true")
+        AuthUser user;
+        if (!server_->authenticate(req, resp, &user))
         {
             resp->setStatusLine(req.getVersion(), http::HttpResponse::k401Unauthorized, "Unauthorized");
             resp->setCloseConnection(true);
@@ -43,7 +43,7 @@ void SSEChatHandler::handle(const http::HttpRequest& req, http::HttpResponse* re
             initData << "event: connected\n";
             initData << "data: {\"sessionId\": \"" << sessionId << "\", \"status\": \"connected\"}\n\n";
             
-            conn->send(initData.str());
+            http::HttpContext::send(conn, initData.str());
             
             
             return false; // 返回false停止HttpServer的驱动循环，但连接保持打开
@@ -6,10 +6,23 @@
 #include <muduo/base/Logging.h>
 #include <muduo/net/EventLoop.h>
 
+#include "logging/Log.h"
 #include "utils/JsonUtil.h"
 #include "AIUtil/AIConfig.h"
 #include "ChatServer.h"
 
+muduo::Logger::LogLevel toMuduoLevel(LogLevel level) {
+    switch (level) {
+        case LogLevel::TRACE: return muduo::Logger::TRACE;
+        case LogLevel::DEBUG: return muduo::Logger::DEBUG;
+        case LogLevel::INFO:  return muduo::Logger::INFO;
+        case LogLevel::WARN:  return muduo::Logger::WARN;
+        case LogLevel::ERROR: return muduo::Logger::ERROR;
+        case LogLevel::FATAL: return muduo::Logger::FATAL;
+        default:              return muduo::Logger::WARN;
+    }
+}
+
 // 工作线程绑定的函数
 void executeMysql(const std::string sql_with_params) {
     // 从配置中获取数据库信息
@@ -60,8 +73,9 @@ void executeMysql(const std::string sql_with_params) {
 int main(int argc, char* argv[]) {
 	std::string serverName = "ChatServer";
 	int port = 8080;
+    std::string configPath = "../ChatServer/resource/config.json";
     int opt;
-    const char* str = "p:";
+    const char* str = "p:c:";
     while ((opt = getopt(argc, argv, str)) != -1)
     {
         switch (opt)
@@ -71,6 +85,12 @@ int main(int argc, char* argv[]) {
             port = atoi(optarg);
             break;
         }
+        case 'c':
+        {
+            // 压测时指向 bench/config.mock.json
+            configPath = optarg;
+            break;
+        }
         default:
             break;
         }
@@ -78,54 +98,46 @@ int main(int argc, char* argv[]) {
 
     // 加载配置文件
     AIConfig& config = AIConfig::getInstance();
-    if (!config.loadFromFile("../ChatServer/resource/config.json")) {
-        LOG_ERROR << "Failed to load config file!";
+    if (!config.loadFromFile(configPath)) {
+        LOG_ERROR << "Failed to load config file: " << configPath;
         return -1;
     }
     
     // 根据配置设置日志级别
     const auto& logConfig = config.getLogConfig();
-    switch (logConfig.level) {
-        case LogLevel::TRACE:
-            muduo::Logger::setLogLevel(muduo::Logger::TRACE);
-            break;
-        case LogLevel::DEBUG:
-            muduo::Logger::setLogLevel(muduo::Logger::DEBUG);
-            break;
-        case LogLevel::INFO:
-            muduo::Logger::setLogLevel(muduo::Logger::INFO);
-            break;
-        case LogLevel::WARN:
-            muduo::Logger::setLogLevel(muduo::Logger::WARN);
-            break;
-        case LogLevel::ERROR:
-            muduo::Logger::setLogLevel(muduo::Logger::ERROR);
-            break;
-        case LogLevel::FATAL:
-            muduo::Logger::setLogLevel(muduo::Logger::FATAL);
-            break;
-        default:
-            muduo::Logger::setLogLevel(muduo::Logger::WARN);
-            break;
+    muduo::Logger::setLogLevel(toMuduoLevel(logConfig.level));
+    for (const auto& module : logConfig.modules) {
+        http::logging::LogModule::setLevel(module.first, toMuduoLevel(module.second));
+    }
+    if (logConfig.async) {
+        http::logging::startAsyncLogging(logConfig.file, static_cast<long>(logConfig.rollSizeMb) * 1024 * 1024,
+                                         logConfig.flushInterval);
     }
     
     // 在设置日志级别后再打印进程ID
     LOG_INFO << "pid = " << getpid();
 
-    // 初始化 ChatServer
-    ChatServer server(port, serverName);
-    // server.setThreadNum(4);
-    std::this_thread::sleep_for(std::chrono::seconds(2));
-    
-    // 从配置中获取RabbitMQ信息
-    const auto& mqConfig = config.getRabbitMQConfig();
-    
-    // 初始化线程池，绑定参数
-    RabbitMQThreadPool pool(mqConfig.host, mqConfig.queueName, mqConfig.threadNum, executeMysql);
-    // 启动线程池，作为消费者处理 MQ 的消息
-    pool.start();
+    // 服务和线程池放在单独的作用域中，析构（线程退出）先于停止异步日志
+    {
+        // 初始化 ChatServer
+        ChatServer server(port, serverName);
+        // server.setThreadNum(4);
+        std::this_thread::sleep_for(std::chrono::seconds(2));
 
-    server.start();
-    
+        // 从配置中获取RabbitMQ信息
+        const auto& mqConfig = config.getRabbitMQConfig();
+
+        // 初始化线程池，绑定参数
+        RabbitMQThreadPool pool(mqConfig.host, mqConfig.queueName, mqConfig.threadNum, executeMysql);
+        // 启动线程池，作为消费者处理 MQ 的消息
+        pool.start();
+
+        server.start();
+
+        pool.shutdown();
+    }
+
+    // 刷出缓冲中的日志，并让静态析构期间的日志改写标准输出
+    http::logging::stopAsyncLogging();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include <muduo/base/Logging.h>
+
+#include "metrics/MetricsRegistry.h"
+#include "utils/AuthPool.h"
+#include "utils/PasswordUtil.h"
+
+AuthPool::AuthPool(size_t threads, size_t maxPending)
+    : stop_(false)
+    , maxPending_(maxPending) {
+    auto& registry = http::metrics::MetricsRegistry::instance();
+    rejected_ = &registry.counter("auth_pool_rejected_total", "Login and register requests refused because the auth pool queue was full");
+    registry.gaugeCallback("auth_pool_pending", "Tasks and password hashes waiting in the auth pool", {},
+                           [this]() { return static_cast<double>(pending()); });
+
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+    LOG_INFO << "Auth pool started with " << threads << " threads, pbkdf2 backend "
+             << Pbkdf2::backendName() << " (" << Pbkdf2::lanes() << " lanes)";
+}
+
+AuthPool::~AuthPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+bool AuthPool::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_ || tasks_.size() + hashJobs_.size() >= maxPending_) {
+            rejected_->inc();
+            return false;
+        }
+        tasks_.push_back(std::move(task));
+    }
+    condition_.notify_one();
+    return true;
+}
+
+bool AuthPool::hash(const std::string& password, const std::string& saltHex, HashCallback callback, int iterations) {
+    HashJob job;
+    job.task.password = password;
+    job.iterations = iterations;
+    job.valid = true;
+    job.callback = std::move(callback);
+    try {
+        job.task.salt = PasswordUtil::fromHex(saltHex);
+    } catch (const std::exception&) {
+        job.valid = false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_ || tasks_.size() + hashJobs_.size() >= maxPending_) {
+            rejected_->inc();
+            return false;
+        }
+        hashJobs_.push_back(std::move(job));
+    }
+    condition_.notify_one();
+    return true;
+}
+
+size_t AuthPool::pending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size() + hashJobs_.size();
+}
+
+void AuthPool::workerLoop() {
+    const size_t lanes = Pbkdf2::lanes();
+    std::vector<HashJob> batch;
+    batch.reserve(lanes);
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this]() { return stop_ || !tasks_.empty() || !hashJobs_.empty(); });
+            if (stop_ && tasks_.empty() && hashJobs_.empty()) {
+                return;
+            }
+            if (!tasks_.empty()) {
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            } else {
+                // 取出队首起迭代次数相同的连续任务，凑成一批
+                int iterations = hashJobs_.front().iterations;
+                while (!hashJobs_.empty() && batch.size() < lanes && hashJobs_.front().iterations == iterations) {
+                    batch.push_back(std::move(hashJobs_.front()));
+                    hashJobs_.pop_front();
+                }
+            }
+        }
+
+        if (task) {
+            try {
+                task();
+            } catch (const std::exception& e) {
+                LOG_ERROR << "Auth task failed: " << e.what();
+            }
+        } else {
+            runHashBatch(batch);
+            batch.clear();
+        }
+    }
+}
+
+void AuthPool::runHashBatch(std::vector<HashJob>& batch) {
+    static http::metrics::Histogram& batchTime = http::metrics::MetricsRegistry::instance().histogram(
+        "auth_pbkdf2_batch_seconds", "Time to derive one batch of password hashes");
+
+    std::vector<Pbkdf2Task> tasks;
+    tasks.reserve(batch.size());
+    for (auto& job : batch) {
+        if (job.valid) {
+            tasks.push_back(std::move(job.task));
+        }
+    }
+    {
+        http::metrics::ScopedTimer timer(batchTime);
+        Pbkdf2::deriveBatch(tasks.data(), tasks.size(), batch.front().iterations);
+    }
+
+    size_t next = 0;
+    for (auto& job : batch) {
+        std::string hash;
+        if (job.valid) {
+            const Pbkdf2Task& task = tasks[next++];
+            hash = PasswordUtil::toHex(task.key, sizeof task.key);
+        }
+        try {
+            job.callback(hash);
+        } catch (const std::exception& e) {
+            LOG_ERROR << "Auth hash callback failed: " << e.what();
+        }
+    }
+}
@@ -1,5 +1,6 @@
 #include "utils/MQManager.h"
 #include "AIUtil/AIConfig.h"
+#include "metrics/MetricsRegistry.h"
 #include <muduo/base/Logging.h>
 
 // ------------------- MQManager -------------------
@@ -25,9 +26,20 @@ void MQManager::publish(const std::string& queue, const std::string& msg) {
     size_t index = counter_.fetch_add(1) % poolSize_;
     auto& conn = pool_[index];
 
-    std::lock_guard<std::mutex> lock(conn->mtx);
-    auto message = AmqpClient::BasicMessage::Create(msg);
-    conn->channel->BasicPublish("", queue, message);
+    static http::metrics::Histogram& duration = http::metrics::MetricsRegistry::instance().histogram(
+        "mq_publish_duration_seconds", "RabbitMQ publish latency including channel lock wait");
+    static http::metrics::Counter& errors = http::metrics::MetricsRegistry::instance().counter(
+        "mq_publish_errors_total", "Failed RabbitMQ publishes");
+
+    http::metrics::ScopedTimer timer(duration);
+    try {
+        std::lock_guard<std::mutex> lock(conn->mtx);
+        auto message = AmqpClient::BasicMessage::Create(msg);
+        conn->channel->BasicPublish("", queue, message);
+    } catch (...) {
+        errors.inc();
+        throw;
+    }
 }
 
 // ------------------- RabbitMQThreadPool -------------------
@@ -11,7 +11,7 @@ bool ParseJsonUtil::parseJsonFromBody(const http::HttpRequest& req, http::HttpRe
         json errorResp;
         errorResp["success"] = false;
         errorResp["error"] = "Request entity too large: body size exceeds 1MB limit";
-        std::string errorBody = errorResp.dump(4);
+        std::string errorBody = errorResp.dump();
         
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Request Entity Too Large");
         resp->setCloseConnection(false);
@@ -25,7 +25,7 @@ bool ParseJsonUtil::parseJsonFromBody(const http::HttpRequest& req, http::HttpRe
         json errorResp;
         errorResp["success"] = false;
         errorResp["error"] = "Invalid request: Content-Type must be application/json";
-        std::string errorBody = errorResp.dump(4);
+        std::string errorBody = errorResp.dump();
         
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
         resp->setCloseConnection(false);
@@ -43,7 +43,7 @@ bool ParseJsonUtil::parseJsonFromBody(const http::HttpRequest& req, http::HttpRe
         json errorResp;
         errorResp["success"] = false;
         errorResp["error"] = "Invalid JSON format: " + std::string(e.what());
-        std::string errorBody = errorResp.dump(4);
+        std::string errorBody = errorResp.dump();
         
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
         resp->setCloseConnection(false);
@@ -1,52 +1,70 @@
+#include <openssl/crypto.h>
 #include <openssl/evp.h>
 #include <openssl/rand.h>
-#include <openssl/sha.h>
-#include <iomanip>
-#include <sstream>
+#include <stdexcept>
 #include <vector>
 
 #include "utils/PasswordUtil.h"
+#include "utils/Pbkdf2.h"
+
+std::string PasswordUtil::toHex(const unsigned char* data, size_t length) {
+    static const char kHex[] = "0123456789abcdef";
+    std::string hex(length * 2, '0');
+    for (size_t i = 0; i < length; ++i) {
+        hex[i * 2] = kHex[data[i] >> 4];
+        hex[i * 2 + 1] = kHex[data[i] & 0x0f];
+    }
+    return hex;
+}
+
+std::string PasswordUtil::fromHex(const std::string& hex) {
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    std::string bytes(hex.size() / 2, '\0');
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        int high = nibble(hex[i * 2]);
+        int low = nibble(hex[i * 2 + 1]);
+        if (high < 0 || low < 0) {
+            throw std::invalid_argument("invalid hex string");
+        }
+        bytes[i] = static_cast<char>((high << 4) | low);
+    }
+    return bytes;
+}
 
 std::string PasswordUtil::generateSalt(size_t length) {
     std::vector<unsigned char> salt(length);
     RAND_bytes(salt.data(), length);
-    
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (size_t i = 0; i < salt.size(); ++i) {
-        ss << std::setw(2) << static_cast<unsigned>(salt[i]);
-    }
-    return ss.str();
+    return toHex(salt.data(), salt.size());
 }
 
 std::string PasswordUtil::hashPassword(const std::string& password,
                                       const std::string& salt,
                                       int iterations,
                                       size_t keyLength) {
-    std::vector<unsigned char> derivedKey(keyLength);
-    
-    // 将十六进制盐值转换为二进制
-    std::vector<unsigned char> saltBytes(salt.length() / 2);
-    for (size_t i = 0; i < salt.length(); i += 2) {
-        std::string byteString = salt.substr(i, 2);
-        saltBytes[i / 2] = static_cast<unsigned char>(std::stoi(byteString, nullptr, 16));
+    if (keyLength == sizeof(Pbkdf2Task::key)) {
+        Pbkdf2Task task;
+        task.password = password;
+        task.salt = fromHex(salt);
+        Pbkdf2::deriveBatch(&task, 1, iterations);
+        return toHex(task.key, sizeof task.key);
     }
-    
+
+    std::vector<unsigned char> derivedKey(keyLength);
+    std::string saltBytes = fromHex(salt);
     PKCS5_PBKDF2_HMAC(
         password.c_str(), password.length(),
-        saltBytes.data(), saltBytes.size(),
+        reinterpret_cast<const unsigned char*>(saltBytes.data()), saltBytes.size(),
         iterations,
         EVP_sha256(),
         keyLength,
         derivedKey.data()
     );
-    
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (size_t i = 0; i < derivedKey.size(); ++i) {
-        ss << std::setw(2) << static_cast<unsigned>(derivedKey[i]);
-    }
-    return ss.str();
+    return toHex(derivedKey.data(), derivedKey.size());
 }
 
 bool PasswordUtil::verifyPassword(const std::string& password,
@@ -55,5 +73,10 @@ bool PasswordUtil::verifyPassword(const std::string& password,
                                  int iterations,
                                  size_t keyLength) {
     std::string computedHash = hashPassword(password, salt, iterations, keyLength);
-    return computedHash == hashedPassword;
-}
\ No newline at end of file
+    return equals(computedHash, hashedPassword);
+}
+
+bool PasswordUtil::equals(const std::string& a, const std::string& b) {
+    // 比较耗时与首个不同字符的位置无关
+    return a.size() == b.size() && CRYPTO_memcmp(a.data(), b.data(), a.size()) == 0;
+}
@@ -0,0 +1,262 @@
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <cstdint>
+#include <cstring>
+
+#include "utils/Pbkdf2.h"
+
+namespace {
+
+typedef uint32_t U32x8 __attribute__((vector_size(32)));
+typedef uint32_t U32x16 __attribute__((vector_size(64)));
+
+const uint32_t kIV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+const uint32_t kRound[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+// 用宏而不是函数，避免以值传递向量类型（未启用对应指令集时 ABI 不同）
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+// V 为 uint32_t 或 GCC 向量类型，同一份代码按通道数实例化
+template <typename V>
+inline void compress(V state[8], const V block[16]) {
+    V w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = block[i];
+    }
+    for (int i = 16; i < 64; ++i) {
+        V s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        V s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    V a = state[0], b = state[1], c = state[2], d = state[3];
+    V e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i) {
+        V t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + kRound[i] + w[i];
+        V t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+inline uint32_t loadBE(const unsigned char* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+inline void storeBE(unsigned char* p, uint32_t v) {
+    p[0] = static_cast<unsigned char>(v >> 24);
+    p[1] = static_cast<unsigned char>(v >> 16);
+    p[2] = static_cast<unsigned char>(v >> 8);
+    p[3] = static_cast<unsigned char>(v);
+}
+
+void compressBytes(uint32_t state[8], const unsigned char* bytes) {
+    uint32_t block[16];
+    for (int i = 0; i < 16; ++i) {
+        block[i] = loadBE(bytes + i * 4);
+    }
+    compress(state, block);
+}
+
+// 在已处理 prefixLen 字节（64 的倍数）的状态上继续哈希 data 并完成填充
+void finish(uint32_t state[8], const unsigned char* data, size_t len, uint64_t prefixLen) {
+    size_t full = len / 64 * 64;
+    for (size_t off = 0; off < full; off += 64) {
+        compressBytes(state, data + off);
+    }
+    unsigned char tail[128] = {0};
+    size_t rest = len - full;
+    memcpy(tail, data + full, rest);
+    tail[rest] = 0x80;
+    size_t tailLen = rest + 9 <= 64 ? 64 : 128;
+    uint64_t bits = (prefixLen + len) * 8;
+    for (int i = 0; i < 8; ++i) {
+        tail[tailLen - 1 - i] = static_cast<unsigned char>(bits >> (i * 8));
+    }
+    compressBytes(state, tail);
+    if (tailLen == 128) {
+        compressBytes(state, tail + 64);
+    }
+}
+
+// 单条口令的 HMAC 预计算状态和第一轮结果，后续迭代在各通道中并行
+struct Lane {
+    uint32_t inner[8];   // 处理完 K ^ ipad 之后的状态
+    uint32_t outer[8];   // 处理完 K ^ opad 之后的状态
+    uint32_t u[8];       // U1
+};
+
+void prepare(const Pbkdf2Task& task, Lane* lane) {
+    unsigned char key[64] = {0};
+    if (task.password.size() > 64) {
+        SHA256(reinterpret_cast<const unsigned char*>(task.password.data()), task.password.size(), key);
+    } else {
+        memcpy(key, task.password.data(), task.password.size());
+    }
+    unsigned char pad[64];
+    for (int i = 0; i < 64; ++i) {
+        pad[i] = key[i] ^ 0x36;
+    }
+    memcpy(lane->inner, kIV, sizeof kIV);
+    compressBytes(lane->inner, pad);
+    for (int i = 0; i < 64; ++i) {
+        pad[i] = key[i] ^ 0x5c;
+    }
+    memcpy(lane->outer, kIV, sizeof kIV);
+    compressBytes(lane->outer, pad);
+
+    // U1 = HMAC(P, S || INT(1))
+    std::string message = task.salt;
+    message.append("\x00\x00\x00\x01", 4);
+    uint32_t state[8];
+    memcpy(state, lane->inner, sizeof state);
+    finish(state, reinterpret_cast<const unsigned char*>(message.data()), message.size(), 64);
+    unsigned char digest[32];
+    for (int i = 0; i < 8; ++i) {
+        storeBE(digest + i * 4, state[i]);
+    }
+    memcpy(state, lane->outer, sizeof state);
+    finish(state, digest, sizeof digest, 64);
+    memcpy(lane->u, state, sizeof state);
+}
+
+// 之后每轮的输入都是 32 字节摘要，加上 64 字节的 pad 前缀共 96 字节，填充后恰好一块
+template <typename V, size_t N>
+inline void iterate(const Lane* lanes, size_t count, int iterations, uint32_t out[][8]) {
+    V inner[8], outer[8], u[8], t[8];
+    for (int i = 0; i < 8; ++i) {
+        for (size_t l = 0; l < N; ++l) {
+            // 不足 N 条时空余通道重复第一条，结果丢弃
+            const Lane& lane = lanes[l < count ? l : 0];
+            inner[i][l] = lane.inner[i];
+            outer[i][l] = lane.outer[i];
+            u[i][l] = lane.u[i];
+        }
+        t[i] = u[i];
+    }
+
+    V block[16];
+    for (int i = 8; i < 16; ++i) {
+        block[i] = V{} + 0u;
+    }
+    block[8] = V{} + 0x80000000u;
+    block[15] = V{} + 768u;
+    for (int round = 1; round < iterations; ++round) {
+        V state[8];
+        for (int i = 0; i < 8; ++i) {
+            block[i] = u[i];
+            state[i] = inner[i];
+        }
+        compress(state, block);
+        for (int i = 0; i < 8; ++i) {
+            block[i] = state[i];
+            state[i] = outer[i];
+        }
+        compress(state, block);
+        for (int i = 0; i < 8; ++i) {
+            u[i] = state[i];
+            t[i] ^= state[i];
+        }
+    }
+
+    for (size_t l = 0; l < count; ++l) {
+        for (int i = 0; i < 8; ++i) {
+            out[l][i] = t[i][l];
+        }
+    }
+}
+
+// 通用代码内联进带 target 属性的入口后按对应指令集生成
+__attribute__((target("avx2"), flatten))
+void iterateAvx2(const Lane* lanes, size_t count, int iterations, uint32_t out[][8]) {
+    iterate<U32x8, 8>(lanes, count, iterations, out);
+}
+
+__attribute__((target("avx512f"), flatten))
+void iterateAvx512(const Lane* lanes, size_t count, int iterations, uint32_t out[][8]) {
+    iterate<U32x16, 16>(lanes, count, iterations, out);
+}
+
+Pbkdf2::Backend detectBackend() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return Pbkdf2::kAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Pbkdf2::kAvx2;
+    }
+    return Pbkdf2::kOpenSsl;
+}
+
+Pbkdf2::Backend resolve(Pbkdf2::Backend backend) {
+    static const Pbkdf2::Backend detected = detectBackend();
+    return backend == Pbkdf2::kAuto ? detected : backend;
+}
+
+size_t widthOf(Pbkdf2::Backend backend) {
+    switch (backend) {
+    case Pbkdf2::kAvx512: return 16;
+    case Pbkdf2::kAvx2:   return 8;
+    default:              return 1;
+    }
+}
+
+} // namespace
+
+size_t Pbkdf2::lanes() {
+    return widthOf(resolve(kAuto));
+}
+
+const char* Pbkdf2::backendName(Backend backend) {
+    switch (resolve(backend)) {
+    case kAvx512: return "avx512";
+    case kAvx2:   return "avx2";
+    default:      return "openssl";
+    }
+}
+
+void Pbkdf2::deriveBatch(Pbkdf2Task* tasks, size_t count, int iterations, Backend backend) {
+    backend = resolve(backend);
+    const size_t width = widthOf(backend);
+    Lane lanes[16];
+    uint32_t out[16][8];
+    size_t begin = 0;
+    // 一批的耗时与通道数无关，任务太少时逐条计算延迟更低
+    while (width > 1 && count - begin >= width / 4) {
+        size_t n = count - begin < width ? count - begin : width;
+        for (size_t l = 0; l < n; ++l) {
+            prepare(tasks[begin + l], &lanes[l]);
+        }
+        if (backend == kAvx512) {
+            iterateAvx512(lanes, n, iterations, out);
+        } else {
+            iterateAvx2(lanes, n, iterations, out);
+        }
+        for (size_t l = 0; l < n; ++l) {
+            for (int i = 0; i < 8; ++i) {
+                storeBE(tasks[begin + l].key + i * 4, out[l][i]);
+            }
+        }
+        begin += n;
+    }
+    for (; begin < count; ++begin) {
+        Pbkdf2Task& task = tasks[begin];
+        PKCS5_PBKDF2_HMAC(task.password.data(), static_cast<int>(task.password.size()),
+                          reinterpret_cast<const unsigned char*>(task.salt.data()), static_cast<int>(task.salt.size()),
+                          iterations, EVP_sha256(), sizeof task.key, task.key);
+    }
+}
@@ -29,13 +29,25 @@
 
    René Nyffenegger rene.nyffenegger@adp-gmbh.ch
 
+   Altered: the encoder / decoder loops were replaced with a table-driven
+   scalar codec and SSE4.1 / AVX2 kernels selected at runtime, and
+   base64_encode_to / base64_decode_to were added for caller-owned buffers.
+   Truncated input now throws std::runtime_error instead of std::out_of_range.
+
 */
 
 #include "../include/utils/base64.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <stdexcept>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BASE64_HAS_X86 1
+#endif
+
  //
  // Depending on the url parameter in base64_chars, one of
  // two sets of base64 characters needs to be chosen.
@@ -52,22 +64,346 @@ static const char* base64_chars[2] = {
              "0123456789"
              "-_"};
 
-static unsigned int pos_of_char(const unsigned char chr) {
- //
- // Return the position of chr within base64_encode()
- //
+static const char* const kInvalidInput = "Input is not valid base64-encoded data.";
 
-    if      (chr >= 'A' && chr <= 'Z') return chr - 'A';
-    else if (chr >= 'a' && chr <= 'z') return chr - 'a' + ('Z' - 'A')               + 1;
-    else if (chr >= '0' && chr <= '9') return chr - '0' + ('Z' - 'A') + ('z' - 'a') + 2;
-    else if (chr == '+' || chr == '-') return 62; // Be liberal with input and accept both url ('-') and non-url ('+') base 64 characters (
-    else if (chr == '/' || chr == '_') return 63; // Ditto for '/' and '_'
-    else
- //
- // 2020-10-23: Throw std::exception rather than const char*
- //(Pablo Martin-Gomez, https://github.com/Bouska)
- //
-    throw std::runtime_error("Input is not valid base64-encoded data.");
+// 字符到 6 位值的查找表，非法字符为 0xFF；两套字符集的 62、63 都接受
+struct DecodeTable {
+    unsigned char values[256];
+
+    DecodeTable() {
+        std::fill(values, values + 256, 0xFF);
+        for (int i = 0; i < 64; ++i) {
+            values[static_cast<unsigned char>(base64_chars[0][i])] = static_cast<unsigned char>(i);
+            values[static_cast<unsigned char>(base64_chars[1][i])] = static_cast<unsigned char>(i);
+        }
+    }
+};
+
+static const DecodeTable kDecodeTable;
+
+static inline unsigned int pos_of_char(const unsigned char chr) {
+    unsigned int value = kDecodeTable.values[chr];
+    if (value == 0xFF) {
+        throw std::runtime_error(kInvalidInput);
+    }
+    return value;
+}
+
+static inline bool is_padding(char c) {
+    // accept URL-safe base 64 strings, too, so check for '.' also.
+    return c == '=' || c == '.';
+}
+
+//
+// 标量实现：每 3 字节一组编码，从 pos 开始处理剩余部分
+//
+static size_t encode_scalar(unsigned char const* in, size_t len, size_t pos, char* out, size_t o, bool url) {
+    const char* chars = base64_chars[url];
+    const char trailing_char = url ? '.' : '=';
+
+    for (; pos + 3 <= len; pos += 3) {
+        uint32_t v = (uint32_t(in[pos]) << 16) | (uint32_t(in[pos + 1]) << 8) | in[pos + 2];
+        out[o++] = chars[(v >> 18) & 0x3F];
+        out[o++] = chars[(v >> 12) & 0x3F];
+        out[o++] = chars[(v >> 6) & 0x3F];
+        out[o++] = chars[v & 0x3F];
+    }
+    if (pos + 1 == len) {
+        out[o++] = chars[(in[pos] & 0xFC) >> 2];
+        out[o++] = chars[(in[pos] & 0x03) << 4];
+        out[o++] = trailing_char;
+        out[o++] = trailing_char;
+    }
+    else if (pos + 2 == len) {
+        out[o++] = chars[(in[pos] & 0xFC) >> 2];
+        out[o++] = chars[((in[pos] & 0x03) << 4) + ((in[pos + 1] & 0xF0) >> 4)];
+        out[o++] = chars[(in[pos + 1] & 0x0F) << 2];
+        out[o++] = trailing_char;
+    }
+    return o;
+}
+
+//
+// 标量实现：从 pos（4 的倍数）开始逐组解码，语义与原实现一致：
+// 最后一组可以不带填充，组内第 3 个字符为填充时忽略第 4 个字符，填充之后仍可继续出现新的组。
+// 每组先读完所有输入再写输出，保证原地解码安全
+//
+static size_t decode_scalar(char const* in, size_t len, size_t pos, unsigned char* out, size_t o) {
+    while (pos < len) {
+        if (pos + 1 >= len) {
+            throw std::runtime_error(kInvalidInput);
+        }
+        unsigned int c1 = pos_of_char(static_cast<unsigned char>(in[pos + 1]));
+        unsigned int c0 = pos_of_char(static_cast<unsigned char>(in[pos]));
+        bool has2 = pos + 2 < len && !is_padding(in[pos + 2]);
+        bool has3 = has2 && pos + 3 < len && !is_padding(in[pos + 3]);
+        unsigned int c2 = has2 ? pos_of_char(static_cast<unsigned char>(in[pos + 2])) : 0;
+        unsigned int c3 = has3 ? pos_of_char(static_cast<unsigned char>(in[pos + 3])) : 0;
+
+        out[o++] = static_cast<unsigned char>((c0 << 2) + ((c1 & 0x30) >> 4));
+        if (has2) {
+            out[o++] = static_cast<unsigned char>(((c1 & 0x0F) << 4) + ((c2 & 0x3C) >> 2));
+            if (has3) {
+                out[o++] = static_cast<unsigned char>(((c2 & 0x03) << 6) + c3);
+            }
+        }
+        pos += 4;
+    }
+    return o;
+}
+
+#ifdef BASE64_HAS_X86
+
+//
+// 向量化实现（Muła / Lemire 的做法）：
+// 编码时用 pshufb 把每 3 字节扩展为 4 字节，再用乘法把 6 位组移到各字节的低位，最后按所在区间加偏移得到字符；
+// 解码时按高 / 低半字节查表校验并求值，遇到非法字符或填充的块交给标量实现处理，然后用 maddubs / madd 把 4 个 6 位组合并成 3 字节
+//
+
+__attribute__((target("sse4.1")))
+static inline __m128i enc_reshuffle_sse(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003F03F0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+// 6 位值到字符：[0,25] +65，[26,51] +71，[52,61] -4，62、63 按字符集各自的偏移
+__attribute__((target("sse4.1")))
+static inline __m128i enc_translate_sse(__m128i in, __m128i lut) {
+    __m128i indices = _mm_subs_epu8(in, _mm_set1_epi8(51));
+    const __m128i mask = _mm_cmpgt_epi8(in, _mm_set1_epi8(25));
+    indices = _mm_sub_epi8(indices, mask);
+    return _mm_add_epi8(in, _mm_shuffle_epi8(lut, indices));
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i enc_lut_sse(bool url) {
+    return url ? _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32, 0, 0)
+               : _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+}
+
+// 解码按高 / 低半字节查表：lo 表记录每个低半字节在哪些高半字节下是合法字符，
+// hi 表为 1 << 高半字节，二者相与为 0 即非法（>= 0x80 的字节高半字节表项为 0）
+alignas(16) static const uint8_t kDecodeValidLo[16] = {
+    0xA8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8, 0xF8,
+    0xF8, 0xF8, 0xF0, 0x54, 0x50, 0x54, 0x50, 0x74
+};
+alignas(16) static const int8_t kDecodeValidHi[16] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, -128, 0, 0, 0, 0, 0, 0, 0, 0
+};
+// 按高半字节的偏移：'+' 19，数字 4，大写 -65，小写 -71
+alignas(16) static const int8_t kDecodeOffset[16] = {
+    0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+};
+// 高半字节为 2 时按低半字节修正：'-' 17，'/' 16；'_' 落在大写字母的高半字节，单独加 33
+alignas(16) static const int8_t kDecodeFix2[16] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -2, 0, -3
+};
+
+// 字符到 6 位值，有非法字符时返回 false
+__attribute__((target("sse4.1")))
+static inline bool dec_translate_sse(__m128i str, __m128i* value) {
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i hi = _mm_and_si128(_mm_srli_epi32(str, 4), nibble);
+    const __m128i lo = _mm_and_si128(str, nibble);
+    const __m128i bits = _mm_and_si128(
+        _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(kDecodeValidLo)), lo),
+        _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(kDecodeValidHi)), hi));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(bits, _mm_setzero_si128())) != 0) {
+        return false;
+    }
+
+    __m128i delta = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(kDecodeOffset)), hi);
+    const __m128i hi2 = _mm_cmpeq_epi8(hi, _mm_set1_epi8(2));
+    delta = _mm_add_epi8(delta, _mm_and_si128(hi2,
+        _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(kDecodeFix2)), lo)));
+    const __m128i underscore = _mm_cmpeq_epi8(str, _mm_set1_epi8('_'));
+    delta = _mm_add_epi8(delta, _mm_and_si128(underscore, _mm_set1_epi8(33)));
+    *value = _mm_add_epi8(str, delta);
+    return true;
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i dec_reshuffle_sse(__m128i in) {
+    const __m128i merge_ab_and_bc = _mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140));
+    const __m128i out = _mm_madd_epi16(merge_ab_and_bc, _mm_set1_epi32(0x00011000));
+    return _mm_shuffle_epi8(out, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+__attribute__((target("sse4.1")))
+static size_t encode_sse41(unsigned char const* in, size_t len, char* out, bool url, size_t* consumed) {
+    const __m128i lut = enc_lut_sse(url);
+    size_t pos = 0;
+    size_t o = 0;
+    // 每次读 16 字节、用其中 12 字节
+    for (; pos + 16 <= len; pos += 12, o += 16) {
+        __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos));
+        str = enc_translate_sse(enc_reshuffle_sse(str), lut);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), str);
+    }
+    *consumed = pos;
+    return o;
+}
+
+__attribute__((target("sse4.1")))
+static size_t decode_sse41(char const* in, size_t len, unsigned char* out, size_t* consumed) {
+    size_t pos = 0;
+    size_t o = 0;
+    // 每次写 16 字节、其中 12 字节有效，保留足够余量使写入不超出 decoded_max_length
+    for (; pos + 24 <= len; pos += 16, o += 12) {
+        __m128i value;
+        if (!dec_translate_sse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos)), &value)) {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), dec_reshuffle_sse(value));
+    }
+    *consumed = pos;
+    return o;
+}
+
+__attribute__((target("avx2")))
+static size_t encode_avx2(unsigned char const* in, size_t len, char* out, bool url, size_t* consumed) {
+    const __m256i lut = _mm256_broadcastsi128_si256(enc_lut_sse(url));
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                             1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    size_t pos = 0;
+    size_t o = 0;
+    // 两个 128 位通道各取 12 字节，共 24 字节输入、32 字节输出
+    for (; pos + 28 <= len; pos += 24, o += 32) {
+        __m256i str = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos + 12)), 1);
+        str = _mm256_shuffle_epi8(str, shuffle);
+        const __m256i t0 = _mm256_and_si256(str, _mm256_set1_epi32(0x0FC0FC00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(str, _mm256_set1_epi32(0x003F03F0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        str = _mm256_or_si256(t1, t3);
+
+        __m256i indices = _mm256_subs_epu8(str, _mm256_set1_epi8(51));
+        const __m256i mask = _mm256_cmpgt_epi8(str, _mm256_set1_epi8(25));
+        indices = _mm256_sub_epi8(indices, mask);
+        str = _mm256_add_epi8(str, _mm256_shuffle_epi8(lut, indices));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), str);
+    }
+    *consumed = pos;
+    return o;
+}
+
+__attribute__((target("avx2")))
+static size_t decode_avx2(char const* in, size_t len, unsigned char* out, size_t* consumed) {
+    const __m256i lutLo = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(kDecodeValidLo)));
+    const __m256i lutHi = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(kDecodeValidHi)));
+    const __m256i lutOffset = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(kDecodeOffset)));
+    const __m256i lutFix2 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(kDecodeFix2)));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    size_t pos = 0;
+    size_t o = 0;
+    // 每次写 32 字节、其中 24 字节有效
+    for (; pos + 44 <= len; pos += 32, o += 24) {
+        const __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + pos));
+        const __m256i hi = _mm256_and_si256(_mm256_srli_epi32(str, 4), nibble);
+        const __m256i lo = _mm256_and_si256(str, nibble);
+        const __m256i bits = _mm256_and_si256(_mm256_shuffle_epi8(lutLo, lo), _mm256_shuffle_epi8(lutHi, hi));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(bits, _mm256_setzero_si256())) != 0) {
+            break;
+        }
+
+        __m256i delta = _mm256_shuffle_epi8(lutOffset, hi);
+        const __m256i hi2 = _mm256_cmpeq_epi8(hi, _mm256_set1_epi8(2));
+        delta = _mm256_add_epi8(delta, _mm256_and_si256(hi2, _mm256_shuffle_epi8(lutFix2, lo)));
+        const __m256i underscore = _mm256_cmpeq_epi8(str, _mm256_set1_epi8('_'));
+        delta = _mm256_add_epi8(delta, _mm256_and_si256(underscore, _mm256_set1_epi8(33)));
+        const __m256i value = _mm256_add_epi8(str, delta);
+
+        const __m256i merge_ab_and_bc = _mm256_maddubs_epi16(value, _mm256_set1_epi32(0x01400140));
+        __m256i packed = _mm256_madd_epi16(merge_ab_and_bc, _mm256_set1_epi32(0x00011000));
+        packed = _mm256_shuffle_epi8(packed, _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), packed);
+    }
+    *consumed = pos;
+    return o;
+}
+
+#endif  // BASE64_HAS_X86
+
+static Base64Impl detect_impl() {
+#ifdef BASE64_HAS_X86
+    if (__builtin_cpu_supports("avx2")) return Base64Impl::Avx2;
+    if (__builtin_cpu_supports("sse4.1")) return Base64Impl::Sse41;
+#endif
+    return Base64Impl::Scalar;
+}
+
+static const Base64Impl kDetectedImpl = detect_impl();
+static std::atomic<Base64Impl> g_impl(kDetectedImpl);
+
+Base64Impl base64_set_impl(Base64Impl impl) {
+    bool supported = impl == Base64Impl::Scalar
+                  || (impl == Base64Impl::Sse41 && kDetectedImpl != Base64Impl::Scalar)
+                  || (impl == Base64Impl::Avx2 && kDetectedImpl == Base64Impl::Avx2);
+    g_impl.store(supported ? impl : kDetectedImpl, std::memory_order_relaxed);
+    return base64_impl();
+}
+
+Base64Impl base64_impl() {
+    return g_impl.load(std::memory_order_relaxed);
+}
+
+size_t base64_encoded_length(size_t len) {
+    return (len + 2) / 3 * 4;
+}
+
+size_t base64_decoded_max_length(size_t len) {
+    return (len + 3) / 4 * 3;
+}
+
+size_t base64_encode_to(unsigned char const* in, size_t len, char* out, bool url) {
+    size_t pos = 0;
+    size_t o = 0;
+#ifdef BASE64_HAS_X86
+    switch (base64_impl()) {
+    case Base64Impl::Avx2:
+        o = encode_avx2(in, len, out, url, &pos);
+        break;
+    case Base64Impl::Sse41:
+        o = encode_sse41(in, len, out, url, &pos);
+        break;
+    default:
+        break;
+    }
+#endif
+    return encode_scalar(in, len, pos, out, o, url);
+}
+
+size_t base64_decode_to(char const* in, size_t len, unsigned char* out) {
+    size_t pos = 0;
+    size_t o = 0;
+#ifdef BASE64_HAS_X86
+    switch (base64_impl()) {
+    case Base64Impl::Avx2: {
+        o = decode_avx2(in, len, out, &pos);
+        // AVX2 在块内遇到填充或非法字符时停下，剩余部分先尝试 16 字节的块
+        size_t more = 0;
+        o += decode_sse41(in + pos, len - pos, out + o, &more);
+        pos += more;
+        break;
+    }
+    case Base64Impl::Sse41:
+        o = decode_sse41(in, len, out, &pos);
+        break;
+    default:
+        break;
+    }
+#endif
+    return decode_scalar(in, len, pos, out, o);
 }
 
 static std::string insert_linebreaks(std::string str, size_t distance) {
@@ -109,53 +445,8 @@ static std::string encode(String s, bool url) {
 }
 
 std::string base64_encode(unsigned char const* bytes_to_encode, size_t in_len, bool url) {
-
-    size_t len_encoded = (in_len +2) / 3 * 4;
-
-    unsigned char trailing_char = url ? '.' : '=';
-
- //
- // Choose set of base64 characters. They differ
- // for the last two positions, depending on the url
- // parameter.
- // A bool (as is the parameter url) is guaranteed
- // to evaluate to either 0 or 1 in C++ therefore,
- // the correct character set is chosen by subscripting
- // base64_chars with url.
- //
-    const char* base64_chars_ = base64_chars[url];
-
-    std::string ret;
-    ret.reserve(len_encoded);
-
-    unsigned int pos = 0;
-
-    while (pos < in_len) {
-        ret.push_back(base64_chars_[(bytes_to_encode[pos + 0] & 0xfc) >> 2]);
-
-        if (pos+1 < in_len) {
-           ret.push_back(base64_chars_[((bytes_to_encode[pos + 0] & 0x03) << 4) + ((bytes_to_encode[pos + 1] & 0xf0) >> 4)]);
-
-           if (pos+2 < in_len) {
-              ret.push_back(base64_chars_[((bytes_to_encode[pos + 1] & 0x0f) << 2) + ((bytes_to_encode[pos + 2] & 0xc0) >> 6)]);
-              ret.push_back(base64_chars_[  bytes_to_encode[pos + 2] & 0x3f]);
-           }
-           else {
-              ret.push_back(base64_chars_[(bytes_to_encode[pos + 1] & 0x0f) << 2]);
-              ret.push_back(trailing_char);
-           }
-        }
-        else {
-
-            ret.push_back(base64_chars_[(bytes_to_encode[pos + 0] & 0x03) << 4]);
-            ret.push_back(trailing_char);
-            ret.push_back(trailing_char);
-        }
-
-        pos += 3;
-    }
-
-
+    std::string ret(base64_encoded_length(in_len), '\0');
+    base64_encode_to(bytes_to_encode, in_len, &ret[0], url);
     return ret;
 }
 
@@ -177,66 +468,10 @@ static std::string decode(String const& encoded_string, bool remove_linebreaks)
        return base64_decode(copy, false);
     }
 
-    size_t length_of_string = encoded_string.length();
-    size_t pos = 0;
-
- //
- // The approximate length (bytes) of the decoded string might be one or
- // two bytes smaller, depending on the amount of trailing equal signs
- // in the encoded string. This approximation is needed to reserve
- // enough space in the string to be returned.
- //
-    size_t approx_length_of_decoded_string = length_of_string / 4 * 3;
-    std::string ret;
-    ret.reserve(approx_length_of_decoded_string);
-
-    while (pos < length_of_string) {
-    //
-    // Iterate over encoded input string in chunks. The size of all
-    // chunks except the last one is 4 bytes.
-    //
-    // The last chunk might be padded with equal signs or dots
-    // in order to make it 4 bytes in size as well, but this
-    // is not required as per RFC 2045.
-    //
-    // All chunks except the last one produce three output bytes.
-    //
-    // The last chunk produces at least one and up to three bytes.
-    //
-
-       size_t pos_of_char_1 = pos_of_char(encoded_string.at(pos+1) );
-
-    //
-    // Emit the first output byte that is produced in each chunk:
-    //
-       ret.push_back(static_cast<std::string::value_type>( ( (pos_of_char(encoded_string.at(pos+0)) ) << 2 ) + ( (pos_of_char_1 & 0x30 ) >> 4)));
-
-       if ( ( pos + 2 < length_of_string  )       &&  // Check for data that is not padded with equal signs (which is allowed by RFC 2045)
-              encoded_string.at(pos+2) != '='     &&
-              encoded_string.at(pos+2) != '.'         // accept URL-safe base 64 strings, too, so check for '.' also.
-          )
-       {
-       //
-       // Emit a chunk's second byte (which might not be produced in the last chunk).
-       //
-          unsigned int pos_of_char_2 = pos_of_char(encoded_string.at(pos+2) );
-          ret.push_back(static_cast<std::string::value_type>( (( pos_of_char_1 & 0x0f) << 4) + (( pos_of_char_2 & 0x3c) >> 2)));
-
-          if ( ( pos + 3 < length_of_string )     &&
-                 encoded_string.at(pos+3) != '='  &&
-                 encoded_string.at(pos+3) != '.'
-             )
-          {
-          //
-          // Emit a chunk's third byte (which might not be produced in the last chunk).
-          //
-             ret.push_back(static_cast<std::string::value_type>( ( (pos_of_char_2 & 0x03 ) << 6 ) + pos_of_char(encoded_string.at(pos+3))   ));
-          }
-       }
-
-       pos += 4;
-    }
-
+    std::string ret(base64_decoded_max_length(encoded_string.length()), '\0');
+    size_t length = base64_decode_to(encoded_string.data(), encoded_string.length(),
+                                     reinterpret_cast<unsigned char*>(&ret[0]));
+    ret.resize(length);
     return ret;
 }
 
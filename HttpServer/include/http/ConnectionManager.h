@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/net/Callbacks.h>
+#include <muduo/net/EventLoop.h>
+
+namespace http
+{
+
+namespace metrics
+{
+class Counter;
+} // namespace metrics
+
+// 连接生命周期限制，超时单位为秒，取 0 表示不限
+struct ConnectionOptions
+{
+    int    idleTimeout = 60;              // keep-alive 连接两次请求之间的最长空闲时间
+    int    headerTimeout = 10;            // 从请求第一个字节到请求头读完
+    int    bodyTimeout = 30;              // 从请求头读完到请求体读完
+    size_t maxConnections = 10000;        // 全局并发连接数
+    size_t maxConnectionsPerIp = 256;     // 单个客户端 IP 的并发连接数
+    size_t maxHeaderBytes = 16 * 1024;    // 请求行加请求头的总长度
+    size_t maxBodyBytes = 16 * 1024 * 1024;
+};
+
+// 连接当前所处阶段，决定使用哪个超时
+enum class ConnectionPhase
+{
+    kIdle,          // 等待下一个请求
+    kReadingHeader, // 请求头未读完
+    kReadingBody,   // 请求体未读完
+    kBusy,          // 请求已读完，响应（含流式响应）尚未结束，不限时
+    kUpgraded,      // 已升级为 WebSocket，不再受 HTTP 超时约束
+};
+
+class ConnectionManager;
+class ConnectionWheel;
+
+// 每个连接的超时状态，保存在 HttpContext 中，只在连接所属 IO 线程中访问
+struct ConnectionTimer
+{
+    ConnectionManager* manager = nullptr;
+    ConnectionWheel*   wheel = nullptr;  // 所属 IO 线程的时间轮
+    ConnectionPhase    phase = ConnectionPhase::kIdle;
+    int64_t            deadline = 0;     // 到期 tick，0 表示不限时
+    std::string        peerIp;           // 计入单 IP 连接数时记录
+    bool               admitted = false; // 是否已计入连接数
+};
+
+// 连接管理器：每个 IO 线程一个时间轮（1 秒一格，槽中保存连接的弱引用），
+// 阶段切换时把连接放入到期所在的槽，到期时检查连接当前的 deadline，
+// 未被刷新的才驱逐；同时限制全局和单 IP 的并发连接数
+class ConnectionManager : muduo::noncopyable
+{
+public:
+    ConnectionManager();
+    ~ConnectionManager();
+
+    // 需在服务启动前设置
+    void setOptions(const ConnectionOptions& options);
+
+    const ConnectionOptions& options() const
+    { return options_; }
+
+    // 新连接建立时在 IO 线程中调用；超出连接数上限时返回 false，由调用者拒绝并关闭连接
+    bool onConnected(const muduo::net::TcpConnectionPtr& conn, ConnectionTimer* timer);
+    void onDisconnected(ConnectionTimer* timer);
+
+    // 切换阶段并按新阶段的超时重新计时，只在 IO 线程中调用
+    void setPhase(const muduo::net::TcpConnectionPtr& conn, ConnectionTimer* timer, ConnectionPhase phase);
+
+    size_t connections() const
+    { return connections_.load(std::memory_order_relaxed); }
+
+    // 请求头或请求体超出大小限制时计数，reason 为 header_too_large / body_too_large / bad_request / body_spill_failed
+    void countRejectedRequest(const char* reason);
+
+private:
+    friend class ConnectionWheel;
+
+    ConnectionWheel* wheelFor(muduo::net::EventLoop* loop);
+    void evict(const muduo::net::TcpConnectionPtr& conn, ConnectionPhase phase);
+    int timeoutFor(ConnectionPhase phase) const;
+
+    ConnectionOptions   options_;
+    std::atomic<size_t> connections_;
+
+    std::mutex                                          ipMutex_;
+    std::unordered_map<std::string, size_t>             perIp_;
+    std::mutex                                          wheelMutex_;
+    std::vector<std::unique_ptr<ConnectionWheel>>       wheels_;
+
+    metrics::Counter* evictedIdle_;
+    metrics::Counter* evictedHeader_;
+    metrics::Counter* evictedBody_;
+    metrics::Counter* rejectedGlobal_;
+    metrics::Counter* rejectedPerIp_;
+};
+
+} // namespace http
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/net/TcpConnection.h>
+
+#include "HttpResponse.h"
+
+namespace http
+{
+
+// 延迟完成的响应：处理器返回时结果尚未就绪（如耗 CPU 的口令校验转交其它线程），
+// 由任意线程填写 response() 后调用 complete()，发送投递到连接所属的 IO 线程执行。
+// 全局中间件的 after 在处理器返回时已作用于本响应，之后添加的头部不再经过中间件
+class DeferredResponse : muduo::noncopyable
+{
+public:
+    DeferredResponse(const muduo::net::TcpConnectionPtr& conn, HttpResponse response);
+    // 未调用 complete() 就释放时回复 500，连接不会一直等待
+    ~DeferredResponse();
+
+    // complete() 之前只应由一个线程修改
+    HttpResponse* response()
+    { return &response_; }
+
+    // 发送响应，只有第一次调用生效
+    void complete();
+
+private:
+    std::weak_ptr<muduo::net::TcpConnection> conn_;
+    HttpResponse                             response_;
+    std::atomic<bool>                        completed_;
+};
+
+using DeferredResponsePtr = std::shared_ptr<DeferredResponse>;
+
+} // namespace http
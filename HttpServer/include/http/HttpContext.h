@@ -1,12 +1,29 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <string>
+
 #include <muduo/net/TcpServer.h>
 
+#include "ConnectionManager.h"
 #include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "RequestBody.h"
+
+namespace ssl
+{
+class SslConnection;
+} // namespace ssl
 
 namespace http
 {
 
+namespace websocket
+{
+class WebSocketConnection;
+} // namespace websocket
+
 class HttpContext 
 {
 public:
@@ -14,21 +31,105 @@ public:
     {
         kExpectRequestLine, // 解析请求行
         kExpectHeaders, // 解析请求头
-        kExpectBody, // 解析请求体
+        kGotHeaders, // 请求头已读完，等待 beginBody
+        kExpectBody, // 按 Content-Length 读取请求体
+        kExpectChunkSize, // 分块编码：块大小行
+        kExpectChunkData, // 分块编码：块数据
+        kExpectChunkEnd, // 分块编码：块数据之后的 CRLF
+        kExpectTrailers, // 分块编码：结尾的 trailer 字段
         kGotAll, // 解析完成
     };
     
     HttpContext()
     : state_(kExpectRequestLine)
+    , maxHeaderBytes_(ConnectionOptions().maxHeaderBytes)
+    , maxBodyBytes_(ConnectionOptions().maxBodyBytes)
+    , headerBytes_(0)
+    , error_(HttpResponse::k400BadRequest)
+    , pauseAtHeaders_(false)
+    , chunked_(false)
+    , bodyLimit_(0)
+    , bodyBytes_(0)
+    , chunkRemaining_(0)
+    , spillThreshold_(0)
+    , dispatched_(false)
+    , responded_(false)
+    , responsePending_(false)
+    , readPaused_(false)
     {}
 
+    // 返回 false 表示报文非法或超出大小限制，对应的状态码由 error() 给出
     bool parseRequest(muduo::net::Buffer* buf, muduo::Timestamp receiveTime);
     bool gotAll() const 
     { return state_ == kGotAll;  }
 
+    HttpRequestParseState state() const
+    { return state_; }
+
+    bool readingBody() const
+    { return state_ > kGotHeaders && state_ < kGotAll; }
+
+    // 为 true 时请求头读完后停在 kGotHeaders，由调用者按路由调用 beginBody；
+    // 默认按全局上限直接读取并整体缓存请求体
+    void setPauseAtHeaders(bool pause)
+    { pauseAtHeaders_ = pause; }
+
+    // 按路由的请求体设置（可为空）开始读取请求体；超出上限或无法创建临时文件时返回 false
+    bool beginBody(const BodyOptions* options);
+
+    // 流式请求体的请求在请求头读完时已分发，请求体读完后不再分发
+    void setDispatched()
+    { dispatched_ = true; }
+
+    bool dispatched() const
+    { return dispatched_; }
+
+    // 已分发请求的响应在请求体读完之前已经结束
+    bool responded() const
+    { return responded_; }
+
+    // 请求已分发、响应尚未结束（延迟响应、流式响应）；期间不解析同一连接上的下一个请求，
+    // 保证 HTTP/1.1 响应按请求顺序发出。与请求无关，reset 不清除
+    void setResponsePending()
+    { responsePending_ = true; }
+
+    bool responsePending() const
+    { return responsePending_; }
+
+    // 等待响应期间又收到数据时暂停读取，数据留在缓冲中，响应结束后恢复
+    void pauseRead(const muduo::net::TcpConnectionPtr& conn);
+
+    // 响应结束后继续解析缓冲中的请求，由 HttpServer 设置
+    using ResumeCallback = std::function<void (const muduo::net::TcpConnectionPtr&)>;
+    void setResumeCallback(ResumeCallback callback)
+    { resumeCallback_ = std::move(callback); }
+
+    // 连接断开时结束未读完的流式请求体
+    void abortBody();
+
+    // 请求行加请求头、请求体的长度上限
+    void setLimits(size_t maxHeaderBytes, size_t maxBodyBytes)
+    {
+        maxHeaderBytes_ = maxHeaderBytes;
+        maxBodyBytes_ = maxBodyBytes;
+    }
+
+    HttpResponse::HttpStatusCode error() const
+    { return error_; }
+
     void reset()
     {
         state_ = kExpectRequestLine;
+        headerBytes_ = 0;
+        error_ = HttpResponse::k400BadRequest;
+        chunked_ = false;
+        bodyLimit_ = 0;
+        bodyBytes_ = 0;
+        chunkRemaining_ = 0;
+        spillThreshold_ = 0;
+        spillDir_.clear();
+        dispatched_ = false;
+        responded_ = false;
         HttpRequest dummyData;
         request_.swap(dummyData);
     }
@@ -39,11 +140,79 @@ public:
     HttpRequest& request()
     { return request_;}
 
+    // 升级为 WebSocket 后，后续数据交由 WebSocketConnection 处理
+    void setWebSocket(const std::shared_ptr<websocket::WebSocketConnection>& ws)
+    { webSocket_ = ws; }
+
+    const std::shared_ptr<websocket::WebSocketConnection>& webSocket() const
+    { return webSocket_; }
+
+    // TLS 连接的加解密状态，随连接上下文一起释放
+    void setSslConnection(const std::shared_ptr<ssl::SslConnection>& sslConn)
+    { sslConn_ = sslConn; }
+
+    ssl::SslConnection* sslConnection() const
+    { return sslConn_.get(); }
+
+    ConnectionTimer& connectionTimer()
+    { return timer_; }
+
+    // 连接建立时记录一次，每个请求分发前复制到 HttpRequest
+    void setPeerIp(const std::string& ip)
+    { peerIp_ = ip; }
+
+    const std::string& peerIp() const
+    { return peerIp_; }
+
+    // 切换连接阶段，未接入 ConnectionManager 时忽略；只在 IO 线程中调用
+    void setConnectionPhase(const muduo::net::TcpConnectionPtr& conn, ConnectionPhase phase)
+    {
+        if (timer_.manager)
+            timer_.manager->setPhase(conn, &timer_, phase);
+    }
+
+    // 响应写完后调用，连接回到空闲计时，并继续处理已缓冲的下一个请求
+    static void onResponseComplete(const muduo::net::TcpConnectionPtr& conn);
+
+    // 向连接发送响应数据：TLS 连接先加密再发送，可在任意线程调用
+    static void send(const muduo::net::TcpConnectionPtr& conn, const char* data, size_t len);
+    static void send(const muduo::net::TcpConnectionPtr& conn, const std::string& data);
+    static void send(const muduo::net::TcpConnectionPtr& conn, muduo::net::Buffer* buf);
+
 private:
     bool processRequestLine(const char* begin, const char* end);
+    // 空行之后根据 Transfer-Encoding / Content-Length 决定是否读取请求体
+    bool processHeadersEnd();
+    bool processChunkSize(const char* begin, const char* end);
+    // 把一段请求体交给 BodyReader、临时文件或内存缓冲
+    bool appendBody(const char* data, size_t len);
+    bool spillBody();
+    void finishBody();
+    bool fail(HttpResponse::HttpStatusCode code);
+    void resumeParsing(const muduo::net::TcpConnectionPtr& conn);
     
-    HttpRequestParseState state_;
-    HttpRequest           request_;
+    HttpRequestParseState                           state_;
+    HttpRequest                                     request_;
+    size_t                                          maxHeaderBytes_;
+    size_t                                          maxBodyBytes_;
+    size_t                                          headerBytes_; // 当前请求已读取的请求行和请求头长度
+    HttpResponse::HttpStatusCode                    error_;
+    bool                                            pauseAtHeaders_;
+    bool                                            chunked_; // Transfer-Encoding: chunked
+    uint64_t                                        bodyLimit_; // 本请求的请求体上限
+    uint64_t                                        bodyBytes_; // 已读取的请求体长度
+    uint64_t                                        chunkRemaining_; // 当前块未读取的长度
+    size_t                                          spillThreshold_;
+    std::string                                     spillDir_;
+    bool                                            dispatched_;
+    bool                                            responded_;
+    bool                                            responsePending_;
+    bool                                            readPaused_;
+    ResumeCallback                                  resumeCallback_;
+    ConnectionTimer                                 timer_;
+    std::string                                     peerIp_;
+    std::shared_ptr<websocket::WebSocketConnection> webSocket_;
+    std::shared_ptr<ssl::SslConnection>             sslConn_;
 };
 
 } // namespace http
\ No newline at end of file
@@ -6,6 +6,8 @@
 
 #include <muduo/base/Timestamp.h>
 
+#include "RequestBody.h"
+
 namespace http
 {
 
@@ -30,7 +32,7 @@ public:
     Method method() const { return method_; }
 
     void setPath(const char* start, const char* end);
-    std::string path() const { return path_; }
+    const std::string& path() const { return path_; }
 
     void setPathParameters(const std::string &key, const std::string &value);
     std::string getPathParameters(const std::string &key) const;
@@ -66,12 +68,43 @@ public:
     std::string getBody() const
     { return content_; }
 
+    // 读取请求体时由 HttpContext 逐段追加
+    void appendBody(const char* data, size_t len)
+    { content_.append(data, len); }
+
+    void reserveBody(size_t len)
+    { content_.reserve(len); }
+
+    void swapBody(std::string& body)
+    { content_.swap(body); }
+
+    // 请求体超过路由的落盘阈值时写入临时文件，此时 getBody() 为空
+    void setSpilledBody(std::shared_ptr<SpilledBody> body)
+    { spilledBody_ = std::move(body); }
+
+    const std::shared_ptr<SpilledBody>& spilledBody() const
+    { return spilledBody_; }
+
+    // 路由开启流式请求体时非空，处理器通过它接收请求体
+    void setBodyReader(BodyReaderPtr reader)
+    { bodyReader_ = std::move(reader); }
+
+    const BodyReaderPtr& bodyReader() const
+    { return bodyReader_; }
+
     void setContentLength(uint64_t length)
     { contentLength_ = length; }
     
     uint64_t contentLength() const
     { return contentLength_; }
 
+    // 客户端 IP，由 HttpServer 在分发请求前设置
+    void setPeerIp(const std::string& ip)
+    { peerIp_ = ip; }
+
+    const std::string& peerIp() const
+    { return peerIp_; }
+
     void swap(HttpRequest& that);
 
 private:
@@ -84,6 +117,9 @@ private:
     std::map<std::string, std::string>           headers_; // 请求头
     std::string                                  content_; // 请求体
     uint64_t                                     contentLength_ { 0 }; // 请求体长度
+    std::shared_ptr<SpilledBody>                 spilledBody_; // 落盘的请求体
+    BodyReaderPtr                                bodyReader_; // 流式请求体
+    std::string                                  peerIp_; // 客户端 IP
 };  
 
 } // namespace http
\ No newline at end of file
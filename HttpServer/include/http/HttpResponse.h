@@ -5,33 +5,54 @@
 #include <functional>
 #include <memory>
 
+#include "utils/StreamCompressor.h"
+
 namespace http
 {
 
+class StreamWriter;
+class DeferredResponse;
+
 class HttpResponse 
 {
 public:
     // 流式写入回调函数类型
     using StreamWriteCallback = std::function<bool(muduo::net::TcpConnectionPtr conn, HttpResponse* resp)>;
+    // 推送式流响应回调：响应头发出后调用一次，业务通过 StreamWriter 主动推送数据
+    using StreamStartCallback = std::function<void(const std::shared_ptr<StreamWriter>& writer)>;
+    // 延迟响应回调：处理器返回后在 IO 线程中调用一次，业务在其它线程填写响应后调用 complete()
+    using DeferredCallback = std::function<void(const std::shared_ptr<DeferredResponse>& pending)>;
     
     enum HttpStatusCode
     {
         kUnknown,
+        k101SwitchingProtocols = 101,
         k200Ok = 200,
         k204NoContent = 204,
         k301MovedPermanently = 301,
+        k304NotModified = 304,
         k400BadRequest = 400,
         k401Unauthorized = 401,
         k403Forbidden = 403,
         k404NotFound = 404,
+        k408RequestTimeout = 408,
         k409Conflict = 409,
+        k413PayloadTooLarge = 413,
+        k414UriTooLong = 414,
+        k417ExpectationFailed = 417,
+        k426UpgradeRequired = 426,
+        k429TooManyRequests = 429,
+        k431RequestHeaderFieldsTooLarge = 431,
         k500InternalServerError = 500,
+        k501NotImplemented = 501,
+        k503ServiceUnavailable = 503,
     };
 
     HttpResponse(bool close = true)
         : statusCode_(kUnknown)
         , closeConnection_(close)
         , isStreaming_(false)
+        , isChunked_(false)
     {}
 
     void setVersion(std::string version)
@@ -66,6 +87,18 @@ public:
         auto it = headers_.find(key);
         return it != headers_.end() ? it->second : empty;
     }
+
+    void removeHeader(const std::string& key)
+    { headers_.erase(key); }
+
+    // 追加预先格式化好的头部块（每行 "Name: value\r\n"），发送时原样输出，不经过 headers_
+    // 用于中间件在启动时生成的固定头部（CORS、安全头等），超过 kMaxRawHeaderBlocks 个时忽略
+    static const size_t kMaxRawHeaderBlocks = 4;
+    void addRawHeaders(std::shared_ptr<const std::string> block)
+    {
+        if (block && rawHeaderCount_ < kMaxRawHeaderBlocks)
+            rawHeaders_[rawHeaderCount_++] = std::move(block);
+    }
     
     void setBody(const std::string& body)
     { 
@@ -73,6 +106,34 @@ public:
         // body_ += "\0";
     }
 
+    void setBody(std::string&& body)
+    { body_ = std::move(body); }
+
+    const std::string& getBody() const
+    { return body_; }
+
+    // 共享只读响应体（静态文件缓存、内存映射文件等），发送时直接引用，不再拷贝到 body_
+    // owner 负责在发送完成前保持 data 所指内存有效
+    void setSharedBody(std::shared_ptr<const void> owner, const char* data, size_t size)
+    {
+        sharedBodyOwner_ = std::move(owner);
+        sharedBodyData_ = data;
+        sharedBodySize_ = size;
+        setContentLength(size);
+    }
+
+    bool hasSharedBody() const
+    { return sharedBodyOwner_ != nullptr; }
+
+    const std::shared_ptr<const void>& sharedBodyOwner() const
+    { return sharedBodyOwner_; }
+
+    const char* sharedBodyData() const
+    { return sharedBodyData_; }
+
+    size_t sharedBodySize() const
+    { return sharedBodySize_; }
+
     // 设置流式响应模式
     void setStreamingMode(bool streaming)
     {
@@ -97,25 +158,88 @@ public:
         return streamWriteCallback_;
     }
 
+    // 设置推送式流响应回调
+    void setStreamStartCallback(StreamStartCallback callback)
+    {
+        streamStartCallback_ = std::move(callback);
+    }
+
+    const StreamStartCallback& getStreamStartCallback() const
+    {
+        return streamStartCallback_;
+    }
+
+    // 设置后本次不立即发送响应，当前已设置的头部会保留
+    void defer(DeferredCallback callback)
+    {
+        deferredCallback_ = std::move(callback);
+    }
+
+    const DeferredCallback& getDeferredCallback() const
+    {
+        return deferredCallback_;
+    }
+
+    // 推送式流响应的压缩器，由压缩中间件设置，StreamWriter 写出前逐段压缩
+    void setStreamCompressor(StreamCompressorPtr compressor)
+    {
+        streamCompressor_ = std::move(compressor);
+    }
+
+    const StreamCompressorPtr& getStreamCompressor() const
+    {
+        return streamCompressor_;
+    }
+
+    // 使用 chunked 传输编码，响应体长度未知时使用
+    void setChunked(bool on)
+    {
+        isChunked_ = on;
+        if (on)
+        {
+            headers_.erase("Content-Length");
+            addHeader("Transfer-Encoding", "chunked");
+        }
+        else
+        {
+            headers_.erase("Transfer-Encoding");
+        }
+    }
+
+    bool isChunked() const
+    {
+        return isChunked_;
+    }
+
     void setStatusLine(const std::string& version,
                          HttpStatusCode statusCode,
                          const std::string& statusMessage);
 
     void setErrorHeader(){}
 
-    void appendToBuffer(muduo::net::Buffer* outputBuf) const;
+    // includeBody 为 false 时只输出状态行和头部，响应体由调用方另行发送
+    void appendToBuffer(muduo::net::Buffer* outputBuf, bool includeBody = true) const;
 private:
     std::string                        httpVersion_; 
     HttpStatusCode                     statusCode_;
     std::string                        statusMessage_;
     bool                               closeConnection_;
     std::map<std::string, std::string> headers_;
+    std::shared_ptr<const std::string> rawHeaders_[kMaxRawHeaderBlocks];
+    size_t                             rawHeaderCount_ = 0;
     std::string                        body_;
     bool                               isFile_;
+    std::shared_ptr<const void>        sharedBodyOwner_;
+    const char*                        sharedBodyData_ = nullptr;
+    size_t                             sharedBodySize_ = 0;
     
     // 流式响应相关字段
     bool                               isStreaming_;
     StreamWriteCallback                streamWriteCallback_;
+    StreamStartCallback                streamStartCallback_;
+    DeferredCallback                   deferredCallback_;
+    StreamCompressorPtr                streamCompressor_;
+    bool                               isChunked_;
 };
 
 } // namespace http
\ No newline at end of file
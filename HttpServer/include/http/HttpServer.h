@@ -13,15 +13,26 @@
 #include <muduo/net/EventLoop.h>
 #include <muduo/base/Logging.h>
 
+#include "ConnectionManager.h"
+#include "DeferredResponse.h"
 #include "HttpContext.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
+#include "StreamWriter.h"
 #include "router/Router.h"
 #include "middleware/MiddlewareChain.h"
+#include "middleware/admission/AdmissionMiddleware.h"
 #include "middleware/cors/CorsMiddleware.h"
+#include "middleware/ratelimit/RateLimitMiddleware.h"
+#include "middleware/compression/CompressionMiddleware.h"
+#include "middleware/security/SecurityHeadersMiddleware.h"
 #include "session/SessionManager.h"
+#include "session/ShardedSessionStorage.h"
 #include "ssl/SslConnection.h"
 #include "ssl/SslContext.h"
+#include "trace/Tracer.h"
+#include "websocket/WebSocketConnection.h"
+#include "websocket/WebSocketHandler.h"
 
 namespace http
 {
@@ -29,7 +40,10 @@ namespace http
 class HttpServer : muduo::noncopyable
 {
 public:
+    static constexpr size_t kBodyChunkSize = 256 * 1024; // 大响应体单次发送的块大小
+
     using HttpCallback = std::function<void (const http::HttpRequest&, http::HttpResponse*)>;
+    using MiddlewareList = std::initializer_list<std::shared_ptr<middleware::Middleware>>;
     
     // 构造函数
     HttpServer(int port,
@@ -60,10 +74,10 @@ public:
         router_.registerCallback(HttpRequest::kGet, path, cb);
     }
     
-    // 注册静态路由处理器
-    void Get(const std::string& path, router::Router::HandlerPtr handler)
+    // 注册静态路由处理器，middlewares 只作用于该路由
+    void Get(const std::string& path, router::Router::HandlerPtr handler, MiddlewareList middlewares = {})
     {
-        router_.registerHandler(HttpRequest::kGet, path, handler);
+        router_.registerHandler(HttpRequest::kGet, path, handler, makeChain(middlewares));
     }
 
     void Post(const std::string& path, const HttpCallback& cb)
@@ -71,15 +85,16 @@ public:
         router_.registerCallback(HttpRequest::kPost, path, cb);
     }
 
-    void Post(const std::string& path, router::Router::HandlerPtr handler)
+    void Post(const std::string& path, router::Router::HandlerPtr handler, MiddlewareList middlewares = {})
     {
-        router_.registerHandler(HttpRequest::kPost, path, handler);
+        router_.registerHandler(HttpRequest::kPost, path, handler, makeChain(middlewares));
     }
 
     // 注册动态路由处理器
-    void addRoute(HttpRequest::Method method, const std::string& path, router::Router::HandlerPtr handler)
+    void addRoute(HttpRequest::Method method, const std::string& path, router::Router::HandlerPtr handler,
+                  MiddlewareList middlewares = {})
     {
-        router_.addRegexHandler(method, path, handler);
+        router_.addRegexHandler(method, path, handler, makeChain(middlewares));
     }
 
     // 注册动态路由处理函数
@@ -88,6 +103,20 @@ public:
         router_.addRegexCallback(method, path, callback);
     }
 
+    // 设置路由的请求体处理方式（大小上限、超过阈值落盘、流式交付），path 与注册路由时一致。
+    // 流式路由在请求头读完、经过中间件后即调用处理器，处理器通过 req.bodyReader() 接收请求体，
+    // 通常用 resp->defer() 在请求体读完后再回复
+    void setBodyOptions(HttpRequest::Method method, const std::string& path, const BodyOptions& options)
+    {
+        router_.setBodyOptions(method, path, options);
+    }
+
+    // 注册 WebSocket 处理器，GET 请求携带 Upgrade: websocket 时升级
+    void WebSocket(const std::string& path, websocket::WebSocketHandlerPtr handler)
+    {
+        router_.registerWebSocket(path, handler);
+    }
+
     // 设置会话管理器
     void setSessionManager(std::unique_ptr<session::SessionManager> manager)
     {
@@ -100,7 +129,7 @@ public:
         return sessionManager_.get();
     }
 
-    // 添加中间件的方法
+    // 添加全局中间件，按添加顺序执行 before，相反顺序执行 after
     void addMiddleware(std::shared_ptr<middleware::Middleware> middleware) 
     {
         middlewareChain_.addMiddleware(middleware);
@@ -113,6 +142,23 @@ public:
 
     void setSslConfig(const ssl::SslConfig& config);
 
+    // 连接超时、连接数和请求大小限制，需在 start 之前设置
+    void setConnectionOptions(const ConnectionOptions& options)
+    {
+        connectionManager_.setOptions(options);
+    }
+
+    // 注册 Prometheus 抓取端点，导出进程内 MetricsRegistry 的全部指标
+    void enableMetrics(const std::string& path = "/metrics");
+
+    // 开启请求追踪：按 sampleRate 采样，每隔 flushInterval 秒把环形缓冲中的 span
+    // 以 Chrome trace 格式写入 path（有新 span 时才写）
+    void enableTracing(double sampleRate, const std::string& path, double flushInterval = 10.0);
+
+    // TLS 握手与会话恢复统计，未启用 SSL 时全部为 0
+    ssl::SslStats getSslStats() const
+    { return sslCtx_ ? sslCtx_->getStats() : ssl::SslStats(); }
+
 private:
     void initialize();
 
@@ -120,25 +166,44 @@ private:
     void onMessage(const muduo::net::TcpConnectionPtr& conn,
                    muduo::net::Buffer* buf,
                    muduo::Timestamp receiveTime);
-    void onRequest(const muduo::net::TcpConnectionPtr&, const HttpRequest&);
+    void onRequest(const muduo::net::TcpConnectionPtr&, HttpRequest&);
+    // 请求头读完后按路由设置开始读取请求体：检查大小上限、回复 100 Continue，流式路由在此分发请求
+    bool startBody(const muduo::net::TcpConnectionPtr& conn, HttpContext* context, muduo::net::Buffer* buf,
+                   muduo::Timestamp receiveTime);
+    // 请求非法或超出大小限制：回复错误状态并关闭连接
+    void rejectRequest(const muduo::net::TcpConnectionPtr& conn, HttpResponse::HttpStatusCode code);
+    // 同上，但请求已经分发（流式请求体）时处理器可能已经回复，只能直接断开
+    void rejectRequest(const muduo::net::TcpConnectionPtr& conn, HttpContext* context);
     
+    // 按块发送大的共享响应体，每块写完后再发送下一块
+    void sendBodyInChunks(const muduo::net::TcpConnectionPtr& conn, const HttpResponse& response);
+
     // 流式响应处理
     void onStreamWrite(const muduo::net::TcpConnectionPtr& conn, HttpResponse* resp);
 
-    void handleRequest(const HttpRequest& req, HttpResponse* resp);
+    void handleRequest(HttpRequest& req, HttpResponse* resp);
+
+    static middleware::MiddlewareChainPtr makeChain(MiddlewareList middlewares)
+    {
+        return middlewares.size() == 0 ? nullptr : std::make_shared<middleware::MiddlewareChain>(middlewares);
+    }
+
+    // WebSocket 升级握手
+    void handleWebSocketUpgrade(const muduo::net::TcpConnectionPtr& conn,
+                                const HttpRequest& req,
+                                const websocket::WebSocketHandlerPtr& handler);
     
 private:
     muduo::net::InetAddress                      listenAddr_; // 监听地址
     muduo::net::TcpServer                        server_; 
     muduo::net::EventLoop                        mainLoop_; // 主循环
-    HttpCallback                                 httpCallback_; // 回调函数
+    HttpCallback                                 httpCallback_; // 自定义回调，为空时使用中间件 + 路由
     router::Router                               router_; // 路由
     std::unique_ptr<session::SessionManager>     sessionManager_; // 会话管理器
     middleware::MiddlewareChain                  middlewareChain_; // 中间件链
     std::unique_ptr<ssl::SslContext>             sslCtx_; // SSL 上下文
     bool                                         useSSL_; // 是否使用 SSL   
-    // TcpConnectionPtr -> SslConnectionPtr 
-    std::map<muduo::net::TcpConnectionPtr, std::unique_ptr<ssl::SslConnection>> sslConns_;
+    ConnectionManager                            connectionManager_; // 连接超时与连接数限制
     
     // 存储正在进行流式响应的连接和响应对象
     std::map<muduo::net::TcpConnectionPtr, std::unique_ptr<HttpResponse>> streamingResponses_;
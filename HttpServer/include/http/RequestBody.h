@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <muduo/base/noncopyable.h>
+
+namespace http
+{
+
+// 单个路由的请求体处理方式，未设置的路由沿用 ConnectionOptions::maxBodyBytes 并整体缓存在内存中
+struct BodyOptions
+{
+    size_t      maxBytes = 0;         // 请求体上限，0 表示使用全局上限；Content-Length 超出时读请求体之前即拒绝
+    size_t      spillThreshold = 0;   // 超过该长度的请求体写入临时文件，0 表示不落盘
+    std::string spillDir = "/tmp";    // 临时文件所在目录
+    bool        streaming = false;    // 请求头读完即分发，请求体经 BodyReader 分块交付给处理器
+};
+
+// 落盘的请求体：写入发生在 IO 线程，依赖页缓存，不适合慢速磁盘；最后一个引用释放时删除文件
+class SpilledBody : muduo::noncopyable
+{
+public:
+    // 在 dir 下创建临时文件，失败时返回空
+    static std::shared_ptr<SpilledBody> create(const std::string& dir);
+    ~SpilledBody();
+
+    bool write(const char* data, size_t len);
+
+    const std::string& path() const
+    { return path_; }
+
+    uint64_t size() const
+    { return size_; }
+
+    // 读出全部内容，用于体积不大但超过落盘阈值的请求
+    std::string readAll() const;
+
+private:
+    SpilledBody(int fd, std::string path)
+        : fd_(fd)
+        , path_(std::move(path))
+        , size_(0)
+    {}
+
+    int         fd_;
+    std::string path_;
+    uint64_t    size_;
+};
+
+// 流式请求体：数据块按到达顺序在连接的 IO 线程中交付，交付后即从输入缓冲中移除。
+// 回调应在处理器的 handle() 中设置，之前到达的数据不会丢失（分发先于读取请求体）；
+// 结束时 onEnd(true)，连接断开或请求体格式错误时 onEnd(false)，之后回调被释放
+class BodyReader : muduo::noncopyable
+{
+public:
+    using DataCallback = std::function<void (const char* data, size_t len)>;
+    using EndCallback = std::function<void (bool complete)>;
+
+    BodyReader()
+        : received_(0)
+        , finished_(false)
+    {}
+
+    void onData(DataCallback cb)
+    { dataCallback_ = std::move(cb); }
+
+    void onEnd(EndCallback cb)
+    { endCallback_ = std::move(cb); }
+
+    uint64_t received() const
+    { return received_; }
+
+    bool finished() const
+    { return finished_; }
+
+    // 以下由 HttpContext 调用
+    void append(const char* data, size_t len);
+    void finish(bool complete);
+
+private:
+    DataCallback dataCallback_;
+    EndCallback  endCallback_;
+    uint64_t     received_;
+    bool         finished_;
+};
+
+using BodyReaderPtr = std::shared_ptr<BodyReader>;
+
+} // namespace http
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include <muduo/net/TcpConnection.h>
+
+#include "utils/StreamCompressor.h"
+
+namespace http
+{
+
+// 流式响应写入器：响应头发出后，由业务线程直接向连接推送数据
+// 所有写操作都会投递到连接所属的 IO 线程执行，可在任意线程调用
+class StreamWriter : public std::enable_shared_from_this<StreamWriter>
+{
+public:
+    // chunked: 是否使用 Transfer-Encoding: chunked 分帧（需在响应头中声明）
+    // closeOnEnd: 结束后是否关闭连接
+    StreamWriter(const muduo::net::TcpConnectionPtr& conn, bool chunked, bool closeOnEnd);
+
+    // 设置后写出的数据先经过压缩（Content-Encoding 需已在响应头中声明）
+    void setCompressor(StreamCompressorPtr compressor)
+    { compressor_ = std::move(compressor); }
+
+    // 写入原始数据；flush 为 false 时压缩器可暂存数据，与后续写入合并输出
+    void write(const std::string& data, bool flush = true);
+
+    // 写入一个 SSE 事件
+    void sendEvent(const std::string& event, const std::string& data);
+
+    // 结束流式响应，之后的写入会被忽略
+    void end();
+
+    // 客户端是否仍然在线
+    bool connected() const;
+
+    bool finished() const
+    { return finished_.load(std::memory_order_acquire); }
+
+    // 构造 SSE 事件报文
+    static std::string formatEvent(const std::string& event, const std::string& data);
+
+private:
+    void writeInLoop(const std::string& data, bool flush, bool last);
+
+    std::weak_ptr<muduo::net::TcpConnection> conn_;
+    bool                                     chunked_;
+    bool                                     closeOnEnd_;
+    std::atomic<bool>                        finished_;
+    StreamCompressorPtr                      compressor_; // 只在 IO 线程中使用
+};
+
+using StreamWriterPtr = std::shared_ptr<StreamWriter>;
+
+} // namespace http
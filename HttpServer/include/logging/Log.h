@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include <muduo/base/Logging.h>
+#include <muduo/base/noncopyable.h>
+
+namespace http
+{
+namespace logging
+{
+
+// 按模块设置日志级别：未单独配置的模块跟随全局级别（muduo::Logger::logLevel）
+class LogModule : muduo::noncopyable
+{
+public:
+    // 返回的引用在进程生命周期内有效，调用点通过 LOG_MODULE 宏缓存
+    static LogModule& get(const char* name);
+    static void setLevel(const std::string& name, muduo::Logger::LogLevel level);
+
+    const char* name() const
+    { return name_.c_str(); }
+
+    bool enabled(muduo::Logger::LogLevel level) const
+    {
+        int own = level_.load(std::memory_order_relaxed);
+        return level >= (own < 0 ? muduo::Logger::logLevel() : own);
+    }
+
+private:
+    explicit LogModule(const std::string& name)
+        : name_(name)
+        , level_(-1)
+    {}
+
+    std::string      name_;
+    std::atomic<int> level_; // -1 表示跟随全局级别
+};
+
+// 单个日志点的令牌桶限流（GCRA 形式，只用一个原子变量）：
+// 平均每秒最多 perSecond 条，允许 burst 条突发（默认等于 perSecond），被丢弃的条数附在下一条输出中
+class LogRateLimiter : muduo::noncopyable
+{
+public:
+    static const uint64_t kDenied = ~uint64_t(0);
+
+    explicit LogRateLimiter(double perSecond, int burst = 0);
+
+    // 被限流时返回 kDenied，否则返回此前被丢弃的条数
+    uint64_t acquire();
+
+private:
+    int64_t               intervalNs_;
+    int64_t               toleranceNs_;
+    std::atomic<int64_t>  tat_; // 理论上下一条的到达时间
+    std::atomic<uint64_t> dropped_;
+};
+
+// 带限流的日志点
+struct RateLimitedSite : muduo::noncopyable
+{
+    RateLimitedSite(const char* name, double perSecond)
+        : module(LogModule::get(name))
+        , limiter(perSecond)
+    {}
+
+    LogModule&     module;
+    LogRateLimiter limiter;
+};
+
+// 结构化字段：LOG_INFO << "msg" << kv("key", value) 输出 " key=value"，
+// 字符串值含空白、引号或为空时加引号转义，便于按字段检索
+template <typename T>
+struct Field
+{
+    const char* key;
+    const T&    value;
+};
+
+template <typename T>
+Field<T> kv(const char* key, const T& value)
+{ return Field<T>{key, value}; }
+
+void appendQuoted(muduo::LogStream& stream, const char* data, size_t len);
+
+inline void appendValue(muduo::LogStream& stream, const std::string& value)
+{ appendQuoted(stream, value.data(), value.size()); }
+
+inline void appendValue(muduo::LogStream& stream, const char* value)
+{ appendQuoted(stream, value, value ? strlen(value) : 0); }
+
+template <size_t N>
+void appendValue(muduo::LogStream& stream, const char (&value)[N])
+{ appendQuoted(stream, value, strlen(value)); }
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type
+appendValue(muduo::LogStream& stream, const T& value)
+{ stream << value; }
+
+template <typename T>
+muduo::LogStream& operator<<(muduo::LogStream& stream, const Field<T>& field)
+{
+    stream << ' ' << field.key << '=';
+    appendValue(stream, field.value);
+    return stream;
+}
+
+// 把 muduo Logger 的输出切换到后台线程：前台只拷贝到双缓冲，
+// 后台线程按 flushInterval 秒或缓冲写满时批量写入滚动文件（单个文件超过 rollSize 字节时滚动）
+void startAsyncLogging(const std::string& basename, long rollSize, int flushInterval = 3);
+void stopAsyncLogging();
+
+// 日志点前缀 module=<name>
+inline muduo::LogStream& moduleStream(muduo::LogStream& stream, const LogModule& module, uint64_t suppressed)
+{
+    stream << "module=" << module.name() << ' ';
+    if (suppressed > 0)
+        stream << "suppressed=" << suppressed << ' ';
+    return stream;
+}
+
+} // namespace logging
+} // namespace http
+
+// 按模块级别输出：LOG_MODULE("ai", DEBUG) << "..." << kv("bytes", n);
+#define LOG_MODULE(moduleName, level)                                                           \
+    if (static http::logging::LogModule& logModule_ = http::logging::LogModule::get(moduleName); \
+        !logModule_.enabled(muduo::Logger::level)) {}                                           \
+    else http::logging::moduleStream(                                                           \
+        muduo::Logger(__FILE__, __LINE__, muduo::Logger::level, __func__).stream(), logModule_, 0)
+
+// 同上，并限制该日志点每秒最多输出 perSecond 条
+#define LOG_MODULE_RATE(moduleName, level, perSecond)                                           \
+    if (static http::logging::RateLimitedSite logSite_(moduleName, perSecond);                  \
+        !logSite_.module.enabled(muduo::Logger::level)) {}                                      \
+    else if (uint64_t logSuppressed_ = logSite_.limiter.acquire();                              \
+             logSuppressed_ == http::logging::LogRateLimiter::kDenied) {}                       \
+    else http::logging::moduleStream(                                                           \
+        muduo::Logger(__FILE__, __LINE__, muduo::Logger::level, __func__).stream(), logSite_.module, logSuppressed_)
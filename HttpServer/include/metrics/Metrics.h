@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <muduo/base/noncopyable.h>
+
+namespace http
+{
+namespace metrics
+{
+
+// 热路径上的写操作按线程分片：每个线程固定写自己的分片（独占缓存行），
+// 只做 relaxed 原子加，不加锁；读取（抓取 /metrics）时汇总所有分片
+const size_t kShardCount = 16;
+
+// 当前线程使用的分片下标，线程首次使用时轮流分配
+size_t currentShard();
+
+class Counter : muduo::noncopyable
+{
+public:
+    void inc(uint64_t n = 1)
+    { shards_[currentShard()].value.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, kShardCount> shards_;
+};
+
+// 瞬时值，如当前连接数、正在使用的数据库连接数
+class Gauge : muduo::noncopyable
+{
+public:
+    void set(int64_t v)
+    { value_.store(v, std::memory_order_relaxed); }
+
+    void add(int64_t n = 1)
+    { value_.fetch_add(n, std::memory_order_relaxed); }
+
+    void sub(int64_t n = 1)
+    { value_.fetch_sub(n, std::memory_order_relaxed); }
+
+    int64_t value() const
+    { return value_.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<int64_t> value_{0};
+};
+
+struct HistogramOptions
+{
+    double scale = 1e-6; // 记录值到导出单位的换算，默认记录微秒、导出秒
+    int    minExp = 7;   // 导出的最小桶边界 2^minExp（更小的值计入第一个桶）
+    int    maxExp = 27;  // 最大桶边界 2^maxExp，超出的只计入 +Inf
+
+    // 延迟：128us ~ 134s
+    static HistogramOptions latency()
+    { return HistogramOptions(); }
+
+    // 无量纲的数值（如 token 数、每秒 token 数）：1 ~ 65536
+    static HistogramOptions count()
+    {
+        HistogramOptions options;
+        options.scale = 1;
+        options.minExp = 0;
+        options.maxExp = 16;
+        return options;
+    }
+};
+
+// 对数线性直方图：每个 2 的幂区间再均分为 4 个子桶，相对误差不超过 25%，
+// 桶下标由位运算得出，记录时不需要查找边界
+class Histogram : muduo::noncopyable
+{
+public:
+    static const int kSubBuckets = 4;
+
+    explicit Histogram(const HistogramOptions& options = HistogramOptions());
+
+    void observe(uint64_t value);
+
+    // 导出用的快照，buckets[i] 为落入第 i 个桶（非累计）的次数
+    struct Snapshot
+    {
+        std::vector<uint64_t> buckets;
+        uint64_t              count = 0;
+        uint64_t              sum = 0;
+    };
+    Snapshot snapshot() const;
+
+    const HistogramOptions& options() const
+    { return options_; }
+
+    size_t bucketCount() const
+    { return bucketCount_; }
+
+    static size_t bucketIndex(uint64_t value);
+    // 第 i 个桶包含的最大整数值
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    struct alignas(64) Shard
+    {
+        std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+        std::atomic<uint64_t>                    count{0};
+        std::atomic<uint64_t>                    sum{0};
+    };
+
+    HistogramOptions                 options_;
+    size_t                           bucketCount_;
+    std::array<Shard, kShardCount>   shards_;
+};
+
+// 作用域计时：析构时把经过的微秒数记入直方图
+class ScopedTimer : muduo::noncopyable
+{
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram)
+        , start_(std::chrono::steady_clock::now())
+    {}
+
+    ~ScopedTimer()
+    { histogram_.observe(elapsedMicros()); }
+
+    uint64_t elapsedMicros() const
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_).count());
+    }
+
+private:
+    Histogram&                            histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace metrics
+} // namespace http
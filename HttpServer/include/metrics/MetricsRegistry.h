@@ -0,0 +1,78 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <muduo/base/noncopyable.h>
+
+#include "Metrics.h"
+
+namespace http
+{
+namespace metrics
+{
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+// 指标注册表：同名同标签的指标只创建一次，返回的引用在进程生命周期内有效
+// 注册和导出加锁，调用方应在初始化时取得指标引用并缓存，热路径只操作指标本身
+class MetricsRegistry : muduo::noncopyable
+{
+public:
+    static MetricsRegistry& instance();
+
+    Counter& counter(const std::string& name, const std::string& help, const Labels& labels = Labels());
+    Gauge& gauge(const std::string& name, const std::string& help, const Labels& labels = Labels());
+    Histogram& histogram(const std::string& name, const std::string& help, const Labels& labels = Labels(),
+                         const HistogramOptions& options = HistogramOptions::latency());
+
+    // 抓取时才计算的瞬时值，如连接池空闲连接数
+    void gaugeCallback(const std::string& name, const std::string& help, const Labels& labels,
+                       std::function<double()> callback);
+
+    // 抓取时才读取的累计值，用于已在别处计数的单调量，如 TLS 会话恢复次数
+    void counterCallback(const std::string& name, const std::string& help, const Labels& labels,
+                         std::function<double()> callback);
+
+    // Prometheus 文本格式（version 0.0.4）
+    std::string render() const;
+
+    static const char* contentType()
+    { return "text/plain; version=0.0.4; charset=utf-8"; }
+
+private:
+    MetricsRegistry() = default;
+
+    enum class Type { kCounter, kGauge, kHistogram };
+
+    struct Series
+    {
+        std::string                labels; // 已格式化的 {k="v",...}，无标签时为空
+        std::unique_ptr<Counter>   counter;
+        std::unique_ptr<Gauge>     gauge;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()>    callback;
+    };
+
+    struct Family
+    {
+        std::string         help;
+        Type                type;
+        std::vector<Series> series;
+    };
+
+    Series& findOrCreate(const std::string& name, const std::string& help, Type type, const Labels& labels);
+
+    static std::string formatLabels(const Labels& labels);
+
+    mutable std::mutex             mutex_;
+    std::map<std::string, Family>  families_;
+};
+
+} // namespace metrics
+} // namespace http
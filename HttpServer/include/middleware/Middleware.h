@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "http/HttpRequest.h"
 #include "http/HttpResponse.h"
 
@@ -11,23 +13,23 @@ namespace middleware
 class Middleware 
 {
 public:
+    // before 的处理结果
+    enum Action
+    {
+        kContinue, // 继续执行后续中间件和路由
+        kRespond,  // 已在 response 中生成响应，跳过后续中间件和路由
+    };
+
     virtual ~Middleware() = default;
     
-    // 请求前处理
-    virtual void before(HttpRequest& request) = 0;
-    
-    // 响应后处理
-    virtual void after(HttpResponse& response) = 0;
+    // 请求前处理，返回 kRespond 表示直接结束请求（如 CORS 预检、鉴权失败）
+    virtual Action before(HttpRequest& request, HttpResponse* response) = 0;
     
-    // 设置下一个中间件
-    void setNext(std::shared_ptr<Middleware> next) 
-    {
-        nextMiddleware_ = next;
-    }
-
-protected:
-    std::shared_ptr<Middleware> nextMiddleware_;
+    // 响应后处理，只有 before 执行过的中间件才会被调用，顺序与 before 相反
+    virtual void after(const HttpRequest& request, HttpResponse& response) = 0;
 };
 
+using MiddlewarePtr = std::shared_ptr<Middleware>;
+
 } // namespace middleware
-} // namespace http
\ No newline at end of file
+} // namespace http
@@ -13,13 +13,36 @@ namespace middleware
 class MiddlewareChain 
 {
 public:
-    void addMiddleware(std::shared_ptr<Middleware> middleware);
-    void processBefore(HttpRequest& request);
-    void processAfter(HttpResponse& response);
+    MiddlewareChain() = default;
+    MiddlewareChain(std::initializer_list<MiddlewarePtr> middlewares)
+        : middlewares_(middlewares)
+    {}
+
+    void addMiddleware(MiddlewarePtr middleware);
+
+    bool empty() const
+    { return middlewares_.empty(); }
+
+    // 洋葱模型：依次执行 before，全部放行后调用 handler，再按相反顺序执行已进入中间件的 after
+    // handler 以模板参数传入，避免每个请求构造 std::function
+    template <typename Handler>
+    void run(HttpRequest& request, HttpResponse* response, Handler&& handler)
+    {
+        size_t entered = 0;
+        if (processBefore(request, response, &entered))
+            handler();
+        processAfter(request, *response, entered);
+    }
+
+    // 全部放行时返回 true；entered 为执行过 before 的中间件数量（包括短路的那个）
+    bool processBefore(HttpRequest& request, HttpResponse* response, size_t* entered);
+    void processAfter(const HttpRequest& request, HttpResponse& response, size_t entered);
 
 private:
-    std::vector<std::shared_ptr<Middleware>> middlewares_;
+    std::vector<MiddlewarePtr> middlewares_;
 };
 
+using MiddlewareChainPtr = std::shared_ptr<MiddlewareChain>;
+
 } // namespace middleware
-} // namespace http
\ No newline at end of file
+} // namespace http
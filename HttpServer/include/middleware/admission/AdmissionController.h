@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/EventLoop.h>
+
+namespace http
+{
+
+namespace metrics
+{
+class Gauge;
+} // namespace metrics
+
+namespace middleware
+{
+
+struct AdmissionOptions
+{
+    double interval = 0.1;       // 采样间隔（秒）
+    double maxLoopLagMs = 200;   // 主循环定时器延迟阈值，0 表示不检查
+    double recoverRatio = 0.8;   // 所有信号都回落到阈值的该比例以下才解除过载，避免来回抖动
+    int    retryAfter = 1;       // 拒绝时 Retry-After 的秒数
+};
+
+// 准入控制：在主循环上周期采样各过载信号（工作队列深度与排队时间、主循环延迟、数据库连接池等待数），
+// 任一信号超过阈值即进入过载状态，由 AdmissionMiddleware 在路由前拒绝开销大的请求；
+// 已在处理中的请求和流不受影响
+class AdmissionController : muduo::noncopyable
+{
+public:
+    explicit AdmissionController(const AdmissionOptions& options = AdmissionOptions());
+
+    // probe 在主循环中调用，需线程安全且足够廉价；threshold <= 0 时只导出不参与判断。需在 start 前添加
+    void addSignal(const std::string& name, std::function<double()> probe, double threshold);
+
+    void start(muduo::net::EventLoop* loop);
+
+    bool overloaded() const
+    { return overloaded_.load(std::memory_order_relaxed); }
+
+    int retryAfter() const
+    { return options_.retryAfter; }
+
+private:
+    struct Signal
+    {
+        std::string             name;
+        std::function<double()> probe;
+        double                  threshold;
+        metrics::Gauge*         gauge;
+    };
+
+    void sample();
+    void update(double value, const Signal& signal, bool* over, bool* recovered) const;
+
+    AdmissionOptions    options_;
+    std::vector<Signal> signals_;
+    Signal              loopLag_;
+    muduo::Timestamp    lastSample_;
+    std::atomic<bool>   overloaded_;
+    metrics::Gauge*     overloadedGauge_;
+};
+
+using AdmissionControllerPtr = std::shared_ptr<AdmissionController>;
+
+} // namespace middleware
+} // namespace http
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+#include "../Middleware.h"
+#include "AdmissionController.h"
+
+namespace http
+{
+
+namespace metrics
+{
+class Counter;
+} // namespace metrics
+
+namespace middleware
+{
+
+// 挂在开销大的路由上，过载时直接返回 503 和 Retry-After，按路由统计拒绝数
+class AdmissionMiddleware : public Middleware
+{
+public:
+    AdmissionMiddleware(AdmissionControllerPtr controller, const std::string& route);
+
+    Action before(HttpRequest& request, HttpResponse* response) override;
+    void after(const HttpRequest& request, HttpResponse& response) override;
+
+private:
+    AdmissionControllerPtr controller_;
+    metrics::Counter*      shed_;
+};
+
+} // namespace middleware
+} // namespace http
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "utils/StreamCompressor.h"
+
+namespace http
+{
+namespace middleware
+{
+
+struct CompressionConfig
+{
+    // 服务端偏好顺序，客户端给出相同 q 值时按此顺序选择；不支持的编码会被忽略
+    std::vector<ContentEncoding> encodings;
+    // 可压缩的 Content-Type，以 "/" 结尾的按前缀匹配（如 "text/"）
+    std::vector<std::string> contentTypes;
+    size_t minSize = 1024;  // 小于该大小的响应体不压缩
+    int level = -1;         // 压缩级别，-1 表示各编码的默认级别
+    bool streaming = true;  // 是否压缩推送式流响应（SSE 等）
+
+    static CompressionConfig defaultConfig()
+    {
+        CompressionConfig config;
+        config.encodings = {ContentEncoding::kBrotli, ContentEncoding::kZstd,
+                            ContentEncoding::kGzip, ContentEncoding::kDeflate};
+        config.contentTypes = {"text/", "application/json", "application/javascript",
+                               "application/xml", "image/svg+xml"};
+        return config;
+    }
+};
+
+} // namespace middleware
+} // namespace http
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+#include "../Middleware.h"
+#include "CompressionConfig.h"
+
+namespace http
+{
+namespace middleware
+{
+
+// 响应压缩：按 Accept-Encoding 协商编码，普通响应整体压缩，
+// 推送式流响应（SSE）交给 StreamWriter 逐事件压缩并立即 flush
+class CompressionMiddleware : public Middleware
+{
+public:
+    explicit CompressionMiddleware(const CompressionConfig& config = CompressionConfig::defaultConfig());
+
+    Action before(HttpRequest& request, HttpResponse* response) override;
+    void after(const HttpRequest& request, HttpResponse& response) override;
+
+    // 根据 Accept-Encoding 选出编码，没有可用编码时返回 kIdentity
+    ContentEncoding negotiate(const std::string& acceptEncoding) const;
+
+private:
+    bool isCompressibleType(const std::string& contentType) const;
+
+private:
+    CompressionConfig config_;
+};
+
+} // namespace middleware
+} // namespace http
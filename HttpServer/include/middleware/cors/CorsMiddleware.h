@@ -1,5 +1,9 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+
 #include "http/HttpRequest.h"
 #include "http/HttpResponse.h"
 #include "../Middleware.h"
@@ -10,24 +14,34 @@ namespace http
 namespace middleware 
 {
 
+// CORS 头在构造时按允许的源预先格式化，请求处理时只做一次哈希查找并追加原始字节
 class CorsMiddleware : public Middleware 
 {
 public:
     explicit CorsMiddleware(const CorsConfig& config = CorsConfig::defaultConfig());
     
-    void before(HttpRequest& request) override;
-    void after(HttpResponse& response) override;
+    Action before(HttpRequest& request, HttpResponse* response) override;
+    void after(const HttpRequest& request, HttpResponse& response) override;
 
-    std::string join(const std::vector<std::string>& strings, const std::string& delimiter);
+    static std::string join(const std::vector<std::string>& strings, const std::string& delimiter);
 
 private:
-    bool isOriginAllowed(const std::string& origin) const;
-    void handlePreflightRequest(const HttpRequest& request, HttpResponse& response);
-    void addCorsHeaders(HttpResponse& response, const std::string& origin);
+    // 某个源对应的响应头块，wildcard 时所有源共用一份
+    struct HeaderBlocks
+    {
+        std::shared_ptr<const std::string> simple;    // 普通响应
+        std::shared_ptr<const std::string> preflight; // 预检响应（额外包含方法、头部、缓存时间）
+    };
+
+    const HeaderBlocks* findBlocks(const std::string& origin) const;
+    HeaderBlocks buildBlocks(const std::string& origin) const;
 
 private:
-    CorsConfig config_;
+    CorsConfig                                    config_;
+    bool                                          allowAll_;
+    HeaderBlocks                                  wildcardBlocks_;
+    std::unordered_map<std::string, HeaderBlocks> originBlocks_;
 };
 
 } // namespace middleware
-} // namespace http
\ No newline at end of file
+} // namespace http
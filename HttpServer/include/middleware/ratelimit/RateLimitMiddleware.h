@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <muduo/net/EventLoop.h>
+
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+#include "../Middleware.h"
+#include "RateLimiter.h"
+
+namespace http
+{
+
+namespace metrics
+{
+class Counter;
+} // namespace metrics
+
+namespace middleware
+{
+
+// 按用户（取不到时按客户端 IP）限流，不同类别的路由各自一套令牌桶；
+// 超限时返回 429 和 Retry-After、X-RateLimit-Limit、X-RateLimit-Remaining
+class RateLimitMiddleware : public Middleware
+{
+public:
+    // 返回请求所属用户的标识，未登录时返回空串，改按客户端 IP 限流
+    using KeyExtractor = std::function<std::string(const HttpRequest&)>;
+
+    // defaultLimit 用于未归入任何类别的路由，rate <= 0 表示不限
+    explicit RateLimitMiddleware(const RateLimit& defaultLimit, KeyExtractor keyExtractor = nullptr);
+
+    // 为一组路径（精确匹配）单独设置限额，需在服务启动前调用
+    void addClass(const std::string& name, const RateLimit& limit, const std::vector<std::string>& paths);
+
+    // 在 loop 上定时清理已补满的令牌桶
+    void start(muduo::net::EventLoop* loop, double sweepInterval = 30);
+
+    Action before(HttpRequest& request, HttpResponse* response) override;
+    void after(const HttpRequest& request, HttpResponse& response) override;
+
+private:
+    struct LimitClass
+    {
+        LimitClass(const std::string& className, const RateLimit& limit);
+
+        std::string       name;
+        RateLimiter       limiter;
+        metrics::Counter* limited;
+    };
+
+    void sweep();
+
+    KeyExtractor                                 keyExtractor_;
+    std::unique_ptr<LimitClass>                  defaultClass_;
+    std::vector<std::unique_ptr<LimitClass>>     classes_;
+    std::unordered_map<std::string, LimitClass*> routes_;
+};
+
+} // namespace middleware
+} // namespace http
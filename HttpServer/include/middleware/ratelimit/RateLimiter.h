@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <muduo/base/noncopyable.h>
+
+namespace http
+{
+namespace middleware
+{
+
+struct RateLimit
+{
+    double rate = 10;   // 每秒补充的令牌数
+    double burst = 20;  // 桶容量，即允许的突发请求数
+};
+
+// 按 key 划分的令牌桶表：按 key 的哈希分为多个分片，每个分片一把锁；
+// 不用定时器补充令牌，取令牌时按距上次取用的时间差一次性补足
+class RateLimiter : muduo::noncopyable
+{
+public:
+    explicit RateLimiter(const RateLimit& limit);
+
+    // 取一个令牌，成功返回 true；失败时 *retryAfter 为下一个令牌可用前需等待的秒数
+    bool tryAcquire(const std::string& key, int64_t nowMicros, double* retryAfter);
+
+    // 删除已补满的桶（与不存在等价），返回删除的数量；由后台定时调用
+    size_t expireIdle(int64_t nowMicros);
+
+    size_t size() const;
+
+    const RateLimit& limit() const
+    { return limit_; }
+
+private:
+    struct Bucket
+    {
+        double  tokens;
+        int64_t lastMicros;
+    };
+
+    struct alignas(64) Shard
+    {
+        mutable std::mutex                      mutex;
+        std::unordered_map<std::string, Bucket> buckets;
+    };
+
+    static const size_t kShardCount = 64;
+
+    RateLimit limit_;
+    double    ratePerMicro_;
+    Shard     shards_[kShardCount];
+};
+
+} // namespace middleware
+} // namespace http
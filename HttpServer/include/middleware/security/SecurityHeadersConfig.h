@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace http 
+{
+namespace middleware 
+{
+
+// 值为空的头不输出
+struct SecurityHeadersConfig 
+{
+    std::string contentTypeOptions = "nosniff";
+    std::string frameOptions = "SAMEORIGIN";
+    std::string referrerPolicy = "strict-origin-when-cross-origin";
+    std::string strictTransportSecurity; // 仅在 HTTPS 部署时设置，如 "max-age=31536000"
+    std::string contentSecurityPolicy;
+    std::vector<std::pair<std::string, std::string>> extraHeaders;
+
+    static SecurityHeadersConfig defaultConfig() 
+    {
+        return SecurityHeadersConfig();
+    }
+};
+
+} // namespace middleware
+} // namespace http
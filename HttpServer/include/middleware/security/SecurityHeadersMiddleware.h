@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+#include "../Middleware.h"
+#include "SecurityHeadersConfig.h"
+
+namespace http 
+{
+namespace middleware 
+{
+
+// 为所有响应追加固定的安全相关头部，头部块在构造时格式化一次
+class SecurityHeadersMiddleware : public Middleware 
+{
+public:
+    explicit SecurityHeadersMiddleware(const SecurityHeadersConfig& config = SecurityHeadersConfig::defaultConfig());
+
+    Action before(HttpRequest& request, HttpResponse* response) override;
+    void after(const HttpRequest& request, HttpResponse& response) override;
+
+private:
+    std::shared_ptr<const std::string> headers_;
+};
+
+} // namespace middleware
+} // namespace http
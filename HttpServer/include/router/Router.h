@@ -11,6 +11,10 @@
 #include "RouterHandler.h"
 #include "http/HttpRequest.h"
 #include "http/HttpResponse.h"
+#include "http/RequestBody.h"
+#include "metrics/Metrics.h"
+#include "middleware/MiddlewareChain.h"
+#include "websocket/WebSocketHandler.h"
 
 namespace http
 {
@@ -25,6 +29,8 @@ class Router
 public:
     using HandlerPtr = std::shared_ptr<RouterHandler>;
     using HandlerCallback = std::function<void(const HttpRequest &, HttpResponse *)>;
+    using WebSocketHandlerPtr = websocket::WebSocketHandlerPtr;
+    using MiddlewareChainPtr = middleware::MiddlewareChainPtr;
 
     // 路由键（请求方法 + URI）
     struct RouteKey
@@ -54,28 +60,51 @@ public:
         }
     };
 
-    // 注册对象式的路由处理器
-    void registerHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler);
+    // 注册对象式的路由处理器，middlewares 为仅作用于该路由的中间件（在全局中间件之内执行）
+    void registerHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler,
+                         MiddlewareChainPtr middlewares = nullptr);
 
     // 注册回调函数形式的路由处理器
-    void registerCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback);
+    void registerCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback,
+                          MiddlewareChainPtr middlewares = nullptr);
 
     // 注册对象式的动态路由处理器
-    void addRegexHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler)
+    void addRegexHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler,
+                         MiddlewareChainPtr middlewares = nullptr)
     {
-        std::regex pathRegex = convertToRegex(path);
-        regexHandlers_.emplace_back(method, pathRegex, handler);
+        regexRoutes_.emplace_back(method, convertToRegex(path),
+                                  makeTarget(method, path, std::move(handler), nullptr, std::move(middlewares)));
     }
 
     // 注册回调函数形式的动态路由处理器
-    void addRegexCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback)
+    void addRegexCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback,
+                          MiddlewareChainPtr middlewares = nullptr)
     {
-        std::regex pathRegex = convertToRegex(path);
-        regexCallbacks_.emplace_back(method, pathRegex, callback);
+        regexRoutes_.emplace_back(method, convertToRegex(path),
+                                  makeTarget(method, path, nullptr, callback, std::move(middlewares)));
     }
 
-    // 处理请求
-    bool route(const HttpRequest &req, HttpResponse *resp);
+    // 注册 WebSocket 处理器，路径只支持精准匹配
+    void registerWebSocket(const std::string &path, WebSocketHandlerPtr handler)
+    {
+        webSocketHandlers_[path] = std::move(handler);
+    }
+
+    // 查找路径对应的 WebSocket 处理器，不存在时返回空
+    WebSocketHandlerPtr findWebSocket(const std::string &path) const
+    {
+        auto it = webSocketHandlers_.find(path);
+        return it != webSocketHandlers_.end() ? it->second : nullptr;
+    }
+
+    // 设置路由的请求体处理方式，path 与注册路由时一致（动态路由为模式串），需在服务启动前设置
+    void setBodyOptions(HttpRequest::Method method, const std::string &path, const BodyOptions &options);
+
+    // 请求头读完、读取请求体之前查找请求体处理方式，未设置时返回空
+    const BodyOptions *findBodyOptions(const HttpRequest &req) const;
+
+    // 处理请求，动态路由的路径参数直接写入 req
+    bool route(HttpRequest &req, HttpResponse *resp);
 
 private:
     std::regex convertToRegex(const std::string &pathPattern)
@@ -94,28 +123,53 @@ private:
         }
     }
     
-    struct RouteCallbackObj
+    // 路由级指标，注册时创建，请求路径上只做原子加
+    struct RouteMetrics
+    {
+        metrics::Counter*   requests[6]; // 按状态码类别（1xx ~ 5xx），下标 0 为其它
+        metrics::Histogram* duration;
+
+        void record(const HttpResponse &resp, uint64_t micros) const;
+    };
+
+    // 路由目标：处理器与回调二选一，可附带路由级中间件
+    struct RouteTarget
+    {
+        HandlerPtr         handler;
+        HandlerCallback    callback;
+        MiddlewareChainPtr middlewares;
+        RouteMetrics       stats;
+
+        void invoke(HttpRequest &req, HttpResponse *resp) const;
+    };
+
+    // 以注册时的路径（动态路由为模式串）作为 route 标签，避免标签基数随请求路径膨胀
+    static RouteTarget makeTarget(HttpRequest::Method method, const std::string &path, HandlerPtr handler,
+                                  HandlerCallback callback, MiddlewareChainPtr middlewares);
+    static RouteMetrics makeMetrics(const char *method, const std::string &route);
+
+    struct RegexRoute
     {
         HttpRequest::Method method_;
         std::regex pathRegex_;
-        HandlerCallback callback_;
-        RouteCallbackObj(HttpRequest::Method method, std::regex pathRegex, const HandlerCallback &callback)
-            : method_(method), pathRegex_(pathRegex), callback_(callback) {}
+        RouteTarget target_;
+        RegexRoute(HttpRequest::Method method, std::regex pathRegex, RouteTarget target)
+            : method_(method), pathRegex_(std::move(pathRegex)), target_(std::move(target)) {}
     };
 
-    struct RouteHandlerObj
+    struct RegexBodyOptions
     {
         HttpRequest::Method method_;
         std::regex pathRegex_;
-        HandlerPtr handler_;
-        RouteHandlerObj(HttpRequest::Method method, std::regex pathRegex, HandlerPtr handler)
-            : method_(method), pathRegex_(pathRegex), handler_(handler) {}
+        BodyOptions options_;
     };
 
-    std::unordered_map<RouteKey, HandlerPtr, RouteKeyHash>      handlers_;       // 精准匹配
-    std::unordered_map<RouteKey, HandlerCallback, RouteKeyHash> callbacks_;      // 精准匹配
-    std::vector<RouteHandlerObj>                                regexHandlers_;  // 正则匹配
-    std::vector<RouteCallbackObj>                               regexCallbacks_; // 正则匹配
+    std::unordered_map<RouteKey, RouteTarget, RouteKeyHash> routes_;      // 精准匹配
+    std::vector<RegexRoute>                                 regexRoutes_; // 正则匹配，按注册顺序
+    std::unordered_map<std::string, WebSocketHandlerPtr>    webSocketHandlers_; // WebSocket 路由
+    std::unordered_map<RouteKey, BodyOptions, RouteKeyHash> bodyOptions_; // 请求体处理方式，精准匹配
+    std::vector<RegexBodyOptions>                           regexBodyOptions_; // 请求体处理方式，动态路由
+    RouteMetrics                                            unmatchedMetrics_ { makeMetrics("ANY", "unmatched") };
 };
 
 } // namespace router
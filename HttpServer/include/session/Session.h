@@ -1,9 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
-#include <chrono>
 
 namespace http
 {
@@ -24,6 +28,13 @@ public:
     bool isExpired() const;
     void refresh(); // 刷新过期时间
 
+    // 过期时间（system_clock 纪元毫秒），可在任意线程读取
+    int64_t expiryMs() const
+    { return expiryMs_.load(std::memory_order_relaxed); }
+
+    // 当前时间（system_clock 纪元毫秒）
+    static int64_t nowMs();
+
     void setManager(SessionManager* sessionManager) 
     { sessionManager_ = sessionManager; }
 
@@ -32,13 +43,16 @@ public:
 
     // 数据存取
     void setValue(const std::string&key, const std::string&value);
+    // 批量写入，只触发一次保存
+    void setValues(std::initializer_list<std::pair<const std::string, std::string>> values);
     std::string getValue(const std::string&key) const;
     void remove(const std::string&key);
     void clear();
 private:
     std::string                                  sessionId_;
     std::unordered_map<std::string, std::string> data_;
-    std::chrono::system_clock::time_point        expiryTime_;
+    mutable std::mutex                           mutex_; // 保护 data_，会话可能被多个 IO 线程同时访问
+    std::atomic<int64_t>                         expiryMs_;
     int                                          maxAge_; // 过期时间（秒）
     SessionManager*                              sessionManager_;
 };
@@ -19,13 +19,21 @@ public:
 
     // 从请求中获取或创建会话
     std::shared_ptr<Session> getSession(const HttpRequest& req, HttpResponse* resp);
+
+    // 只查找请求携带的未过期会话，不创建也不刷新，找不到时返回 nullptr
+    std::shared_ptr<Session> findSession(const HttpRequest& req);
     
     // 销毁会话
     void destroySession(const std::string& sessionId);
 
-    // 清理过期会话
+    // 清理过期会话，需定期调用（如 EventLoop::runEvery）
     void cleanExpiredSessions();
 
+    SessionStorage* getStorage() const
+    {
+        return storage_.get();
+    }
+
     // 更新会话
     void updateSession(std::shared_ptr<Session> session)
     {
@@ -38,7 +46,6 @@ private:
     void setSessionCookie(const std::string& sessionId, HttpResponse* resp);
 
     std::unique_ptr<SessionStorage> storage_;
-    std::mt19937 rng_; // 用于生成随机会话id
 };
 
 } // namespace session
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 
 #include "Session.h"
 
@@ -16,16 +17,20 @@ public:
     virtual void save(std::shared_ptr<Session> session) = 0;
     virtual std::shared_ptr<Session> load(const std::string& sessionId) = 0;
     virtual void remove(const std::string& sessionId) = 0;
+    // 清理过期会话，由 SessionManager::cleanExpiredSessions 定期调用
+    virtual void cleanExpired() {}
 };
 
-// 基于内存的会话存储实现
+// 基于内存的会话存储实现，单锁保护，清理时全表扫描
 class MemorySessionStorage : public SessionStorage
 {
 public:
     void save(std::shared_ptr<Session> session) override;
     std::shared_ptr<Session> load(const std::string& sessionId) override;
     void remove(const std::string& sessionId) override;
+    void cleanExpired() override;
 private:
+    std::mutex                                                mutex_;
     std::unordered_map<std::string, std::shared_ptr<Session>> sessions_;
 };
 
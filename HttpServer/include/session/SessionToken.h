@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+
+namespace http
+{
+namespace session
+{
+
+// 令牌中携带的会话声明
+struct SessionClaims
+{
+    int64_t     userId    = 0;
+    std::string username;
+    int64_t     issuedAt  = 0; // 签发时间（秒）
+    int64_t     expiresAt = 0; // 过期时间（秒）
+    uint64_t    tokenId   = 0; // 随机 ID，用于吊销
+};
+
+// 无状态会话令牌：base64url(载荷) "." base64url(HMAC-SHA256)
+// 载荷为紧凑的二进制声明，可选 AES-256-GCM 加密；校验只做一次 HMAC 和常量时间比较，不访问存储
+// 吊销集合只在本节点内存中保存，条目在令牌过期后清理
+class SessionTokenCodec
+{
+public:
+    struct Options
+    {
+        std::string secret;                 // 签名密钥，至少 32 字节
+        bool        encrypt    = false;     // 是否加密载荷
+        int         maxAge     = 3600;      // 令牌有效期（秒）
+        std::string cookieName = "token";
+    };
+
+    explicit SessionTokenCodec(const Options& options);
+
+    // 签发令牌
+    std::string issue(int64_t userId, const std::string& username) const;
+
+    // 校验签名、有效期与吊销状态，成功时填充 claims
+    bool verify(const std::string& token, SessionClaims* claims) const;
+
+    // 吊销令牌直到其过期
+    void revoke(const SessionClaims& claims);
+
+    // 清理已过期的吊销条目
+    void cleanRevoked();
+
+    std::string getTokenFromCookie(const HttpRequest& req) const;
+    void setTokenCookie(const std::string& token, HttpResponse* resp) const;
+    void clearTokenCookie(HttpResponse* resp) const;
+
+    int maxAge() const
+    { return options_.maxAge; }
+
+private:
+    std::string sign(const std::string& data) const;
+    bool encryptPayload(const std::string& plain, std::string* out) const;
+    bool decryptPayload(const std::string& in, std::string* plain) const;
+    bool isRevoked(uint64_t tokenId) const;
+
+    Options                                   options_;
+    std::string                               macKey_;
+    std::string                               encKey_;
+    mutable std::shared_mutex                 revokedMutex_;
+    std::unordered_map<uint64_t, int64_t>     revoked_; // tokenId -> 过期时间
+};
+
+} // namespace session
+} // namespace http
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SessionStorage.h"
+#include "TimingWheel.h"
+
+namespace http
+{
+namespace session
+{
+
+// 分片的并发会话存储
+// 每个分片一把锁、一个哈希表和一个分层时间轮，按 tick（秒）惰性过期：
+// 会话被访问时只刷新自身的过期时间，时间轮到期时再按真实过期时间决定删除或重新调度
+class ShardedSessionStorage : public SessionStorage
+{
+public:
+    struct Options
+    {
+        size_t shardCount  = 64;      // 向上取整为 2 的幂
+        size_t maxSessions = 1000000; // 会话总数上限，0 表示不限制
+    };
+
+    ShardedSessionStorage();
+    explicit ShardedSessionStorage(const Options& options);
+
+    void save(std::shared_ptr<Session> session) override;
+    std::shared_ptr<Session> load(const std::string& sessionId) override;
+    void remove(const std::string& sessionId) override;
+    void cleanExpired() override;
+
+    size_t size() const
+    { return size_.load(std::memory_order_relaxed); }
+
+    // 因容量上限被淘汰的会话数
+    size_t evictedCount() const
+    { return evicted_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<Session> session;
+        int64_t                  scheduledTick; // 时间轮中对应条目的到期 tick
+    };
+
+    struct alignas(64) Shard
+    {
+        std::mutex                             mutex;
+        std::unordered_map<std::string, Entry> sessions;
+        TimingWheel                            wheel;
+
+        explicit Shard(int64_t startTick) : wheel(startTick) {}
+    };
+
+    Shard& shardFor(const std::string& sessionId);
+    // 调用者持有分片锁
+    void expireLocked(Shard& shard, int64_t nowTick);
+    void evictLocked(Shard& shard);
+
+    static int64_t toTick(int64_t ms)
+    { return ms / 1000 + 1; }
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t                              shardMask_;
+    size_t                              maxPerShard_;
+    std::atomic<size_t>                 size_;
+    std::atomic<size_t>                 evicted_;
+};
+
+} // namespace session
+} // namespace http
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace http
+{
+namespace session
+{
+
+// 分层时间轮：4 层，每层 64 个槽，第一层一个槽对应一个 tick
+// 插入与每个 tick 的推进均为 O(1)（高层槽在跨越边界时整体下移一层）
+// 不是线程安全的，由调用者加锁
+class TimingWheel
+{
+public:
+    struct Entry
+    {
+        std::string key;
+        int64_t     tick; // 调度时的到期 tick
+    };
+
+    explicit TimingWheel(int64_t startTick = 0);
+
+    // 在 tick 到期时返回 key，已过期的 tick 会在下一次推进时返回
+    void schedule(const std::string& key, int64_t tick);
+
+    // 推进到 nowTick（含），把到期的条目追加到 due
+    void advance(int64_t nowTick, std::vector<Entry>* due);
+
+    // 按到期顺序查找最早的若干条目（不移除），用于容量淘汰
+    void peekEarliest(size_t limit, std::vector<Entry>* out) const;
+
+    size_t size() const
+    { return size_; }
+
+private:
+    static const int     kLevels = 4;
+    static const int     kSlotBits = 6;
+    static const int     kSlots = 1 << kSlotBits;
+    static const int64_t kSlotMask = kSlots - 1;
+    static const int64_t kMaxSpan = (int64_t(1) << (kSlotBits * kLevels)) - 1;
+
+    void place(Entry entry);
+    // 把 level 层当前槽的条目重新放置到下层，返回该层当前的槽下标
+    int cascade(int level);
+
+    std::vector<Entry> slots_[kLevels][kSlots];
+    int64_t            nextTick_; // 下一个待处理的 tick
+    size_t             size_;
+};
+
+} // namespace session
+} // namespace http
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -30,6 +31,12 @@ public:
     // 会话配置
     void setSessionTimeout(int seconds) { sessionTimeout_ = seconds; }
     void setSessionCacheSize(long size) { sessionCacheSize_ = size; }
+    void setSessionCacheShards(int shards) { sessionCacheShards_ = shards; }
+    // 会话票据密钥轮换周期（秒），0 表示不使用无状态票据
+    void setTicketKeyRotation(int seconds) { ticketKeyRotation_ = seconds; }
+    // TLS 1.3 0-RTT，握手完成前只处理幂等的 GET 请求
+    void setEarlyData(bool enable) { earlyData_ = enable; }
+    void setMaxEarlyData(uint32_t bytes) { maxEarlyData_ = bytes; }
 
     // Getters
     const std::string& getCertificateFile() const { return certFile_; }
@@ -41,6 +48,10 @@ public:
     int getVerifyDepth() const { return verifyDepth_; }
     int getSessionTimeout() const { return sessionTimeout_; }
     long getSessionCacheSize() const { return sessionCacheSize_; }
+    int getSessionCacheShards() const { return sessionCacheShards_; }
+    int getTicketKeyRotation() const { return ticketKeyRotation_; }
+    bool getEarlyData() const { return earlyData_; }
+    uint32_t getMaxEarlyData() const { return maxEarlyData_; }
 
 private:
     std::string certFile_; // 证书文件
@@ -52,6 +63,10 @@ private:
     int         verifyDepth_; // 验证深度
     int         sessionTimeout_; // 会话超时时间
     long        sessionCacheSize_; // 会话缓存大小
+    int         sessionCacheShards_; // 会话缓存分片数
+    int         ticketKeyRotation_; // 票据密钥轮换周期
+    bool        earlyData_; // 是否接受 0-RTT 数据
+    uint32_t    maxEarlyData_; // 0-RTT 数据上限
 };
 
 } // namespace ssl
\ No newline at end of file
@@ -9,52 +9,56 @@
 
 #include "SslContext.h"
 
-namespace ssl 
+namespace ssl
 {
 
-// 添加消息回调函数类型定义
-using MessageCallback = std::function<void(const std::shared_ptr<muduo::net::TcpConnection>&,
-                                         muduo::net::Buffer*,
-                                         muduo::Timestamp)>;
-
-class SslConnection : muduo::noncopyable 
+// TLS 连接：读写都在连接所属的 IO 线程中进行
+// 读方向：密文写入内存 BIO 后循环 SSL_read，明文累积在 decryptedBuffer_ 中，
+//        不完整的 HTTP 请求会留到下一次数据到达时继续解析
+// 写方向：一次 SSL_write 产生的全部 TLS 记录合并为一次 send
+class SslConnection : muduo::noncopyable
 {
 public:
     using TcpConnectionPtr = std::shared_ptr<muduo::net::TcpConnection>;
-    using BufferPtr = muduo::net::Buffer*;
-    
+
     SslConnection(const TcpConnectionPtr& conn, SslContext* ctx);
     ~SslConnection();
 
     void startHandshake();
+
+    // 处理收到的密文，返回 false 表示出错且连接已关闭
+    bool onRead(muduo::net::Buffer* buf);
+
     void send(const void* data, size_t len);
-    void onRead(const TcpConnectionPtr& conn, BufferPtr buf, muduo::Timestamp time);
+    void send(muduo::net::Buffer* buf);
+
+    // 发送 close_notify 后关闭写端
+    void shutdown();
+
     bool isHandshakeCompleted() const { return state_ == SSLState::ESTABLISHED; }
+    // 握手尚未完成但已接受 0-RTT 数据，此时的数据可能被重放
+    bool isEarlyDataAccepted() const
+    { return state_ == SSLState::HANDSHAKE && SSL_get_early_data_status(ssl_) == SSL_EARLY_DATA_ACCEPTED; }
     muduo::net::Buffer* getDecryptedBuffer() { return &decryptedBuffer_; }
-    // SSL BIO 操作回调
-    static int bioWrite(BIO* bio, const char* data, int len);
-    static int bioRead(BIO* bio, char* data, int len);
-    static long bioCtrl(BIO* bio, int cmd, long num, void* ptr);
-    // 设置消息回调函数
-    void setMessageCallback(const MessageCallback& cb) { messageCallback_ = cb; }
 
 private:
-    void handleHandshake();
-    void onEncrypted(const char* data, size_t len);
-    void onDecrypted(const char* data, size_t len);
+    bool handleHandshake();
+    bool readEarlyData();
+    bool drainRead();
+    void flushWriteBio();
     SSLError getLastError(int ret);
     void handleError(SSLError error);
 
-    SSL*                ssl_; // SSL 连接
-    SslContext*         ctx_; // SSL 上下文
-    TcpConnectionPtr    conn_; // TCP 连接
-    SSLState            state_; // SSL 状态
-    BIO*                readBio_;   // 网络数据 -> SSL
-    BIO*                writeBio_;  // SSL -> 网络数据
-    muduo::net::Buffer  readBuffer_; // 读缓冲区
-    muduo::net::Buffer  writeBuffer_; // 写缓冲区
-    muduo::net::Buffer  decryptedBuffer_; // 解密后的数据
-    MessageCallback     messageCallback_; // 消息回调
+    SSL*                      ssl_; // SSL 连接
+    SslContext*               ctx_; // SSL 上下文
+    // SslConnection 存放在连接的上下文中，由连接持有，这里不能再持有连接，否则循环引用
+    muduo::net::TcpConnection* conn_; // TCP 连接
+    SSLState                  state_; // SSL 状态
+    BIO*                      readBio_;   // 网络数据 -> SSL
+    BIO*                      writeBio_;  // SSL -> 网络数据
+    bool                      readingEarlyData_; // 是否还在读取 0-RTT 数据
+    muduo::net::Buffer        writeBuffer_; // 待发送的密文
+    muduo::net::Buffer        decryptedBuffer_; // 解密后的数据
 };
 
-} // namespace ssl
\ No newline at end of file
+} // namespace ssl
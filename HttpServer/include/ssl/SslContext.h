@@ -1,16 +1,37 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <shared_mutex>
 
 #include <muduo/base/noncopyable.h>
 #include <openssl/ssl.h>
 
 #include "SslConfig.h"
+#include "SslSessionCache.h"
 
-namespace ssl 
+namespace ssl
 {
 
-class SslContext : muduo::noncopyable 
+// 握手与会话恢复统计
+struct SslStats
+{
+    uint64_t handshakes = 0;          // 完成的握手数
+    uint64_t resumed = 0;             // 其中会话恢复的次数（缓存或票据）
+    uint64_t earlyDataAccepted = 0;   // 接受 0-RTT 的次数
+    uint64_t earlyDataRejected = 0;   // 客户端尝试 0-RTT 但被拒绝的次数
+    uint64_t cacheHits = 0;           // 会话缓存命中
+    uint64_t cacheMisses = 0;         // 会话缓存未命中
+    uint64_t cacheEvictions = 0;      // 会话缓存因容量淘汰的条目数
+    uint64_t cacheSize = 0;           // 会话缓存当前大小
+    uint64_t ticketKeyRotations = 0;  // 票据密钥轮换次数
+
+    double resumptionRate() const
+    { return handshakes == 0 ? 0.0 : static_cast<double>(resumed) / handshakes; }
+};
+
+class SslContext : muduo::noncopyable
 {
 public:
     explicit SslContext(const SslConfig& config);
@@ -19,15 +40,49 @@ public:
     bool initialize();
     SSL_CTX* getNativeHandle() { return ctx_; }
 
+    bool earlyDataEnabled() const { return config_.getEarlyData(); }
+
+    // 握手完成时由 SslConnection 调用
+    void recordHandshake(SSL* ssl);
+    SslStats getStats() const;
+
 private:
+    // 会话票据加密密钥，current 用于签发，previous 仅用于解密轮换前签发的票据
+    struct TicketKey
+    {
+        unsigned char name[16];
+        unsigned char aesKey[32];
+        unsigned char hmacKey[32];
+        int64_t       created;
+    };
+
     bool loadCertificates();
     bool setupProtocol();
     void setupSessionCache();
+    bool setupSessionTickets();
+    bool generateTicketKey(TicketKey* key, int64_t now);
+    void rotateTicketKeysIfNeeded(int64_t now);
+    static int handleTicketKey(SSL* ssl, unsigned char keyName[16], unsigned char* iv,
+                               EVP_CIPHER_CTX* cipherCtx, EVP_MAC_CTX* macCtx, int enc);
+    static int allowEarlyData(SSL* ssl, void* arg);
     static void handleSslError(const char* msg);
 
 private:
     SSL_CTX*  ctx_; // SSL上下文
     SslConfig config_; // SSL配置
+
+    std::unique_ptr<SslSessionCache> sessionCache_; // 分片会话缓存
+
+    mutable std::shared_mutex ticketMutex_;
+    TicketKey                 currentKey_;
+    TicketKey                 previousKey_;
+    bool                      hasPreviousKey_;
+
+    std::atomic<uint64_t> handshakes_;
+    std::atomic<uint64_t> resumed_;
+    std::atomic<uint64_t> earlyDataAccepted_;
+    std::atomic<uint64_t> earlyDataRejected_;
+    std::atomic<uint64_t> ticketKeyRotations_;
 };
 
-} // namespace ssl
\ No newline at end of file
+} // namespace ssl
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <muduo/base/noncopyable.h>
+#include <openssl/ssl.h>
+
+namespace ssl
+{
+
+// 服务端 TLS 会话缓存：替代 OpenSSL 内置的单锁缓存，按会话 ID 分片，
+// 每个分片独立加锁并按 LRU 淘汰，会话以 DER 序列化后保存
+class SslSessionCache : muduo::noncopyable
+{
+public:
+    SslSessionCache(size_t shardCount, size_t capacity, int timeoutSeconds);
+
+    // 挂到 SSL_CTX 上，关闭内置缓存
+    void attach(SSL_CTX* ctx);
+
+    // 0-RTT 防重放：同一张票据只允许携带一次早期数据，返回 false 表示已经用过
+    bool claimEarlyData(SSL_SESSION* session);
+
+    size_t size() const;
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+    uint64_t evictions() const { return evictions_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry
+    {
+        std::string                      der;
+        int64_t                          expiry; // 过期时间（秒）
+        std::list<std::string>::iterator lruPos;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex                     mutex;
+        std::unordered_map<std::string, Entry> sessions;
+        std::list<std::string>                 lru; // 表头最近使用
+        std::unordered_map<std::string, int64_t> earlyDataUsed; // 已用于 0-RTT 的票据 -> 过期时间
+    };
+
+    Shard& shardFor(const std::string& id);
+
+    bool store(SSL_SESSION* session);
+    SSL_SESSION* lookup(const unsigned char* id, int len);
+    void remove(SSL_SESSION* session);
+
+    // OpenSSL 回调
+    static int onNewSession(SSL* ssl, SSL_SESSION* session);
+    static SSL_SESSION* onGetSession(SSL* ssl, const unsigned char* id, int len, int* copy);
+    static void onRemoveSession(SSL_CTX* ctx, SSL_SESSION* session);
+    static int exDataIndex();
+
+    std::vector<Shard>    shards_;
+    size_t                shardCapacity_;
+    int                   timeoutSeconds_;
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> evictions_;
+};
+
+} // namespace ssl
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/Channel.h>
+#include <muduo/net/EventLoop.h>
+
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+#include "utils/MappedFile.h"
+
+namespace http
+{
+namespace staticfile
+{
+
+// 一个已加载的静态文件，加载后只读，可被多个线程同时引用
+struct StaticFile
+{
+    std::string path;          // 相对根目录的路径
+    std::string contentType;
+    std::string etag;          // 原始内容的强 ETag，压缩版本在其后追加编码后缀
+    std::string lastModified;  // HTTP-date
+    uint64_t    size = 0;
+
+    // 小文件常驻内存，并预先生成压缩版本（压缩后不够小则为空）
+    std::shared_ptr<const std::string> identity;
+    std::shared_ptr<const std::string> gzip;
+    std::shared_ptr<const std::string> brotli;
+
+    // 超过内存缓存上限的大文件，以内存映射方式发送
+    std::shared_ptr<const MappedFile> mapped;
+};
+
+using StaticFilePtr = std::shared_ptr<const StaticFile>;
+
+// 静态资源缓存：启动时加载根目录下的网页资源，通过 inotify 监听变化并重新加载
+class StaticFileCache : muduo::noncopyable
+{
+public:
+    struct Options
+    {
+        size_t      maxInMemorySize = 1 << 20; // 超过该大小的文件不常驻内存
+        size_t      minCompressSize = 256;     // 小于该大小的文件不压缩
+        std::string cacheControl = "no-cache"; // 默认每次用 ETag 校验
+    };
+
+    explicit StaticFileCache(const std::string& root);
+    StaticFileCache(const std::string& root, const Options& options);
+    ~StaticFileCache();
+
+    // 扫描根目录加载全部资源，返回加载的文件数
+    size_t loadAll();
+
+    // 在 loop 中监听根目录变化，文件写入完成、替换或删除后更新缓存
+    bool watch(muduo::net::EventLoop* loop);
+
+    StaticFilePtr find(const std::string& path) const;
+
+    // 按请求的 If-None-Match / Accept-Encoding 填充响应；文件不存在时返回 false
+    bool serve(const HttpRequest& req, HttpResponse* resp, const std::string& path) const;
+
+    size_t size() const;
+
+private:
+    StaticFilePtr loadFile(const std::string& path) const;
+    void reload(const std::string& path);
+    void remove(const std::string& path);
+    void scanDirectory(const std::string& relDir, size_t* loaded);
+    void addWatch(const std::string& relDir);
+    void handleInotify(muduo::Timestamp receiveTime);
+
+    std::string                                    root_;
+    Options                                        options_;
+    mutable std::shared_mutex                      mutex_;
+    std::unordered_map<std::string, StaticFilePtr> files_;
+
+    int                                            inotifyFd_;
+    muduo::net::EventLoop*                         loop_;
+    std::unique_ptr<muduo::net::Channel>           channel_;
+    std::unordered_map<int, std::string>           watchDirs_; // watch 描述符 -> 相对目录
+};
+
+} // namespace staticfile
+} // namespace http
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <muduo/base/noncopyable.h>
+
+namespace http
+{
+namespace trace
+{
+
+// 单调时钟纳秒数，跨线程的 span 起止时间都取自同一时钟
+int64_t nowNanos();
+
+// 请求级追踪上下文：每个请求都有 requestId，只有被采样的请求记录 span
+struct TraceContext
+{
+    uint64_t requestId = 0;
+    bool     sampled = false;
+
+    // 16 位十六进制，用于 X-Request-Id 和日志
+    std::string idString() const;
+};
+
+// 进程内追踪器：按请求采样，span 写入定长环形缓冲（满后覆盖最旧的），
+// 按需导出为 Chrome trace 格式（chrome://tracing、Perfetto 可直接打开）
+class Tracer : muduo::noncopyable
+{
+public:
+    static const size_t kDefaultCapacity = 16384;
+
+    static Tracer& instance();
+
+    // 采样比例 0 ~ 1，0 为关闭（默认）；按请求序号确定性采样，每 1/rate 个请求取一个
+    void setSampleRate(double rate);
+    // 环形缓冲容量，会清空已记录的 span
+    void setCapacity(size_t capacity);
+
+    bool enabled() const
+    { return sampleEvery_.load(std::memory_order_relaxed) != 0; }
+
+    // 分配请求 ID 并决定是否采样
+    TraceContext newTrace();
+
+    // name 须为静态字符串
+    void record(const TraceContext& ctx, const char* name, int64_t startNs, int64_t endNs);
+
+    // 写入 Chrome trace JSON，返回写入的 span 数，失败返回 -1
+    int exportChromeTrace(const std::string& path) const;
+
+    // 累计记录过的 span 数（含已被覆盖的）
+    uint64_t recorded() const;
+
+    // 当前线程正在处理的请求上下文，跨线程时由投递任务的一方捕获后用 ScopedTraceContext 恢复
+    static const TraceContext& current();
+    static void setCurrent(const TraceContext& ctx);
+
+private:
+    Tracer();
+
+    struct SpanRecord
+    {
+        uint64_t    requestId;
+        const char* name;
+        int64_t     startNs;
+        int64_t     endNs;
+        int         tid;
+    };
+
+    std::atomic<uint32_t>   sampleEvery_;
+    std::atomic<uint64_t>   nextId_;
+    mutable std::mutex      mutex_; // 只有被采样的请求会进入，竞争很小
+    std::vector<SpanRecord> ring_;
+    uint64_t                total_;
+};
+
+// 在当前线程设置请求上下文，析构时恢复原值
+class ScopedTraceContext : muduo::noncopyable
+{
+public:
+    explicit ScopedTraceContext(const TraceContext& ctx)
+        : saved_(Tracer::current())
+    { Tracer::setCurrent(ctx); }
+
+    ~ScopedTraceContext()
+    { Tracer::setCurrent(saved_); }
+
+private:
+    TraceContext saved_;
+};
+
+// 作用域 span：未采样时只有一次判断，不取时间
+class Span : muduo::noncopyable
+{
+public:
+    explicit Span(const char* name, const TraceContext& ctx = Tracer::current())
+        : ctx_(ctx)
+        , name_(name)
+        , startNs_(ctx.sampled ? nowNanos() : 0)
+    {}
+
+    ~Span()
+    { end(); }
+
+    void end()
+    {
+        if (ctx_.sampled && name_)
+        {
+            Tracer::instance().record(ctx_, name_, startNs_, nowNanos());
+            name_ = nullptr;
+        }
+    }
+
+private:
+    TraceContext ctx_;
+    const char*  name_;
+    int64_t      startNs_;
+};
+
+} // namespace trace
+} // namespace http
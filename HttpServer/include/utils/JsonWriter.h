@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <muduo/net/Buffer.h>
+
+namespace http
+{
+
+// 流式 JSON 写入器：边遍历数据边输出紧凑格式的 JSON，不构造中间 DOM
+// Output 需提供 append(const char*, size_t)，如 std::string、muduo::net::Buffer
+// 调用方负责事件顺序正确（key 之后紧跟一个值），写入器只处理逗号和转义
+template <typename Output>
+class BasicJsonWriter
+{
+public:
+    explicit BasicJsonWriter(Output* out)
+        : out_(out)
+        , afterKey_(false)
+    {}
+
+    BasicJsonWriter& startObject()
+    {
+        beforeValue();
+        put('{');
+        hasElement_.push_back(false);
+        return *this;
+    }
+
+    BasicJsonWriter& endObject()
+    {
+        hasElement_.pop_back();
+        put('}');
+        return *this;
+    }
+
+    BasicJsonWriter& startArray()
+    {
+        beforeValue();
+        put('[');
+        hasElement_.push_back(false);
+        return *this;
+    }
+
+    BasicJsonWriter& endArray()
+    {
+        hasElement_.pop_back();
+        put(']');
+        return *this;
+    }
+
+    BasicJsonWriter& key(std::string_view name)
+    {
+        beforeValue();
+        writeString(name);
+        put(':');
+        afterKey_ = true;
+        return *this;
+    }
+
+    BasicJsonWriter& value(std::string_view str)
+    {
+        beforeValue();
+        writeString(str);
+        return *this;
+    }
+
+    BasicJsonWriter& value(const char* str)
+    { return value(std::string_view(str)); }
+
+    BasicJsonWriter& value(const std::string& str)
+    { return value(std::string_view(str)); }
+
+    BasicJsonWriter& value(bool b)
+    {
+        beforeValue();
+        if (b)
+            append("true", 4);
+        else
+            append("false", 5);
+        return *this;
+    }
+
+    BasicJsonWriter& value(int64_t n)
+    {
+        beforeValue();
+        char buf[24];
+        int len = snprintf(buf, sizeof buf, "%lld", static_cast<long long>(n));
+        append(buf, static_cast<size_t>(len));
+        return *this;
+    }
+
+    BasicJsonWriter& value(int n)
+    { return value(static_cast<int64_t>(n)); }
+
+    BasicJsonWriter& value(uint64_t n)
+    {
+        beforeValue();
+        char buf[24];
+        int len = snprintf(buf, sizeof buf, "%llu", static_cast<unsigned long long>(n));
+        append(buf, static_cast<size_t>(len));
+        return *this;
+    }
+
+    BasicJsonWriter& value(double d)
+    {
+        beforeValue();
+        char buf[32];
+        int len = snprintf(buf, sizeof buf, "%.17g", d);
+        append(buf, static_cast<size_t>(len));
+        return *this;
+    }
+
+    BasicJsonWriter& null()
+    {
+        beforeValue();
+        append("null", 4);
+        return *this;
+    }
+
+    // 写入已经序列化好的 JSON 片段
+    BasicJsonWriter& raw(std::string_view json)
+    {
+        beforeValue();
+        append(json.data(), json.size());
+        return *this;
+    }
+
+    // 常用的键值对写法
+    template <typename T>
+    BasicJsonWriter& member(std::string_view name, const T& v)
+    {
+        key(name);
+        return value(v);
+    }
+
+    // 所有对象和数组都已闭合
+    bool complete() const
+    { return hasElement_.empty(); }
+
+private:
+    void beforeValue()
+    {
+        if (afterKey_)
+        {
+            afterKey_ = false;
+            return;
+        }
+        if (!hasElement_.empty())
+        {
+            if (hasElement_.back())
+                put(',');
+            else
+                hasElement_.back() = true;
+        }
+    }
+
+    void writeString(std::string_view str)
+    {
+        static const char kHex[] = "0123456789abcdef";
+        put('"');
+        // 不需要转义的连续片段整段追加，UTF-8 多字节字符原样输出
+        const char* p = str.data();
+        const char* end = p + str.size();
+        const char* run = p;
+        for (; p < end; ++p)
+        {
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+            if (p > run)
+                append(run, static_cast<size_t>(p - run));
+            run = p + 1;
+            switch (c)
+            {
+            case '"':  append("\\\"", 2); break;
+            case '\\': append("\\\\", 2); break;
+            case '\n': append("\\n", 2); break;
+            case '\r': append("\\r", 2); break;
+            case '\t': append("\\t", 2); break;
+            case '\b': append("\\b", 2); break;
+            case '\f': append("\\f", 2); break;
+            default:
+            {
+                char esc[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xf]};
+                append(esc, sizeof esc);
+                break;
+            }
+            }
+        }
+        if (end > run)
+            append(run, static_cast<size_t>(end - run));
+        put('"');
+    }
+
+    void put(char c)
+    { out_->append(&c, 1); }
+
+    void append(const char* data, size_t len)
+    { out_->append(data, len); }
+
+    Output*           out_;
+    std::vector<bool> hasElement_; // 每层容器是否已有元素，决定是否需要逗号
+    bool              afterKey_;
+};
+
+using JsonWriter = BasicJsonWriter<std::string>;
+using BufferJsonWriter = BasicJsonWriter<muduo::net::Buffer>;
+
+} // namespace http
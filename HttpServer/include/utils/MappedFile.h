@@ -0,0 +1,59 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <string>
+
+#include <muduo/base/noncopyable.h>
+
+// 只读内存映射文件：数据直接来自页缓存，发送时不经过额外的用户态读缓冲
+// 映射期间文件被原地截断会触发 SIGBUS，更新文件应写新文件后 rename 替换
+class MappedFile : muduo::noncopyable
+{
+public:
+    explicit MappedFile(const std::string& path)
+        : data_(nullptr)
+        , size_(0)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                // 顺序发送，提示内核预读
+                ::madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                data_ = static_cast<const char*>(addr);
+                size_ = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd); // 映射建立后即可关闭文件描述符
+    }
+
+    ~MappedFile()
+    {
+        if (data_)
+            ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    bool isValid() const
+    { return data_ != nullptr; }
+
+    const char* data() const
+    { return data_; }
+
+    size_t size() const
+    { return size_; }
+
+private:
+    const char* data_;
+    size_t      size_;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <muduo/base/noncopyable.h>
+
+namespace http
+{
+
+enum class ContentEncoding
+{
+    kIdentity,
+    kGzip,
+    kDeflate,
+    kBrotli,
+    kZstd,
+};
+
+// Content-Encoding 中使用的名称
+const char* contentEncodingName(ContentEncoding encoding);
+
+// 当前构建是否支持该编码（brotli / zstd 取决于编译时是否找到对应库）
+bool contentEncodingSupported(ContentEncoding encoding);
+
+// 增量压缩器：可多次追加数据，flush 时输出到目前为止的全部压缩数据，
+// 客户端收到后即可解出，用于流式响应
+class StreamCompressor : muduo::noncopyable
+{
+public:
+    virtual ~StreamCompressor() = default;
+
+    // 压缩 data 并把产生的输出追加到 out；flush 为 true 时强制输出缓冲的数据
+    virtual bool compress(const char* data, size_t len, bool flush, std::string* out) = 0;
+
+    // 结束压缩流，输出剩余数据和尾部
+    virtual bool finish(std::string* out) = 0;
+
+    ContentEncoding encoding() const
+    { return encoding_; }
+
+    // level 小于 0 时使用各编码适合动态内容的默认级别；不支持的编码返回空
+    static std::unique_ptr<StreamCompressor> create(ContentEncoding encoding, int level = -1);
+
+    // 一次性压缩整段数据
+    static bool compressAll(ContentEncoding encoding, int level, const std::string& input, std::string* out);
+
+protected:
+    explicit StreamCompressor(ContentEncoding encoding)
+        : encoding_(encoding)
+    {}
+
+private:
+    ContentEncoding encoding_;
+};
+
+using StreamCompressorPtr = std::shared_ptr<StreamCompressor>;
+
+} // namespace http
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
@@ -33,6 +34,10 @@ public:
     // 获取连接
     std::shared_ptr<DbConnection> getConnection();
 
+    // 正在等待空闲连接的线程数
+    size_t waitingThreads() const
+    { return waiters_.load(std::memory_order_relaxed); }
+
 private:
     // 构造函数
     DbConnectionPool();
@@ -55,6 +60,7 @@ private:
     std::queue<std::shared_ptr<DbConnection>> connections_;
     std::mutex                                mutex_;
     std::condition_variable                   cv_;
+    std::atomic<size_t>                       waiters_{0};
     bool                                      initialized_ = false;
     std::thread                               checkThread_; // 添加检查线程
 };
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <muduo/net/Buffer.h>
+
+namespace http
+{
+namespace websocket
+{
+
+// RFC 6455 帧操作码
+enum Opcode : uint8_t
+{
+    kContinuation = 0x0,
+    kText         = 0x1,
+    kBinary       = 0x2,
+    kClose        = 0x8,
+    kPing         = 0x9,
+    kPong         = 0xA,
+};
+
+// 关闭状态码
+enum CloseCode : uint16_t
+{
+    kNormalClosure   = 1000,
+    kGoingAway       = 1001,
+    kProtocolError   = 1002,
+    kUnsupportedData = 1003,
+    kNoStatus        = 1005,
+    kAbnormalClosure = 1006,
+    kInvalidPayload  = 1007,
+    kMessageTooBig   = 1009,
+    kInternalError   = 1011,
+};
+
+struct WebSocketFrame
+{
+    bool        fin  = true;
+    bool        rsv1 = false; // permessage-deflate 压缩标记
+    Opcode      opcode = kText;
+    std::string payload;
+};
+
+// 帧编解码，只处理客户端到服务端（带掩码）的帧
+class WebSocketCodec
+{
+public:
+    enum DecodeResult
+    {
+        kIncomplete,    // 数据不足一帧
+        kFrameReady,    // 解析出一帧
+        kProtocolError, // 帧格式错误
+        kTooLarge,      // 负载超过限制
+    };
+
+    // 从 buf 中解析一帧，成功时移动读指针
+    static DecodeResult decode(muduo::net::Buffer* buf, WebSocketFrame* frame, size_t maxPayload);
+
+    // 编码一帧服务端帧（不带掩码）并追加到 out
+    static void encode(std::string* out, Opcode opcode, const char* data, size_t len,
+                       bool fin = true, bool rsv1 = false);
+
+    // 原地异或掩码，x86 上使用 SSE2/AVX2 按块处理
+    static void unmask(char* data, size_t len, const uint8_t key[4]);
+
+    // 计算握手响应中的 Sec-WebSocket-Accept
+    static std::string computeAcceptKey(const std::string& clientKey);
+};
+
+} // namespace websocket
+} // namespace http
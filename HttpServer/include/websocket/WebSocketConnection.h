@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include <boost/any.hpp>
+#include <muduo/net/TcpConnection.h>
+
+#include "websocket/WebSocketCodec.h"
+#include "websocket/WebSocketDeflate.h"
+
+namespace http
+{
+namespace websocket
+{
+
+class WebSocketHandler;
+
+// 升级后的 WebSocket 连接，负责帧的收发、分片合并、ping/pong 与关闭握手
+// send/ping/close 可在任意线程调用，实际写入在 IO 线程中完成
+class WebSocketConnection : public std::enable_shared_from_this<WebSocketConnection>
+{
+public:
+    WebSocketConnection(const muduo::net::TcpConnectionPtr& conn, std::shared_ptr<WebSocketHandler> handler);
+
+    // 握手时协商出的压缩扩展
+    void setDeflate(std::unique_ptr<WebSocketDeflate> deflate)
+    { deflate_ = std::move(deflate); }
+
+    void setMaxMessageSize(size_t size)
+    { maxMessageSize_ = size; }
+
+    // IO 线程：处理收到的数据
+    void onData(muduo::net::Buffer* buf);
+    // IO 线程：底层 TCP 连接断开
+    void onDisconnected();
+
+    void sendText(const std::string& message);
+    void sendBinary(const std::string& message);
+    void ping(const std::string& payload = std::string());
+    void close(uint16_t code = kNormalClosure, const std::string& reason = std::string());
+
+    bool connected() const;
+
+    const std::string& name() const
+    { return name_; }
+
+    void setContext(const boost::any& context)
+    { context_ = context; }
+
+    const boost::any& getContext() const
+    { return context_; }
+
+    boost::any* getMutableContext()
+    { return &context_; }
+
+private:
+    void handleFrame(WebSocketFrame& frame);
+    void handleMessage(Opcode opcode, bool compressed, std::string& payload);
+    void sendFrame(Opcode opcode, std::string data);
+    void sendFrameInLoop(Opcode opcode, const std::string& data);
+    void failConnection(uint16_t code);
+    void notifyClose(uint16_t code);
+
+    std::weak_ptr<muduo::net::TcpConnection> conn_;
+    std::shared_ptr<WebSocketHandler>        handler_;
+    std::unique_ptr<WebSocketDeflate>        deflate_;
+    std::string                              name_;
+    size_t                                   maxMessageSize_;
+
+    // 分片消息的合并状态
+    Opcode                                   fragmentOpcode_;
+    bool                                     fragmentCompressed_;
+    std::string                              fragmentBuffer_;
+
+    bool                                     closeSent_; // 只在 IO 线程访问
+    std::atomic<bool>                        closed_;
+    boost::any                               context_;
+};
+
+using WebSocketConnectionPtr = std::shared_ptr<WebSocketConnection>;
+
+} // namespace websocket
+} // namespace http
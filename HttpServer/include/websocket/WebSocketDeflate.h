@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+
+#include <zlib.h>
+
+namespace http
+{
+namespace websocket
+{
+
+// permessage-deflate 扩展（RFC 7692），每个连接一个实例，只在 IO 线程中使用
+class WebSocketDeflate
+{
+public:
+    WebSocketDeflate();
+    ~WebSocketDeflate();
+
+    WebSocketDeflate(const WebSocketDeflate&) = delete;
+    WebSocketDeflate& operator=(const WebSocketDeflate&) = delete;
+
+    // 解析 Sec-WebSocket-Extensions 请求头，接受第一个可用的 permessage-deflate 提议
+    // 成功时 response 为需要回写的响应头值
+    bool negotiate(const std::string& offers, std::string* response);
+
+    // 压缩一条完整消息，去掉末尾的 00 00 ff ff
+    bool compress(const std::string& in, std::string* out);
+
+    // 解压一条完整消息，输出超过 maxSize 时失败
+    bool decompress(const std::string& in, std::string* out, size_t maxSize);
+
+    // 小于该长度的消息不压缩，直接以 RSV1=0 发送
+    static const size_t kMinCompressSize = 64;
+
+private:
+    bool initDeflate();
+    bool initInflate();
+
+    z_stream deflateStream_;
+    z_stream inflateStream_;
+    bool     deflateReady_;
+    bool     inflateReady_;
+    bool     serverNoContextTakeover_;
+    int      serverWindowBits_;
+};
+
+} // namespace websocket
+} // namespace http
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+#include "websocket/WebSocketConnection.h"
+
+namespace http
+{
+namespace websocket
+{
+
+// WebSocket 路由处理器，通过 HttpServer::WebSocket 注册到指定路径
+// 除 onUpgrade 外的回调都在连接所属的 IO 线程中执行，耗时操作应投递到业务线程
+class WebSocketHandler
+{
+public:
+    virtual ~WebSocketHandler() = default;
+
+    // 握手阶段调用，返回 false 拒绝升级，拒绝时可在 resp 中设置状态码和响应体
+    // 鉴权等一次性工作放在这里，结果可通过 ws->setContext 保存
+    virtual bool onUpgrade(const HttpRequest& req, HttpResponse* resp, const WebSocketConnectionPtr& ws)
+    { return true; }
+
+    virtual void onOpen(const WebSocketConnectionPtr& ws) {}
+
+    // 收到一条完整消息（分片已合并、已解压）
+    virtual void onMessage(const WebSocketConnectionPtr& ws, const std::string& message, bool binary) = 0;
+
+    // 连接关闭，code 为对端关闭码，连接异常断开时为 kAbnormalClosure
+    virtual void onClose(const WebSocketConnectionPtr& ws, uint16_t code) {}
+};
+
+using WebSocketHandlerPtr = std::shared_ptr<WebSocketHandler>;
+
+} // namespace websocket
+} // namespace http
@@ -0,0 +1,200 @@
+#include "http/ConnectionManager.h"
+
+#include <algorithm>
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/TcpConnection.h>
+
+#include "http/HttpContext.h"
+#include "metrics/MetricsRegistry.h"
+
+namespace http
+{
+
+// 单层时间轮，一格 1 秒，格数大于最长超时，因此同一槽中的连接到期 tick 相同
+// 连接刷新 deadline 时不移除旧位置，到期时与连接当前的 deadline 比对即可识别
+class ConnectionWheel : muduo::noncopyable
+{
+public:
+    ConnectionWheel(ConnectionManager* owner, muduo::net::EventLoop* loop, size_t slots)
+        : owner_(owner)
+        , loop_(loop)
+        , tick_(0)
+        , slots_(slots)
+    {}
+
+    muduo::net::EventLoop* loop() const
+    { return loop_; }
+
+    void start()
+    {
+        loop_->runEvery(1.0, [this]() { onTick(); });
+    }
+
+    void schedule(const muduo::net::TcpConnectionPtr& conn, ConnectionTimer* timer, int seconds)
+    {
+        timer->deadline = tick_ + seconds;
+        slots_[static_cast<size_t>(timer->deadline) % slots_.size()].push_back(conn);
+    }
+
+private:
+    void onTick()
+    {
+        ++tick_;
+        std::vector<std::weak_ptr<muduo::net::TcpConnection>> due;
+        due.swap(slots_[static_cast<size_t>(tick_) % slots_.size()]);
+        for (const auto& weakConn : due)
+        {
+            muduo::net::TcpConnectionPtr conn = weakConn.lock();
+            if (!conn || !conn->connected())
+                continue;
+            HttpContext* context = boost::any_cast<HttpContext>(conn->getMutableContext());
+            if (!context)
+                continue;
+            const ConnectionTimer& timer = context->connectionTimer();
+            // 之后又切换过阶段的连接在新的槽中另有记录
+            if (timer.deadline != tick_)
+                continue;
+            owner_->evict(conn, timer.phase);
+        }
+    }
+
+    ConnectionManager*                                                   owner_;
+    muduo::net::EventLoop*                                               loop_;
+    int64_t                                                              tick_;
+    std::vector<std::vector<std::weak_ptr<muduo::net::TcpConnection>>>  slots_;
+};
+
+ConnectionManager::ConnectionManager()
+    : connections_(0)
+{
+    auto& registry = metrics::MetricsRegistry::instance();
+    const char* evictedName = "http_connections_evicted_total";
+    const char* evictedHelp = "Connections closed by the server on timeout";
+    evictedIdle_ = &registry.counter(evictedName, evictedHelp, {{"reason", "idle"}});
+    evictedHeader_ = &registry.counter(evictedName, evictedHelp, {{"reason", "header_timeout"}});
+    evictedBody_ = &registry.counter(evictedName, evictedHelp, {{"reason", "body_timeout"}});
+    const char* rejectedName = "http_connections_rejected_total";
+    const char* rejectedHelp = "Connections refused on accept because of connection limits";
+    rejectedGlobal_ = &registry.counter(rejectedName, rejectedHelp, {{"reason", "max_connections"}});
+    rejectedPerIp_ = &registry.counter(rejectedName, rejectedHelp, {{"reason", "max_per_ip"}});
+}
+
+ConnectionManager::~ConnectionManager() = default;
+
+void ConnectionManager::setOptions(const ConnectionOptions& options)
+{
+    options_ = options;
+}
+
+bool ConnectionManager::onConnected(const muduo::net::TcpConnectionPtr& conn, ConnectionTimer* timer)
+{
+    timer->manager = this;
+    timer->wheel = wheelFor(conn->getLoop());
+
+    size_t total = connections_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (options_.maxConnections > 0 && total > options_.maxConnections)
+    {
+        connections_.fetch_sub(1, std::memory_order_relaxed);
+        rejectedGlobal_->inc();
+        return false;
+    }
+    if (options_.maxConnectionsPerIp > 0)
+    {
+        std::string ip = conn->peerAddress().toIp();
+        std::lock_guard<std::mutex> lock(ipMutex_);
+        size_t& count = perIp_[ip];
+        if (count >= options_.maxConnectionsPerIp)
+        {
+            connections_.fetch_sub(1, std::memory_order_relaxed);
+            rejectedPerIp_->inc();
+            return false;
+        }
+        ++count;
+        timer->peerIp = std::move(ip);
+    }
+    timer->admitted = true;
+    setPhase(conn, timer, ConnectionPhase::kIdle);
+    return true;
+}
+
+void ConnectionManager::onDisconnected(ConnectionTimer* timer)
+{
+    if (!timer->admitted)
+        return;
+    timer->admitted = false;
+    timer->deadline = 0;
+    connections_.fetch_sub(1, std::memory_order_relaxed);
+    if (!timer->peerIp.empty())
+    {
+        std::lock_guard<std::mutex> lock(ipMutex_);
+        auto it = perIp_.find(timer->peerIp);
+        if (it != perIp_.end() && --it->second == 0)
+            perIp_.erase(it);
+    }
+}
+
+void ConnectionManager::setPhase(const muduo::net::TcpConnectionPtr& conn, ConnectionTimer* timer,
+                                 ConnectionPhase phase)
+{
+    timer->phase = phase;
+    int seconds = timeoutFor(phase);
+    if (seconds <= 0 || !timer->wheel)
+    {
+        timer->deadline = 0;
+        return;
+    }
+    timer->wheel->schedule(conn, timer, seconds);
+}
+
+void ConnectionManager::countRejectedRequest(const char* reason)
+{
+    // 只在出错路径上调用，注册表查找的开销可以接受
+    metrics::MetricsRegistry::instance()
+        .counter("http_requests_rejected_total", "Requests refused before routing", {{"reason", reason}})
+        .inc();
+}
+
+ConnectionWheel* ConnectionManager::wheelFor(muduo::net::EventLoop* loop)
+{
+    std::lock_guard<std::mutex> lock(wheelMutex_);
+    for (const auto& wheel : wheels_)
+    {
+        if (wheel->loop() == loop)
+            return wheel.get();
+    }
+    // 首个连接到来时在该 IO 线程中创建，槽数比最长超时多一格
+    int longest = std::max({options_.idleTimeout, options_.headerTimeout, options_.bodyTimeout, 0});
+    wheels_.push_back(std::make_unique<ConnectionWheel>(this, loop, static_cast<size_t>(longest) + 2));
+    wheels_.back()->start();
+    return wheels_.back().get();
+}
+
+void ConnectionManager::evict(const muduo::net::TcpConnectionPtr& conn, ConnectionPhase phase)
+{
+    if (phase == ConnectionPhase::kIdle)
+    {
+        evictedIdle_->inc();
+        conn->forceClose();
+        return;
+    }
+
+    // 读请求超时：告知客户端后立即关闭，不等待对端，慢速客户端无法继续占用连接
+    (phase == ConnectionPhase::kReadingHeader ? evictedHeader_ : evictedBody_)->inc();
+    LOG_DEBUG << "Request read timeout from " << conn->peerAddress().toIpPort();
+    HttpContext::send(conn, "HTTP/1.1 408 Request Timeout\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+    conn->forceClose();
+}
+
+int ConnectionManager::timeoutFor(ConnectionPhase phase) const
+{
+    switch (phase)
+    {
+    case ConnectionPhase::kIdle:          return options_.idleTimeout;
+    case ConnectionPhase::kReadingHeader: return options_.headerTimeout;
+    case ConnectionPhase::kReadingBody:   return options_.bodyTimeout;
+    default:                              return 0;
+    }
+}
+
+} // namespace http
@@ -0,0 +1,50 @@
+#include "http/DeferredResponse.h"
+#include "http/HttpContext.h"
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+
+namespace http
+{
+
+DeferredResponse::DeferredResponse(const muduo::net::TcpConnectionPtr& conn, HttpResponse response)
+    : conn_(conn)
+    , response_(std::move(response))
+    , completed_(false)
+{}
+
+DeferredResponse::~DeferredResponse()
+{
+    if (completed_.load(std::memory_order_acquire))
+        return;
+    LOG_WARN << "Deferred response released without completion";
+    response_.setStatusLine("HTTP/1.1", HttpResponse::k500InternalServerError, "Internal Server Error");
+    response_.setCloseConnection(true);
+    response_.setContentLength(0);
+    response_.setBody(std::string());
+    complete();
+}
+
+void DeferredResponse::complete()
+{
+    bool expected = false;
+    if (!completed_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return;
+    auto conn = conn_.lock();
+    if (!conn || !conn->connected())
+        return;
+
+    // 在调用线程中序列化，IO 线程只负责发送
+    muduo::net::Buffer buf;
+    response_.appendToBuffer(&buf);
+    bool close = response_.closeConnection();
+    conn->getLoop()->runInLoop([conn, data = buf.retrieveAllAsString(), close]()
+    {
+        HttpContext::send(conn, data);
+        if (close)
+            conn->shutdown();
+        HttpContext::onResponseComplete(conn);
+    });
+}
+
+} // namespace http
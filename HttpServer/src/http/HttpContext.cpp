@@ -1,4 +1,9 @@
+#include <strings.h>
+
+#include <algorithm>
+
 #include "http/HttpContext.h"
+#include "ssl/SslConnection.h"
 
 using namespace muduo;
 using namespace muduo::net;
@@ -6,6 +11,138 @@ using namespace muduo::net;
 namespace http
 {
 
+namespace
+{
+
+ssl::SslConnection* findSslConnection(const TcpConnectionPtr& conn)
+{
+    const HttpContext* context = boost::any_cast<HttpContext>(&conn->getContext());
+    return context ? context->sslConnection() : nullptr;
+}
+
+// Content-Length 只允许十进制数字，拒绝符号、空白和溢出
+bool parseContentLength(const std::string& value, uint64_t* length)
+{
+    if (value.empty() || value.size() > 19)
+        return false;
+    uint64_t n = 0;
+    for (char c : value)
+    {
+        if (c < '0' || c > '9')
+            return false;
+        n = n * 10 + static_cast<uint64_t>(c - '0');
+    }
+    *length = n;
+    return true;
+}
+
+// 请求头名称不区分大小写
+std::string findHeaderIgnoreCase(const HttpRequest& req, const char* field)
+{
+    for (const auto& header : req.headers())
+    {
+        if (strcasecmp(header.first.c_str(), field) == 0)
+            return header.second;
+    }
+    return std::string();
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// 块大小行（含扩展）的长度上限
+const size_t kMaxChunkLineBytes = 1024;
+
+} // namespace
+
+void HttpContext::onResponseComplete(const TcpConnectionPtr& conn)
+{
+    HttpContext* context = boost::any_cast<HttpContext>(conn->getMutableContext());
+    if (!context || !conn->connected())
+        return;
+    context->responsePending_ = false;
+    if (context->dispatched_ && context->readingBody())
+    {
+        // 流式请求体尚未读完，继续按请求体超时计时，读完后直接回到空闲
+        context->responded_ = true;
+        context->setConnectionPhase(conn, ConnectionPhase::kReadingBody);
+        return;
+    }
+    context->setConnectionPhase(conn, ConnectionPhase::kIdle);
+    context->resumeParsing(conn);
+}
+
+void HttpContext::pauseRead(const TcpConnectionPtr& conn)
+{
+    if (readPaused_)
+        return;
+    readPaused_ = true;
+    conn->stopRead();
+}
+
+void HttpContext::resumeParsing(const TcpConnectionPtr& conn)
+{
+    Buffer* input = sslConn_ ? sslConn_->getDecryptedBuffer() : conn->inputBuffer();
+    if (!readPaused_ && input->readableBytes() == 0)
+        return;
+    if (readPaused_)
+    {
+        readPaused_ = false;
+        conn->startRead();
+    }
+    // 同步响应时仍在本次 onMessage 之中，排到当前事件处理之后再解析
+    if (resumeCallback_ && input->readableBytes() > 0)
+    {
+        ResumeCallback callback = resumeCallback_;
+        conn->getLoop()->queueInLoop([conn, callback]() { callback(conn); });
+    }
+}
+
+void HttpContext::send(const TcpConnectionPtr& conn, const char* data, size_t len)
+{
+    ssl::SslConnection* sslConn = findSslConnection(conn);
+    if (!sslConn)
+    {
+        conn->send(data, static_cast<int>(len));
+    }
+    else if (conn->getLoop()->isInLoopThread())
+    {
+        sslConn->send(data, len);
+    }
+    else
+    {
+        // SSL 对象只能在 IO 线程中使用
+        conn->getLoop()->runInLoop([conn, data = std::string(data, len)]() {
+            send(conn, data);
+        });
+    }
+}
+
+void HttpContext::send(const TcpConnectionPtr& conn, const std::string& data)
+{
+    send(conn, data.data(), data.size());
+}
+
+void HttpContext::send(const TcpConnectionPtr& conn, Buffer* buf)
+{
+    ssl::SslConnection* sslConn = findSslConnection(conn);
+    if (!sslConn)
+    {
+        conn->send(buf);
+        return;
+    }
+    send(conn, buf->peek(), buf->readableBytes());
+    buf->retrieveAll();
+}
+
 // 将报文解析出来将关键信息封装到 HttpRequest 对象
 bool HttpContext::parseRequest(Buffer *buf, Timestamp receiveTime)
 {
@@ -16,8 +153,15 @@ bool HttpContext::parseRequest(Buffer *buf, Timestamp receiveTime)
         if (state_ == kExpectRequestLine)
         {
             const char *crlf = buf->findCRLF(); // 注意这个返回值边界可能有错
+            // 请求行过长时不再等待换行，避免缓冲区无限增长
+            size_t lineLength = crlf ? static_cast<size_t>(crlf - buf->peek()) : buf->readableBytes();
+            if (lineLength + 2 > maxHeaderBytes_)
+            {
+                return fail(HttpResponse::k414UriTooLong);
+            }
             if (crlf)
             {
+                headerBytes_ = lineLength + 2;
                 ok = processRequestLine(buf->peek(), crlf);
                 if (ok)
                 {
@@ -38,8 +182,14 @@ bool HttpContext::parseRequest(Buffer *buf, Timestamp receiveTime)
         else if (state_ == kExpectHeaders)
         {
             const char *crlf = buf->findCRLF();
+            size_t lineLength = crlf ? static_cast<size_t>(crlf - buf->peek()) : buf->readableBytes();
+            if (headerBytes_ + lineLength + 2 > maxHeaderBytes_)
+            {
+                return fail(HttpResponse::k431RequestHeaderFieldsTooLarge);
+            }
             if (crlf)
             {
+                headerBytes_ += lineLength + 2;
                 const char *colon = std::find(buf->peek(), crlf, ':');
                 if (colon < crlf)
                 {
@@ -48,37 +198,17 @@ bool HttpContext::parseRequest(Buffer *buf, Timestamp receiveTime)
                 else if (buf->peek() == crlf)
                 { 
                     // 空行，结束 Header
-                    // 根据请求方法和 Content-Length，判断是否需要读取 body
-                    if (request_.method() == HttpRequest::kPost || 
-                        request_.method() == HttpRequest::kPut)
+                    buf->retrieveUntil(crlf + 2);
+                    if (!processHeadersEnd())
                     {
-                        std::string contentLength = request_.getHeader("Content-Length");
-                        if (!contentLength.empty())
-                        {
-                            request_.setContentLength(std::stoi(contentLength));
-                            if (request_.contentLength() > 0)
-                            {
-                                state_ = kExpectBody;
-                            }
-                            else
-                            {
-                                state_ = kGotAll;
-                                hasMore = false;
-                            }
-                        }
-                        else
-                        {
-                            // POST/PUT 请求没有 Content-Length，是HTTP语法错误
-                            ok = false;
-                            hasMore = false;
-                        }
+                        return false;
                     }
-                    else
+                    if (state_ == kGotHeaders && !pauseAtHeaders_ && !beginBody(nullptr))
                     {
-                        // GET/HEAD/DELETE 等方法直接完成（没有请求体）
-                        state_ = kGotAll; 
-                        hasMore = false;
+                        return false;
                     }
+                    hasMore = readingBody();
+                    continue;
                 }
                 else
                 {
@@ -94,25 +224,282 @@ bool HttpContext::parseRequest(Buffer *buf, Timestamp receiveTime)
         }
         else if (state_ == kExpectBody)
         {
-            // 检查缓冲区中是否有足够的数据
-            if (buf->readableBytes() < request_.contentLength())
+            // 请求体边到达边取走，不在输入缓冲中积累
+            size_t len = static_cast<size_t>(std::min<uint64_t>(buf->readableBytes(),
+                                                                request_.contentLength() - bodyBytes_));
+            if (len > 0)
+            {
+                if (!appendBody(buf->peek(), len))
+                {
+                    return false;
+                }
+                buf->retrieve(len);
+            }
+            if (bodyBytes_ == request_.contentLength())
+            {
+                finishBody();
+            }
+            hasMore = false;
+        }
+        else if (state_ == kExpectChunkSize)
+        {
+            const char *crlf = buf->findCRLF();
+            size_t lineLength = crlf ? static_cast<size_t>(crlf - buf->peek()) : buf->readableBytes();
+            if (lineLength + 2 > kMaxChunkLineBytes)
+            {
+                return fail(HttpResponse::k400BadRequest);
+            }
+            if (!crlf)
+            {
+                hasMore = false;
+            }
+            else
+            {
+                if (!processChunkSize(buf->peek(), crlf))
+                {
+                    return false;
+                }
+                buf->retrieveUntil(crlf + 2);
+            }
+        }
+        else if (state_ == kExpectChunkData)
+        {
+            size_t len = static_cast<size_t>(std::min<uint64_t>(buf->readableBytes(), chunkRemaining_));
+            if (len > 0)
+            {
+                if (!appendBody(buf->peek(), len))
+                {
+                    return false;
+                }
+                buf->retrieve(len);
+                chunkRemaining_ -= len;
+            }
+            if (chunkRemaining_ == 0)
+            {
+                state_ = kExpectChunkEnd;
+            }
+            else
+            {
+                hasMore = false;
+            }
+        }
+        else if (state_ == kExpectChunkEnd)
+        {
+            if (buf->readableBytes() < 2)
+            {
+                hasMore = false;
+            }
+            else if (buf->peek()[0] != '\r' || buf->peek()[1] != '\n')
             {
-                hasMore = false; // 数据不完整，等待更多数据
-                return true;
+                return fail(HttpResponse::k400BadRequest);
             }
+            else
+            {
+                buf->retrieve(2);
+                state_ = kExpectChunkSize;
+            }
+        }
+        else if (state_ == kExpectTrailers)
+        {
+            // trailer 字段计入请求头长度，内容忽略
+            const char *crlf = buf->findCRLF();
+            size_t lineLength = crlf ? static_cast<size_t>(crlf - buf->peek()) : buf->readableBytes();
+            if (headerBytes_ + lineLength + 2 > maxHeaderBytes_)
+            {
+                return fail(HttpResponse::k431RequestHeaderFieldsTooLarge);
+            }
+            if (!crlf)
+            {
+                hasMore = false;
+            }
+            else
+            {
+                headerBytes_ += lineLength + 2;
+                bool last = buf->peek() == crlf;
+                buf->retrieveUntil(crlf + 2);
+                if (last)
+                {
+                    finishBody();
+                    hasMore = false;
+                }
+            }
+        }
+        else
+        {
+            // kGotHeaders 等待 beginBody，kGotAll 等待分发
+            hasMore = false;
+        }
+    }
+    return ok; // ok为false代表报文语法解析错误
+}
 
-            // 只读取 Content-Length 指定的长度
-            std::string body(buf->peek(), buf->peek() + request_.contentLength());
-            request_.setBody(body);
+bool HttpContext::fail(HttpResponse::HttpStatusCode code)
+{
+    error_ = code;
+    return false;
+}
 
-            // 准确移动读指针
-            buf->retrieve(request_.contentLength());
+bool HttpContext::processHeadersEnd()
+{
+    std::string transferEncoding = findHeaderIgnoreCase(request_, "Transfer-Encoding");
+    std::string contentLength = request_.getHeader("Content-Length");
+    if (!transferEncoding.empty())
+    {
+        // 同时带 Content-Length 的请求可被用于请求走私，直接拒绝；只支持单独的 chunked 编码
+        if (!contentLength.empty() || request_.getVersion() != "HTTP/1.1")
+        {
+            return fail(HttpResponse::k400BadRequest);
+        }
+        if (strcasecmp(transferEncoding.c_str(), "chunked") != 0)
+        {
+            return fail(HttpResponse::k501NotImplemented);
+        }
+        chunked_ = true;
+        state_ = kGotHeaders;
+        return true;
+    }
 
-            state_ = kGotAll;
-            hasMore = false;
+    // 根据请求方法和 Content-Length，判断是否需要读取 body
+    if (request_.method() == HttpRequest::kPost || 
+        request_.method() == HttpRequest::kPut)
+    {
+        uint64_t length = 0;
+        // POST/PUT 请求既没有 Content-Length 也不是分块编码，是HTTP语法错误
+        if (!parseContentLength(contentLength, &length))
+        {
+            return fail(HttpResponse::k400BadRequest);
         }
+        request_.setContentLength(length);
+        state_ = length > 0 ? kGotHeaders : kGotAll;
+    }
+    else
+    {
+        // GET/HEAD/DELETE 等方法直接完成（没有请求体）
+        state_ = kGotAll;
+    }
+    return true;
+}
+
+bool HttpContext::beginBody(const BodyOptions* options)
+{
+    bodyLimit_ = options && options->maxBytes > 0 ? options->maxBytes : maxBodyBytes_;
+    // 请求体到达之前即按声明的长度拒绝，分块编码在读到每个块大小时检查
+    if (!chunked_ && request_.contentLength() > bodyLimit_)
+    {
+        return fail(HttpResponse::k413PayloadTooLarge);
+    }
+
+    if (options && options->streaming)
+    {
+        request_.setBodyReader(std::make_shared<BodyReader>());
+    }
+    else if (options && options->spillThreshold > 0)
+    {
+        spillThreshold_ = options->spillThreshold;
+        spillDir_ = options->spillDir;
+        if (!chunked_ && request_.contentLength() > spillThreshold_ && !spillBody())
+        {
+            return false;
+        }
+    }
+    if (!chunked_ && !request_.bodyReader() && !request_.spilledBody())
+    {
+        request_.reserveBody(static_cast<size_t>(request_.contentLength()));
+    }
+    state_ = chunked_ ? kExpectChunkSize : kExpectBody;
+    return true;
+}
+
+bool HttpContext::processChunkSize(const char* begin, const char* end)
+{
+    // 块大小为十六进制，之后可以跟 ;扩展，扩展内容忽略
+    uint64_t size = 0;
+    const char* p = begin;
+    for (; p < end && hexValue(*p) >= 0; ++p)
+    {
+        if (p - begin >= 15)
+        {
+            return fail(HttpResponse::k413PayloadTooLarge);
+        }
+        size = size * 16 + static_cast<uint64_t>(hexValue(*p));
+    }
+    while (p < end && (*p == ' ' || *p == '\t'))
+    {
+        ++p;
+    }
+    if (p == begin || (p < end && *p != ';'))
+    {
+        return fail(HttpResponse::k400BadRequest);
+    }
+
+    if (size == 0)
+    {
+        state_ = kExpectTrailers;
+        return true;
+    }
+    if (size > bodyLimit_ - bodyBytes_)
+    {
+        return fail(HttpResponse::k413PayloadTooLarge);
+    }
+    chunkRemaining_ = size;
+    state_ = kExpectChunkData;
+    return true;
+}
+
+bool HttpContext::appendBody(const char* data, size_t len)
+{
+    bodyBytes_ += len;
+    if (request_.bodyReader())
+    {
+        request_.bodyReader()->append(data, len);
+        return true;
+    }
+    if (!request_.spilledBody() && spillThreshold_ > 0 && bodyBytes_ > spillThreshold_ && !spillBody())
+    {
+        return false;
+    }
+    if (request_.spilledBody())
+    {
+        return request_.spilledBody()->write(data, len) || fail(HttpResponse::k500InternalServerError);
+    }
+    request_.appendBody(data, len);
+    return true;
+}
+
+bool HttpContext::spillBody()
+{
+    std::shared_ptr<SpilledBody> file = SpilledBody::create(spillDir_);
+    if (!file)
+    {
+        return fail(HttpResponse::k500InternalServerError);
+    }
+    // 已缓存在内存中的部分先写入文件
+    std::string buffered;
+    request_.swapBody(buffered);
+    if (!file->write(buffered.data(), buffered.size()))
+    {
+        return fail(HttpResponse::k500InternalServerError);
+    }
+    request_.setSpilledBody(std::move(file));
+    return true;
+}
+
+void HttpContext::finishBody()
+{
+    request_.setContentLength(bodyBytes_);
+    state_ = kGotAll;
+    if (request_.bodyReader())
+    {
+        request_.bodyReader()->finish(true);
+    }
+}
+
+void HttpContext::abortBody()
+{
+    if (request_.bodyReader())
+    {
+        request_.bodyReader()->finish(false);
     }
-    return ok; // ok为false代表报文语法解析错误
 }
 
 // 解析请求行
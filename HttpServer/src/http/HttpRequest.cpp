@@ -142,6 +142,11 @@ void HttpRequest::swap(HttpRequest &that)
     std::swap(version_, that.version_);
     std::swap(headers_, that.headers_);
     std::swap(receiveTime_, that.receiveTime_);
+    std::swap(peerIp_, that.peerIp_);
+    std::swap(content_, that.content_);
+    std::swap(contentLength_, that.contentLength_);
+    std::swap(spilledBody_, that.spilledBody_);
+    std::swap(bodyReader_, that.bodyReader_);
 }
 
 } // namespace http
\ No newline at end of file
@@ -3,7 +3,7 @@
 namespace http
 {
 
-void HttpResponse::appendToBuffer(muduo::net::Buffer* outputBuf) const
+void HttpResponse::appendToBuffer(muduo::net::Buffer* outputBuf, bool includeBody) const
 {
     // HttpResponse 封装的信息格式化输出
     char buf[32]; 
@@ -14,13 +14,17 @@ void HttpResponse::appendToBuffer(muduo::net::Buffer* outputBuf) const
     outputBuf->append(statusMessage_);
     outputBuf->append("\r\n");
 
-    if (closeConnection_)
+    // 显式设置了 Connection 头（如协议升级）时不再输出默认值
+    if (headers_.find("Connection") == headers_.end())
     {
-        outputBuf->append("Connection: close\r\n");
-    }
-    else
-    {
-        outputBuf->append("Connection: Keep-Alive\r\n");
+        if (closeConnection_)
+        {
+            outputBuf->append("Connection: close\r\n");
+        }
+        else
+        {
+            outputBuf->append("Connection: Keep-Alive\r\n");
+        }
     }
 
     for (const auto& header : headers_)
@@ -30,9 +34,18 @@ void HttpResponse::appendToBuffer(muduo::net::Buffer* outputBuf) const
         outputBuf->append(header.second);
         outputBuf->append("\r\n");
     }
+    for (size_t i = 0; i < rawHeaderCount_; ++i)
+    {
+        outputBuf->append(rawHeaders_[i]->data(), rawHeaders_[i]->size());
+    }
     outputBuf->append("\r\n");
-    
-    outputBuf->append(body_);
+
+    if (!includeBody)
+        return;
+    if (hasSharedBody())
+        outputBuf->append(sharedBodyData_, sharedBodySize_);
+    else
+        outputBuf->append(body_);
 }
 
 void HttpResponse::setStatusLine(const std::string& version,
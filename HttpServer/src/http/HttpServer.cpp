@@ -1,12 +1,54 @@
+#include <algorithm>
 #include <any>
 #include <functional>
 #include <memory>
+#include <strings.h>
 
 #include "http/HttpServer.h"
+#include "logging/Log.h"
+#include "metrics/MetricsRegistry.h"
 
 namespace http
 {
 
+namespace
+{
+
+// 请求头名称不区分大小写
+std::string findHeaderIgnoreCase(const HttpRequest& req, const char* field)
+{
+    for (const auto& header : req.headers())
+    {
+        if (strcasecmp(header.first.c_str(), field) == 0)
+            return header.second;
+    }
+    return std::string();
+}
+
+// 判断逗号分隔的头部值中是否包含指定 token（不区分大小写）
+bool headerHasToken(const std::string& value, const char* token)
+{
+    size_t tokenLen = strlen(token);
+    size_t pos = 0;
+    while (pos < value.size())
+    {
+        size_t comma = value.find(',', pos);
+        if (comma == std::string::npos)
+            comma = value.size();
+        size_t begin = value.find_first_not_of(" \t", pos);
+        size_t end = comma;
+        while (end > begin && (value[end - 1] == ' ' || value[end - 1] == '\t'))
+            --end;
+        if (begin < end && end - begin == tokenLen &&
+            strncasecmp(value.c_str() + begin, token, tokenLen) == 0)
+            return true;
+        pos = comma + 1;
+    }
+    return false;
+}
+
+} // namespace
+
 // 默认http回应函数
 void defaultHttpCallback(const HttpRequest &, HttpResponse *resp)
 {
@@ -22,7 +64,6 @@ HttpServer::HttpServer(int port,
     : listenAddr_(port)
     , server_(&mainLoop_, listenAddr_, name, option)
     , useSSL_(useSSL)
-    , httpCallback_(std::bind(&HttpServer::handleRequest, this, std::placeholders::_1, std::placeholders::_2))
 {
     initialize();
 }
@@ -57,28 +98,107 @@ void HttpServer::setSslConfig(const ssl::SslConfig& config)
             LOG_ERROR << "Failed to initialize SSL context";
             abort();
         }
+
+        // 握手与会话缓存统计由 SslContext 计数，抓取时读取
+        auto& registry = metrics::MetricsRegistry::instance();
+        registry.counterCallback("tls_sessions_resumed_total",
+                                 "TLS handshakes that resumed a session (cache or ticket)", {},
+                                 [this]() { return static_cast<double>(getSslStats().resumed); });
+        registry.counterCallback("tls_full_handshakes_total", "TLS handshakes that did not resume a session", {},
+                                 [this]()
+                                 {
+                                     ssl::SslStats stats = getSslStats();
+                                     return static_cast<double>(stats.handshakes - stats.resumed);
+                                 });
+        registry.counterCallback("tls_session_cache_hits_total", "TLS session cache lookups that found a session", {},
+                                 [this]() { return static_cast<double>(getSslStats().cacheHits); });
+        registry.counterCallback("tls_session_cache_misses_total", "TLS session cache lookups that found nothing",
+                                 {}, [this]() { return static_cast<double>(getSslStats().cacheMisses); });
+        registry.counterCallback("tls_session_cache_evictions_total",
+                                 "TLS sessions evicted from the cache to stay within capacity", {},
+                                 [this]() { return static_cast<double>(getSslStats().cacheEvictions); });
+        registry.gaugeCallback("tls_session_cache_size", "TLS sessions currently held in the session cache", {},
+                               [this]() { return static_cast<double>(getSslStats().cacheSize); });
     }
 }
 
+void HttpServer::enableMetrics(const std::string& path)
+{
+    Get(path, [](const HttpRequest&, HttpResponse* resp)
+    {
+        std::string body = metrics::MetricsRegistry::instance().render();
+        resp->setStatusLine("HTTP/1.1", HttpResponse::k200Ok, "OK");
+        resp->setCloseConnection(false);
+        resp->setContentType(metrics::MetricsRegistry::contentType());
+        resp->setContentLength(body.size());
+        resp->setBody(std::move(body));
+    });
+}
+
+void HttpServer::enableTracing(double sampleRate, const std::string& path, double flushInterval)
+{
+    trace::Tracer::instance().setSampleRate(sampleRate);
+    auto lastExported = std::make_shared<uint64_t>(0);
+    mainLoop_.runEvery(flushInterval, [path, lastExported]()
+    {
+        trace::Tracer& tracer = trace::Tracer::instance();
+        uint64_t recorded = tracer.recorded();
+        if (recorded != *lastExported && tracer.exportChromeTrace(path) >= 0)
+            *lastExported = recorded;
+    });
+    LOG_INFO << "Request tracing enabled, sample rate " << sampleRate << ", exporting to " << path;
+}
+
 void HttpServer::onConnection(const muduo::net::TcpConnectionPtr& conn)
 {
+    static metrics::Gauge& activeConnections = metrics::MetricsRegistry::instance().gauge(
+        "http_connections_active", "Currently open client connections");
+
     if (conn->connected())
     {
+        activeConnections.add();
+        conn->setContext(HttpContext());
+        HttpContext* context = boost::any_cast<HttpContext>(conn->getMutableContext());
+        const ConnectionOptions& options = connectionManager_.options();
+        context->setLimits(options.maxHeaderBytes, options.maxBodyBytes);
+        context->setPauseAtHeaders(true);
+        context->setPeerIp(conn->peerAddress().toIp());
+        context->setResumeCallback([this](const muduo::net::TcpConnectionPtr& c)
+        {
+            // TLS 连接的明文已在解密缓冲中，传入的密文缓冲为空
+            onMessage(c, c->inputBuffer(), muduo::Timestamp::now());
+        });
+        if (!connectionManager_.onConnected(conn, &context->connectionTimer()))
+        {
+            // 超出连接数上限：明文连接告知客户端稍后重试，TLS 连接握手前无法应答，直接关闭
+            if (!useSSL_)
+            {
+                conn->send("HTTP/1.1 503 Service Unavailable\r\nConnection: close\r\n"
+                           "Retry-After: 1\r\nContent-Length: 0\r\n\r\n");
+            }
+            conn->forceClose();
+            return;
+        }
         if (useSSL_)
         {
-            auto sslConn = std::make_unique<ssl::SslConnection>(conn, sslCtx_.get());
-            sslConn->setMessageCallback(
-                std::bind(&HttpServer::onMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
-            sslConns_[conn] = std::move(sslConn);
-            sslConns_[conn]->startHandshake();
+            // SSL 状态挂在连接上下文中，跟随连接释放，也无需跨线程共享的连接表
+            auto sslConn = std::make_shared<ssl::SslConnection>(conn, sslCtx_.get());
+            context->setSslConnection(sslConn);
+            sslConn->startHandshake();
         }
-        conn->setContext(HttpContext());
     }
     else 
     {
-        if (useSSL_)
+        activeConnections.sub();
+        HttpContext* context = boost::any_cast<HttpContext>(conn->getMutableContext());
+        if (context)
         {
-            sslConns_.erase(conn);
+            connectionManager_.onDisconnected(&context->connectionTimer());
+            context->abortBody();
+        }
+        if (context && context->webSocket())
+        {
+            context->webSocket()->onDisconnected();
         }
     }
 }
@@ -89,68 +209,297 @@ void HttpServer::onMessage(const muduo::net::TcpConnectionPtr &conn,
 {
     try
     {
-        // 是否支持ssl
-        if (useSSL_)
-        {
-            LOG_INFO << "onMessage useSSL_ is true";
-            // 1.查找对应的SSL连接
-            auto it = sslConns_.find(conn);
-            if (it != sslConns_.end())
-            {
-                LOG_INFO << "onMessage sslConns_ is not empty";
-                // 2. SSL连接处理数据
-                it->second->onRead(conn, buf, receiveTime);
-
-                // 3. 如果 SSL 握手还未完成，直接返回
-                if (!it->second->isHandshakeCompleted())
-                {
-                    LOG_INFO << "onMessage sslConns_ is not empty";
-                    return;
-                }
-
-                // 4. 从SSL连接的解密缓冲区获取数据
-                muduo::net::Buffer* decryptedBuf = it->second->getDecryptedBuffer();
-                if (decryptedBuf->readableBytes() == 0)
-                    return; // 没有解密后的数据
-
-                // 5. 使用解密后的数据进行HTTP 处理
-                buf = decryptedBuf; // 将 buf 指向解密后的数据
-                LOG_INFO << "onMessage decryptedBuf is not empty";
-            }
-        }
         // HttpContext 对象用于解析 buf 中的请求报文，并把报文的关键信息封装到 HttpRequest 对象
         HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
-        if (!context->parseRequest(buf, receiveTime)) // 解析一个 http 请求
+        // TLS 连接先解密，明文累积在 SSL 连接的缓冲区中
+        ssl::SslConnection* sslConn = context->sslConnection();
+        if (sslConn)
+        {
+            if (!sslConn->onRead(buf))
+                return;
+            if (!sslConn->isHandshakeCompleted() && !sslConn->isEarlyDataAccepted())
+                return;
+            buf = sslConn->getDecryptedBuffer();
+            // 握手完成前解析出的非幂等请求在此之后处理
+            if (buf->readableBytes() == 0 && !context->gotAll() &&
+                context->state() != HttpContext::kGotHeaders)
+                return;
+        }
+        // 已升级为 WebSocket 的连接不再按 HTTP 解析
+        if (context->webSocket())
+        {
+            context->webSocket()->onData(buf);
+            return;
+        }
+        // 上一个响应结束前不解析下一个请求，数据留在缓冲中，由 onResponseComplete 恢复
+        if (context->responsePending() && context->state() == HttpContext::kExpectRequestLine)
+        {
+            if (buf->readableBytes() > 0)
+                context->pauseRead(conn);
+            return;
+        }
+        // 新请求的第一个字节开始计算请求头超时
+        if (context->state() == HttpContext::kExpectRequestLine && buf->readableBytes() > 0 &&
+            context->connectionTimer().phase == ConnectionPhase::kIdle)
+        {
+            context->setConnectionPhase(conn, ConnectionPhase::kReadingHeader);
+        }
+        if (!context->gotAll() && !context->parseRequest(buf, receiveTime)) // 解析一个 http 请求
+        {
+            // 解析 http 报文过程中出错，或请求超出大小限制
+            rejectRequest(conn, context);
+            buf->retrieveAll();
+            return;
+        }
+        if (context->state() == HttpContext::kGotHeaders)
         {
-            // 解析 http 报文过程中出错
-            conn->send("HTTP/1.1 400 Bad Request\r\n\r\n");
-            conn->shutdown();
+            // 0-RTT 数据可能被重放，握手完成前不读取非幂等请求的请求体
+            if (sslConn && !sslConn->isHandshakeCompleted())
+                return;
+            if (!startBody(conn, context, buf, receiveTime))
+                return;
         }
         // 如果 buf 缓冲区中解析出一个完整的数据包才封装响应报文
         if (context->gotAll())
         {
+            if (context->dispatched())
+            {
+                // 流式请求体读完，处理器已在请求头读完时执行；响应未结束时不限时
+                context->setConnectionPhase(conn, context->responded() ? ConnectionPhase::kIdle
+                                                                       : ConnectionPhase::kBusy);
+                context->reset();
+                return;
+            }
+            // 0-RTT 数据可能被重放，握手完成前只处理幂等的 GET 请求
+            if (sslConn && !sslConn->isHandshakeCompleted() &&
+                context->request().method() != HttpRequest::kGet)
+                return;
+            // 响应结束前不限时，由各响应路径在结束时切回空闲
+            context->setConnectionPhase(conn, ConnectionPhase::kBusy);
+            context->setResponsePending();
+            context->request().setPeerIp(context->peerIp());
             onRequest(conn, context->request());
             context->reset();
+            // 握手请求之后紧跟的帧数据
+            if (context->webSocket() && buf->readableBytes() > 0)
+            {
+                context->webSocket()->onData(buf);
+            }
         }
     }
     catch (const std::exception &e)
     {
         // 捕获异常，返回错误信息
         LOG_ERROR << "Exception in onMessage: " << e.what();
-        conn->send("HTTP/1.1 400 Bad Request\r\n\r\n");
-        conn->shutdown();
+        HttpContext* context = boost::any_cast<HttpContext>(conn->getMutableContext());
+        if (context && context->dispatched())
+            rejectRequest(conn, context);
+        else
+            rejectRequest(conn, HttpResponse::k400BadRequest);
     }
 }
 
-void HttpServer::onRequest(const muduo::net::TcpConnectionPtr &conn, const HttpRequest &req)
+bool HttpServer::startBody(const muduo::net::TcpConnectionPtr& conn, HttpContext* context, muduo::net::Buffer* buf,
+                           muduo::Timestamp receiveTime)
+{
+    HttpRequest& req = context->request();
+    const BodyOptions* options = httpCallback_ ? nullptr : router_.findBodyOptions(req);
+    if (!context->beginBody(options))
+    {
+        rejectRequest(conn, context);
+        buf->retrieveAll();
+        return false;
+    }
+
+    // 客户端发送 Expect: 100-continue 时先等待确认，超出上限的请求在此之前已被拒绝，不会传输请求体
+    std::string expect = findHeaderIgnoreCase(req, "Expect");
+    if (!expect.empty())
+    {
+        if (strcasecmp(expect.c_str(), "100-continue") != 0)
+        {
+            rejectRequest(conn, HttpResponse::k417ExpectationFailed);
+            buf->retrieveAll();
+            return false;
+        }
+        // 请求体已经随请求头到达时不必再确认
+        if (req.getVersion() == "HTTP/1.1" && buf->readableBytes() == 0)
+            HttpContext::send(conn, "HTTP/1.1 100 Continue\r\n\r\n");
+    }
+    context->setConnectionPhase(conn, ConnectionPhase::kReadingBody);
+
+    if (options && options->streaming)
+    {
+        context->setDispatched();
+        context->setResponsePending();
+        req.setPeerIp(context->peerIp());
+        onRequest(conn, req);
+    }
+
+    if (!context->parseRequest(buf, receiveTime))
+    {
+        rejectRequest(conn, context);
+        buf->retrieveAll();
+        return false;
+    }
+    return true;
+}
+
+void HttpServer::rejectRequest(const muduo::net::TcpConnectionPtr& conn, HttpContext* context)
+{
+    if (!context->dispatched())
+    {
+        rejectRequest(conn, context->error());
+        return;
+    }
+    connectionManager_.countRejectedRequest(
+        context->error() == HttpResponse::k413PayloadTooLarge ? "body_too_large" : "bad_request");
+    context->abortBody();
+    conn->forceClose();
+}
+
+void HttpServer::rejectRequest(const muduo::net::TcpConnectionPtr& conn, HttpResponse::HttpStatusCode code)
+{
+    const char* statusLine;
+    const char* reason;
+    switch (code)
+    {
+    case HttpResponse::k413PayloadTooLarge:
+        statusLine = "413 Payload Too Large";
+        reason = "body_too_large";
+        break;
+    case HttpResponse::k414UriTooLong:
+        statusLine = "414 URI Too Long";
+        reason = "header_too_large";
+        break;
+    case HttpResponse::k431RequestHeaderFieldsTooLarge:
+        statusLine = "431 Request Header Fields Too Large";
+        reason = "header_too_large";
+        break;
+    case HttpResponse::k417ExpectationFailed:
+        statusLine = "417 Expectation Failed";
+        reason = "bad_request";
+        break;
+    case HttpResponse::k500InternalServerError:
+        statusLine = "500 Internal Server Error";
+        reason = "body_spill_failed";
+        break;
+    case HttpResponse::k501NotImplemented:
+        statusLine = "501 Not Implemented";
+        reason = "bad_request";
+        break;
+    default:
+        statusLine = "400 Bad Request";
+        reason = "bad_request";
+        break;
+    }
+    connectionManager_.countRejectedRequest(reason);
+
+    std::string response = "HTTP/1.1 ";
+    response += statusLine;
+    response += "\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+    HttpContext::send(conn, response);
+    // 不再读取后续数据；对端迟迟不关闭时，由仍在计时的请求头 / 请求体超时强制关闭
+    conn->stopRead();
+    conn->shutdown();
+}
+
+void HttpServer::sendBodyInChunks(const muduo::net::TcpConnectionPtr& conn, const HttpResponse& response)
+{
+    struct Transfer
+    {
+        std::shared_ptr<const void> owner; // 保证发送期间数据不被释放
+        const char*                 data;
+        size_t                      size;
+        size_t                      offset;
+        bool                        close;
+    };
+    auto transfer = std::make_shared<Transfer>(Transfer{response.sharedBodyOwner(),
+                                                        response.sharedBodyData(),
+                                                        response.sharedBodySize(),
+                                                        0,
+                                                        response.closeConnection()});
+
+    // 发送期间暂停读取，避免流水线请求的响应与正文交错
+    conn->getLoop()->runInLoop([conn, transfer]()
+    {
+        conn->stopRead();
+        auto sendNext = std::make_shared<std::function<void (const muduo::net::TcpConnectionPtr&)>>();
+        *sendNext = [transfer](const muduo::net::TcpConnectionPtr& c)
+        {
+            if (transfer->offset >= transfer->size)
+            {
+                c->setWriteCompleteCallback(muduo::net::WriteCompleteCallback());
+                if (transfer->close)
+                    c->shutdown();
+                else
+                    c->startRead();
+                HttpContext::onResponseComplete(c);
+                return;
+            }
+            size_t len = std::min(kBodyChunkSize, transfer->size - transfer->offset);
+            const char* chunk = transfer->data + transfer->offset;
+            transfer->offset += len;
+            HttpContext::send(c, chunk, len);
+        };
+        // 回调由连接持有，发送结束时清除
+        conn->setWriteCompleteCallback([sendNext](const muduo::net::TcpConnectionPtr& c) { (*sendNext)(c); });
+        (*sendNext)(conn);
+    });
+}
+
+void HttpServer::onRequest(const muduo::net::TcpConnectionPtr &conn, HttpRequest &req)
 {
     const std::string &connection = req.getHeader("Connection");
     bool close = ((connection == "close") ||
                   (req.getVersion() == "HTTP/1.0" && connection != "Keep-Alive"));
     HttpResponse response(close);
 
-    // 根据请求报文信息来封装响应报文对象
-    httpCallback_(req, &response); // 执行 onHttpCallback 函数
+    // 请求上下文在本线程内对处理器可见，投递到其它线程的任务需自行捕获
+    trace::Tracer& tracer = trace::Tracer::instance();
+    trace::TraceContext traceCtx = tracer.newTrace();
+    trace::ScopedTraceContext scopedTrace(traceCtx);
+    trace::Span requestSpan("http.request", traceCtx);
+    // 只有被采样的请求才有可查的追踪记录
+    if (traceCtx.sampled)
+        response.addHeader("X-Request-Id", traceCtx.idString());
+
+    // WebSocket 升级请求不经过中间件和普通路由
+    if (req.method() == HttpRequest::kGet &&
+        headerHasToken(findHeaderIgnoreCase(req, "Upgrade"), "websocket"))
+    {
+        auto wsHandler = router_.findWebSocket(req.path());
+        if (wsHandler)
+        {
+            handleWebSocketUpgrade(conn, req, wsHandler);
+            return;
+        }
+    }
+
+    // 根据请求报文信息来封装响应报文对象；未设置自定义回调时直接走中间件和路由，请求对象无需拷贝
+    if (httpCallback_)
+        httpCallback_(req, &response);
+    else
+        handleRequest(req, &response);
+
+    // 延迟响应：由业务线程生成后经 DeferredResponse 发回本连接，连接在此之前保持忙碌状态
+    if (response.getDeferredCallback()) {
+        HttpResponse::DeferredCallback callback = response.getDeferredCallback();
+        response.defer(nullptr);
+        callback(std::make_shared<DeferredResponse>(conn, std::move(response)));
+        return;
+    }
+
+    // 推送式流响应：先发响应头，之后由业务线程通过 StreamWriter 写入
+    if (response.getStreamStartCallback()) {
+        muduo::net::Buffer buf;
+        response.appendToBuffer(&buf);
+        HttpContext::send(conn, &buf);
+
+        auto writer = std::make_shared<StreamWriter>(conn, response.isChunked(), response.closeConnection());
+        writer->setCompressor(response.getStreamCompressor());
+        response.getStreamStartCallback()(writer);
+        return;
+    }
 
     // 检查是否为流式响应
     if (response.isStreaming()) {
@@ -160,25 +509,36 @@ void HttpServer::onRequest(const muduo::net::TcpConnectionPtr &conn, const HttpR
         // 发送初始响应头
         muduo::net::Buffer buf;
         response.appendToBuffer(&buf);
-        conn->send(&buf);
+        HttpContext::send(conn, &buf);
         
         // 开始流式写入
         onStreamWrite(conn, streamingResponses_[conn].get());
         return;
     }
 
-    // response 设置一个成员，判断是否请求的是文件，如果是文件设置为 true，并且文件位置在这里 send 出去。
+    // 大的共享响应体（如内存映射的静态文件）不整体拷入输出缓冲，按块随写完成事件发送
+    if (response.hasSharedBody() && response.sharedBodySize() > kBodyChunkSize)
+    {
+        muduo::net::Buffer buf;
+        response.appendToBuffer(&buf, false);
+        HttpContext::send(conn, &buf);
+        sendBodyInChunks(conn, response);
+        return;
+    }
+
     muduo::net::Buffer buf;
     response.appendToBuffer(&buf);
-    // 打印完整的响应内容用于调试
-    LOG_INFO << "Sending response:\n" << buf.toStringPiece().as_string();
+    LOG_MODULE("http", TRACE) << "Sending response" << logging::kv("bytes", buf.readableBytes())
+                              << logging::kv("status", static_cast<int>(response.getStatusCode()));
 
-    conn->send(&buf);
+    HttpContext::send(conn, &buf);
     // 如果是短连接的话，返回响应报文后就断开连接
     if (response.closeConnection())
     {
         conn->shutdown();
     }
+    // 短连接同样回到空闲计时，对端迟迟不关闭时由空闲超时回收
+    HttpContext::onResponseComplete(conn);
 }
 
 // 流式响应处理
@@ -203,39 +563,104 @@ void HttpServer::onStreamWrite(const muduo::net::TcpConnectionPtr& conn, HttpRes
             if (resp->closeConnection()) {
                 conn->shutdown();
             }
+            HttpContext::onResponseComplete(conn);
         }
     } else {
         // 没有回调函数，结束流式传输
         streamingResponses_.erase(conn);
+        HttpContext::onResponseComplete(conn);
     }
 }
 
-// 执行请求对应的路由处理函数
-void HttpServer::handleRequest(const HttpRequest &req, HttpResponse *resp)
+void HttpServer::handleWebSocketUpgrade(const muduo::net::TcpConnectionPtr& conn,
+                                        const HttpRequest& req,
+                                        const websocket::WebSocketHandlerPtr& handler)
 {
-    try
+    HttpResponse response(true);
+    response.setVersion(req.getVersion());
+
+    std::string key = findHeaderIgnoreCase(req, "Sec-WebSocket-Key");
+    std::string version = findHeaderIgnoreCase(req, "Sec-WebSocket-Version");
+    bool valid = req.getVersion() == "HTTP/1.1" &&
+                 headerHasToken(findHeaderIgnoreCase(req, "Connection"), "upgrade") &&
+                 !key.empty();
+
+    auto ws = std::make_shared<websocket::WebSocketConnection>(conn, handler);
+    if (!valid)
     {
-        // 处理请求前的中间件
-        HttpRequest mutableReq = req;
-        middlewareChain_.processBefore(mutableReq);
+        response.setStatusCode(HttpResponse::k400BadRequest);
+        response.setStatusMessage("Bad Request");
+    }
+    else if (version != "13")
+    {
+        response.setStatusCode(HttpResponse::k426UpgradeRequired);
+        response.setStatusMessage("Upgrade Required");
+        response.addHeader("Sec-WebSocket-Version", "13");
+    }
+    else if (!handler->onUpgrade(req, &response, ws))
+    {
+        if (response.getStatusCode() == HttpResponse::kUnknown)
+        {
+            response.setStatusCode(HttpResponse::k403Forbidden);
+            response.setStatusMessage("Forbidden");
+        }
+    }
+    else
+    {
+        response.setStatusCode(HttpResponse::k101SwitchingProtocols);
+        response.setStatusMessage("Switching Protocols");
+        response.setCloseConnection(false);
+        response.addHeader("Upgrade", "websocket");
+        response.addHeader("Connection", "Upgrade");
+        response.addHeader("Sec-WebSocket-Accept", websocket::WebSocketCodec::computeAcceptKey(key));
 
-        // 路由处理
-        if (!router_.route(mutableReq, resp))
+        std::string extensions = findHeaderIgnoreCase(req, "Sec-WebSocket-Extensions");
+        if (!extensions.empty())
         {
-            LOG_INFO << "请求 url：" << req.method() << " " << req.path();
-            LOG_INFO << "未找到路由，返回404";
-            resp->setStatusCode(HttpResponse::k404NotFound);
-            resp->setStatusMessage("Not Found");
-            resp->setCloseConnection(true);
+            auto deflate = std::make_unique<websocket::WebSocketDeflate>();
+            std::string accepted;
+            if (deflate->negotiate(extensions, &accepted))
+            {
+                response.addHeader("Sec-WebSocket-Extensions", accepted);
+                ws->setDeflate(std::move(deflate));
+            }
         }
+    }
+
+    muduo::net::Buffer buf;
+    response.appendToBuffer(&buf);
+    HttpContext::send(conn, &buf);
 
-        // 处理响应后的中间件
-        middlewareChain_.processAfter(*resp);
+    if (response.getStatusCode() != HttpResponse::k101SwitchingProtocols)
+    {
+        conn->shutdown();
+        HttpContext::onResponseComplete(conn);
+        return;
     }
-    catch (const HttpResponse& res) 
+
+    HttpContext* context = boost::any_cast<HttpContext>(conn->getMutableContext());
+    context->setWebSocket(ws);
+    context->setConnectionPhase(conn, ConnectionPhase::kUpgraded);
+    handler->onOpen(ws);
+}
+
+// 执行请求对应的路由处理函数
+void HttpServer::handleRequest(HttpRequest &req, HttpResponse *resp)
+{
+    try
     {
-        // 处理中间件抛出的响应（如CORS预检请求）
-        *resp = res;
+        // 全局中间件包裹路由处理，中间件可直接生成响应跳过路由
+        middlewareChain_.run(req, resp, [this, &req, resp]()
+        {
+            if (!router_.route(req, resp))
+            {
+                LOG_MODULE_RATE("http", INFO, 5) << "Route not found" << logging::kv("method", static_cast<int>(req.method()))
+                                                 << logging::kv("path", req.path());
+                resp->setStatusCode(HttpResponse::k404NotFound);
+                resp->setStatusMessage("Not Found");
+                resp->setCloseConnection(true);
+            }
+        });
     }
     catch (const std::exception& e) 
     {
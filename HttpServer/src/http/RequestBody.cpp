@@ -0,0 +1,90 @@
+#include "http/RequestBody.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include <muduo/base/Logging.h>
+
+namespace http
+{
+
+std::shared_ptr<SpilledBody> SpilledBody::create(const std::string& dir)
+{
+    std::string path = dir + "/http-body-XXXXXX";
+    int fd = ::mkostemp(&path[0], O_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_ERROR << "Failed to create request body file in " << dir << ": " << strerror(errno);
+        return nullptr;
+    }
+    return std::shared_ptr<SpilledBody>(new SpilledBody(fd, std::move(path)));
+}
+
+SpilledBody::~SpilledBody()
+{
+    ::close(fd_);
+    ::unlink(path_.c_str());
+}
+
+bool SpilledBody::write(const char* data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = ::write(fd_, data, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            LOG_ERROR << "Failed to write request body file " << path_ << ": " << strerror(errno);
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+        size_ += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+std::string SpilledBody::readAll() const
+{
+    std::string content(static_cast<size_t>(size_), '\0');
+    size_t offset = 0;
+    while (offset < content.size())
+    {
+        ssize_t n = ::pread(fd_, &content[offset], content.size() - offset, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        offset += static_cast<size_t>(n);
+    }
+    content.resize(offset);
+    return content;
+}
+
+void BodyReader::append(const char* data, size_t len)
+{
+    received_ += len;
+    if (dataCallback_)
+        dataCallback_(data, len);
+}
+
+void BodyReader::finish(bool complete)
+{
+    if (finished_)
+        return;
+    finished_ = true;
+    // 回调通常持有延迟响应等对象，结束后释放以免形成引用环
+    DataCallback data;
+    data.swap(dataCallback_);
+    EndCallback end;
+    end.swap(endCallback_);
+    if (end)
+        end(complete);
+}
+
+} // namespace http
@@ -0,0 +1,126 @@
+#include "http/StreamWriter.h"
+#include "http/HttpContext.h"
+
+#include <cstdio>
+
+#include <muduo/net/EventLoop.h>
+
+namespace http
+{
+
+StreamWriter::StreamWriter(const muduo::net::TcpConnectionPtr& conn, bool chunked, bool closeOnEnd)
+    : conn_(conn)
+    , chunked_(chunked)
+    , closeOnEnd_(closeOnEnd)
+    , finished_(false)
+{}
+
+void StreamWriter::write(const std::string& data, bool flush)
+{
+    if (data.empty() || finished())
+        return;
+    writeInLoop(data, flush, false);
+}
+
+void StreamWriter::sendEvent(const std::string& event, const std::string& data)
+{
+    // 事件边界处 flush，客户端可立即解压出完整事件
+    write(formatEvent(event, data), true);
+}
+
+void StreamWriter::end()
+{
+    bool expected = false;
+    if (!finished_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return;
+    writeInLoop(std::string(), true, true);
+}
+
+bool StreamWriter::connected() const
+{
+    auto conn = conn_.lock();
+    return conn && conn->connected();
+}
+
+std::string StreamWriter::formatEvent(const std::string& event, const std::string& data)
+{
+    std::string out;
+    out.reserve(event.size() + data.size() + 16);
+    if (!event.empty())
+    {
+        out += "event: ";
+        out += event;
+        out += "\n";
+    }
+    // 多行数据需要逐行加 data: 前缀
+    size_t start = 0;
+    while (true)
+    {
+        size_t pos = data.find('\n', start);
+        out += "data: ";
+        out.append(data, start, pos == std::string::npos ? std::string::npos : pos - start);
+        out += "\n";
+        if (pos == std::string::npos)
+            break;
+        start = pos + 1;
+    }
+    out += "\n";
+    return out;
+}
+
+void StreamWriter::writeInLoop(const std::string& data, bool flush, bool last)
+{
+    auto conn = conn_.lock();
+    if (!conn || !conn->connected())
+        return;
+
+    bool chunked = chunked_;
+    bool closeOnEnd = closeOnEnd_ || !chunked_;
+    // 投递到 IO 线程，保证与其他写操作的顺序；压缩器的状态也只在 IO 线程中修改
+    conn->getLoop()->runInLoop([conn, data, flush, last, chunked, closeOnEnd, compressor = compressor_]() mutable {
+        if (!conn->connected())
+            return;
+
+        std::string payload;
+        if (compressor)
+        {
+            if (!data.empty())
+                compressor->compress(data.data(), data.size(), flush && !last, &payload);
+            if (last)
+                compressor->finish(&payload);
+        }
+        else
+        {
+            payload = std::move(data);
+        }
+
+        std::string frame;
+        if (chunked)
+        {
+            char sizeLine[24];
+            if (!payload.empty())
+            {
+                snprintf(sizeLine, sizeof sizeLine, "%zx\r\n", payload.size());
+                frame.reserve(payload.size() + 32);
+                frame += sizeLine;
+                frame += payload;
+                frame += "\r\n";
+            }
+            if (last)
+                frame += "0\r\n\r\n";
+        }
+        else
+        {
+            frame = std::move(payload);
+        }
+
+        if (!frame.empty())
+            HttpContext::send(conn, frame);
+        if (last && closeOnEnd)
+            conn->shutdown();
+        if (last)
+            HttpContext::onResponseComplete(conn);
+    });
+}
+
+} // namespace http
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <muduo/base/AsyncLogging.h>
+
+#include "logging/Log.h"
+
+namespace http
+{
+namespace logging
+{
+
+namespace
+{
+
+std::mutex& moduleMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::map<std::string, std::unique_ptr<LogModule>>& modules()
+{
+    static std::map<std::string, std::unique_ptr<LogModule>> registry;
+    return registry;
+}
+
+std::unique_ptr<muduo::AsyncLogging> gAsyncLog;
+
+void asyncOutput(const char* msg, int len)
+{
+    gAsyncLog->append(msg, len);
+}
+
+// 只在 FATAL 时被调用：abort 之前停止后台线程，把缓冲中的日志写出
+void asyncFlush()
+{
+    gAsyncLog->stop();
+}
+
+void stdoutOutput(const char* msg, int len)
+{
+    fwrite(msg, 1, static_cast<size_t>(len), stdout);
+}
+
+int64_t monotonicNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+LogModule& LogModule::get(const char* name)
+{
+    std::lock_guard<std::mutex> lock(moduleMutex());
+    auto& module = modules()[name];
+    if (!module)
+        module.reset(new LogModule(name));
+    return *module;
+}
+
+void LogModule::setLevel(const std::string& name, muduo::Logger::LogLevel level)
+{
+    LogModule& module = get(name.c_str());
+    module.level_.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogRateLimiter::LogRateLimiter(double perSecond, int burst)
+    : intervalNs_(static_cast<int64_t>(1e9 / std::max(perSecond, 1e-3)))
+    , toleranceNs_(intervalNs_ * (std::max(burst > 0 ? burst : static_cast<int>(perSecond), 1) - 1))
+    , tat_(0)
+    , dropped_(0)
+{
+}
+
+uint64_t LogRateLimiter::acquire()
+{
+    int64_t now = monotonicNanos();
+    int64_t tat = tat_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        int64_t start = std::max(tat, now);
+        if (start - now > toleranceNs_)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return kDenied;
+        }
+        if (tat_.compare_exchange_weak(tat, start + intervalNs_, std::memory_order_relaxed))
+            break;
+    }
+    return dropped_.exchange(0, std::memory_order_relaxed);
+}
+
+void appendQuoted(muduo::LogStream& stream, const char* data, size_t len)
+{
+    bool needQuote = len == 0;
+    for (size_t i = 0; i < len && !needQuote; ++i)
+    {
+        char c = data[i];
+        needQuote = c == ' ' || c == '"' || c == '=' || c == '\t' || c == '\n' || c == '\r';
+    }
+    if (!needQuote)
+    {
+        stream << muduo::StringPiece(data, static_cast<int>(len));
+        return;
+    }
+
+    std::string quoted;
+    quoted.reserve(len + 2);
+    quoted += '"';
+    for (size_t i = 0; i < len; ++i)
+    {
+        char c = data[i];
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        if (c == '\n')
+        {
+            quoted += "\\n";
+            continue;
+        }
+        if (c == '\r')
+        {
+            quoted += "\\r";
+            continue;
+        }
+        quoted += c;
+    }
+    quoted += '"';
+    stream << quoted;
+}
+
+void startAsyncLogging(const std::string& basename, long rollSize, int flushInterval)
+{
+    if (gAsyncLog)
+        return;
+    gAsyncLog.reset(new muduo::AsyncLogging(basename, rollSize, flushInterval));
+    gAsyncLog->start();
+    muduo::Logger::setOutput(asyncOutput);
+    muduo::Logger::setFlush(asyncFlush);
+}
+
+void stopAsyncLogging()
+{
+    if (!gAsyncLog)
+        return;
+    // 之后的日志（如退出流程）直接写标准输出
+    muduo::Logger::setOutput(stdoutOutput);
+    muduo::Logger::setFlush(nullptr);
+    gAsyncLog->stop();
+}
+
+} // namespace logging
+} // namespace http
@@ -0,0 +1,87 @@
+#include "metrics/Metrics.h"
+
+namespace http
+{
+namespace metrics
+{
+
+size_t currentShard()
+{
+    static std::atomic<size_t> nextShard{0};
+    thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kShardCount;
+    return shard;
+}
+
+uint64_t Counter::value() const
+{
+    uint64_t total = 0;
+    for (const auto& shard : shards_)
+    {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+Histogram::Histogram(const HistogramOptions& options)
+    : options_(options)
+    , bucketCount_(bucketIndex((uint64_t(1) << options.maxExp) - 1) + 1)
+{
+    for (auto& shard : shards_)
+    {
+        // 最后一个槽位记录超出 2^maxExp 的值
+        shard.buckets.reset(new std::atomic<uint64_t>[bucketCount_ + 1]);
+        for (size_t i = 0; i <= bucketCount_; ++i)
+        {
+            shard.buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+size_t Histogram::bucketIndex(uint64_t value)
+{
+    if (value < static_cast<uint64_t>(kSubBuckets))
+        return static_cast<size_t>(value);
+    // value 位于 [2^e, 2^(e+1))，取最高位之后的两位作为子桶
+    int e = 63 - __builtin_clzll(value);
+    size_t sub = static_cast<size_t>((value >> (e - 2)) & (kSubBuckets - 1));
+    return static_cast<size_t>(kSubBuckets * (e - 1)) + sub;
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index)
+{
+    if (index < static_cast<size_t>(kSubBuckets))
+        return index;
+    int e = static_cast<int>(index / kSubBuckets) + 1;
+    uint64_t sub = index % kSubBuckets;
+    return ((kSubBuckets + sub + 1) << (e - 2)) - 1;
+}
+
+void Histogram::observe(uint64_t value)
+{
+    Shard& shard = shards_[currentShard()];
+    size_t index = bucketIndex(value);
+    if (index > bucketCount_)
+        index = bucketCount_;
+    shard.buckets[index].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const
+{
+    Snapshot snap;
+    snap.buckets.assign(bucketCount_ + 1, 0);
+    for (const auto& shard : shards_)
+    {
+        for (size_t i = 0; i <= bucketCount_; ++i)
+        {
+            snap.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        snap.count += shard.count.load(std::memory_order_relaxed);
+        snap.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+} // namespace metrics
+} // namespace http
@@ -0,0 +1,198 @@
+#include "metrics/MetricsRegistry.h"
+
+#include <cstdio>
+
+namespace http
+{
+namespace metrics
+{
+
+namespace
+{
+
+void appendNumber(std::string* out, double value)
+{
+    char buf[32];
+    snprintf(buf, sizeof buf, "%.9g", value);
+    *out += buf;
+}
+
+void appendNumber(std::string* out, uint64_t value)
+{
+    *out += std::to_string(value);
+}
+
+// 在已格式化的标签串中追加一个标签（直方图的 le）
+std::string withLabel(const std::string& labels, const std::string& extra)
+{
+    if (labels.empty())
+        return "{" + extra + "}";
+    return labels.substr(0, labels.size() - 1) + "," + extra + "}";
+}
+
+} // namespace
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+std::string MetricsRegistry::formatLabels(const Labels& labels)
+{
+    if (labels.empty())
+        return std::string();
+    std::string out = "{";
+    for (size_t i = 0; i < labels.size(); ++i)
+    {
+        if (i > 0)
+            out += ",";
+        out += labels[i].first;
+        out += "=\"";
+        for (char c : labels[i].second)
+        {
+            if (c == '\\' || c == '"')
+                out += '\\';
+            if (c == '\n')
+            {
+                out += "\\n";
+                continue;
+            }
+            out += c;
+        }
+        out += "\"";
+    }
+    out += "}";
+    return out;
+}
+
+MetricsRegistry::Series& MetricsRegistry::findOrCreate(const std::string& name, const std::string& help,
+                                                        Type type, const Labels& labels)
+{
+    Family& family = families_[name];
+    if (family.series.empty())
+    {
+        family.help = help;
+        family.type = type;
+    }
+    std::string formatted = formatLabels(labels);
+    for (auto& series : family.series)
+    {
+        if (series.labels == formatted)
+            return series;
+    }
+    family.series.emplace_back();
+    family.series.back().labels = std::move(formatted);
+    return family.series.back();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const Labels& labels)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& series = findOrCreate(name, help, Type::kCounter, labels);
+    if (!series.counter)
+        series.counter.reset(new Counter);
+    return *series.counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const Labels& labels)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& series = findOrCreate(name, help, Type::kGauge, labels);
+    if (!series.gauge)
+        series.gauge.reset(new Gauge);
+    return *series.gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const Labels& labels,
+                                      const HistogramOptions& options)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& series = findOrCreate(name, help, Type::kHistogram, labels);
+    if (!series.histogram)
+        series.histogram.reset(new Histogram(options));
+    return *series.histogram;
+}
+
+void MetricsRegistry::gaugeCallback(const std::string& name, const std::string& help, const Labels& labels,
+                                    std::function<double()> callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& series = findOrCreate(name, help, Type::kGauge, labels);
+    series.callback = std::move(callback);
+}
+
+void MetricsRegistry::counterCallback(const std::string& name, const std::string& help, const Labels& labels,
+                                      std::function<double()> callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& series = findOrCreate(name, help, Type::kCounter, labels);
+    series.callback = std::move(callback);
+}
+
+std::string MetricsRegistry::render() const
+{
+    std::string out;
+    out.reserve(16 * 1024);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : families_)
+    {
+        const std::string& name = entry.first;
+        const Family& family = entry.second;
+        const char* type = family.type == Type::kCounter ? "counter"
+                         : family.type == Type::kGauge ? "gauge" : "histogram";
+        out += "# HELP " + name + " " + family.help + "\n";
+        out += "# TYPE " + name + " " + type + "\n";
+
+        for (const auto& series : family.series)
+        {
+            if (series.counter || series.gauge || series.callback)
+            {
+                out += name + series.labels + " ";
+                if (series.counter)
+                    appendNumber(&out, series.counter->value());
+                else if (series.gauge)
+                    appendNumber(&out, static_cast<double>(series.gauge->value()));
+                else
+                    appendNumber(&out, series.callback());
+                out += "\n";
+                continue;
+            }
+            if (!series.histogram)
+                continue;
+
+            const Histogram& histogram = *series.histogram;
+            const HistogramOptions& options = histogram.options();
+            Histogram::Snapshot snap = histogram.snapshot();
+            uint64_t minBound = uint64_t(1) << options.minExp;
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < histogram.bucketCount(); ++i)
+            {
+                cumulative += snap.buckets[i];
+                // 桶内都是不超过 upper 的整数，以 upper + 1 作为边界便于阅读
+                uint64_t bound = Histogram::bucketUpperBound(i) + 1;
+                if (bound < minBound)
+                    continue;
+                char le[48];
+                snprintf(le, sizeof le, "le=\"%.9g\"", static_cast<double>(bound) * options.scale);
+                out += name + "_bucket" + withLabel(series.labels, le) + " ";
+                appendNumber(&out, cumulative);
+                out += "\n";
+            }
+            out += name + "_bucket" + withLabel(series.labels, "le=\"+Inf\"") + " ";
+            appendNumber(&out, snap.count);
+            out += "\n";
+            out += name + "_sum" + series.labels + " ";
+            appendNumber(&out, static_cast<double>(snap.sum) * options.scale);
+            out += "\n";
+            out += name + "_count" + series.labels + " ";
+            appendNumber(&out, snap.count);
+            out += "\n";
+        }
+    }
+    return out;
+}
+
+} // namespace metrics
+} // namespace http
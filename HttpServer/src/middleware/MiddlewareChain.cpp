@@ -7,30 +7,36 @@ namespace http
 namespace middleware
 {
 
-void MiddlewareChain::addMiddleware(std::shared_ptr<Middleware> middleware)
+void MiddlewareChain::addMiddleware(MiddlewarePtr middleware)
 {
-    middlewares_.push_back(middleware);
+    if (middleware)
+    {
+        middlewares_.push_back(std::move(middleware));
+    }
 }
 
-void MiddlewareChain::processBefore(HttpRequest &request)
+bool MiddlewareChain::processBefore(HttpRequest &request, HttpResponse *response, size_t *entered)
 {
-    for (auto &middleware : middlewares_)
+    for (size_t i = 0; i < middlewares_.size(); ++i)
     {
-        middleware->before(request);
+        *entered = i + 1;
+        if (middlewares_[i]->before(request, response) == Middleware::kRespond)
+        {
+            // 短路的中间件自身也算已进入，它之前的中间件仍会执行 after（如给预检响应加头）
+            return false;
+        }
     }
+    return true;
 }
 
-void MiddlewareChain::processAfter(HttpResponse &response)
+void MiddlewareChain::processAfter(const HttpRequest &request, HttpResponse &response, size_t entered)
 {
     try
     {
         // 反向处理响应，以保持中间件的正确执行顺序
-        for (auto it = middlewares_.rbegin(); it != middlewares_.rend(); ++it)
+        for (size_t i = entered; i > 0; --i)
         {
-            if (*it)
-            { // 添加空指针检查
-                (*it)->after(response);
-            }
+            middlewares_[i - 1]->after(request, response);
         }
     }
     catch (const std::exception &e)
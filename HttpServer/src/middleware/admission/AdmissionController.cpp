@@ -0,0 +1,88 @@
+#include "middleware/admission/AdmissionController.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <muduo/base/Logging.h>
+
+#include "metrics/MetricsRegistry.h"
+
+namespace http
+{
+namespace middleware
+{
+
+namespace
+{
+
+const char kSignalName[] = "admission_signal_value";
+const char kSignalHelp[] = "Overload signals sampled by the admission controller";
+
+} // namespace
+
+AdmissionController::AdmissionController(const AdmissionOptions& options)
+    : options_(options)
+    , overloaded_(false)
+{
+    auto& registry = metrics::MetricsRegistry::instance();
+    loopLag_.name = "loop_lag_ms";
+    loopLag_.threshold = options_.maxLoopLagMs;
+    loopLag_.gauge = &registry.gauge(kSignalName, kSignalHelp, {{"signal", loopLag_.name}});
+    overloadedGauge_ = &registry.gauge("admission_overloaded", "1 while expensive requests are being shed");
+}
+
+void AdmissionController::addSignal(const std::string& name, std::function<double()> probe, double threshold)
+{
+    metrics::Gauge* gauge = &metrics::MetricsRegistry::instance().gauge(kSignalName, kSignalHelp, {{"signal", name}});
+    signals_.push_back(Signal{name, std::move(probe), threshold, gauge});
+}
+
+void AdmissionController::start(muduo::net::EventLoop* loop)
+{
+    lastSample_ = muduo::Timestamp::now();
+    loop->runEvery(options_.interval, [this]() { sample(); });
+}
+
+void AdmissionController::update(double value, const Signal& signal, bool* over, bool* recovered) const
+{
+    signal.gauge->set(std::llround(value));
+    if (signal.threshold <= 0)
+        return;
+    if (value > signal.threshold)
+        *over = true;
+    if (value > signal.threshold * options_.recoverRatio)
+        *recovered = false;
+}
+
+void AdmissionController::sample()
+{
+    // 定时器实际触发时间比预期晚多少，即主循环被阻塞的时长
+    muduo::Timestamp now = muduo::Timestamp::now();
+    double lagMs = (muduo::timeDifference(now, lastSample_) - options_.interval) * 1000;
+    lastSample_ = now;
+
+    bool over = false;
+    bool recovered = true;
+    update(std::max(lagMs, 0.0), loopLag_, &over, &recovered);
+    for (const auto& signal : signals_)
+    {
+        update(signal.probe(), signal, &over, &recovered);
+    }
+
+    bool wasOverloaded = overloaded();
+    if (!wasOverloaded && over)
+    {
+        overloaded_.store(true, std::memory_order_relaxed);
+        overloadedGauge_->set(1);
+        LOG_WARN << "Admission control: overloaded, shedding expensive requests";
+    }
+    else if (wasOverloaded && recovered)
+    {
+        overloaded_.store(false, std::memory_order_relaxed);
+        overloadedGauge_->set(0);
+        LOG_WARN << "Admission control: load recovered";
+    }
+}
+
+} // namespace middleware
+} // namespace http
@@ -0,0 +1,42 @@
+#include "middleware/admission/AdmissionMiddleware.h"
+
+#include "metrics/MetricsRegistry.h"
+
+namespace http
+{
+namespace middleware
+{
+
+AdmissionMiddleware::AdmissionMiddleware(AdmissionControllerPtr controller, const std::string& route)
+    : controller_(std::move(controller))
+    , shed_(&metrics::MetricsRegistry::instance().counter(
+          "http_requests_shed_total", "Requests rejected with 503 by admission control", {{"route", route}}))
+{
+}
+
+Middleware::Action AdmissionMiddleware::before(HttpRequest& request, HttpResponse* response)
+{
+    if (!controller_->overloaded())
+    {
+        return kContinue;
+    }
+
+    shed_->inc();
+    static const std::string body = "{\"success\":false,\"error\":\"Server is busy, please retry later\"}";
+    response->setStatusLine(request.getVersion(), HttpResponse::k503ServiceUnavailable, "Service Unavailable");
+    response->setCloseConnection(false);
+    response->addHeader("Retry-After", std::to_string(controller_->retryAfter()));
+    response->setContentType("application/json");
+    response->setContentLength(body.size());
+    response->setBody(body);
+    return kRespond;
+}
+
+void AdmissionMiddleware::after(const HttpRequest& request, HttpResponse& response)
+{
+    (void)request;
+    (void)response;
+}
+
+} // namespace middleware
+} // namespace http
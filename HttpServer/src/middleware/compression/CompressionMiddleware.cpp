@@ -0,0 +1,152 @@
+#include <cstdlib>
+#include <strings.h>
+
+#include <muduo/base/Logging.h>
+
+#include "middleware/compression/CompressionMiddleware.h"
+
+namespace http
+{
+namespace middleware
+{
+
+namespace
+{
+
+// 解析 Accept-Encoding 中某个编码的 q 值，未出现时返回 -1
+double qualityOf(const std::string& header, const char* name)
+{
+    double wildcard = -1;
+    size_t pos = 0;
+    while (pos < header.size())
+    {
+        size_t comma = header.find(',', pos);
+        if (comma == std::string::npos)
+            comma = header.size();
+        size_t begin = header.find_first_not_of(" \t", pos);
+        if (begin < comma)
+        {
+            size_t end = header.find_first_of(" \t;", begin);
+            if (end == std::string::npos || end > comma)
+                end = comma;
+            double q = 1.0;
+            size_t qpos = header.find("q=", end);
+            if (qpos < comma)
+                q = std::strtod(header.c_str() + qpos + 2, nullptr);
+
+            std::string token = header.substr(begin, end - begin);
+            if (strcasecmp(token.c_str(), name) == 0)
+                return q;
+            if (token == "*")
+                wildcard = q;
+        }
+        pos = comma + 1;
+    }
+    return wildcard;
+}
+
+} // namespace
+
+CompressionMiddleware::CompressionMiddleware(const CompressionConfig& config) : config_(config) {}
+
+Middleware::Action CompressionMiddleware::before(HttpRequest& request, HttpResponse* response)
+{
+    (void)request;
+    (void)response;
+    return kContinue;
+}
+
+void CompressionMiddleware::after(const HttpRequest& request, HttpResponse& response)
+{
+    HttpResponse::HttpStatusCode status = response.getStatusCode();
+    if (status == HttpResponse::k101SwitchingProtocols ||
+        status == HttpResponse::k204NoContent ||
+        status == HttpResponse::k304NotModified ||
+        request.method() == HttpRequest::kHead)
+        return;
+
+    // 已编码的响应（如预压缩的静态文件）和拉取式流响应不处理
+    if (!response.getHeader("Content-Encoding").empty() ||
+        response.hasSharedBody() || response.isStreaming())
+        return;
+
+    if (!isCompressibleType(response.getHeader("Content-Type")))
+        return;
+
+    bool stream = static_cast<bool>(response.getStreamStartCallback());
+    if (stream ? !config_.streaming : response.getBody().size() < config_.minSize)
+        return;
+
+    // 结果依赖 Accept-Encoding，缓存需要区分
+    const std::string& vary = response.getHeader("Vary");
+    if (vary.empty())
+        response.addHeader("Vary", "Accept-Encoding");
+    else if (vary.find("Accept-Encoding") == std::string::npos)
+        response.addHeader("Vary", vary + ", Accept-Encoding");
+
+    ContentEncoding encoding = negotiate(request.getHeader("Accept-Encoding"));
+    if (encoding == ContentEncoding::kIdentity)
+        return;
+
+    if (stream)
+    {
+        StreamCompressorPtr compressor = StreamCompressor::create(encoding, config_.level);
+        if (!compressor)
+            return;
+        // 压缩后长度未知，非 chunked 的流以关闭连接结束
+        if (!response.isChunked())
+            response.removeHeader("Content-Length");
+        response.addHeader("Content-Encoding", contentEncodingName(encoding));
+        response.setStreamCompressor(std::move(compressor));
+        return;
+    }
+
+    std::string compressed;
+    if (!StreamCompressor::compressAll(encoding, config_.level, response.getBody(), &compressed) ||
+        compressed.size() >= response.getBody().size())
+        return;
+
+    LOG_DEBUG << "Compressed response " << response.getBody().size() << " -> " << compressed.size()
+              << " bytes (" << contentEncodingName(encoding) << ")";
+    response.setContentLength(compressed.size());
+    response.setBody(std::move(compressed));
+    response.addHeader("Content-Encoding", contentEncodingName(encoding));
+}
+
+ContentEncoding CompressionMiddleware::negotiate(const std::string& acceptEncoding) const
+{
+    if (acceptEncoding.empty())
+        return ContentEncoding::kIdentity;
+
+    ContentEncoding best = ContentEncoding::kIdentity;
+    double bestQ = 0;
+    for (ContentEncoding encoding : config_.encodings)
+    {
+        if (!contentEncodingSupported(encoding))
+            continue;
+        // 同 q 值时保留配置中靠前的编码
+        double q = qualityOf(acceptEncoding, contentEncodingName(encoding));
+        if (q > bestQ)
+        {
+            best = encoding;
+            bestQ = q;
+        }
+    }
+    return best;
+}
+
+bool CompressionMiddleware::isCompressibleType(const std::string& contentType) const
+{
+    if (contentType.empty())
+        return false;
+    std::string type = contentType.substr(0, contentType.find(';'));
+    for (const auto& rule : config_.contentTypes)
+    {
+        if (rule.back() == '/' ? type.compare(0, rule.size(), rule) == 0 : type == rule)
+            return true;
+    }
+    return false;
+}
+
+} // namespace middleware
+} // namespace http
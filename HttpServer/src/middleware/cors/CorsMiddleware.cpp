@@ -1,6 +1,5 @@
 #include <algorithm>
 #include <sstream>
-#include <iostream>
 
 #include <muduo/base/Logging.h>
 
@@ -11,101 +10,100 @@ namespace http
 namespace middleware 
 {
 
-CorsMiddleware::CorsMiddleware(const CorsConfig& config) : config_(config) {}
-
-void CorsMiddleware::before(HttpRequest& request) 
+CorsMiddleware::CorsMiddleware(const CorsConfig& config)
+    : config_(config)
+    , allowAll_(std::find(config.allowedOrigins.begin(), config.allowedOrigins.end(), "*")
+                != config.allowedOrigins.end())
 {
-    LOG_DEBUG << "CorsMiddleware::before - Processing request";
-    
-    if (request.method() == HttpRequest::Method::kOptions) 
+    if (allowAll_)
     {
-        LOG_INFO << "Processing CORS preflight request";
-        HttpResponse response;
-        handlePreflightRequest(request, response);
-        throw response;
+        wildcardBlocks_ = buildBlocks("*");
     }
-}
-
-void CorsMiddleware::after(HttpResponse& response) 
-{
-    LOG_DEBUG << "CorsMiddleware::after - Processing response";
-    
-    // 直接添加 CORS 头，简化处理逻辑
-    if (!config_.allowedOrigins.empty()) 
+    else
     {
-        // 如果允许所有源
-        if (std::find(config_.allowedOrigins.begin(), config_.allowedOrigins.end(), "*") 
-            != config_.allowedOrigins.end()) 
+        for (const auto& origin : config_.allowedOrigins)
         {
-            addCorsHeaders(response, "*");
-        } 
-        else 
-        {
-            // 添加第一个允许的源
-            addCorsHeaders(response, config_.allowedOrigins[0]);
+            originBlocks_[origin] = buildBlocks(origin);
         }
     }
 }
 
-bool CorsMiddleware::isOriginAllowed(const std::string& origin) const 
+Middleware::Action CorsMiddleware::before(HttpRequest& request, HttpResponse* response) 
 {
-    return config_.allowedOrigins.empty() || 
-           std::find(config_.allowedOrigins.begin(), 
-                    config_.allowedOrigins.end(), "*") != config_.allowedOrigins.end() ||
-           std::find(config_.allowedOrigins.begin(), 
-                    config_.allowedOrigins.end(), origin) != config_.allowedOrigins.end();
+    if (request.method() != HttpRequest::kOptions) 
+    {
+        return kContinue;
+    }
+
+    // 预检请求直接在这里应答，不再进入路由
+    const HeaderBlocks* blocks = findBlocks(request.getHeader("Origin"));
+    response->setCloseConnection(false);
+    if (!blocks)
+    {
+        LOG_WARN << "Origin not allowed: " << request.getHeader("Origin");
+        response->setStatusLine(request.getVersion(), HttpResponse::k403Forbidden, "Forbidden");
+        response->setContentLength(0);
+        return kRespond;
+    }
+
+    response->setStatusLine(request.getVersion(), HttpResponse::k204NoContent, "No Content");
+    response->addRawHeaders(blocks->preflight);
+    return kRespond;
 }
 
-void CorsMiddleware::handlePreflightRequest(const HttpRequest& request, 
-                                          HttpResponse& response) 
+void CorsMiddleware::after(const HttpRequest& request, HttpResponse& response) 
 {
-    const std::string& origin = request.getHeader("Origin");
-    
-    if (!isOriginAllowed(origin)) 
+    // 预检响应已在 before 中带上完整的头部
+    if (request.method() == HttpRequest::kOptions)
     {
-        LOG_WARN << "Origin not allowed: " << origin;
-        response.setStatusCode(HttpResponse::k403Forbidden);
         return;
     }
 
-    addCorsHeaders(response, origin);
-    response.setStatusCode(HttpResponse::k204NoContent);
-    LOG_INFO << "Preflight request processed successfully";
+    const HeaderBlocks* blocks = findBlocks(request.getHeader("Origin"));
+    if (blocks)
+    {
+        response.addRawHeaders(blocks->simple);
+    }
 }
 
-void CorsMiddleware::addCorsHeaders(HttpResponse& response, 
-                                  const std::string& origin) 
+const CorsMiddleware::HeaderBlocks* CorsMiddleware::findBlocks(const std::string& origin) const
 {
-    try 
+    if (allowAll_)
     {
-        response.addHeader("Access-Control-Allow-Origin", origin);
-        
-        if (config_.allowCredentials) 
-        {
-            response.addHeader("Access-Control-Allow-Credentials", "true");
-        }
-        
-        if (!config_.allowedMethods.empty()) 
-        {
-            response.addHeader("Access-Control-Allow-Methods", 
-                             join(config_.allowedMethods, ", "));
-        }
-        
-        if (!config_.allowedHeaders.empty()) 
-        {
-            response.addHeader("Access-Control-Allow-Headers", 
-                             join(config_.allowedHeaders, ", "));
-        }
-        
-        response.addHeader("Access-Control-Max-Age", 
-                          std::to_string(config_.maxAge));
-        
-        LOG_DEBUG << "CORS headers added successfully";
-    } 
-    catch (const std::exception& e) 
+        return &wildcardBlocks_;
+    }
+    auto it = originBlocks_.find(origin);
+    return it != originBlocks_.end() ? &it->second : nullptr;
+}
+
+CorsMiddleware::HeaderBlocks CorsMiddleware::buildBlocks(const std::string& origin) const
+{
+    std::string simple = "Access-Control-Allow-Origin: " + origin + "\r\n";
+    if (config_.allowCredentials) 
     {
-        LOG_ERROR << "Error adding CORS headers: " << e.what();
+        simple += "Access-Control-Allow-Credentials: true\r\n";
     }
+    // 按源回显时响应随 Origin 变化，需要告知缓存
+    if (origin != "*")
+    {
+        simple += "Vary: Origin\r\n";
+    }
+
+    std::string preflight = simple;
+    if (!config_.allowedMethods.empty()) 
+    {
+        preflight += "Access-Control-Allow-Methods: " + join(config_.allowedMethods, ", ") + "\r\n";
+    }
+    if (!config_.allowedHeaders.empty()) 
+    {
+        preflight += "Access-Control-Allow-Headers: " + join(config_.allowedHeaders, ", ") + "\r\n";
+    }
+    preflight += "Access-Control-Max-Age: " + std::to_string(config_.maxAge) + "\r\n";
+
+    HeaderBlocks blocks;
+    blocks.simple = std::make_shared<const std::string>(std::move(simple));
+    blocks.preflight = std::make_shared<const std::string>(std::move(preflight));
+    return blocks;
 }
 
 // 工具函数：将字符串数组连接成单个字符串
@@ -121,4 +119,4 @@ std::string CorsMiddleware::join(const std::vector<std::string>& strings, const
 }
 
 } // namespace middleware
-} // namespace http
\ No newline at end of file
+} // namespace http
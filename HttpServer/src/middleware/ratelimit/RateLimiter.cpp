@@ -0,0 +1,77 @@
+#include "middleware/ratelimit/RateLimiter.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace http
+{
+namespace middleware
+{
+
+RateLimiter::RateLimiter(const RateLimit& limit)
+    : limit_(limit)
+    , ratePerMicro_(limit.rate / 1e6)
+{
+}
+
+bool RateLimiter::tryAcquire(const std::string& key, int64_t nowMicros, double* retryAfter)
+{
+    Shard& shard = shards_[std::hash<std::string>()(key) % kShardCount];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // 先查找再插入，命中时不构造节点
+    auto it = shard.buckets.find(key);
+    if (it == shard.buckets.end())
+    {
+        it = shard.buckets.emplace(key, Bucket{limit_.burst, nowMicros}).first;
+    }
+    Bucket& bucket = it->second;
+    if (nowMicros > bucket.lastMicros)
+    {
+        bucket.tokens = std::min(limit_.burst, bucket.tokens + (nowMicros - bucket.lastMicros) * ratePerMicro_);
+        bucket.lastMicros = nowMicros;
+    }
+    if (bucket.tokens >= 1)
+    {
+        bucket.tokens -= 1;
+        return true;
+    }
+    *retryAfter = (1 - bucket.tokens) / limit_.rate;
+    return false;
+}
+
+size_t RateLimiter::expireIdle(int64_t nowMicros)
+{
+    size_t expired = 0;
+    for (Shard& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto it = shard.buckets.begin(); it != shard.buckets.end();)
+        {
+            const Bucket& bucket = it->second;
+            if (bucket.tokens + (nowMicros - bucket.lastMicros) * ratePerMicro_ >= limit_.burst)
+            {
+                it = shard.buckets.erase(it);
+                ++expired;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+    return expired;
+}
+
+size_t RateLimiter::size() const
+{
+    size_t total = 0;
+    for (const Shard& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.buckets.size();
+    }
+    return total;
+}
+
+} // namespace middleware
+} // namespace http
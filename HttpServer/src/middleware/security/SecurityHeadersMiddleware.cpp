@@ -0,0 +1,55 @@
+#include "middleware/security/SecurityHeadersMiddleware.h"
+
+namespace http 
+{
+namespace middleware 
+{
+
+namespace
+{
+
+void appendHeader(std::string* block, const char* name, const std::string& value)
+{
+    if (value.empty())
+        return;
+    *block += name;
+    *block += ": ";
+    *block += value;
+    *block += "\r\n";
+}
+
+} // namespace
+
+SecurityHeadersMiddleware::SecurityHeadersMiddleware(const SecurityHeadersConfig& config)
+{
+    std::string block;
+    appendHeader(&block, "X-Content-Type-Options", config.contentTypeOptions);
+    appendHeader(&block, "X-Frame-Options", config.frameOptions);
+    appendHeader(&block, "Referrer-Policy", config.referrerPolicy);
+    appendHeader(&block, "Strict-Transport-Security", config.strictTransportSecurity);
+    appendHeader(&block, "Content-Security-Policy", config.contentSecurityPolicy);
+    for (const auto& header : config.extraHeaders)
+    {
+        appendHeader(&block, header.first.c_str(), header.second);
+    }
+    if (!block.empty())
+    {
+        headers_ = std::make_shared<const std::string>(std::move(block));
+    }
+}
+
+Middleware::Action SecurityHeadersMiddleware::before(HttpRequest& request, HttpResponse* response)
+{
+    (void)request;
+    (void)response;
+    return kContinue;
+}
+
+void SecurityHeadersMiddleware::after(const HttpRequest& request, HttpResponse& response)
+{
+    (void)request;
+    response.addRawHeaders(headers_);
+}
+
+} // namespace middleware
+} // namespace http
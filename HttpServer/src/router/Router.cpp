@@ -1,5 +1,8 @@
+#include <chrono>
+
 #include <muduo/base/Logging.h>
 
+#include "metrics/MetricsRegistry.h"
 #include "router/Router.h"
 
 namespace http
@@ -7,72 +10,145 @@ namespace http
 namespace router
 {
 
-void Router::registerHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler)
+namespace
+{
+
+const char* methodName(HttpRequest::Method method)
+{
+    switch (method)
+    {
+    case HttpRequest::kGet:     return "GET";
+    case HttpRequest::kPost:    return "POST";
+    case HttpRequest::kHead:    return "HEAD";
+    case HttpRequest::kPut:     return "PUT";
+    case HttpRequest::kDelete:  return "DELETE";
+    case HttpRequest::kOptions: return "OPTIONS";
+    default:                    return "OTHER";
+    }
+}
+
+} // namespace
+
+Router::RouteMetrics Router::makeMetrics(const char *method, const std::string &route)
+{
+    static const char* const kCodeClasses[6] = {"other", "1xx", "2xx", "3xx", "4xx", "5xx"};
+
+    metrics::MetricsRegistry &registry = metrics::MetricsRegistry::instance();
+    RouteMetrics result;
+    for (int i = 0; i < 6; ++i)
+    {
+        result.requests[i] = &registry.counter("http_requests_total", "HTTP requests by route and status class",
+                                               {{"method", method}, {"route", route}, {"code", kCodeClasses[i]}});
+    }
+    result.duration = &registry.histogram("http_request_duration_seconds", "HTTP handler latency in seconds",
+                                          {{"method", method}, {"route", route}});
+    return result;
+}
+
+Router::RouteTarget Router::makeTarget(HttpRequest::Method method, const std::string &path, HandlerPtr handler,
+                                       HandlerCallback callback, MiddlewareChainPtr middlewares)
+{
+    return RouteTarget{std::move(handler), std::move(callback), std::move(middlewares), makeMetrics(methodName(method), path)};
+}
+
+void Router::RouteMetrics::record(const HttpResponse &resp, uint64_t micros) const
+{
+    int code = static_cast<int>(resp.getStatusCode()) / 100;
+    requests[code >= 1 && code <= 5 ? code : 0]->inc();
+    duration->observe(micros);
+}
+
+void Router::registerHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler,
+                             MiddlewareChainPtr middlewares)
 {
     RouteKey key{method, path};
-    handlers_[key] = std::move(handler);
+    routes_[key] = makeTarget(method, path, std::move(handler), nullptr, std::move(middlewares));
 }
 
-void Router::registerCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback)
+void Router::registerCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback,
+                              MiddlewareChainPtr middlewares)
 {
     RouteKey key{method, path};
-    callbacks_[key] = std::move(callback);
+    routes_[key] = makeTarget(method, path, nullptr, callback, std::move(middlewares));
 }
 
-bool Router::route(const HttpRequest &req, HttpResponse *resp)
+void Router::RouteTarget::invoke(HttpRequest &req, HttpResponse *resp) const
 {
-    RouteKey key{req.method(), req.path()};
+    auto start = std::chrono::steady_clock::now();
+    auto call = [this, &req, resp]()
+    {
+        if (handler)
+            handler->handle(req, resp);
+        else
+            callback(req, resp);
+    };
 
-    // 查找处理器
-    auto handlerIt = handlers_.find(key);
-    if (handlerIt != handlers_.end())
+    if (middlewares && !middlewares->empty())
+        middlewares->run(req, resp, call);
+    else
+        call();
+
+    // 流式响应只统计处理器本身的耗时，不含后续推送
+    stats.record(*resp, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count()));
+}
+
+void Router::setBodyOptions(HttpRequest::Method method, const std::string &path, const BodyOptions &options)
+{
+    if (path.find("/:") == std::string::npos)
+        bodyOptions_[RouteKey{method, path}] = options;
+    else
+        regexBodyOptions_.push_back(RegexBodyOptions{method, convertToRegex(path), options});
+}
+
+const BodyOptions *Router::findBodyOptions(const HttpRequest &req) const
+{
+    // 大多数路由不设置，此时不必匹配路径
+    if (bodyOptions_.empty() && regexBodyOptions_.empty())
+        return nullptr;
+
+    auto it = bodyOptions_.find(RouteKey{req.method(), req.path()});
+    if (it != bodyOptions_.end())
+        return &it->second;
+
+    for (const auto &entry : regexBodyOptions_)
     {
-        handlerIt->second->handle(req, resp);
-        return true;
+        if (entry.method_ == req.method() && std::regex_match(req.path(), entry.pathRegex_))
+            return &entry.options_;
     }
+    return nullptr;
+}
 
-    // 查找回调函数
-    auto callbackIt = callbacks_.find(key);
-    if (callbackIt != callbacks_.end())
+bool Router::route(HttpRequest &req, HttpResponse *resp)
+{
+    RouteKey key{req.method(), req.path()};
+
+    // 查找精准匹配的处理器或回调
+    auto it = routes_.find(key);
+    if (it != routes_.end())
     {
-        callbackIt->second(req, resp);
+        it->second.invoke(req, resp);
         return true;
     }
 
-    // 查找动态路由处理器
-    for (const auto &[method, pathRegex, handler] : regexHandlers_)
+    // 查找动态路由
+    std::string pathStr(req.path());
+    for (const auto &route : regexRoutes_)
     {
         std::smatch match;
-        std::string pathStr(req.path());
         // 如果方法匹配并且动态路由匹配，则执行处理器
-        if (method == req.method() && std::regex_match(pathStr, match, pathRegex))
+        if (route.method_ == req.method() && std::regex_match(pathStr, match, route.pathRegex_))
         {
-            HttpRequest newReq(req);
-            extractPathParameters(match, newReq);
-            
-            handler->handle(newReq, resp);
-            return true;
-        }
-    }
-
-    // 查找动态路由回调函数
-    for (const auto &[method, pathRegex, callback] : regexCallbacks_)
-    {
-        std::smatch match;
-        std::string pathStr(req.path());
-        // 如果方法匹配并且动态路由匹配，则执行回调函数
-        if (method == req.method() && std::regex_match(pathStr, match, pathRegex))
-        {
-            HttpRequest newReq(req);
-            extractPathParameters(match, newReq);
-
-            callback(req, resp);
+            extractPathParameters(match, req);
+            route.target_.invoke(req, resp);
             return true;
         }
     }
 
+    // 未匹配的请求由调用方返回 404
+    unmatchedMetrics_.requests[4]->inc();
     return false;
 }
 
 } // namespace router
-} // namespace http
\ No newline at end of file
+} // namespace http
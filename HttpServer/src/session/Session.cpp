@@ -8,28 +8,43 @@ namespace session
 
 Session::Session(const std::string& sessionId, SessionManager* sessionManager, int maxAge)
     : sessionId_(sessionId)
+    , expiryMs_(0)
     , maxAge_(maxAge)
     , sessionManager_(sessionManager)
 {
     refresh(); // 初始化时设置过期时间
 }
 
+int64_t Session::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
 // 检查会话是否已过期
 bool Session::isExpired() const
 {
-    return std::chrono::system_clock::now() > expiryTime_;
+    return nowMs() > expiryMs();
 }
 
-// 刷新会话的过期时间
+// 刷新会话的过期时间，存储层按需惰性调整过期调度，这里只更新时间戳
 void Session::refresh()
 {
-    expiryTime_ = std::chrono::system_clock::now() + std::chrono::seconds(maxAge_);
+    expiryMs_.store(nowMs() + static_cast<int64_t>(maxAge_) * 1000, std::memory_order_relaxed);
 }
 
 // 设置会话数据
 void Session::setValue(const std::string& key, const std::string& value)
 {
-    data_[key] = value;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = data_.find(key);
+        if (it != data_.end() && it->second == value)
+        {
+            return; // 值未变化，无需保存
+        }
+        data_[key] = value;
+    }
     // 如果设置了manager，自动保存更改
     if (sessionManager_)
     {
@@ -37,9 +52,31 @@ void Session::setValue(const std::string& key, const std::string& value)
     }
 }
 
+void Session::setValues(std::initializer_list<std::pair<const std::string, std::string>> values)
+{
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& kv : values)
+        {
+            auto it = data_.find(kv.first);
+            if (it == data_.end() || it->second != kv.second)
+            {
+                data_[kv.first] = kv.second;
+                changed = true;
+            }
+        }
+    }
+    if (changed && sessionManager_)
+    {
+        sessionManager_->updateSession(shared_from_this());
+    }
+}
+
 // 获取会话数据
 std::string Session::getValue(const std::string& key) const
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto it = data_.find(key);
     return it != data_.end() ? it->second : std::string();
 }
@@ -47,12 +84,14 @@ std::string Session::getValue(const std::string& key) const
 // 删除会话数据
 void Session::remove(const std::string& key)
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     data_.erase(key);
 }
 
 // 清空会话数据
 void Session::clear()
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     data_.clear();
 }
 
@@ -12,7 +12,6 @@ namespace session
 // 初始化会话管理器，设置会话存储对象和随机数生成器
 SessionManager::SessionManager(std::unique_ptr<SessionStorage> storage)
     : storage_(std::move(storage)) 
-    , rng_(std::random_device{}()) // 初始化随机数生成器，用于生成随机的会话 ID
 {}
 
 // 从请求中获取或创建会话，如果请求中包含会话 ID，则从存储中加载会话，否则创建一个新的会话
@@ -31,29 +30,49 @@ std::shared_ptr<Session> SessionManager::getSession(const HttpRequest& req, Http
         sessionId = generateSessionId();
         session = std::make_shared<Session>(sessionId, this);
         setSessionCookie(sessionId, resp);
-    }
-    else 
-    {
-        session->setManager(this); // 为现有会话设置管理器
+        // 只有新建的会话需要写入存储，已有会话的数据变化由 setValue 触发保存
+        storage_->save(session);
+        return session;
     }
 
+    // 已有会话只刷新过期时间，存储层到期时再按新时间重新调度
     session->refresh();
-    storage_->save(session);  // 这里可能有问题，保存会话
+    return session;
+}
+
+std::shared_ptr<Session> SessionManager::findSession(const HttpRequest& req)
+{
+    std::string sessionId = getSessionIdFromCookie(req);
+    if (sessionId.empty())
+    {
+        return nullptr;
+    }
+    std::shared_ptr<Session> session = storage_->load(sessionId);
+    if (!session || session->isExpired())
+    {
+        return nullptr;
+    }
     return session;
 }
 
 // 生成唯一的会话标识符，确保会话的唯一性和安全性
 std::string SessionManager::generateSessionId()
 {
-    std::stringstream ss;
-    std::uniform_int_distribution<> dist(0, 15);
+    // 多个 IO 线程会同时创建会话，每个线程使用独立的随机数生成器
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    static const char kHex[] = "0123456789abcdef";
 
     // 生成 32 个字符的会话 ID，每个字符是一个十六进制数字
-    for (int i = 0; i < 32; ++i)
+    std::string id(32, '0');
+    for (int i = 0; i < 32; i += 16)
     {
-        ss << std::hex << dist(rng_);
+        uint64_t bits = rng();
+        for (int j = 0; j < 16; ++j)
+        {
+            id[i + j] = kHex[(bits >> (j * 4)) & 0xF];
+        }
     }
-    return ss.str();
+    return id;
 }
 
 void SessionManager::destroySession(const std::string& sessionId)
@@ -63,9 +82,7 @@ void SessionManager::destroySession(const std::string& sessionId)
 
 void SessionManager::cleanExpiredSessions()
 {
-    // 注意：这个实现依赖于具体的存储实现
-    // 对于内存存储，可以在加载时检查是否过期
-    // 对于其他存储的实现，可能需要定期清理过期会话
+    storage_->cleanExpired();
 }
 
 std::string SessionManager::getSessionIdFromCookie(const HttpRequest& req)
@@ -10,6 +10,7 @@ namespace session
 
 void MemorySessionStorage::save(std::shared_ptr<Session> session)
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     // 创建会话副本并存储
     sessions_[session->getId()] = session;
 }
@@ -17,6 +18,7 @@ void MemorySessionStorage::save(std::shared_ptr<Session> session)
 // 通过会话 ID 从存储中加载会话
 std::shared_ptr<Session> MemorySessionStorage::load(const std::string& sessionId)
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto it = sessions_.find(sessionId);
     if (it != sessions_.end())
     {
@@ -38,8 +40,25 @@ std::shared_ptr<Session> MemorySessionStorage::load(const std::string& sessionId
 // 通过会话 ID 从存储中移除会话
 void MemorySessionStorage::remove(const std::string& sessionId)
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     sessions_.erase(sessionId);
 }
 
+void MemorySessionStorage::cleanExpired()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = sessions_.begin(); it != sessions_.end();)
+    {
+        if (it->second->isExpired())
+        {
+            it = sessions_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
 } // namespace session
 } // namespace http
\ No newline at end of file
@@ -0,0 +1,350 @@
+#include "session/SessionToken.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+namespace http
+{
+namespace session
+{
+
+namespace
+{
+
+const uint8_t kTokenVersion = 1;
+const uint8_t kFlagEncrypted = 0x01;
+const size_t  kMacSize = 32;
+const size_t  kGcmNonceSize = 12;
+const size_t  kGcmTagSize = 16;
+const size_t  kMaxUsernameSize = 255;
+
+const char kBase64UrlChars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+std::string base64UrlEncode(const std::string& in)
+{
+    std::string out;
+    out.reserve((in.size() * 4 + 2) / 3);
+    size_t i = 0;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(in.data());
+    for (; i + 3 <= in.size(); i += 3)
+    {
+        uint32_t v = (p[i] << 16) | (p[i + 1] << 8) | p[i + 2];
+        out.push_back(kBase64UrlChars[(v >> 18) & 0x3F]);
+        out.push_back(kBase64UrlChars[(v >> 12) & 0x3F]);
+        out.push_back(kBase64UrlChars[(v >> 6) & 0x3F]);
+        out.push_back(kBase64UrlChars[v & 0x3F]);
+    }
+    size_t rest = in.size() - i;
+    if (rest > 0)
+    {
+        uint32_t v = p[i] << 16;
+        if (rest == 2)
+            v |= p[i + 1] << 8;
+        out.push_back(kBase64UrlChars[(v >> 18) & 0x3F]);
+        out.push_back(kBase64UrlChars[(v >> 12) & 0x3F]);
+        if (rest == 2)
+            out.push_back(kBase64UrlChars[(v >> 6) & 0x3F]);
+    }
+    return out;
+}
+
+bool base64UrlDecode(const char* in, size_t len, std::string* out)
+{
+    static int8_t table[256];
+    static bool initialized = [] {
+        memset(table, -1, sizeof table);
+        for (int i = 0; i < 64; ++i)
+            table[static_cast<unsigned char>(kBase64UrlChars[i])] = static_cast<int8_t>(i);
+        return true;
+    }();
+    (void)initialized;
+
+    if (len % 4 == 1)
+        return false;
+    out->clear();
+    out->reserve(len * 3 / 4);
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        int8_t v = table[static_cast<unsigned char>(in[i])];
+        if (v < 0)
+            return false;
+        acc = (acc << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            out->push_back(static_cast<char>((acc >> bits) & 0xFF));
+        }
+    }
+    return true;
+}
+
+void putU64(std::string* out, uint64_t v)
+{
+    for (int i = 7; i >= 0; --i)
+        out->push_back(static_cast<char>((v >> (i * 8)) & 0xFF));
+}
+
+uint64_t getU64(const unsigned char* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+int64_t nowSeconds()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string hmacSha256(const std::string& key, const char* data, size_t len)
+{
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned int macLen = 0;
+    HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()),
+         reinterpret_cast<const unsigned char*>(data), len, mac, &macLen);
+    return std::string(reinterpret_cast<char*>(mac), macLen);
+}
+
+// 载荷格式：版本(1) 标志(1) userId(8) iat(8) exp(8) tokenId(8) 用户名长度(1) 用户名
+const size_t kClaimsFixedSize = 1 + 1 + 8 + 8 + 8 + 8 + 1;
+
+} // namespace
+
+SessionTokenCodec::SessionTokenCodec(const Options& options)
+    : options_(options)
+{
+    if (options_.secret.size() < 32)
+    {
+        throw std::invalid_argument("session token secret must be at least 32 bytes");
+    }
+    // 签名与加密使用从主密钥派生的不同子密钥
+    macKey_ = hmacSha256(options_.secret, "session-token-mac", 17);
+    encKey_ = hmacSha256(options_.secret, "session-token-enc", 17);
+}
+
+std::string SessionTokenCodec::issue(int64_t userId, const std::string& username) const
+{
+    if (username.size() > kMaxUsernameSize)
+    {
+        throw std::invalid_argument("username too long for session token");
+    }
+
+    uint64_t tokenId = 0;
+    if (RAND_bytes(reinterpret_cast<unsigned char*>(&tokenId), sizeof tokenId) != 1)
+    {
+        throw std::runtime_error("RAND_bytes failed");
+    }
+
+    int64_t now = nowSeconds();
+    std::string claims;
+    claims.reserve(kClaimsFixedSize + username.size());
+    claims.push_back(static_cast<char>(kTokenVersion));
+    claims.push_back(static_cast<char>(options_.encrypt ? kFlagEncrypted : 0));
+    putU64(&claims, static_cast<uint64_t>(userId));
+    putU64(&claims, static_cast<uint64_t>(now));
+    putU64(&claims, static_cast<uint64_t>(now + options_.maxAge));
+    putU64(&claims, tokenId);
+    claims.push_back(static_cast<char>(username.size()));
+    claims.append(username);
+
+    std::string payload;
+    if (options_.encrypt)
+    {
+        // 版本和标志保持明文，校验时据此选择解析方式
+        std::string sealed;
+        if (!encryptPayload(claims.substr(2), &sealed))
+        {
+            throw std::runtime_error("failed to encrypt session token");
+        }
+        payload = claims.substr(0, 2) + sealed;
+    }
+    else
+    {
+        payload.swap(claims);
+    }
+
+    std::string encoded = base64UrlEncode(payload);
+    return encoded + "." + base64UrlEncode(sign(encoded));
+}
+
+bool SessionTokenCodec::verify(const std::string& token, SessionClaims* claims) const
+{
+    size_t dot = token.find('.');
+    if (dot == std::string::npos || dot == 0)
+        return false;
+
+    std::string mac;
+    if (!base64UrlDecode(token.data() + dot + 1, token.size() - dot - 1, &mac) || mac.size() != kMacSize)
+        return false;
+
+    std::string expected = hmacSha256(macKey_, token.data(), dot);
+    if (CRYPTO_memcmp(expected.data(), mac.data(), kMacSize) != 0)
+        return false;
+
+    std::string payload;
+    if (!base64UrlDecode(token.data(), dot, &payload) || payload.size() < 2)
+        return false;
+    if (static_cast<uint8_t>(payload[0]) != kTokenVersion)
+        return false;
+
+    std::string body;
+    if (static_cast<uint8_t>(payload[1]) & kFlagEncrypted)
+    {
+        if (!decryptPayload(payload.substr(2), &body))
+            return false;
+    }
+    else
+    {
+        body = payload.substr(2);
+    }
+
+    if (body.size() < kClaimsFixedSize - 2)
+        return false;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(body.data());
+    size_t nameLen = p[32];
+    if (body.size() != kClaimsFixedSize - 2 + nameLen)
+        return false;
+
+    SessionClaims parsed;
+    parsed.userId = static_cast<int64_t>(getU64(p));
+    parsed.issuedAt = static_cast<int64_t>(getU64(p + 8));
+    parsed.expiresAt = static_cast<int64_t>(getU64(p + 16));
+    parsed.tokenId = getU64(p + 24);
+    parsed.username.assign(body.data() + 33, nameLen);
+
+    if (parsed.expiresAt < nowSeconds())
+        return false;
+    if (isRevoked(parsed.tokenId))
+        return false;
+
+    *claims = std::move(parsed);
+    return true;
+}
+
+void SessionTokenCodec::revoke(const SessionClaims& claims)
+{
+    std::unique_lock<std::shared_mutex> lock(revokedMutex_);
+    revoked_[claims.tokenId] = claims.expiresAt;
+}
+
+void SessionTokenCodec::cleanRevoked()
+{
+    int64_t now = nowSeconds();
+    std::unique_lock<std::shared_mutex> lock(revokedMutex_);
+    for (auto it = revoked_.begin(); it != revoked_.end();)
+    {
+        if (it->second < now)
+            it = revoked_.erase(it);
+        else
+            ++it;
+    }
+}
+
+bool SessionTokenCodec::isRevoked(uint64_t tokenId) const
+{
+    std::shared_lock<std::shared_mutex> lock(revokedMutex_);
+    return !revoked_.empty() && revoked_.count(tokenId) > 0;
+}
+
+std::string SessionTokenCodec::getTokenFromCookie(const HttpRequest& req) const
+{
+    std::string cookie = req.getHeader("Cookie");
+    std::string prefix = options_.cookieName + "=";
+    size_t pos = 0;
+    // 按 "; " 分隔逐个匹配名称，避免误匹配到其他 cookie 的值
+    while (pos < cookie.size())
+    {
+        while (pos < cookie.size() && (cookie[pos] == ' ' || cookie[pos] == ';'))
+            ++pos;
+        size_t end = cookie.find(';', pos);
+        if (end == std::string::npos)
+            end = cookie.size();
+        if (cookie.compare(pos, prefix.size(), prefix) == 0)
+            return cookie.substr(pos + prefix.size(), end - pos - prefix.size());
+        pos = end;
+    }
+    return std::string();
+}
+
+void SessionTokenCodec::setTokenCookie(const std::string& token, HttpResponse* resp) const
+{
+    resp->addHeader("Set-Cookie", options_.cookieName + "=" + token +
+                    "; Path=/; HttpOnly; SameSite=Lax; Max-Age=" + std::to_string(options_.maxAge));
+}
+
+void SessionTokenCodec::clearTokenCookie(HttpResponse* resp) const
+{
+    resp->addHeader("Set-Cookie", options_.cookieName + "=; Path=/; HttpOnly; SameSite=Lax; Max-Age=0");
+}
+
+std::string SessionTokenCodec::sign(const std::string& data) const
+{
+    return hmacSha256(macKey_, data.data(), data.size());
+}
+
+bool SessionTokenCodec::encryptPayload(const std::string& plain, std::string* out) const
+{
+    unsigned char nonce[kGcmNonceSize];
+    if (RAND_bytes(nonce, sizeof nonce) != 1)
+        return false;
+
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (!ctx)
+        return false;
+
+    out->assign(reinterpret_cast<char*>(nonce), kGcmNonceSize);
+    out->resize(kGcmNonceSize + plain.size() + kGcmTagSize);
+    unsigned char* cipher = reinterpret_cast<unsigned char*>(&(*out)[kGcmNonceSize]);
+
+    int len = 0;
+    bool ok = EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr,
+                                 reinterpret_cast<const unsigned char*>(encKey_.data()), nonce) == 1 &&
+              EVP_EncryptUpdate(ctx, cipher, &len,
+                                reinterpret_cast<const unsigned char*>(plain.data()),
+                                static_cast<int>(plain.size())) == 1 &&
+              EVP_EncryptFinal_ex(ctx, cipher + len, &len) == 1 &&
+              EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, static_cast<int>(kGcmTagSize),
+                                  cipher + plain.size()) == 1;
+    EVP_CIPHER_CTX_free(ctx);
+    return ok;
+}
+
+bool SessionTokenCodec::decryptPayload(const std::string& in, std::string* plain) const
+{
+    if (in.size() < kGcmNonceSize + kGcmTagSize)
+        return false;
+
+    size_t cipherLen = in.size() - kGcmNonceSize - kGcmTagSize;
+    const unsigned char* nonce = reinterpret_cast<const unsigned char*>(in.data());
+    const unsigned char* cipher = nonce + kGcmNonceSize;
+    std::string tag = in.substr(kGcmNonceSize + cipherLen);
+
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (!ctx)
+        return false;
+
+    plain->resize(cipherLen);
+    unsigned char* outBuf = reinterpret_cast<unsigned char*>(&(*plain)[0]);
+    int len = 0;
+    bool ok = EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr,
+                                 reinterpret_cast<const unsigned char*>(encKey_.data()), nonce) == 1 &&
+              EVP_DecryptUpdate(ctx, outBuf, &len, cipher, static_cast<int>(cipherLen)) == 1 &&
+              EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, static_cast<int>(kGcmTagSize), &tag[0]) == 1 &&
+              EVP_DecryptFinal_ex(ctx, outBuf + len, &len) == 1;
+    EVP_CIPHER_CTX_free(ctx);
+    return ok;
+}
+
+} // namespace session
+} // namespace http
@@ -0,0 +1,180 @@
+#include "session/ShardedSessionStorage.h"
+
+#include <functional>
+
+namespace http
+{
+namespace session
+{
+
+namespace
+{
+// 容量淘汰时比较的候选条目数
+const size_t kEvictCandidates = 8;
+} // namespace
+
+ShardedSessionStorage::ShardedSessionStorage()
+    : ShardedSessionStorage(Options())
+{}
+
+ShardedSessionStorage::ShardedSessionStorage(const Options& options)
+    : size_(0)
+    , evicted_(0)
+{
+    size_t shardCount = 1;
+    while (shardCount < options.shardCount)
+    {
+        shardCount <<= 1;
+    }
+    shardMask_ = shardCount - 1;
+    maxPerShard_ = options.maxSessions == 0 ? 0 : (options.maxSessions + shardCount - 1) / shardCount;
+
+    int64_t startTick = toTick(Session::nowMs());
+    shards_.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i)
+    {
+        shards_.push_back(std::make_unique<Shard>(startTick));
+    }
+}
+
+ShardedSessionStorage::Shard& ShardedSessionStorage::shardFor(const std::string& sessionId)
+{
+    return *shards_[std::hash<std::string>{}(sessionId) & shardMask_];
+}
+
+void ShardedSessionStorage::save(std::shared_ptr<Session> session)
+{
+    Shard& shard = shardFor(session->getId());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.sessions.find(session->getId());
+    if (it != shard.sessions.end())
+    {
+        // 已存在的会话对象被原地修改，无需重新调度
+        it->second.session = std::move(session);
+        return;
+    }
+
+    if (maxPerShard_ != 0 && shard.sessions.size() >= maxPerShard_)
+    {
+        expireLocked(shard, toTick(Session::nowMs()));
+        if (shard.sessions.size() >= maxPerShard_)
+        {
+            evictLocked(shard);
+        }
+    }
+
+    int64_t tick = toTick(session->expiryMs());
+    std::string id = session->getId();
+    shard.wheel.schedule(id, tick);
+    shard.sessions.emplace(std::move(id), Entry{std::move(session), tick});
+    size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::shared_ptr<Session> ShardedSessionStorage::load(const std::string& sessionId)
+{
+    Shard& shard = shardFor(sessionId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.sessions.find(sessionId);
+    if (it == shard.sessions.end())
+    {
+        return nullptr;
+    }
+    if (it->second.session->isExpired())
+    {
+        // 时间轮中的条目在到期时会因找不到会话而被忽略
+        shard.sessions.erase(it);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return it->second.session;
+}
+
+void ShardedSessionStorage::remove(const std::string& sessionId)
+{
+    Shard& shard = shardFor(sessionId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.sessions.erase(sessionId) > 0)
+    {
+        size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void ShardedSessionStorage::cleanExpired()
+{
+    int64_t nowTick = toTick(Session::nowMs());
+    for (auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        expireLocked(*shard, nowTick);
+    }
+}
+
+void ShardedSessionStorage::expireLocked(Shard& shard, int64_t nowTick)
+{
+    std::vector<TimingWheel::Entry> due;
+    shard.wheel.advance(nowTick, &due);
+
+    int64_t nowMs = Session::nowMs();
+    for (auto& item : due)
+    {
+        auto it = shard.sessions.find(item.key);
+        // 会话已删除，或被删除后以同一 ID 重新加入（调度 tick 不同），条目已失效
+        if (it == shard.sessions.end() || it->second.scheduledTick != item.tick)
+        {
+            continue;
+        }
+
+        int64_t expiryMs = it->second.session->expiryMs();
+        if (expiryMs < nowMs)
+        {
+            shard.sessions.erase(it);
+            size_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            // 会话期间被访问过，按新的过期时间重新调度
+            int64_t tick = toTick(expiryMs);
+            it->second.scheduledTick = tick;
+            shard.wheel.schedule(item.key, tick);
+        }
+    }
+}
+
+void ShardedSessionStorage::evictLocked(Shard& shard)
+{
+    // 在最早到期的若干条目中选择真实过期时间最早的会话淘汰
+    std::vector<TimingWheel::Entry> candidates;
+    shard.wheel.peekEarliest(kEvictCandidates, &candidates);
+
+    auto victim = shard.sessions.end();
+    for (const auto& item : candidates)
+    {
+        auto it = shard.sessions.find(item.key);
+        if (it == shard.sessions.end() || it->second.scheduledTick != item.tick)
+        {
+            continue;
+        }
+        if (victim == shard.sessions.end() ||
+            it->second.session->expiryMs() < victim->second.session->expiryMs())
+        {
+            victim = it;
+        }
+    }
+
+    // 候选条目均已失效时退化为淘汰任意一个
+    if (victim == shard.sessions.end())
+    {
+        victim = shard.sessions.begin();
+    }
+    if (victim != shard.sessions.end())
+    {
+        shard.sessions.erase(victim);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        evicted_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace session
+} // namespace http
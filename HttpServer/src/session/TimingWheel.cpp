@@ -0,0 +1,109 @@
+#include "session/TimingWheel.h"
+
+namespace http
+{
+namespace session
+{
+
+TimingWheel::TimingWheel(int64_t startTick)
+    : nextTick_(startTick)
+    , size_(0)
+{}
+
+void TimingWheel::schedule(const std::string& key, int64_t tick)
+{
+    place(Entry{key, tick});
+    ++size_;
+}
+
+void TimingWheel::place(Entry entry)
+{
+    int64_t delta = entry.tick - nextTick_;
+    if (delta < 0)
+    {
+        // 已经过期，放到下一个要处理的槽
+        slots_[0][nextTick_ & kSlotMask].push_back(std::move(entry));
+        return;
+    }
+    if (delta > kMaxSpan)
+    {
+        // 超出时间轮范围，先放在最远处，到时再按真实时间重新调度
+        entry.tick = nextTick_ + kMaxSpan;
+        delta = kMaxSpan;
+    }
+
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (int64_t(1) << (kSlotBits * (level + 1))))
+    {
+        ++level;
+    }
+    int64_t slot = (entry.tick >> (kSlotBits * level)) & kSlotMask;
+    slots_[level][slot].push_back(std::move(entry));
+}
+
+int TimingWheel::cascade(int level)
+{
+    int index = static_cast<int>((nextTick_ >> (kSlotBits * level)) & kSlotMask);
+    std::vector<Entry> entries;
+    entries.swap(slots_[level][index]);
+    for (auto& entry : entries)
+    {
+        place(std::move(entry));
+    }
+    return index;
+}
+
+void TimingWheel::advance(int64_t nowTick, std::vector<Entry>* due)
+{
+    // 长时间未推进时（如首次调用），跳过空转的 tick 不影响正确性，但这里逐个处理以保证层间下移
+    while (nextTick_ <= nowTick)
+    {
+        int index = static_cast<int>(nextTick_ & kSlotMask);
+        // 第一层转完一圈时，依次把上层当前槽下移
+        if (index == 0)
+        {
+            for (int level = 1; level < kLevels; ++level)
+            {
+                if (cascade(level) != 0)
+                    break;
+            }
+        }
+
+        std::vector<Entry>& slot = slots_[0][index];
+        size_ -= slot.size();
+        for (auto& entry : slot)
+        {
+            due->push_back(std::move(entry));
+        }
+        slot.clear();
+        ++nextTick_;
+
+        if (size_ == 0 && nextTick_ <= nowTick)
+        {
+            // 时间轮为空，直接跳到目标时间
+            nextTick_ = nowTick + 1;
+        }
+    }
+}
+
+void TimingWheel::peekEarliest(size_t limit, std::vector<Entry>* out) const
+{
+    // 低层的槽总是先于高层到期，按层、按槽从当前位置依次查找
+    for (int level = 0; level < kLevels && out->size() < limit; ++level)
+    {
+        int64_t start = (nextTick_ >> (kSlotBits * level)) & kSlotMask;
+        for (int i = 0; i < kSlots && out->size() < limit; ++i)
+        {
+            const auto& slot = slots_[level][(start + i) & kSlotMask];
+            for (const auto& entry : slot)
+            {
+                out->push_back(entry);
+                if (out->size() >= limit)
+                    break;
+            }
+        }
+    }
+}
+
+} // namespace session
+} // namespace http
@@ -10,6 +10,10 @@ SslConfig::SslConfig()
     , verifyDepth_(4)
     , sessionTimeout_(300)
     , sessionCacheSize_(20480L)
+    , sessionCacheShards_(16)
+    , ticketKeyRotation_(3600)
+    , earlyData_(false)
+    , maxEarlyData_(16384)
 {
 }
 
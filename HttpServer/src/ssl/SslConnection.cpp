@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <climits>
+
 #include <muduo/base/Logging.h>
 #include <openssl/err.h>
 
@@ -6,172 +9,282 @@
 namespace ssl
 {
 
-// 自定义 BIO 方法
-static BIO_METHOD* createCustomBioMethod() 
+namespace
 {
-    BIO_METHOD* method = BIO_meth_new(BIO_TYPE_MEM, "custom");
-    BIO_meth_set_write(method, SslConnection::bioWrite);
-    BIO_meth_set_read(method, SslConnection::bioRead);
-    BIO_meth_set_ctrl(method, SslConnection::bioCtrl);
-    return method;
-}
+
+// 单条 TLS 记录的最大明文长度
+const size_t kMaxRecordSize = 16 * 1024;
+
+} // namespace
 
 SslConnection::SslConnection(const TcpConnectionPtr& conn, SslContext* ctx)
     : ssl_(nullptr)
     , ctx_(ctx)
-    , conn_(conn)
+    , conn_(conn.get())
     , state_(SSLState::HANDSHAKE)
     , readBio_(nullptr)
     , writeBio_(nullptr)
-    , messageCallback_(nullptr)
+    , readingEarlyData_(ctx->earlyDataEnabled())
 {
     // 创建 SSL 对象
     ssl_ = SSL_new(ctx_->getNativeHandle());
     if (!ssl_) {
         LOG_ERROR << "Failed to create SSL object: " << ERR_error_string(ERR_get_error(), nullptr);
+        state_ = SSLState::ERROR;
         return;
     }
 
     // 创建 BIO
     readBio_ = BIO_new(BIO_s_mem());
     writeBio_ = BIO_new(BIO_s_mem());
-    
+
     if (!readBio_ || !writeBio_) {
         LOG_ERROR << "Failed to create BIO objects";
+        BIO_free(readBio_);
+        BIO_free(writeBio_);
         SSL_free(ssl_);
         ssl_ = nullptr;
+        state_ = SSLState::ERROR;
         return;
     }
 
+    // 数据读完时返回 WANT_READ，而不是 EOF
+    BIO_set_mem_eof_return(readBio_, -1);
+    BIO_set_mem_eof_return(writeBio_, -1);
+
     SSL_set_bio(ssl_, readBio_, writeBio_);
     SSL_set_accept_state(ssl_);  // 设置为服务器模式
-    
-    // 设置 SSL 选项
     SSL_set_mode(ssl_, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
-    SSL_set_mode(ssl_, SSL_MODE_ENABLE_PARTIAL_WRITE);
-    
-    // 设置连接回调
-    conn_->setMessageCallback(
-        std::bind(&SslConnection::onRead, this, std::placeholders::_1,
-                 std::placeholders::_2, std::placeholders::_3));
 }
 
-SslConnection::~SslConnection() 
+SslConnection::~SslConnection()
 {
-    if (ssl_) 
+    if (ssl_)
     {
+        // 客户端常常不发 close_notify 直接断开，OpenSSL 会因此把会话从缓存中删除；
+        // 只要连接没有出过错，就视为正常关闭，保留会话供下次恢复
+        if (state_ != SSLState::ERROR)
+        {
+            SSL_set_shutdown(ssl_, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+        }
         SSL_free(ssl_);  // 这会同时释放 BIO
     }
 }
 
-void SslConnection::startHandshake() 
+void SslConnection::startHandshake()
 {
-    SSL_set_accept_state(ssl_);
-    handleHandshake();
+    if (state_ == SSLState::HANDSHAKE)
+    {
+        handleHandshake();
+    }
 }
 
-void SslConnection::send(const void* data, size_t len) 
+bool SslConnection::onRead(muduo::net::Buffer* buf)
 {
-    if (state_ != SSLState::ESTABLISHED) {
-        LOG_ERROR << "Cannot send data before SSL handshake is complete";
-        return;
+    if (state_ != SSLState::HANDSHAKE && state_ != SSLState::ESTABLISHED)
+    {
+        buf->retrieveAll();
+        return false;
     }
-    
-    int written = SSL_write(ssl_, data, len);
-    if (written <= 0) {
-        int err = SSL_get_error(ssl_, written);
-        LOG_ERROR << "SSL_write failed: " << ERR_error_string(err, nullptr);
-        return;
+
+    // 整块密文交给 SSL，由 SSL 自己按记录切分
+    BIO_write(readBio_, buf->peek(), static_cast<int>(buf->readableBytes()));
+    buf->retrieveAll();
+
+    if (state_ == SSLState::HANDSHAKE)
+    {
+        if (!handleHandshake())
+            return false;
+        // 握手未完成；完成时客户端的应用数据可能已经一起到达，继续读取
+        if (state_ != SSLState::ESTABLISHED)
+            return true;
     }
-    
-    char buf[4096];
-    int pending;
-    while ((pending = BIO_pending(writeBio_)) > 0) {
-        int bytes = BIO_read(writeBio_, buf, 
-                           std::min(pending, static_cast<int>(sizeof(buf))));
-        if (bytes > 0) {
-            conn_->send(buf, bytes);
+    return drainRead();
+}
+
+bool SslConnection::drainRead()
+{
+    // 一次把已到达的记录全部解密，避免数据滞留到下一个可读事件
+    for (;;)
+    {
+        decryptedBuffer_.ensureWritableBytes(kMaxRecordSize);
+        size_t writable = std::min(decryptedBuffer_.writableBytes(), static_cast<size_t>(INT_MAX));
+        int ret = SSL_read(ssl_, decryptedBuffer_.beginWrite(), static_cast<int>(writable));
+        if (ret > 0)
+        {
+            decryptedBuffer_.hasWritten(ret);
+            continue;
         }
+
+        int err = SSL_get_error(ssl_, ret);
+        if (err == SSL_ERROR_WANT_READ)
+            break;
+        if (err == SSL_ERROR_ZERO_RETURN)
+        {
+            // 对端发送了 close_notify
+            shutdown();
+            return true;
+        }
+        handleError(getLastError(ret));
+        return false;
     }
+
+    // 读过程中可能产生需要回复的记录（如 TLS 1.3 KeyUpdate）
+    flushWriteBio();
+    return true;
 }
 
-void SslConnection::onRead(const TcpConnectionPtr& conn, BufferPtr buf, 
-                         muduo::Timestamp time) 
+void SslConnection::send(const void* data, size_t len)
 {
-    if (state_ == SSLState::HANDSHAKE) {
-        // 将数据写入 BIO
-        BIO_write(readBio_, buf->peek(), buf->readableBytes());
-        buf->retrieve(buf->readableBytes());
-        handleHandshake();
+    // 接受 0-RTT 后，握手完成前即可向客户端回写（0.5-RTT）
+    bool early = isEarlyDataAccepted();
+    if (state_ != SSLState::ESTABLISHED && !early) {
+        LOG_ERROR << "Cannot send data before SSL handshake is complete";
         return;
-    } else if (state_ == SSLState::ESTABLISHED) {
-        // 解密数据
-        char decryptedData[4096];
-        int ret = SSL_read(ssl_, decryptedData, sizeof(decryptedData));
-        if (ret > 0) {
-            // 创建新的 Buffer 存储解密后的数据
-            muduo::net::Buffer decryptedBuffer;
-            decryptedBuffer.append(decryptedData, ret);
-            
-            // 调用上层回调处理解密后的数据
-            if (messageCallback_) {
-                messageCallback_(conn, &decryptedBuffer, time);
-            }
+    }
+
+    const char* p = static_cast<const char*>(data);
+    while (len > 0)
+    {
+        int chunk = static_cast<int>(std::min(len, static_cast<size_t>(INT_MAX)));
+        int written;
+        if (early)
+        {
+            size_t n = 0;
+            written = SSL_write_early_data(ssl_, p, static_cast<size_t>(chunk), &n) == 1
+                ? static_cast<int>(n) : 0;
+        }
+        else
+        {
+            written = SSL_write(ssl_, p, chunk);
+        }
+        if (written <= 0)
+        {
+            handleError(getLastError(written));
+            return;
+        }
+        p += written;
+        len -= written;
+    }
+    // 本次写入产生的全部记录合并为一次发送
+    flushWriteBio();
+}
+
+void SslConnection::send(muduo::net::Buffer* buf)
+{
+    send(buf->peek(), buf->readableBytes());
+    buf->retrieveAll();
+}
+
+void SslConnection::shutdown()
+{
+    if (state_ == SSLState::ESTABLISHED)
+    {
+        SSL_shutdown(ssl_);
+        flushWriteBio();
+    }
+    if (state_ != SSLState::ERROR)
+    {
+        state_ = SSLState::SHUTDOWN;
+    }
+    conn_->shutdown();
+}
+
+bool SslConnection::readEarlyData()
+{
+    for (;;)
+    {
+        decryptedBuffer_.ensureWritableBytes(kMaxRecordSize);
+        size_t n = 0;
+        int ret = SSL_read_early_data(ssl_, decryptedBuffer_.beginWrite(),
+                                      decryptedBuffer_.writableBytes(), &n);
+        if (ret == SSL_READ_EARLY_DATA_SUCCESS)
+        {
+            decryptedBuffer_.hasWritten(n);
+            continue;
         }
+        flushWriteBio();
+        if (ret == SSL_READ_EARLY_DATA_FINISH)
+        {
+            // 0-RTT 数据读完（或客户端没有发送），继续正常握手
+            readingEarlyData_ = false;
+            return true;
+        }
+
+        int err = SSL_get_error(ssl_, ret);
+        if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE)
+            return true;
+
+        char errBuf[256];
+        ERR_error_string_n(ERR_get_error(), errBuf, sizeof(errBuf));
+        LOG_ERROR << "SSL early data failed: " << errBuf;
+        state_ = SSLState::ERROR;
+        conn_->shutdown();
+        return false;
     }
 }
 
-void SslConnection::handleHandshake() 
+bool SslConnection::handleHandshake()
 {
+    if (readingEarlyData_)
+    {
+        if (!readEarlyData())
+            return false;
+        if (readingEarlyData_)
+            return true; // 仍在等待 0-RTT 数据
+    }
+
     int ret = SSL_do_handshake(ssl_);
-    
+    // 握手报文（以及失败时的告警）都需要发出去
+    flushWriteBio();
+
     if (ret == 1) {
         state_ = SSLState::ESTABLISHED;
-        LOG_INFO << "SSL handshake completed successfully";
-        LOG_INFO << "Using cipher: " << SSL_get_cipher(ssl_);
-        LOG_INFO << "Protocol version: " << SSL_get_version(ssl_);
-        
-        // 握手完成后，确保设置了正确的回调
-        if (!messageCallback_) {
-            LOG_WARN << "No message callback set after SSL handshake";
-        }
-        return;
+        ctx_->recordHandshake(ssl_);
+        LOG_DEBUG << "SSL handshake completed, cipher: " << SSL_get_cipher(ssl_)
+                  << ", protocol: " << SSL_get_version(ssl_);
+        return true;
     }
-    
+
     int err = SSL_get_error(ssl_, ret);
     switch (err) {
         case SSL_ERROR_WANT_READ:
         case SSL_ERROR_WANT_WRITE:
             // 正常的握手过程，需要继续
-            break;
-            
+            return true;
+
         default: {
             // 获取详细的错误信息
             char errBuf[256];
             unsigned long errCode = ERR_get_error();
             ERR_error_string_n(errCode, errBuf, sizeof(errBuf));
             LOG_ERROR << "SSL handshake failed: " << errBuf;
+            state_ = SSLState::ERROR;
             conn_->shutdown();  // 关闭连接
-            break;
+            return false;
         }
     }
 }
 
-void SslConnection::onEncrypted(const char* data, size_t len) 
+void SslConnection::flushWriteBio()
 {
-    writeBuffer_.append(data, len);
-    conn_->send(&writeBuffer_);
-}
+    size_t pending = BIO_ctrl_pending(writeBio_);
+    if (pending == 0)
+        return;
 
-void SslConnection::onDecrypted(const char* data, size_t len) 
-{
-    decryptedBuffer_.append(data, len);
+    writeBuffer_.ensureWritableBytes(pending);
+    int n = BIO_read(writeBio_, writeBuffer_.beginWrite(), static_cast<int>(pending));
+    if (n > 0)
+    {
+        writeBuffer_.hasWritten(n);
+        conn_->send(&writeBuffer_);
+    }
 }
 
-SSLError SslConnection::getLastError(int ret) 
+SSLError SslConnection::getLastError(int ret)
 {
     int err = SSL_get_error(ssl_, ret);
-    switch (err) 
+    switch (err)
     {
         case SSL_ERROR_NONE:
             return SSLError::NONE;
@@ -188,9 +301,9 @@ SSLError SslConnection::getLastError(int ret)
     }
 }
 
-void SslConnection::handleError(SSLError error) 
+void SslConnection::handleError(SSLError error)
 {
-    switch (error) 
+    switch (error)
     {
         case SSLError::WANT_READ:
         case SSLError::WANT_WRITE:
@@ -201,6 +314,8 @@ void SslConnection::handleError(SSLError error)
         case SSLError::UNKNOWN:
             LOG_ERROR << "SSL error occurred: " << ERR_error_string(ERR_get_error(), nullptr);
             state_ = SSLState::ERROR;
+            // 把可能产生的告警发出去再关闭
+            flushWriteBio();
             conn_->shutdown();
             break;
         default:
@@ -208,41 +323,4 @@ void SslConnection::handleError(SSLError error)
     }
 }
 
-int SslConnection::bioWrite(BIO* bio, const char* data, int len) 
-{
-    SslConnection* conn = static_cast<SslConnection*>(BIO_get_data(bio));
-    if (!conn) return -1;
-
-    conn->conn_->send(data, len);
-    return len;
-}
-
-int SslConnection::bioRead(BIO* bio, char* data, int len) 
-{
-    SslConnection* conn = static_cast<SslConnection*>(BIO_get_data(bio));
-    if (!conn) return -1;
-
-    size_t readable = conn->readBuffer_.readableBytes();
-    if (readable == 0) 
-    {
-        return -1;  // 无数据可读
-    }
-
-    size_t toRead = std::min(static_cast<size_t>(len), readable);
-    memcpy(data, conn->readBuffer_.peek(), toRead);
-    conn->readBuffer_.retrieve(toRead);
-    return toRead;
-}
-
-long SslConnection::bioCtrl(BIO* bio, int cmd, long num, void* ptr) 
-{
-    switch (cmd) 
-    {
-        case BIO_CTRL_FLUSH:
-            return 1;
-        default:
-            return 0;
-    }
-}
-
-} // namespace ssl 
\ No newline at end of file
+} // namespace ssl
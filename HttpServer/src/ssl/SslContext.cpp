@@ -1,5 +1,12 @@
+#include <cstring>
+#include <ctime>
+#include <mutex>
+
 #include <muduo/base/Logging.h>
+#include <openssl/core_names.h>
 #include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
 
 #include "ssl/SslContext.h"
 
@@ -8,6 +15,14 @@ namespace ssl
 SslContext::SslContext(const SslConfig& config)
     : ctx_(nullptr)
     , config_(config)
+    , currentKey_()
+    , previousKey_()
+    , hasPreviousKey_(false)
+    , handshakes_(0)
+    , resumed_(0)
+    , earlyDataAccepted_(0)
+    , earlyDataRejected_(0)
+    , ticketKeyRotations_(0)
 {
 
 }
@@ -56,6 +71,21 @@ bool SslContext::initialize()
     // 设置会话缓存
     setupSessionCache();
 
+    // 设置会话票据
+    if (!setupSessionTickets())
+    {
+        return false;
+    }
+
+    // TLS 1.3 0-RTT：OpenSSL 自带的防重放依赖内置会话缓存，这里改由分片缓存记录已用过的票据
+    if (config_.getEarlyData())
+    {
+        SSL_CTX_set_options(ctx_, SSL_OP_NO_ANTI_REPLAY);
+        SSL_CTX_set_max_early_data(ctx_, config_.getMaxEarlyData());
+        SSL_CTX_set_recv_max_early_data(ctx_, config_.getMaxEarlyData());
+        SSL_CTX_set_allow_early_data_cb(ctx_, &SslContext::allowEarlyData, this);
+    }
+
     LOG_INFO << "SSL context initialized successfully";
     return true;
 }
@@ -136,9 +166,170 @@ bool SslContext::setupProtocol()
 
 void SslContext::setupSessionCache()
 {
-    SSL_CTX_set_session_cache_mode(ctx_, SSL_SESS_CACHE_SERVER);
-    SSL_CTX_sess_set_cache_size(ctx_, config_.getSessionCacheSize());
+    static const unsigned char kSessionIdContext[] = "http-server";
+    SSL_CTX_set_session_id_context(ctx_, kSessionIdContext, sizeof(kSessionIdContext) - 1);
     SSL_CTX_set_timeout(ctx_, config_.getSessionTimeout());
+
+    sessionCache_ = std::make_unique<SslSessionCache>(
+        static_cast<size_t>(config_.getSessionCacheShards()),
+        static_cast<size_t>(config_.getSessionCacheSize()),
+        config_.getSessionTimeout());
+    sessionCache_->attach(ctx_);
+}
+
+bool SslContext::setupSessionTickets()
+{
+    if (config_.getTicketKeyRotation() <= 0)
+    {
+        // 不签发无状态票据，TLS 1.3 下票据退化为会话缓存的索引
+        SSL_CTX_set_options(ctx_, SSL_OP_NO_TICKET);
+        return true;
+    }
+
+    if (!generateTicketKey(&currentKey_, static_cast<int64_t>(::time(nullptr))))
+    {
+        handleSslError("Failed to generate session ticket key");
+        return false;
+    }
+    SSL_CTX_set_app_data(ctx_, this);
+    SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx_, &SslContext::handleTicketKey);
+    return true;
+}
+
+bool SslContext::generateTicketKey(TicketKey* key, int64_t now)
+{
+    key->created = now;
+    return RAND_bytes(key->name, sizeof(key->name)) == 1 &&
+           RAND_bytes(key->aesKey, sizeof(key->aesKey)) == 1 &&
+           RAND_bytes(key->hmacKey, sizeof(key->hmacKey)) == 1;
+}
+
+void SslContext::rotateTicketKeysIfNeeded(int64_t now)
+{
+    int64_t interval = config_.getTicketKeyRotation();
+    {
+        std::shared_lock<std::shared_mutex> lock(ticketMutex_);
+        if (now - currentKey_.created < interval)
+            return;
+    }
+
+    TicketKey fresh;
+    if (!generateTicketKey(&fresh, now))
+    {
+        handleSslError("Failed to rotate session ticket key");
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(ticketMutex_);
+    if (now - currentKey_.created < interval)
+        return; // 其他线程已经轮换过
+    previousKey_ = currentKey_;
+    hasPreviousKey_ = true;
+    currentKey_ = fresh;
+    ticketKeyRotations_.fetch_add(1, std::memory_order_relaxed);
+    LOG_INFO << "Session ticket key rotated";
+}
+
+// 返回值：1 使用该密钥；2 解密成功但应签发新票据；0 找不到密钥，走完整握手；-1 出错
+int SslContext::handleTicketKey(SSL* ssl, unsigned char keyName[16], unsigned char* iv,
+                                EVP_CIPHER_CTX* cipherCtx, EVP_MAC_CTX* macCtx, int enc)
+{
+    auto* self = static_cast<SslContext*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+    if (!self)
+        return -1;
+
+    int64_t now = static_cast<int64_t>(::time(nullptr));
+    self->rotateTicketKeysIfNeeded(now);
+
+    TicketKey key;
+    int result = 1;
+    {
+        std::shared_lock<std::shared_mutex> lock(self->ticketMutex_);
+        if (enc)
+        {
+            key = self->currentKey_;
+        }
+        else if (memcmp(keyName, self->currentKey_.name, sizeof(key.name)) == 0)
+        {
+            key = self->currentKey_;
+            // TLS 1.3 客户端每张票据只用一次，恢复后需要换发新票据，否则下次只能完整握手
+            if (SSL_version(ssl) >= TLS1_3_VERSION)
+                result = 2;
+        }
+        else if (self->hasPreviousKey_ &&
+                 memcmp(keyName, self->previousKey_.name, sizeof(key.name)) == 0)
+        {
+            key = self->previousKey_;
+            result = 2; // 旧密钥签发的票据，恢复后换发新票据
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    if (enc)
+    {
+        memcpy(keyName, key.name, sizeof(key.name));
+        if (RAND_bytes(iv, EVP_CIPHER_get_iv_length(EVP_aes_256_cbc())) != 1)
+            return -1;
+    }
+
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, key.hmacKey, sizeof(key.hmacKey)),
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>("SHA256"), 0),
+        OSSL_PARAM_construct_end()
+    };
+    if (EVP_MAC_CTX_set_params(macCtx, params) != 1)
+        return -1;
+
+    int ok = enc ? EVP_EncryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key.aesKey, iv)
+                 : EVP_DecryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key.aesKey, iv);
+    return ok == 1 ? result : -1;
+}
+
+int SslContext::allowEarlyData(SSL* ssl, void* arg)
+{
+    auto* self = static_cast<SslContext*>(arg);
+    SSL_SESSION* session = SSL_get0_session(ssl);
+    return session && self->sessionCache_ && self->sessionCache_->claimEarlyData(session) ? 1 : 0;
+}
+
+void SslContext::recordHandshake(SSL* ssl)
+{
+    handshakes_.fetch_add(1, std::memory_order_relaxed);
+    if (SSL_session_reused(ssl))
+        resumed_.fetch_add(1, std::memory_order_relaxed);
+
+    switch (SSL_get_early_data_status(ssl))
+    {
+        case SSL_EARLY_DATA_ACCEPTED:
+            earlyDataAccepted_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case SSL_EARLY_DATA_REJECTED:
+            earlyDataRejected_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        default:
+            break;
+    }
+}
+
+SslStats SslContext::getStats() const
+{
+    SslStats stats;
+    stats.handshakes = handshakes_.load(std::memory_order_relaxed);
+    stats.resumed = resumed_.load(std::memory_order_relaxed);
+    stats.earlyDataAccepted = earlyDataAccepted_.load(std::memory_order_relaxed);
+    stats.earlyDataRejected = earlyDataRejected_.load(std::memory_order_relaxed);
+    stats.ticketKeyRotations = ticketKeyRotations_.load(std::memory_order_relaxed);
+    if (sessionCache_)
+    {
+        stats.cacheHits = sessionCache_->hits();
+        stats.cacheMisses = sessionCache_->misses();
+        stats.cacheEvictions = sessionCache_->evictions();
+        stats.cacheSize = sessionCache_->size();
+    }
+    return stats;
 }
 
 void SslContext::handleSslError(const char* msg)
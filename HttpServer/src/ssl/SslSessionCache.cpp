@@ -0,0 +1,191 @@
+#include <ctime>
+#include <functional>
+
+#include "ssl/SslSessionCache.h"
+
+namespace ssl
+{
+
+SslSessionCache::SslSessionCache(size_t shardCount, size_t capacity, int timeoutSeconds)
+    : shards_(shardCount == 0 ? 1 : shardCount)
+    , shardCapacity_(0)
+    , timeoutSeconds_(timeoutSeconds)
+    , hits_(0)
+    , misses_(0)
+    , evictions_(0)
+{
+    shardCapacity_ = capacity / shards_.size();
+    if (shardCapacity_ == 0)
+        shardCapacity_ = 1;
+}
+
+int SslSessionCache::exDataIndex()
+{
+    static int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+void SslSessionCache::attach(SSL_CTX* ctx)
+{
+    SSL_CTX_set_ex_data(ctx, exDataIndex(), this);
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+    SSL_CTX_sess_set_new_cb(ctx, &SslSessionCache::onNewSession);
+    SSL_CTX_sess_set_get_cb(ctx, &SslSessionCache::onGetSession);
+    SSL_CTX_sess_set_remove_cb(ctx, &SslSessionCache::onRemoveSession);
+}
+
+size_t SslSessionCache::size() const
+{
+    size_t total = 0;
+    for (const auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.sessions.size();
+    }
+    return total;
+}
+
+SslSessionCache::Shard& SslSessionCache::shardFor(const std::string& id)
+{
+    return shards_[std::hash<std::string>()(id) % shards_.size()];
+}
+
+bool SslSessionCache::store(SSL_SESSION* session)
+{
+    unsigned int idLen = 0;
+    const unsigned char* idData = SSL_SESSION_get_id(session, &idLen);
+    int derLen = i2d_SSL_SESSION(session, nullptr);
+    if (idLen == 0 || derLen <= 0)
+        return false;
+
+    std::string id(reinterpret_cast<const char*>(idData), idLen);
+    std::string der(static_cast<size_t>(derLen), '\0');
+    unsigned char* p = reinterpret_cast<unsigned char*>(&der[0]);
+    i2d_SSL_SESSION(session, &p);
+
+    // 序列化在锁外完成，锁内只做表操作
+    Shard& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(id);
+    if (it != shard.sessions.end())
+    {
+        shard.lru.erase(it->second.lruPos);
+        shard.sessions.erase(it);
+    }
+    while (shard.sessions.size() >= shardCapacity_ && !shard.lru.empty())
+    {
+        shard.sessions.erase(shard.lru.back());
+        shard.lru.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.lru.push_front(id);
+    Entry& entry = shard.sessions[id];
+    entry.der = std::move(der);
+    entry.expiry = static_cast<int64_t>(::time(nullptr)) + timeoutSeconds_;
+    entry.lruPos = shard.lru.begin();
+    return true;
+}
+
+SSL_SESSION* SslSessionCache::lookup(const unsigned char* idData, int len)
+{
+    std::string id(reinterpret_cast<const char*>(idData), static_cast<size_t>(len));
+    std::string der;
+    {
+        Shard& shard = shardFor(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(id);
+        if (it == shard.sessions.end())
+        {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        if (it->second.expiry < static_cast<int64_t>(::time(nullptr)))
+        {
+            shard.lru.erase(it->second.lruPos);
+            shard.sessions.erase(it);
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lruPos);
+        der = it->second.der;
+    }
+
+    // 反序列化在锁外完成
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(der.data());
+    SSL_SESSION* session = d2i_SSL_SESSION(nullptr, &p, static_cast<long>(der.size()));
+    if (session)
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    else
+        misses_.fetch_add(1, std::memory_order_relaxed);
+    return session;
+}
+
+void SslSessionCache::remove(SSL_SESSION* session)
+{
+    unsigned int idLen = 0;
+    const unsigned char* idData = SSL_SESSION_get_id(session, &idLen);
+    std::string id(reinterpret_cast<const char*>(idData), idLen);
+
+    Shard& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(id);
+    if (it != shard.sessions.end())
+    {
+        shard.lru.erase(it->second.lruPos);
+        shard.sessions.erase(it);
+    }
+}
+
+bool SslSessionCache::claimEarlyData(SSL_SESSION* session)
+{
+    // TLS 1.3 每张票据都带有独立的会话 ID，作为票据的唯一标识
+    unsigned int idLen = 0;
+    const unsigned char* idData = SSL_SESSION_get_id(session, &idLen);
+    if (idLen == 0)
+        return false;
+    std::string id(reinterpret_cast<const char*>(idData), idLen);
+    int64_t now = static_cast<int64_t>(::time(nullptr));
+
+    Shard& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // 记录数超过容量时清理已过期的票据，过期票据本身也无法再用于恢复
+    if (shard.earlyDataUsed.size() >= shardCapacity_)
+    {
+        for (auto it = shard.earlyDataUsed.begin(); it != shard.earlyDataUsed.end(); )
+        {
+            if (it->second < now)
+                it = shard.earlyDataUsed.erase(it);
+            else
+                ++it;
+        }
+        if (shard.earlyDataUsed.size() >= shardCapacity_)
+            return false; // 无法记录时宁可拒绝 0-RTT，退回正常握手
+    }
+    return shard.earlyDataUsed.emplace(std::move(id), now + timeoutSeconds_).second;
+}
+
+int SslSessionCache::onNewSession(SSL* ssl, SSL_SESSION* session)
+{
+    auto* cache = static_cast<SslSessionCache*>(
+        SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), exDataIndex()));
+    if (cache)
+        cache->store(session);
+    return 0; // 会话已序列化保存，不持有 OpenSSL 的引用
+}
+
+SSL_SESSION* SslSessionCache::onGetSession(SSL* ssl, const unsigned char* id, int len, int* copy)
+{
+    *copy = 0; // 返回的会话交给 OpenSSL 释放
+    auto* cache = static_cast<SslSessionCache*>(
+        SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), exDataIndex()));
+    return cache ? cache->lookup(id, len) : nullptr;
+}
+
+void SslSessionCache::onRemoveSession(SSL_CTX* ctx, SSL_SESSION* session)
+{
+    auto* cache = static_cast<SslSessionCache*>(SSL_CTX_get_ex_data(ctx, exDataIndex()));
+    if (cache)
+        cache->remove(session);
+}
+
+} // namespace ssl
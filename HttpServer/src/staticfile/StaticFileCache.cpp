@@ -0,0 +1,495 @@
+#include "staticfile/StaticFileCache.h"
+
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#include <muduo/base/Logging.h>
+#include <zlib.h>
+#ifdef HTTP_HAS_BROTLI
+#include <brotli/encode.h>
+#endif
+
+namespace http
+{
+namespace staticfile
+{
+
+namespace
+{
+
+struct MimeType
+{
+    const char* extension;
+    const char* contentType;
+    bool        compressible;
+};
+
+// 只缓存常见的网页资源，目录中的配置、脚本等其他文件不会被加载和暴露
+const MimeType kMimeTypes[] = {
+    {"html",  "text/html; charset=utf-8",              true},
+    {"htm",   "text/html; charset=utf-8",              true},
+    {"css",   "text/css; charset=utf-8",               true},
+    {"js",    "application/javascript; charset=utf-8", true},
+    {"mjs",   "application/javascript; charset=utf-8", true},
+    {"map",   "application/json",                      true},
+    {"txt",   "text/plain; charset=utf-8",             true},
+    {"svg",   "image/svg+xml",                         true},
+    {"ico",   "image/x-icon",                          true},
+    {"png",   "image/png",                             false},
+    {"jpg",   "image/jpeg",                            false},
+    {"jpeg",  "image/jpeg",                            false},
+    {"gif",   "image/gif",                             false},
+    {"webp",  "image/webp",                            false},
+    {"woff",  "font/woff",                             false},
+    {"woff2", "font/woff2",                            false},
+    {"wasm",  "application/wasm",                      true},
+};
+
+const MimeType* findMimeType(const std::string& path)
+{
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos)
+        return nullptr;
+    std::string ext = path.substr(dot + 1);
+    for (auto& c : ext)
+        c = static_cast<char>(::tolower(static_cast<unsigned char>(c)));
+    for (const auto& type : kMimeTypes)
+    {
+        if (ext == type.extension)
+            return &type;
+    }
+    return nullptr;
+}
+
+std::string formatHttpDate(time_t t)
+{
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    char buf[64];
+    strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return buf;
+}
+
+// FNV-1a，用于生成跨进程稳定的 ETag
+uint64_t fnv1a(const char* data, size_t len)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::shared_ptr<const std::string> gzipCompress(const std::string& input)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // windowBits 15 + 16 输出 gzip 格式
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+        return nullptr;
+
+    std::string output(deflateBound(&stream, input.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    stream.avail_out = static_cast<uInt>(output.size());
+    int ret = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (ret != Z_STREAM_END)
+        return nullptr;
+    return std::make_shared<const std::string>(std::move(output));
+}
+
+std::shared_ptr<const std::string> brotliCompress(const std::string& input)
+{
+#ifdef HTTP_HAS_BROTLI
+    size_t outSize = BrotliEncoderMaxCompressedSize(input.size());
+    if (outSize == 0)
+        return nullptr;
+    std::string output(outSize, '\0');
+    if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                               input.size(), reinterpret_cast<const uint8_t*>(input.data()),
+                               &outSize, reinterpret_cast<uint8_t*>(&output[0])))
+        return nullptr;
+    output.resize(outSize);
+    return std::make_shared<const std::string>(std::move(output));
+#else
+    (void)input;
+    return nullptr;
+#endif
+}
+
+// 压缩收益不足 10% 时不保留压缩版本
+std::shared_ptr<const std::string> keepIfSmaller(std::shared_ptr<const std::string> compressed, size_t original)
+{
+    if (compressed && compressed->size() * 10 < original * 9)
+        return compressed;
+    return nullptr;
+}
+
+// Accept-Encoding 中是否接受某种编码（q=0 视为不接受）
+bool acceptsEncoding(const std::string& header, const char* encoding)
+{
+    size_t len = strlen(encoding);
+    size_t pos = 0;
+    while (pos < header.size())
+    {
+        size_t comma = header.find(',', pos);
+        if (comma == std::string::npos)
+            comma = header.size();
+        size_t begin = header.find_first_not_of(" \t", pos);
+        if (begin < comma && header.compare(begin, len, encoding) == 0)
+        {
+            size_t end = begin + len;
+            if (end == comma || header[end] == ';' || header[end] == ' ')
+            {
+                size_t q = header.find("q=", end);
+                return q >= comma || std::strtod(header.c_str() + q + 2, nullptr) > 0;
+            }
+        }
+        pos = comma + 1;
+    }
+    return false;
+}
+
+// If-None-Match 中是否包含与当前内容对应的 ETag（忽略弱校验前缀和编码后缀）
+bool etagMatches(const std::string& header, const std::string& etag)
+{
+    if (header.find('*') != std::string::npos)
+        return true;
+    // etag 形如 "xxxx"，去掉结尾引号后作为前缀匹配，兼容 "xxxx-gz" / "xxxx-br"
+    std::string prefix = etag.substr(0, etag.size() - 1);
+    size_t pos = header.find(prefix);
+    while (pos != std::string::npos)
+    {
+        size_t end = pos + prefix.size();
+        if (end < header.size() && (header[end] == '"' || header[end] == '-'))
+            return true;
+        pos = header.find(prefix, end);
+    }
+    return false;
+}
+
+} // namespace
+
+StaticFileCache::StaticFileCache(const std::string& root)
+    : StaticFileCache(root, Options())
+{}
+
+StaticFileCache::StaticFileCache(const std::string& root, const Options& options)
+    : root_(root)
+    , options_(options)
+    , inotifyFd_(-1)
+    , loop_(nullptr)
+{
+    if (!root_.empty() && root_.back() == '/')
+        root_.pop_back();
+}
+
+StaticFileCache::~StaticFileCache()
+{
+    if (channel_)
+    {
+        channel_->disableAll();
+        channel_->remove();
+    }
+    if (inotifyFd_ >= 0)
+        ::close(inotifyFd_);
+}
+
+size_t StaticFileCache::loadAll()
+{
+    size_t loaded = 0;
+    scanDirectory("", &loaded);
+    LOG_INFO << "Static files loaded from " << root_ << ": " << loaded;
+    return loaded;
+}
+
+void StaticFileCache::scanDirectory(const std::string& relDir, size_t* loaded)
+{
+    std::string dirPath = relDir.empty() ? root_ : root_ + "/" + relDir;
+    DIR* dir = ::opendir(dirPath.c_str());
+    if (!dir)
+    {
+        LOG_WARN << "Cannot open static directory " << dirPath;
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = ::readdir(dir)) != nullptr)
+    {
+        if (entry->d_name[0] == '.')
+            continue; // 跳过隐藏文件和 . / ..
+        std::string rel = relDir.empty() ? entry->d_name : relDir + "/" + entry->d_name;
+
+        struct stat st;
+        if (::stat((root_ + "/" + rel).c_str(), &st) != 0)
+            continue;
+        if (S_ISDIR(st.st_mode))
+        {
+            scanDirectory(rel, loaded);
+        }
+        else if (S_ISREG(st.st_mode) && findMimeType(rel))
+        {
+            reload(rel);
+            ++*loaded;
+        }
+    }
+    ::closedir(dir);
+}
+
+StaticFilePtr StaticFileCache::loadFile(const std::string& path) const
+{
+    const MimeType* mime = findMimeType(path);
+    if (!mime)
+        return nullptr;
+
+    std::string fullPath = root_ + "/" + path;
+    struct stat st;
+    if (::stat(fullPath.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        return nullptr;
+
+    auto file = std::make_shared<StaticFile>();
+    file->path = path;
+    file->contentType = mime->contentType;
+    file->lastModified = formatHttpDate(st.st_mtime);
+    file->size = static_cast<uint64_t>(st.st_size);
+
+    char etag[64];
+    if (file->size > options_.maxInMemorySize)
+    {
+        auto mapped = std::make_shared<const MappedFile>(fullPath);
+        if (!mapped->isValid())
+            return nullptr;
+        file->mapped = mapped;
+        file->size = mapped->size();
+        // 大文件不做全文哈希，用大小和修改时间生成 ETag
+        snprintf(etag, sizeof(etag), "\"%llx-%llx\"",
+                 static_cast<unsigned long long>(file->size),
+                 static_cast<unsigned long long>(st.st_mtime));
+        file->etag = etag;
+        return file;
+    }
+
+    std::ifstream in(fullPath, std::ios::binary);
+    if (!in)
+        return nullptr;
+    std::ostringstream oss;
+    oss << in.rdbuf();
+    auto content = std::make_shared<const std::string>(oss.str());
+    file->size = content->size();
+
+    snprintf(etag, sizeof(etag), "\"%llx-%016llx\"",
+             static_cast<unsigned long long>(content->size()),
+             static_cast<unsigned long long>(fnv1a(content->data(), content->size())));
+    file->etag = etag;
+
+    if (mime->compressible && content->size() >= options_.minCompressSize)
+    {
+        file->gzip = keepIfSmaller(gzipCompress(*content), content->size());
+        file->brotli = keepIfSmaller(brotliCompress(*content), content->size());
+    }
+    file->identity = std::move(content);
+    return file;
+}
+
+void StaticFileCache::reload(const std::string& path)
+{
+    // 读文件和压缩在锁外完成，只在替换指针时加锁；正在发送的旧版本由 shared_ptr 保持有效
+    StaticFilePtr file = loadFile(path);
+    if (!file)
+    {
+        remove(path);
+        return;
+    }
+    LOG_DEBUG << "Static file loaded: " << path << " (" << file->size << " bytes"
+              << (file->gzip ? ", gzip " + std::to_string(file->gzip->size()) : std::string())
+              << (file->brotli ? ", br " + std::to_string(file->brotli->size()) : std::string())
+              << ")";
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    files_[path] = std::move(file);
+}
+
+void StaticFileCache::remove(const std::string& path)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    files_.erase(path);
+}
+
+StaticFilePtr StaticFileCache::find(const std::string& path) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = files_.find(path);
+    return it != files_.end() ? it->second : nullptr;
+}
+
+size_t StaticFileCache::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return files_.size();
+}
+
+bool StaticFileCache::serve(const HttpRequest& req, HttpResponse* resp, const std::string& path) const
+{
+    StaticFilePtr file = find(path);
+    if (!file)
+        return false;
+
+    bool hasVariants = file->gzip || file->brotli;
+    resp->setCloseConnection(false);
+    resp->addHeader("Cache-Control", options_.cacheControl);
+    resp->addHeader("Last-Modified", file->lastModified);
+    if (hasVariants)
+        resp->addHeader("Vary", "Accept-Encoding");
+
+    std::string inm = req.getHeader("If-None-Match");
+    if (!inm.empty() && etagMatches(inm, file->etag))
+    {
+        resp->setStatusLine(req.getVersion(), HttpResponse::k304NotModified, "Not Modified");
+        resp->addHeader("ETag", file->etag);
+        return true;
+    }
+
+    resp->setStatusLine(req.getVersion(), HttpResponse::k200Ok, "OK");
+    resp->setContentType(file->contentType);
+
+    if (file->mapped)
+    {
+        resp->addHeader("ETag", file->etag);
+        resp->setSharedBody(file->mapped, file->mapped->data(), file->mapped->size());
+        return true;
+    }
+
+    // 优先 br，其次 gzip，内容直接引用缓存中的数据
+    std::string acceptEncoding = req.getHeader("Accept-Encoding");
+    std::shared_ptr<const std::string> body = file->identity;
+    std::string etag = file->etag;
+    if (file->brotli && acceptsEncoding(acceptEncoding, "br"))
+    {
+        body = file->brotli;
+        resp->addHeader("Content-Encoding", "br");
+        etag.insert(etag.size() - 1, "-br");
+    }
+    else if (file->gzip && acceptsEncoding(acceptEncoding, "gzip"))
+    {
+        body = file->gzip;
+        resp->addHeader("Content-Encoding", "gzip");
+        etag.insert(etag.size() - 1, "-gz");
+    }
+    resp->addHeader("ETag", etag);
+    resp->setSharedBody(body, body->data(), body->size());
+    return true;
+}
+
+bool StaticFileCache::watch(muduo::net::EventLoop* loop)
+{
+    inotifyFd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ < 0)
+    {
+        LOG_SYSERR << "inotify_init1 failed, static files will not be reloaded";
+        return false;
+    }
+
+    loop_ = loop;
+    addWatch("");
+    for (const auto& file : files_)
+    {
+        size_t slash = file.first.rfind('/');
+        if (slash != std::string::npos)
+            addWatch(file.first.substr(0, slash));
+    }
+
+    channel_.reset(new muduo::net::Channel(loop, inotifyFd_));
+    channel_->setReadCallback(std::bind(&StaticFileCache::handleInotify, this, std::placeholders::_1));
+    loop->runInLoop([this]() { channel_->enableReading(); });
+    return true;
+}
+
+void StaticFileCache::addWatch(const std::string& relDir)
+{
+    for (const auto& dir : watchDirs_)
+    {
+        if (dir.second == relDir)
+            return;
+    }
+    std::string dirPath = relDir.empty() ? root_ : root_ + "/" + relDir;
+    // 编辑器通常写临时文件后 rename 覆盖，因此同时关注 MOVED_TO
+    int wd = ::inotify_add_watch(inotifyFd_, dirPath.c_str(),
+                                 IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                                 IN_CREATE | IN_DELETE | IN_DELETE_SELF);
+    if (wd < 0)
+    {
+        LOG_SYSERR << "inotify_add_watch failed: " << dirPath;
+        return;
+    }
+    watchDirs_[wd] = relDir;
+}
+
+void StaticFileCache::handleInotify(muduo::Timestamp)
+{
+    alignas(struct inotify_event) char buf[4096];
+    for (;;)
+    {
+        ssize_t n = ::read(inotifyFd_, buf, sizeof(buf));
+        if (n <= 0)
+            break;
+
+        for (char* p = buf; p < buf + n; )
+        {
+            auto* event = reinterpret_cast<struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            auto dirIt = watchDirs_.find(event->wd);
+            if (dirIt == watchDirs_.end())
+                continue;
+            if (event->mask & (IN_DELETE_SELF | IN_IGNORED))
+            {
+                watchDirs_.erase(dirIt);
+                continue;
+            }
+            if (event->len == 0 || event->name[0] == '.')
+                continue;
+
+            std::string rel = dirIt->second.empty() ? event->name : dirIt->second + "/" + event->name;
+            if (event->mask & IN_ISDIR)
+            {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                {
+                    addWatch(rel);
+                    size_t loaded = 0;
+                    scanDirectory(rel, &loaded);
+                }
+                continue;
+            }
+            if (!findMimeType(rel))
+                continue;
+
+            if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+            {
+                LOG_INFO << "Static file removed: " << rel;
+                remove(rel);
+            }
+            else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+            {
+                LOG_INFO << "Static file changed: " << rel;
+                reload(rel);
+            }
+        }
+    }
+}
+
+} // namespace staticfile
+} // namespace http
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+#include <muduo/base/CurrentThread.h>
+#include <muduo/base/Logging.h>
+
+#include "trace/Tracer.h"
+#include "utils/JsonWriter.h"
+
+namespace http
+{
+namespace trace
+{
+
+namespace
+{
+
+thread_local TraceContext tCurrent;
+
+} // namespace
+
+int64_t nowNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string TraceContext::idString() const
+{
+    char buf[17];
+    snprintf(buf, sizeof buf, "%016llx", static_cast<unsigned long long>(requestId));
+    return buf;
+}
+
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer()
+    : sampleEvery_(0)
+    // 高位取启动时间（秒），低 20 位计数；每秒不超过约 100 万个请求时，重启后请求 ID 不与之前的重复
+    , nextId_(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                  std::chrono::system_clock::now().time_since_epoch()).count()) << 20)
+    , ring_(kDefaultCapacity)
+    , total_(0)
+{
+}
+
+void Tracer::setSampleRate(double rate)
+{
+    uint32_t every = 0;
+    if (rate > 0)
+        every = rate >= 1 ? 1 : static_cast<uint32_t>(std::lround(1.0 / rate));
+    sampleEvery_.store(every, std::memory_order_relaxed);
+}
+
+void Tracer::setCapacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ring_.assign(capacity > 0 ? capacity : 1, SpanRecord());
+    total_ = 0;
+}
+
+TraceContext Tracer::newTrace()
+{
+    TraceContext ctx;
+    ctx.requestId = nextId_.fetch_add(1, std::memory_order_relaxed);
+    uint32_t every = sampleEvery_.load(std::memory_order_relaxed);
+    ctx.sampled = every != 0 && ctx.requestId % every == 0;
+    return ctx;
+}
+
+void Tracer::record(const TraceContext& ctx, const char* name, int64_t startNs, int64_t endNs)
+{
+    if (!ctx.sampled)
+        return;
+    SpanRecord span{ctx.requestId, name, startNs, endNs, muduo::CurrentThread::tid()};
+    std::lock_guard<std::mutex> lock(mutex_);
+    ring_[total_ % ring_.size()] = span;
+    ++total_;
+}
+
+uint64_t Tracer::recorded() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_;
+}
+
+int Tracer::exportChromeTrace(const std::string& path) const
+{
+    std::vector<SpanRecord> spans;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t count = std::min<uint64_t>(total_, ring_.size());
+        size_t first = total_ > ring_.size() ? total_ % ring_.size() : 0;
+        spans.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            spans.push_back(ring_[(first + i) % ring_.size()]);
+    }
+
+    // 完整事件（ph = X），时间单位为微秒；同一请求的 span 以 args.request_id 关联
+    std::string out;
+    out.reserve(spans.size() * 128);
+    JsonWriter writer(&out);
+    writer.startObject().key("traceEvents").startArray();
+    char id[17];
+    for (const auto& span : spans)
+    {
+        snprintf(id, sizeof id, "%016llx", static_cast<unsigned long long>(span.requestId));
+        writer.startObject()
+              .member("name", span.name)
+              .member("cat", "request")
+              .member("ph", "X")
+              .member("ts", static_cast<double>(span.startNs) / 1000)
+              .member("dur", static_cast<double>(span.endNs - span.startNs) / 1000)
+              .member("pid", static_cast<int>(::getpid()))
+              .member("tid", span.tid);
+        writer.key("args").startObject().member("request_id", id).endObject();
+        writer.endObject();
+    }
+    writer.endArray().member("displayTimeUnit", "ms").endObject();
+
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(out.data(), static_cast<std::streamsize>(out.size())))
+        {
+            LOG_ERROR << "Failed to write trace file " << tmpPath;
+            return -1;
+        }
+    }
+    // 先写临时文件再改名，读取方不会看到写了一半的文件
+    if (::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        LOG_ERROR << "Failed to rename trace file to " << path;
+        return -1;
+    }
+    return static_cast<int>(spans.size());
+}
+
+const TraceContext& Tracer::current()
+{
+    return tCurrent;
+}
+
+void Tracer::setCurrent(const TraceContext& ctx)
+{
+    tCurrent = ctx;
+}
+
+} // namespace trace
+} // namespace http
@@ -1,5 +1,8 @@
 #include <muduo/base/Logging.h>
 
+#include "logging/Log.h"
+#include "metrics/MetricsRegistry.h"
+#include "trace/Tracer.h"
 #include "utils/db/DbConnectionPool.h"
 #include "utils/db/DbException.h"
 
@@ -56,8 +59,15 @@ DbConnectionPool::~DbConnectionPool()
 // 修改获取连接的函数
 std::shared_ptr<DbConnection> DbConnectionPool::getConnection() 
 {
+    static metrics::Histogram& waitTime = metrics::MetricsRegistry::instance().histogram(
+        "db_pool_wait_seconds", "Time spent waiting for a pooled database connection");
+    static metrics::Gauge& inUse = metrics::MetricsRegistry::instance().gauge(
+        "db_pool_connections_in_use", "Database connections currently checked out");
+
     std::shared_ptr<DbConnection> conn;
     {
+        trace::Span span("db.acquire");
+        metrics::ScopedTimer timer(waitTime);
         std::unique_lock<std::mutex> lock(mutex_);
         
         while (connections_.empty()) 
@@ -66,8 +76,10 @@ std::shared_ptr<DbConnection> DbConnectionPool::getConnection()
             {
                 throw DbException("Connection pool not initialized");
             }
-            LOG_INFO << "Waiting for available connection...";
+            LOG_MODULE_RATE("db", WARN, 1) << "Waiting for available connection";
+            waiters_.fetch_add(1, std::memory_order_relaxed);
             cv_.wait(lock);
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
         }
         
         conn = connections_.front();
@@ -77,14 +89,19 @@ std::shared_ptr<DbConnection> DbConnectionPool::getConnection()
     try 
     {
         // 在锁外检查连接
-        if (!conn->ping()) 
+        trace::Span pingSpan("db.ping");
+        bool alive = conn->ping();
+        pingSpan.end();
+        if (!alive) 
         {
             LOG_WARN << "Connection lost, attempting to reconnect...";
             conn->reconnect();
         }
         
+        inUse.add();
         return std::shared_ptr<DbConnection>(conn.get(), 
             [this, conn](DbConnection*) {
+                inUse.sub();
                 std::lock_guard<std::mutex> lock(mutex_);
                 connections_.push(conn);
                 cv_.notify_one();
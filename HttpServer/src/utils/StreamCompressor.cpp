@@ -0,0 +1,296 @@
+#include "utils/StreamCompressor.h"
+
+#include <cstring>
+
+#include <zlib.h>
+#ifdef HTTP_HAS_BROTLI
+#include <brotli/encode.h>
+#endif
+#ifdef HTTP_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace http
+{
+
+namespace
+{
+
+const size_t kOutputChunk = 16 * 1024;
+
+class ZlibCompressor : public StreamCompressor
+{
+public:
+    ZlibCompressor(ContentEncoding encoding, int level)
+        : StreamCompressor(encoding)
+        , finished_(false)
+    {
+        memset(&stream_, 0, sizeof(stream_));
+        // gzip 需要 windowBits + 16；HTTP 的 deflate 实际是 zlib 格式
+        int windowBits = encoding == ContentEncoding::kGzip ? 15 + 16 : 15;
+        ok_ = deflateInit2(&stream_, level < 0 ? 6 : level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    ~ZlibCompressor() override
+    {
+        if (ok_)
+            deflateEnd(&stream_);
+    }
+
+    bool valid() const
+    { return ok_; }
+
+    bool compress(const char* data, size_t len, bool flush, std::string* out) override
+    {
+        return run(data, len, flush ? Z_SYNC_FLUSH : Z_NO_FLUSH, out);
+    }
+
+    bool finish(std::string* out) override
+    {
+        if (finished_)
+            return true;
+        finished_ = true;
+        return run(nullptr, 0, Z_FINISH, out);
+    }
+
+private:
+    bool run(const char* data, size_t len, int mode, std::string* out)
+    {
+        if (!ok_ || (finished_ && mode != Z_FINISH))
+            return false;
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream_.avail_in = static_cast<uInt>(len);
+        // 没有新数据也没有 flush 时，deflate 不会产生输出
+        if (len == 0 && mode == Z_NO_FLUSH)
+            return true;
+        do
+        {
+            size_t oldSize = out->size();
+            out->resize(oldSize + kOutputChunk);
+            stream_.next_out = reinterpret_cast<Bytef*>(&(*out)[oldSize]);
+            stream_.avail_out = static_cast<uInt>(kOutputChunk);
+            int ret = deflate(&stream_, mode);
+            out->resize(oldSize + kOutputChunk - stream_.avail_out);
+            if (ret == Z_STREAM_ERROR)
+                return false;
+            if (ret == Z_STREAM_END)
+                break;
+        } while (stream_.avail_out == 0 || stream_.avail_in > 0);
+        return true;
+    }
+
+    z_stream stream_;
+    bool     ok_;
+    bool     finished_;
+};
+
+#ifdef HTTP_HAS_BROTLI
+class BrotliCompressor : public StreamCompressor
+{
+public:
+    explicit BrotliCompressor(int level)
+        : StreamCompressor(ContentEncoding::kBrotli)
+        , state_(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr))
+        , finished_(false)
+    {
+        if (state_)
+        {
+            // 动态内容使用中等质量，11 级的压缩速度对在线响应来说太慢
+            BrotliEncoderSetParameter(state_, BROTLI_PARAM_QUALITY, level < 0 ? 5 : level);
+            BrotliEncoderSetParameter(state_, BROTLI_PARAM_MODE, BROTLI_MODE_TEXT);
+        }
+    }
+
+    ~BrotliCompressor() override
+    {
+        if (state_)
+            BrotliEncoderDestroyInstance(state_);
+    }
+
+    bool valid() const
+    { return state_ != nullptr; }
+
+    bool compress(const char* data, size_t len, bool flush, std::string* out) override
+    {
+        return run(data, len, flush ? BROTLI_OPERATION_FLUSH : BROTLI_OPERATION_PROCESS, out);
+    }
+
+    bool finish(std::string* out) override
+    {
+        if (finished_)
+            return true;
+        finished_ = true;
+        return run(nullptr, 0, BROTLI_OPERATION_FINISH, out);
+    }
+
+private:
+    bool run(const char* data, size_t len, BrotliEncoderOperation op, std::string* out)
+    {
+        if (!state_ || (finished_ && op != BROTLI_OPERATION_FINISH))
+            return false;
+        const uint8_t* next = reinterpret_cast<const uint8_t*>(data);
+        size_t avail = len;
+        for (;;)
+        {
+            size_t availOut = 0;
+            if (!BrotliEncoderCompressStream(state_, op, &avail, &next, &availOut, nullptr, nullptr))
+                return false;
+            size_t outSize = 0;
+            const uint8_t* output = BrotliEncoderTakeOutput(state_, &outSize);
+            if (outSize > 0)
+                out->append(reinterpret_cast<const char*>(output), outSize);
+            if (avail == 0 && !BrotliEncoderHasMoreOutput(state_))
+            {
+                if (op != BROTLI_OPERATION_FINISH || BrotliEncoderIsFinished(state_))
+                    break;
+            }
+        }
+        return true;
+    }
+
+    BrotliEncoderState* state_;
+    bool                finished_;
+};
+#endif
+
+#ifdef HTTP_HAS_ZSTD
+class ZstdCompressor : public StreamCompressor
+{
+public:
+    explicit ZstdCompressor(int level)
+        : StreamCompressor(ContentEncoding::kZstd)
+        , ctx_(ZSTD_createCCtx())
+        , finished_(false)
+    {
+        if (ctx_)
+            ZSTD_CCtx_setParameter(ctx_, ZSTD_c_compressionLevel, level < 0 ? 3 : level);
+    }
+
+    ~ZstdCompressor() override
+    {
+        ZSTD_freeCCtx(ctx_);
+    }
+
+    bool valid() const
+    { return ctx_ != nullptr; }
+
+    bool compress(const char* data, size_t len, bool flush, std::string* out) override
+    {
+        return run(data, len, flush ? ZSTD_e_flush : ZSTD_e_continue, out);
+    }
+
+    bool finish(std::string* out) override
+    {
+        if (finished_)
+            return true;
+        finished_ = true;
+        return run(nullptr, 0, ZSTD_e_end, out);
+    }
+
+private:
+    bool run(const char* data, size_t len, ZSTD_EndDirective mode, std::string* out)
+    {
+        if (!ctx_ || (finished_ && mode != ZSTD_e_end))
+            return false;
+        ZSTD_inBuffer input = {data, len, 0};
+        for (;;)
+        {
+            size_t oldSize = out->size();
+            out->resize(oldSize + kOutputChunk);
+            ZSTD_outBuffer output = {&(*out)[oldSize], kOutputChunk, 0};
+            size_t remaining = ZSTD_compressStream2(ctx_, &output, &input, mode);
+            out->resize(oldSize + output.pos);
+            if (ZSTD_isError(remaining))
+                return false;
+            // continue 模式只需消耗完输入；flush / end 需要等内部缓冲清空
+            if (mode == ZSTD_e_continue ? input.pos == input.size : remaining == 0)
+                break;
+        }
+        return true;
+    }
+
+    ZSTD_CCtx* ctx_;
+    bool       finished_;
+};
+#endif
+
+} // namespace
+
+const char* contentEncodingName(ContentEncoding encoding)
+{
+    switch (encoding)
+    {
+    case ContentEncoding::kGzip:    return "gzip";
+    case ContentEncoding::kDeflate: return "deflate";
+    case ContentEncoding::kBrotli:  return "br";
+    case ContentEncoding::kZstd:    return "zstd";
+    default:                        return "identity";
+    }
+}
+
+bool contentEncodingSupported(ContentEncoding encoding)
+{
+    switch (encoding)
+    {
+    case ContentEncoding::kGzip:
+    case ContentEncoding::kDeflate:
+        return true;
+#ifdef HTTP_HAS_BROTLI
+    case ContentEncoding::kBrotli:
+        return true;
+#endif
+#ifdef HTTP_HAS_ZSTD
+    case ContentEncoding::kZstd:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+std::unique_ptr<StreamCompressor> StreamCompressor::create(ContentEncoding encoding, int level)
+{
+    switch (encoding)
+    {
+    case ContentEncoding::kGzip:
+    case ContentEncoding::kDeflate:
+    {
+        std::unique_ptr<ZlibCompressor> compressor(new ZlibCompressor(encoding, level));
+        if (compressor->valid())
+            return compressor;
+        break;
+    }
+#ifdef HTTP_HAS_BROTLI
+    case ContentEncoding::kBrotli:
+    {
+        std::unique_ptr<BrotliCompressor> compressor(new BrotliCompressor(level));
+        if (compressor->valid())
+            return compressor;
+        break;
+    }
+#endif
+#ifdef HTTP_HAS_ZSTD
+    case ContentEncoding::kZstd:
+    {
+        std::unique_ptr<ZstdCompressor> compressor(new ZstdCompressor(level));
+        if (compressor->valid())
+            return compressor;
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+    return nullptr;
+}
+
+bool StreamCompressor::compressAll(ContentEncoding encoding, int level, const std::string& input, std::string* out)
+{
+    auto compressor = create(encoding, level);
+    if (!compressor)
+        return false;
+    out->reserve(input.size() / 2);
+    return compressor->compress(input.data(), input.size(), false, out) && compressor->finish(out);
+}
+
+} // namespace http
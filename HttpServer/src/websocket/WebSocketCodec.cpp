@@ -0,0 +1,168 @@
+#include "websocket/WebSocketCodec.h"
+
+#include <cstring>
+
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace http
+{
+namespace websocket
+{
+
+namespace
+{
+const char kWebSocketGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+} // namespace
+
+WebSocketCodec::DecodeResult WebSocketCodec::decode(muduo::net::Buffer* buf, WebSocketFrame* frame, size_t maxPayload)
+{
+    size_t readable = buf->readableBytes();
+    if (readable < 2)
+        return kIncomplete;
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(buf->peek());
+    bool fin = (p[0] & 0x80) != 0;
+    bool rsv1 = (p[0] & 0x40) != 0;
+    uint8_t opcode = p[0] & 0x0F;
+    bool masked = (p[1] & 0x80) != 0;
+    uint64_t len = p[1] & 0x7F;
+
+    // RSV2/RSV3 未协商扩展，必须为 0；客户端帧必须带掩码
+    if ((p[0] & 0x30) != 0 || !masked)
+        return kProtocolError;
+    if (opcode != kContinuation && opcode != kText && opcode != kBinary &&
+        opcode != kClose && opcode != kPing && opcode != kPong)
+        return kProtocolError;
+
+    bool isControl = (opcode & 0x08) != 0;
+    // 控制帧不能分片，负载不超过 125 字节，且不能压缩
+    if (isControl && (!fin || len > 125 || rsv1))
+        return kProtocolError;
+
+    size_t headerLen = 2;
+    if (len == 126)
+    {
+        if (readable < 4)
+            return kIncomplete;
+        len = (static_cast<uint64_t>(p[2]) << 8) | p[3];
+        headerLen = 4;
+    }
+    else if (len == 127)
+    {
+        if (readable < 10)
+            return kIncomplete;
+        len = 0;
+        for (int i = 0; i < 8; ++i)
+            len = (len << 8) | p[2 + i];
+        if (len >> 63)
+            return kProtocolError;
+        headerLen = 10;
+    }
+
+    if (len > maxPayload)
+        return kTooLarge;
+
+    uint8_t key[4];
+    if (readable < headerLen + 4)
+        return kIncomplete;
+    memcpy(key, p + headerLen, 4);
+    headerLen += 4;
+
+    if (readable < headerLen + len)
+        return kIncomplete;
+
+    frame->fin = fin;
+    frame->rsv1 = rsv1;
+    frame->opcode = static_cast<Opcode>(opcode);
+    frame->payload.assign(buf->peek() + headerLen, static_cast<size_t>(len));
+    unmask(&frame->payload[0], frame->payload.size(), key);
+
+    buf->retrieve(headerLen + static_cast<size_t>(len));
+    return kFrameReady;
+}
+
+void WebSocketCodec::encode(std::string* out, Opcode opcode, const char* data, size_t len, bool fin, bool rsv1)
+{
+    char header[10];
+    size_t headerLen = 2;
+    header[0] = static_cast<char>((fin ? 0x80 : 0x00) | (rsv1 ? 0x40 : 0x00) | opcode);
+    if (len < 126)
+    {
+        header[1] = static_cast<char>(len);
+    }
+    else if (len <= 0xFFFF)
+    {
+        header[1] = 126;
+        header[2] = static_cast<char>((len >> 8) & 0xFF);
+        header[3] = static_cast<char>(len & 0xFF);
+        headerLen = 4;
+    }
+    else
+    {
+        header[1] = 127;
+        uint64_t n = len;
+        for (int i = 7; i >= 0; --i)
+        {
+            header[2 + i] = static_cast<char>(n & 0xFF);
+            n >>= 8;
+        }
+        headerLen = 10;
+    }
+    out->reserve(out->size() + headerLen + len);
+    out->append(header, headerLen);
+    out->append(data, len);
+}
+
+void WebSocketCodec::unmask(char* data, size_t len, const uint8_t key[4])
+{
+    size_t i = 0;
+    // 掩码按负载偏移 i % 4 循环，从 0 开始按 16/32 字节整块处理时相位保持不变
+    uint32_t key32;
+    memcpy(&key32, key, 4);
+#if defined(__AVX2__)
+    const __m256i mask256 = _mm256_set1_epi32(static_cast<int>(key32));
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_xor_si256(v, mask256));
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i mask128 = _mm_set1_epi32(static_cast<int>(key32));
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_xor_si128(v, mask128));
+    }
+#endif
+    for (; i + 4 <= len; i += 4)
+    {
+        uint32_t v;
+        memcpy(&v, data + i, 4);
+        v ^= key32;
+        memcpy(data + i, &v, 4);
+    }
+    for (; i < len; ++i)
+    {
+        data[i] = static_cast<char>(data[i] ^ key[i & 3]);
+    }
+}
+
+std::string WebSocketCodec::computeAcceptKey(const std::string& clientKey)
+{
+    std::string input = clientKey + kWebSocketGuid;
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    SHA1(reinterpret_cast<const unsigned char*>(input.data()), input.size(), digest);
+
+    unsigned char encoded[4 * ((SHA_DIGEST_LENGTH + 2) / 3) + 1];
+    int n = EVP_EncodeBlock(encoded, digest, SHA_DIGEST_LENGTH);
+    return std::string(reinterpret_cast<char*>(encoded), n);
+}
+
+} // namespace websocket
+} // namespace http
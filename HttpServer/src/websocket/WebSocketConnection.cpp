@@ -0,0 +1,332 @@
+#include "websocket/WebSocketConnection.h"
+#include "websocket/WebSocketHandler.h"
+#include "http/HttpContext.h"
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+
+namespace http
+{
+namespace websocket
+{
+
+namespace
+{
+// 发出关闭帧后等待对端回应的最长时间
+const double kCloseTimeoutSeconds = 5.0;
+// 单条消息默认上限
+const size_t kDefaultMaxMessageSize = 1024 * 1024;
+
+// 严格的 UTF-8 校验：拒绝超长编码、代理区码点和超过 U+10FFFF 的码点
+bool isValidUtf8(const std::string& text)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* end = p + text.size();
+    while (p < end)
+    {
+        unsigned char c = *p;
+        if (c < 0x80)
+        {
+            ++p;
+            continue;
+        }
+        size_t len;
+        unsigned char lo = 0x80;
+        unsigned char hi = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF)
+        {
+            len = 2;
+        }
+        else if (c >= 0xE0 && c <= 0xEF)
+        {
+            len = 3;
+            if (c == 0xE0)
+                lo = 0xA0;
+            else if (c == 0xED)
+                hi = 0x9F;
+        }
+        else if (c >= 0xF0 && c <= 0xF4)
+        {
+            len = 4;
+            if (c == 0xF0)
+                lo = 0x90;
+            else if (c == 0xF4)
+                hi = 0x8F;
+        }
+        else
+        {
+            return false;
+        }
+        if (static_cast<size_t>(end - p) < len)
+            return false;
+        // 第二个字节的范围随首字节收窄，其余续字节为 0x80 ~ 0xBF
+        if (p[1] < lo || p[1] > hi)
+            return false;
+        for (size_t i = 2; i < len; ++i)
+        {
+            if ((p[i] & 0xC0) != 0x80)
+                return false;
+        }
+        p += len;
+    }
+    return true;
+}
+} // namespace
+
+WebSocketConnection::WebSocketConnection(const muduo::net::TcpConnectionPtr& conn, std::shared_ptr<WebSocketHandler> handler)
+    : conn_(conn)
+    , handler_(std::move(handler))
+    , name_(conn->name())
+    , maxMessageSize_(kDefaultMaxMessageSize)
+    , fragmentOpcode_(kContinuation)
+    , fragmentCompressed_(false)
+    , closeSent_(false)
+    , closed_(false)
+{}
+
+void WebSocketConnection::onData(muduo::net::Buffer* buf)
+{
+    while (!closed_.load(std::memory_order_acquire))
+    {
+        WebSocketFrame frame;
+        WebSocketCodec::DecodeResult result = WebSocketCodec::decode(buf, &frame, maxMessageSize_);
+        if (result == WebSocketCodec::kIncomplete)
+            return;
+        if (result == WebSocketCodec::kProtocolError)
+        {
+            failConnection(kProtocolError);
+            break;
+        }
+        if (result == WebSocketCodec::kTooLarge)
+        {
+            failConnection(kMessageTooBig);
+            break;
+        }
+        handleFrame(frame);
+    }
+    // 关闭后收到的数据直接丢弃
+    buf->retrieveAll();
+}
+
+void WebSocketConnection::onDisconnected()
+{
+    notifyClose(kAbnormalClosure);
+}
+
+void WebSocketConnection::handleFrame(WebSocketFrame& frame)
+{
+    // 未协商压缩时 RSV1 必须为 0，续帧也不能带 RSV1
+    if (frame.rsv1 && (!deflate_ || frame.opcode == kContinuation))
+    {
+        failConnection(kProtocolError);
+        return;
+    }
+
+    switch (frame.opcode)
+    {
+    case kPing:
+        sendFrameInLoop(kPong, frame.payload);
+        break;
+    case kPong:
+        break;
+    case kClose:
+    {
+        uint16_t code = kNoStatus;
+        if (frame.payload.size() == 1)
+        {
+            failConnection(kProtocolError);
+            return;
+        }
+        if (frame.payload.size() >= 2)
+        {
+            code = static_cast<uint16_t>((static_cast<uint8_t>(frame.payload[0]) << 8) |
+                                         static_cast<uint8_t>(frame.payload[1]));
+        }
+        if (!closeSent_)
+        {
+            // 回应关闭帧，只带状态码
+            sendFrameInLoop(kClose, frame.payload.substr(0, 2));
+        }
+        notifyClose(code);
+        if (auto conn = conn_.lock())
+        {
+            conn->shutdown();
+        }
+        break;
+    }
+    case kText:
+    case kBinary:
+        if (fragmentOpcode_ != kContinuation)
+        {
+            // 上一条分片消息尚未结束
+            failConnection(kProtocolError);
+            return;
+        }
+        if (frame.fin)
+        {
+            handleMessage(frame.opcode, frame.rsv1, frame.payload);
+        }
+        else
+        {
+            fragmentOpcode_ = frame.opcode;
+            fragmentCompressed_ = frame.rsv1;
+            fragmentBuffer_.swap(frame.payload);
+        }
+        break;
+    case kContinuation:
+        if (fragmentOpcode_ == kContinuation)
+        {
+            failConnection(kProtocolError);
+            return;
+        }
+        if (fragmentBuffer_.size() + frame.payload.size() > maxMessageSize_)
+        {
+            failConnection(kMessageTooBig);
+            return;
+        }
+        fragmentBuffer_.append(frame.payload);
+        if (frame.fin)
+        {
+            std::string message;
+            message.swap(fragmentBuffer_);
+            Opcode opcode = fragmentOpcode_;
+            fragmentOpcode_ = kContinuation;
+            handleMessage(opcode, fragmentCompressed_, message);
+        }
+        break;
+    }
+}
+
+void WebSocketConnection::handleMessage(Opcode opcode, bool compressed, std::string& payload)
+{
+    if (compressed)
+    {
+        std::string inflated;
+        if (!deflate_->decompress(payload, &inflated, maxMessageSize_))
+        {
+            failConnection(kInvalidPayload);
+            return;
+        }
+        payload.swap(inflated);
+    }
+    // RFC 6455 8.1：文本消息不是合法 UTF-8 时以 1007 关闭
+    if (opcode == kText && !isValidUtf8(payload))
+    {
+        failConnection(kInvalidPayload);
+        return;
+    }
+
+    try
+    {
+        handler_->onMessage(shared_from_this(), payload, opcode == kBinary);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR << "WebSocket handler exception on " << name_ << ": " << e.what();
+        failConnection(kInternalError);
+    }
+}
+
+void WebSocketConnection::sendText(const std::string& message)
+{
+    sendFrame(kText, message);
+}
+
+void WebSocketConnection::sendBinary(const std::string& message)
+{
+    sendFrame(kBinary, message);
+}
+
+void WebSocketConnection::ping(const std::string& payload)
+{
+    sendFrame(kPing, payload.substr(0, 125));
+}
+
+void WebSocketConnection::close(uint16_t code, const std::string& reason)
+{
+    std::string payload;
+    payload.push_back(static_cast<char>(code >> 8));
+    payload.push_back(static_cast<char>(code & 0xFF));
+    payload.append(reason, 0, 123);
+    sendFrame(kClose, std::move(payload));
+}
+
+bool WebSocketConnection::connected() const
+{
+    auto conn = conn_.lock();
+    return conn && conn->connected() && !closed_.load(std::memory_order_acquire);
+}
+
+void WebSocketConnection::sendFrame(Opcode opcode, std::string data)
+{
+    auto conn = conn_.lock();
+    if (!conn || !conn->connected())
+        return;
+    auto self = shared_from_this();
+    conn->getLoop()->runInLoop([self, opcode, data = std::move(data)]() {
+        self->sendFrameInLoop(opcode, data);
+    });
+}
+
+void WebSocketConnection::sendFrameInLoop(Opcode opcode, const std::string& data)
+{
+    if (closeSent_)
+        return;
+    auto conn = conn_.lock();
+    if (!conn || !conn->connected())
+        return;
+
+    const std::string* payload = &data;
+    std::string compressed;
+    bool rsv1 = false;
+    if (deflate_ && (opcode == kText || opcode == kBinary) &&
+        data.size() >= WebSocketDeflate::kMinCompressSize &&
+        deflate_->compress(data, &compressed))
+    {
+        payload = &compressed;
+        rsv1 = true;
+    }
+
+    std::string frame;
+    WebSocketCodec::encode(&frame, opcode, payload->data(), payload->size(), true, rsv1);
+    HttpContext::send(conn, frame);
+
+    if (opcode == kClose)
+    {
+        closeSent_ = true;
+        if (closed_.load(std::memory_order_acquire))
+        {
+            conn->shutdown();
+        }
+        else
+        {
+            // 等待对端回应关闭帧，超时后强制断开
+            conn->forceCloseWithDelay(kCloseTimeoutSeconds);
+        }
+    }
+}
+
+void WebSocketConnection::failConnection(uint16_t code)
+{
+    LOG_WARN << "WebSocket " << name_ << " failed with close code " << code;
+    std::string payload;
+    payload.push_back(static_cast<char>(code >> 8));
+    payload.push_back(static_cast<char>(code & 0xFF));
+    sendFrameInLoop(kClose, payload);
+    notifyClose(code);
+    if (auto conn = conn_.lock())
+    {
+        conn->shutdown();
+    }
+}
+
+void WebSocketConnection::notifyClose(uint16_t code)
+{
+    bool expected = false;
+    if (!closed_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return;
+    handler_->onClose(shared_from_this(), code);
+}
+
+} // namespace websocket
+} // namespace http
@@ -0,0 +1,209 @@
+#include "websocket/WebSocketDeflate.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+namespace http
+{
+namespace websocket
+{
+
+namespace
+{
+const unsigned char kDeflateTail[4] = {0x00, 0x00, 0xff, 0xff};
+
+std::string trim(const std::string& s)
+{
+    size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::vector<std::string> split(const std::string& s, char delim)
+{
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, delim))
+    {
+        parts.push_back(trim(item));
+    }
+    return parts;
+}
+} // namespace
+
+WebSocketDeflate::WebSocketDeflate()
+    : deflateReady_(false)
+    , inflateReady_(false)
+    , serverNoContextTakeover_(false)
+    , serverWindowBits_(15)
+{
+    memset(&deflateStream_, 0, sizeof deflateStream_);
+    memset(&inflateStream_, 0, sizeof inflateStream_);
+}
+
+WebSocketDeflate::~WebSocketDeflate()
+{
+    if (deflateReady_)
+        deflateEnd(&deflateStream_);
+    if (inflateReady_)
+        inflateEnd(&inflateStream_);
+}
+
+bool WebSocketDeflate::negotiate(const std::string& offers, std::string* response)
+{
+    for (const auto& offer : split(offers, ','))
+    {
+        std::vector<std::string> params = split(offer, ';');
+        if (params.empty() || params[0] != "permessage-deflate")
+            continue;
+
+        bool accepted = true;
+        bool serverNoContextTakeover = false;
+        bool clientNoContextTakeover = false;
+        int serverWindowBits = 15;
+        bool hasServerWindowBits = false;
+
+        for (size_t i = 1; i < params.size(); ++i)
+        {
+            std::string name = params[i];
+            std::string value;
+            size_t eq = name.find('=');
+            if (eq != std::string::npos)
+            {
+                value = trim(name.substr(eq + 1));
+                name = trim(name.substr(0, eq));
+                if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+                    value = value.substr(1, value.size() - 2);
+            }
+
+            if (name == "server_no_context_takeover")
+            {
+                serverNoContextTakeover = true;
+            }
+            else if (name == "client_no_context_takeover")
+            {
+                clientNoContextTakeover = true;
+            }
+            else if (name == "server_max_window_bits")
+            {
+                serverWindowBits = atoi(value.c_str());
+                hasServerWindowBits = true;
+                // zlib 的原始 deflate 不支持 8 位窗口
+                if (serverWindowBits < 9 || serverWindowBits > 15)
+                    accepted = false;
+            }
+            else if (name == "client_max_window_bits")
+            {
+                // 解压端始终使用 15 位窗口，可以兼容客户端任意窗口大小
+            }
+            else
+            {
+                accepted = false;
+            }
+        }
+
+        if (!accepted)
+            continue;
+
+        serverNoContextTakeover_ = serverNoContextTakeover;
+        serverWindowBits_ = serverWindowBits;
+
+        *response = "permessage-deflate";
+        if (serverNoContextTakeover)
+            *response += "; server_no_context_takeover";
+        if (clientNoContextTakeover)
+            *response += "; client_no_context_takeover";
+        if (hasServerWindowBits)
+            *response += "; server_max_window_bits=" + std::to_string(serverWindowBits);
+        return true;
+    }
+    return false;
+}
+
+bool WebSocketDeflate::initDeflate()
+{
+    if (deflateReady_)
+        return true;
+    // 负的窗口位数表示输出不带 zlib 头尾的原始 deflate 数据
+    if (deflateInit2(&deflateStream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                     -serverWindowBits_, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+    deflateReady_ = true;
+    return true;
+}
+
+bool WebSocketDeflate::initInflate()
+{
+    if (inflateReady_)
+        return true;
+    if (inflateInit2(&inflateStream_, -15) != Z_OK)
+        return false;
+    inflateReady_ = true;
+    return true;
+}
+
+bool WebSocketDeflate::compress(const std::string& in, std::string* out)
+{
+    if (!initDeflate())
+        return false;
+
+    out->clear();
+    deflateStream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    deflateStream_.avail_in = static_cast<uInt>(in.size());
+
+    char chunk[16384];
+    do
+    {
+        deflateStream_.next_out = reinterpret_cast<Bytef*>(chunk);
+        deflateStream_.avail_out = sizeof chunk;
+        int ret = deflate(&deflateStream_, Z_SYNC_FLUSH);
+        if (ret != Z_OK && ret != Z_BUF_ERROR)
+            return false;
+        out->append(chunk, sizeof chunk - deflateStream_.avail_out);
+    } while (deflateStream_.avail_out == 0);
+
+    // 同步刷新以 00 00 ff ff 结尾，按协议需要去掉
+    if (out->size() >= 4 && memcmp(out->data() + out->size() - 4, kDeflateTail, 4) == 0)
+        out->resize(out->size() - 4);
+
+    if (serverNoContextTakeover_)
+        deflateReset(&deflateStream_);
+    return true;
+}
+
+bool WebSocketDeflate::decompress(const std::string& in, std::string* out, size_t maxSize)
+{
+    if (!initInflate())
+        return false;
+
+    std::string input = in;
+    input.append(reinterpret_cast<const char*>(kDeflateTail), 4);
+
+    out->clear();
+    inflateStream_.next_in = reinterpret_cast<Bytef*>(&input[0]);
+    inflateStream_.avail_in = static_cast<uInt>(input.size());
+
+    char chunk[16384];
+    do
+    {
+        inflateStream_.next_out = reinterpret_cast<Bytef*>(chunk);
+        inflateStream_.avail_out = sizeof chunk;
+        int ret = inflate(&inflateStream_, Z_SYNC_FLUSH);
+        if (ret != Z_OK && ret != Z_BUF_ERROR && ret != Z_STREAM_END)
+            return false;
+        out->append(chunk, sizeof chunk - inflateStream_.avail_out);
+        if (out->size() > maxSize)
+            return false;
+        if (ret == Z_BUF_ERROR)
+            break;
+    } while (inflateStream_.avail_in > 0 || inflateStream_.avail_out == 0);
+    return true;
+}
+
+} // namespace websocket
+} // namespace http
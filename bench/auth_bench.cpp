@@ -0,0 +1,95 @@
+// 登录口令哈希吞吐：PBKDF2-HMAC-SHA256（10000 次迭代）各实现的单核登录数 / 秒，
+// 以及经 AuthPool 排队、批量计算后回调的端到端吞吐
+//
+// ./auth_bench
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utils/AuthPool.h"
+#include "utils/Pbkdf2.h"
+#include "utils/PasswordUtil.h"
+
+namespace
+{
+
+const int kIterations = 10000;
+
+std::vector<Pbkdf2Task> makeTasks(size_t count)
+{
+    std::vector<Pbkdf2Task> tasks(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        tasks[i].password = "correct horse battery staple " + std::to_string(i);
+        tasks[i].salt = PasswordUtil::fromHex(PasswordUtil::generateSalt());
+    }
+    return tasks;
+}
+
+bool supported(Pbkdf2::Backend backend)
+{
+    switch (backend)
+    {
+    case Pbkdf2::kAvx2:   return __builtin_cpu_supports("avx2");
+    case Pbkdf2::kAvx512: return __builtin_cpu_supports("avx512f");
+    default:              return true;
+    }
+}
+
+// 一次计算一整批（16 条），items/s 即单核每秒可完成的登录数
+void BM_Pbkdf2(benchmark::State& state, Pbkdf2::Backend backend)
+{
+    if (!supported(backend))
+    {
+        state.SkipWithError("instruction set not supported");
+        return;
+    }
+    std::vector<Pbkdf2Task> tasks = makeTasks(16);
+    for (auto _ : state)
+    {
+        Pbkdf2::deriveBatch(tasks.data(), tasks.size(), kIterations, backend);
+        benchmark::DoNotOptimize(tasks[0].key);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tasks.size()));
+    state.SetLabel(Pbkdf2::backendName(backend));
+}
+BENCHMARK_CAPTURE(BM_Pbkdf2, OpenSsl, Pbkdf2::kOpenSsl)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Pbkdf2, Avx2, Pbkdf2::kAvx2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Pbkdf2, Avx512, Pbkdf2::kAvx512)->Unit(benchmark::kMillisecond);
+
+// 同时到达 range(0) 个登录请求，单线程 AuthPool 批量计算并逐个回调
+void BM_AuthPoolBurst(benchmark::State& state)
+{
+    const size_t burst = static_cast<size_t>(state.range(0));
+    AuthPool pool(1, burst);
+    std::string salt = PasswordUtil::generateSalt();
+    std::mutex mutex;
+    std::condition_variable done;
+    for (auto _ : state)
+    {
+        size_t remaining = burst;
+        for (size_t i = 0; i < burst; ++i)
+        {
+            pool.hash("correct horse battery staple", salt, [&](const std::string& hash) {
+                benchmark::DoNotOptimize(hash);
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--remaining == 0)
+                    done.notify_one();
+            }, kIterations);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return remaining == 0; });
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * burst));
+    state.SetLabel(Pbkdf2::backendName());
+}
+BENCHMARK(BM_AuthPoolBurst)->Arg(1)->Arg(16)->Arg(64)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
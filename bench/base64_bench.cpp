@@ -0,0 +1,120 @@
+// base64 编解码吞吐：标量 / SSE4.1 / AVX2 各实现在 1KB / 256KB / 4MB 负载下的 GB/s，
+// 以及解码到预分配缓冲、原地解码两种用法
+//
+// ./base64_bench
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "utils/base64.h"
+
+namespace
+{
+
+// 语音接口的音频负载
+std::string binaryPayload(size_t n)
+{
+    std::string data(n, '\0');
+    for (size_t i = 0; i < n; ++i)
+        data[i] = static_cast<char>((i * 2654435761u) >> 24);
+    return data;
+}
+
+const char* implName(Base64Impl impl)
+{
+    switch (impl)
+    {
+    case Base64Impl::Scalar: return "scalar";
+    case Base64Impl::Sse41:  return "sse4.1";
+    case Base64Impl::Avx2:   return "avx2";
+    default:                 return "auto";
+    }
+}
+
+// 当前 CPU 不支持时跳过，返回 false
+bool selectImpl(benchmark::State& state, Base64Impl impl)
+{
+    if (base64_set_impl(impl) != impl && impl != Base64Impl::Auto)
+    {
+        state.SkipWithError("instruction set not supported");
+        return false;
+    }
+    state.SetLabel(implName(base64_impl()));
+    return true;
+}
+
+void BM_Encode(benchmark::State& state, Base64Impl impl)
+{
+    if (!selectImpl(state, impl))
+        return;
+    std::string data = binaryPayload(static_cast<size_t>(state.range(0)));
+    std::string out(base64_encoded_length(data.size()), '\0');
+    for (auto _ : state)
+    {
+        size_t n = base64_encode_to(reinterpret_cast<const unsigned char*>(data.data()), data.size(), &out[0]);
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+
+void BM_Decode(benchmark::State& state, Base64Impl impl)
+{
+    if (!selectImpl(state, impl))
+        return;
+    std::string encoded = base64_encode(binaryPayload(static_cast<size_t>(state.range(0))));
+    std::string out(base64_decoded_max_length(encoded.size()), '\0');
+    for (auto _ : state)
+    {
+        size_t n = base64_decode_to(encoded.data(), encoded.size(), reinterpret_cast<unsigned char*>(&out[0]));
+        benchmark::DoNotOptimize(n);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * encoded.size()));
+}
+
+// 原地解码：每轮先恢复编码内容，恢复的耗时不计入
+void BM_DecodeInPlace(benchmark::State& state)
+{
+    selectImpl(state, Base64Impl::Auto);
+    std::string encoded = base64_encode(binaryPayload(static_cast<size_t>(state.range(0))));
+    std::string buffer = encoded;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        buffer = encoded;
+        state.ResumeTiming();
+        size_t n = base64_decode_to(buffer.data(), buffer.size(), reinterpret_cast<unsigned char*>(&buffer[0]));
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * encoded.size()));
+}
+
+// 经 std::string 接口，包含结果字符串的分配
+void BM_DecodeString(benchmark::State& state)
+{
+    selectImpl(state, Base64Impl::Auto);
+    std::string encoded = base64_encode(binaryPayload(static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        std::string decoded = base64_decode(encoded);
+        benchmark::DoNotOptimize(decoded);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * encoded.size()));
+}
+
+#define BASE64_SIZES ->Arg(1 << 10)->Arg(256 << 10)->Arg(4 << 20)
+
+BENCHMARK_CAPTURE(BM_Encode, Scalar, Base64Impl::Scalar) BASE64_SIZES;
+BENCHMARK_CAPTURE(BM_Encode, Sse41, Base64Impl::Sse41) BASE64_SIZES;
+BENCHMARK_CAPTURE(BM_Encode, Avx2, Base64Impl::Avx2) BASE64_SIZES;
+BENCHMARK_CAPTURE(BM_Decode, Scalar, Base64Impl::Scalar) BASE64_SIZES;
+BENCHMARK_CAPTURE(BM_Decode, Sse41, Base64Impl::Sse41) BASE64_SIZES;
+BENCHMARK_CAPTURE(BM_Decode, Avx2, Base64Impl::Avx2) BASE64_SIZES;
+BENCHMARK(BM_DecodeInPlace) BASE64_SIZES;
+BENCHMARK(BM_DecodeString) BASE64_SIZES;
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,268 @@
+// 热点函数回归基准：请求解析、路由、响应序列化、LLM 流式块解析、token 估算、base64、密码哈希、会话查找
+//
+// ./hotpath_bench --benchmark_out=hotpath.json --benchmark_out_format=json
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/Buffer.h>
+
+#include "http/HttpContext.h"
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+#include "router/Router.h"
+#include "session/SessionManager.h"
+#include "session/ShardedSessionStorage.h"
+#include "AIUtil/LLMParser.h"
+#include "utils/PasswordUtil.h"
+#include "utils/base64.h"
+
+using namespace http;
+
+namespace
+{
+
+// 浏览器发出的典型 GET 请求
+const char kGetRequest[] =
+    "GET /chat/sessions?page=1&size=20 HTTP/1.1\r\n"
+    "Host: chat.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/126.0 Safari/537.36\r\n"
+    "Accept: application/json, text/plain, */*\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+    "Referer: https://chat.example.com/chat\r\n"
+    "Cookie: sessionId=8f14e45fceea167a5a36dedd4bea2543; theme=dark\r\n"
+    "\r\n";
+
+// 前端发送一轮对话
+const char kPostRequest[] =
+    "POST /chat/send-stream HTTP/1.1\r\n"
+    "Host: chat.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "Content-Type: application/json\r\n"
+    "Accept: text/event-stream\r\n"
+    "Cookie: sessionId=8f14e45fceea167a5a36dedd4bea2543\r\n"
+    "Content-Length: 94\r\n"
+    "\r\n"
+    "{\"question\":\"Explain the reactor pattern in two sentences.\",\"modelType\":\"1\",\"sessionId\":\"123\"}";
+
+// 同一请求以分块编码发送
+const char kChunkedPostRequest[] =
+    "POST /chat/send-stream HTTP/1.1\r\n"
+    "Host: chat.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "Content-Type: application/json\r\n"
+    "Accept: text/event-stream\r\n"
+    "Cookie: sessionId=8f14e45fceea167a5a36dedd4bea2543\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "\r\n"
+    "2e\r\n"
+    "{\"question\":\"Explain the reactor pattern in tw\r\n"
+    "30\r\n"
+    "o sentences.\",\"modelType\":\"1\",\"sessionId\":\"123\"}\r\n"
+    "0\r\n"
+    "\r\n";
+
+void BM_ParseRequest(benchmark::State& state, const char* raw)
+{
+    std::string request(raw);
+    muduo::Timestamp now = muduo::Timestamp::now();
+    HttpContext context;
+    muduo::net::Buffer buf;
+    for (auto _ : state)
+    {
+        buf.append(request.data(), request.size());
+        bool ok = context.parseRequest(&buf, now);
+        benchmark::DoNotOptimize(ok);
+        context.reset();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * request.size()));
+}
+BENCHMARK_CAPTURE(BM_ParseRequest, Get, kGetRequest);
+BENCHMARK_CAPTURE(BM_ParseRequest, Post, kPostRequest);
+BENCHMARK_CAPTURE(BM_ParseRequest, ChunkedPost, kChunkedPostRequest);
+
+// 与 ChatServer 相同的静态路由，外加几条带路径参数的动态路由
+router::Router& chatRouter()
+{
+    static router::Router* instance = [] {
+        auto* r = new router::Router;
+        auto noop = [](const HttpRequest&, HttpResponse*) {};
+        const char* gets[] = {"/", "/entry", "/chat", "/chat/sessions", "/chat/stream", "/menu"};
+        const char* posts[] = {"/login", "/register", "/user/logout", "/chat/send", "/chat/tts",
+                               "/chat/history", "/chat/send-new-session", "/chat/send-stream"};
+        for (const char* path : gets)
+            r->registerCallback(HttpRequest::kGet, path, noop);
+        for (const char* path : posts)
+            r->registerCallback(HttpRequest::kPost, path, noop);
+        r->addRegexCallback(HttpRequest::kGet, "/static/:file", noop);
+        r->addRegexCallback(HttpRequest::kGet, "/chat/sessions/:sessionId", noop);
+        r->addRegexCallback(HttpRequest::kGet, "/chat/history/:sessionId/:page", noop);
+        return r;
+    }();
+    return *instance;
+}
+
+HttpRequest makeRequest(const std::string& method, const std::string& path)
+{
+    HttpRequest req;
+    req.setMethod(method.data(), method.data() + method.size());
+    req.setPath(path.data(), path.data() + path.size());
+    return req;
+}
+
+void BM_Route(benchmark::State& state, const char* method, const char* path)
+{
+    router::Router& r = chatRouter();
+    HttpRequest req = makeRequest(method, path);
+    for (auto _ : state)
+    {
+        HttpResponse resp;
+        bool found = r.route(req, &resp);
+        benchmark::DoNotOptimize(found);
+    }
+}
+BENCHMARK_CAPTURE(BM_Route, Static, "POST", "/chat/send-stream");
+// 最后一条动态路由才命中，需要依次尝试全部正则
+BENCHMARK_CAPTURE(BM_Route, Regex, "GET", "/chat/history/8f14e45fceea167a/3");
+BENCHMARK_CAPTURE(BM_Route, NotFound, "GET", "/no/such/path");
+
+void BM_AppendToBuffer(benchmark::State& state)
+{
+    std::string body(static_cast<size_t>(state.range(0)), 'x');
+    HttpResponse resp(false);
+    resp.setStatusLine("HTTP/1.1", HttpResponse::k200Ok, "OK");
+    resp.setContentType("application/json");
+    resp.addHeader("Cache-Control", "no-cache");
+    resp.setContentLength(body.size());
+    resp.setBody(body);
+    muduo::net::Buffer out;
+    for (auto _ : state)
+    {
+        resp.appendToBuffer(&out);
+        benchmark::DoNotOptimize(out.peek());
+        out.retrieveAll();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * body.size()));
+}
+BENCHMARK(BM_AppendToBuffer)->Arg(64)->Arg(4 << 10)->Arg(64 << 10);
+
+std::string dashScopeEvent(const std::string& text)
+{
+    return "data: {\"id\":\"chatcmpl-1\",\"object\":\"chat.completion.chunk\",\"model\":\"qwen-plus\","
+           "\"choices\":[{\"index\":0,\"delta\":{\"content\":\"" + text + "\"},\"finish_reason\":null}]}\n\n";
+}
+
+// curl 每次回调交出的数据块通常含 1~数个事件
+void BM_ParseLLMChunk(benchmark::State& state)
+{
+    std::string chunk;
+    for (int64_t i = 0; i < state.range(0); ++i)
+        chunk += dashScopeEvent("多路复用 ");
+    size_t deltas = 0;
+    for (auto _ : state)
+    {
+        std::string text = parseLLMChunk(chunk, &deltas);
+        benchmark::DoNotOptimize(text);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParseLLMChunk)->Arg(1)->Arg(8);
+
+void BM_CalculateTokens(benchmark::State& state)
+{
+    std::string text;
+    while (text.size() < static_cast<size_t>(state.range(0)))
+        text += "Reactor 模式由事件循环分发就绪事件, the handler runs on the IO thread. ";
+    for (auto _ : state)
+    {
+        int tokens = calculateTokens(text);
+        benchmark::DoNotOptimize(tokens);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_CalculateTokens)->Arg(256)->Arg(16 << 10);
+
+// 语音接口的音频负载大小
+std::string binaryPayload(size_t n)
+{
+    std::string data(n, '\0');
+    for (size_t i = 0; i < n; ++i)
+        data[i] = static_cast<char>((i * 2654435761u) >> 24);
+    return data;
+}
+
+void BM_Base64Encode(benchmark::State& state)
+{
+    std::string data = binaryPayload(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        std::string encoded = base64_encode(data);
+        benchmark::DoNotOptimize(encoded);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK(BM_Base64Encode)->Arg(1 << 10)->Arg(256 << 10);
+
+void BM_Base64Decode(benchmark::State& state)
+{
+    std::string encoded = base64_encode(binaryPayload(static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        std::string decoded = base64_decode(encoded);
+        benchmark::DoNotOptimize(decoded);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * encoded.size()));
+}
+BENCHMARK(BM_Base64Decode)->Arg(1 << 10)->Arg(256 << 10);
+
+// 注册 / 登录时的实际参数：32 字节盐、10000 次迭代
+void BM_HashPassword(benchmark::State& state)
+{
+    std::string salt = PasswordUtil::generateSalt();
+    for (auto _ : state)
+    {
+        std::string hash = PasswordUtil::hashPassword("correct horse battery staple", salt);
+        benchmark::DoNotOptimize(hash);
+    }
+}
+BENCHMARK(BM_HashPassword)->Unit(benchmark::kMillisecond);
+
+// 单线程命中查找，多线程与存储实现的对比见 session_bench
+void BM_GetSession(benchmark::State& state)
+{
+    const size_t kSessions = 10000;
+    session::SessionManager manager(std::make_unique<session::ShardedSessionStorage>());
+    HttpRequest empty;
+    std::vector<HttpRequest> requests;
+    requests.reserve(kSessions);
+    for (size_t i = 0; i < kSessions; ++i)
+    {
+        HttpResponse resp;
+        std::string line = "Cookie: sessionId=" + manager.getSession(empty, &resp)->getId();
+        const char* begin = line.data();
+        HttpRequest req;
+        req.addHeader(begin, begin + line.find(':'), begin + line.size());
+        requests.push_back(std::move(req));
+    }
+
+    size_t index = 0;
+    HttpResponse resp;
+    for (auto _ : state)
+    {
+        auto session = manager.getSession(requests[index], &resp);
+        benchmark::DoNotOptimize(session);
+        index = index + 1 == kSessions ? 0 : index + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetSession);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,146 @@
+// 聊天历史序列化：json DOM + dump 与 JsonWriter 流式写入对比，100 / 1k / 10k 条消息
+//
+// ./json_bench --benchmark_filter=History
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <muduo/net/Buffer.h>
+#include <nlohmann/json.hpp>
+
+#include "http/HttpResponse.h"
+#include "utils/JsonWriter.h"
+
+using json = nlohmann::json;
+using namespace http;
+
+namespace
+{
+
+struct Row
+{
+    bool        isUser;
+    std::string content;
+};
+
+// 模拟结果集：问答交替，内容包含中文、引号和换行
+std::vector<Row> makeRows(size_t n)
+{
+    std::vector<Row> rows;
+    rows.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        bool isUser = i % 2 == 0;
+        std::string content = isUser ? "请解释一下 \"Reactor\" 模式，第 " + std::to_string(i) + " 个问题"
+                                     : "Reactor 模式由事件循环分发就绪事件：\n1. 注册回调\n2. 等待就绪\n3. 调用处理函数。";
+        // 回答通常比问题长得多
+        if (!isUser)
+        {
+            while (content.size() < 600)
+                content += " 多路复用将多个连接的 IO 事件集中处理，避免为每个连接创建线程。";
+        }
+        rows.push_back({isUser, std::move(content)});
+    }
+    return rows;
+}
+
+// 原实现：逐行构造 DOM，dump 成字符串，setBody 拷贝，appendToBuffer 再拷贝
+void BM_HistoryDom(benchmark::State& state)
+{
+    std::vector<Row> rows = makeRows(static_cast<size_t>(state.range(0)));
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        json historyArray = json::array();
+        for (const auto& row : rows)
+        {
+            json msgJson;
+            msgJson["is_user"] = row.isUser;
+            msgJson["content"] = row.content;
+            historyArray.push_back(msgJson);
+        }
+        json successResp;
+        successResp["success"] = true;
+        successResp["history"] = historyArray;
+        std::string body = successResp.dump();
+
+        HttpResponse resp(false);
+        resp.setStatusLine("HTTP/1.1", HttpResponse::k200Ok, "OK");
+        resp.setContentType("application/json");
+        resp.setContentLength(body.size());
+        resp.setBody(body);
+
+        muduo::net::Buffer out;
+        resp.appendToBuffer(&out);
+        bytes = out.readableBytes();
+        benchmark::DoNotOptimize(out.peek());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+// JsonWriter 直接写入响应体，body 移交给响应，只剩 appendToBuffer 一次拷贝
+void BM_HistoryWriter(benchmark::State& state)
+{
+    std::vector<Row> rows = makeRows(static_cast<size_t>(state.range(0)));
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        std::string body;
+        JsonWriter writer(&body);
+        writer.startObject().member("success", true).key("history").startArray();
+        for (const auto& row : rows)
+        {
+            writer.startObject()
+                  .member("is_user", row.isUser)
+                  .member("content", row.content)
+                  .endObject();
+        }
+        writer.endArray().endObject();
+
+        HttpResponse resp(false);
+        resp.setStatusLine("HTTP/1.1", HttpResponse::k200Ok, "OK");
+        resp.setContentType("application/json");
+        resp.setContentLength(body.size());
+        resp.setBody(std::move(body));
+
+        muduo::net::Buffer out;
+        resp.appendToBuffer(&out);
+        bytes = out.readableBytes();
+        benchmark::DoNotOptimize(out.peek());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+// JsonWriter 直接写入输出缓冲（chunked 等无需预知长度的场景）
+void BM_HistoryWriterToBuffer(benchmark::State& state)
+{
+    std::vector<Row> rows = makeRows(static_cast<size_t>(state.range(0)));
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        muduo::net::Buffer out;
+        BufferJsonWriter writer(&out);
+        writer.startObject().member("success", true).key("history").startArray();
+        for (const auto& row : rows)
+        {
+            writer.startObject()
+                  .member("is_user", row.isUser)
+                  .member("content", row.content)
+                  .endObject();
+        }
+        writer.endArray().endObject();
+        bytes = out.readableBytes();
+        benchmark::DoNotOptimize(out.peek());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+} // namespace
+
+BENCHMARK(BM_HistoryDom)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_HistoryWriter)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_HistoryWriterToBuffer)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
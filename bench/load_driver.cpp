@@ -0,0 +1,832 @@
+// 端到端负载驱动：每个虚拟用户持有一条长连接，注册、登录后循环调用 /chat/send-stream，
+// 统计首 token 延迟（TTFT）、token 间隔（ITL）和整轮耗时，可选采样被测进程的 CPU 与内存
+//
+// 用法：load_driver [--host 127.0.0.1] [-p 端口] [-c 并发用户数] [-t IO线程数] [-d 秒]
+//                   [--turns-per-session 5] [--model 1] [--question 文本] [--server-pid PID]
+//                   [--user-prefix bench] [--password 密码]
+
+#include <getopt.h>
+#include <strings.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <muduo/base/Logging.h>
+#include <muduo/base/noncopyable.h>
+#include <muduo/net/Buffer.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThreadPool.h>
+#include <muduo/net/InetAddress.h>
+#include <muduo/net/TcpClient.h>
+
+namespace
+{
+
+struct Options
+{
+    std::string host = "127.0.0.1";
+    int         port = 80;
+    int         users = 50;
+    int         threads = 2;
+    double      durationSeconds = 30;
+    int         turnsPerSession = 5;
+    std::string model = "1";
+    std::string question = "Tell me a short story about a fox.";
+    int         serverPid = 0;
+    std::string userPrefix = "bench";
+    std::string password = "bench123";
+};
+
+Options gOptions;
+
+int64_t nowMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string jsonEscape(const std::string& s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s)
+    {
+        switch (c)
+        {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:   out += c; break;
+        }
+    }
+    return out;
+}
+
+// 从扁平 JSON 中取字符串字段，只用于 {"sessionId":"..."} 这类服务端固定格式
+std::string jsonStringField(const std::string& json, const std::string& key)
+{
+    std::string pattern = "\"" + key + "\":\"";
+    size_t pos = json.find(pattern);
+    if (pos == std::string::npos)
+        return std::string();
+    pos += pattern.size();
+    size_t end = json.find('"', pos);
+    return end == std::string::npos ? std::string() : json.substr(pos, end - pos);
+}
+
+bool iequals(const char* begin, const char* end, const char* s)
+{
+    size_t n = strlen(s);
+    return static_cast<size_t>(end - begin) == n && strncasecmp(begin, s, n) == 0;
+}
+
+// 各虚拟用户共享的统计，每完成一轮对话加一次锁
+class Stats : muduo::noncopyable
+{
+public:
+    void addTurn(int64_t ttftUs, int64_t latencyUs, const std::vector<int64_t>& gaps, size_t tokens)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++turns_;
+        tokens_ += tokens;
+        if (ttftUs >= 0)
+            ttft_.push_back(ttftUs);
+        latency_.push_back(latencyUs);
+        itl_.insert(itl_.end(), gaps.begin(), gaps.end());
+    }
+
+    void addError(const std::string& reason)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++errors_[reason];
+    }
+
+    void snapshot(uint64_t* turns, uint64_t* tokens, uint64_t* errors) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        *turns = turns_;
+        *tokens = tokens_;
+        *errors = 0;
+        for (const auto& e : errors_)
+            *errors += e.second;
+    }
+
+    void report(double seconds)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t errors = 0;
+        for (const auto& e : errors_)
+            errors += e.second;
+        printf("\nduration   %.1fs\n", seconds);
+        printf("turns      %lu ok, %lu failed, %.2f turns/s\n",
+               static_cast<unsigned long>(turns_), static_cast<unsigned long>(errors), turns_ / seconds);
+        printf("tokens     %lu, %.1f tokens/s\n", static_cast<unsigned long>(tokens_), tokens_ / seconds);
+        for (const auto& e : errors_)
+            printf("  error %-20s %lu\n", e.first.c_str(), static_cast<unsigned long>(e.second));
+        printf("%-10s %10s %10s %10s %10s %10s\n", "(ms)", "count", "p50", "p90", "p99", "max");
+        printLatency("ttft", &ttft_);
+        printLatency("itl", &itl_);
+        printLatency("turn", &latency_);
+    }
+
+private:
+    static void printLatency(const char* name, std::vector<int64_t>* samples)
+    {
+        if (samples->empty())
+        {
+            printf("%-10s %10d\n", name, 0);
+            return;
+        }
+        std::sort(samples->begin(), samples->end());
+        auto at = [samples](double q) {
+            size_t i = static_cast<size_t>(q * (samples->size() - 1));
+            return (*samples)[i] / 1000.0;
+        };
+        printf("%-10s %10zu %10.2f %10.2f %10.2f %10.2f\n",
+               name, samples->size(), at(0.50), at(0.90), at(0.99), samples->back() / 1000.0);
+    }
+
+    mutable std::mutex              mutex_;
+    uint64_t                        turns_ = 0;
+    uint64_t                        tokens_ = 0;
+    std::vector<int64_t>            ttft_;
+    std::vector<int64_t>            itl_;
+    std::vector<int64_t>            latency_;
+    std::map<std::string, uint64_t> errors_;
+};
+
+// 被测进程的 CPU 时间与常驻内存，取自 /proc/<pid>/stat 和 /proc/<pid>/status
+class ProcSampler
+{
+public:
+    explicit ProcSampler(int pid) : pid_(pid) {}
+
+    bool enabled() const { return pid_ > 0; }
+
+    void start()
+    {
+        if (!enabled())
+            return;
+        startTicks_ = cpuTicks();
+        startUs_ = nowMicros();
+        sample();
+    }
+
+    void sample()
+    {
+        if (!enabled())
+            return;
+        lastRssKb_ = rssKb();
+        peakRssKb_ = std::max(peakRssKb_, lastRssKb_);
+    }
+
+    // 采样区间内的平均 CPU 占用，100% 表示占满一个核
+    double cpuPercent() const
+    {
+        double seconds = (nowMicros() - startUs_) / 1e6;
+        double cpuSeconds = static_cast<double>(cpuTicks() - startTicks_) / sysconf(_SC_CLK_TCK);
+        return seconds > 0 ? cpuSeconds / seconds * 100 : 0;
+    }
+
+    long lastRssKb() const { return lastRssKb_; }
+    long peakRssKb() const { return peakRssKb_; }
+
+private:
+    long cpuTicks() const
+    {
+        std::ifstream in("/proc/" + std::to_string(pid_) + "/stat");
+        std::string stat;
+        std::getline(in, stat);
+        // 进程名可能含空格，从最后一个 ')' 之后开始数字段：state 为第 3 个字段，utime/stime 为第 14、15 个
+        size_t pos = stat.rfind(')');
+        if (pos == std::string::npos)
+            return 0;
+        std::vector<std::string> fields;
+        size_t i = pos + 2;
+        while (i < stat.size())
+        {
+            size_t end = stat.find(' ', i);
+            if (end == std::string::npos)
+                end = stat.size();
+            fields.push_back(stat.substr(i, end - i));
+            i = end + 1;
+        }
+        if (fields.size() < 13)
+            return 0;
+        return atol(fields[11].c_str()) + atol(fields[12].c_str());
+    }
+
+    long rssKb() const
+    {
+        std::ifstream in("/proc/" + std::to_string(pid_) + "/status");
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.compare(0, 6, "VmRSS:") == 0)
+                return atol(line.c_str() + 6);
+        }
+        return 0;
+    }
+
+    int     pid_;
+    long    startTicks_ = 0;
+    int64_t startUs_ = 0;
+    long    lastRssKb_ = 0;
+    long    peakRssKb_ = 0;
+};
+
+// 增量解析 HTTP/1.1 响应，支持 Content-Length、chunked 和读到连接关闭三种正文边界
+class ResponseParser
+{
+public:
+    using BodyCallback = std::function<void(const char*, size_t)>;
+
+    enum Result { kNeedMore, kComplete, kError };
+
+    void reset()
+    {
+        state_ = kStatusLine;
+        status_ = 0;
+        remaining_ = 0;
+        contentLength_ = -1;
+        chunked_ = false;
+        close_ = false;
+        cookies_.clear();
+    }
+
+    Result parse(muduo::net::Buffer* buf, const BodyCallback& onBody)
+    {
+        while (true)
+        {
+            switch (state_)
+            {
+            case kStatusLine:
+            {
+                const char* crlf = buf->findCRLF();
+                if (!crlf)
+                    return kNeedMore;
+                const char* space = std::find(buf->peek(), crlf, ' ');
+                if (space == crlf || strncmp(buf->peek(), "HTTP/1.", 7) != 0)
+                    return kError;
+                status_ = atoi(space + 1);
+                buf->retrieveUntil(crlf + 2);
+                state_ = kHeaders;
+                break;
+            }
+            case kHeaders:
+            {
+                const char* crlf = buf->findCRLF();
+                if (!crlf)
+                    return kNeedMore;
+                if (crlf == buf->peek())
+                {
+                    buf->retrieve(2);
+                    if (chunked_)
+                        state_ = kChunkSize;
+                    else if (contentLength_ >= 0)
+                    {
+                        remaining_ = contentLength_;
+                        state_ = remaining_ > 0 ? kBody : kDone;
+                    }
+                    else if (status_ == 204 || status_ == 304)
+                        state_ = kDone;
+                    else
+                        state_ = kUntilClose;
+                    break;
+                }
+                parseHeader(buf->peek(), crlf);
+                buf->retrieveUntil(crlf + 2);
+                break;
+            }
+            case kBody:
+            case kChunkData:
+            {
+                if (buf->readableBytes() == 0)
+                    return kNeedMore;
+                size_t n = std::min(buf->readableBytes(), static_cast<size_t>(remaining_));
+                onBody(buf->peek(), n);
+                buf->retrieve(n);
+                remaining_ -= n;
+                if (remaining_ == 0)
+                    state_ = state_ == kBody ? kDone : kChunkEnd;
+                break;
+            }
+            case kChunkSize:
+            {
+                const char* crlf = buf->findCRLF();
+                if (!crlf)
+                    return kNeedMore;
+                char* end = nullptr;
+                remaining_ = strtol(buf->peek(), &end, 16);
+                if (end == buf->peek() || remaining_ < 0)
+                    return kError;
+                buf->retrieveUntil(crlf + 2);
+                state_ = remaining_ > 0 ? kChunkData : kTrailers;
+                break;
+            }
+            case kChunkEnd:
+                if (buf->readableBytes() < 2)
+                    return kNeedMore;
+                if (memcmp(buf->peek(), "\r\n", 2) != 0)
+                    return kError;
+                buf->retrieve(2);
+                state_ = kChunkSize;
+                break;
+            case kTrailers:
+            {
+                const char* crlf = buf->findCRLF();
+                if (!crlf)
+                    return kNeedMore;
+                bool last = crlf == buf->peek();
+                buf->retrieveUntil(crlf + 2);
+                if (last)
+                    state_ = kDone;
+                break;
+            }
+            case kUntilClose:
+                if (buf->readableBytes() > 0)
+                {
+                    onBody(buf->peek(), buf->readableBytes());
+                    buf->retrieveAll();
+                }
+                return kNeedMore;
+            case kDone:
+                return kComplete;
+            }
+        }
+    }
+
+    // 没有长度信息的响应以连接关闭作为结束
+    bool completesOnClose() const { return state_ == kUntilClose; }
+    bool inProgress() const { return state_ != kStatusLine && state_ != kDone; }
+    int status() const { return status_; }
+    bool closeConnection() const { return close_; }
+    const std::vector<std::string>& cookies() const { return cookies_; }
+
+private:
+    enum State { kStatusLine, kHeaders, kBody, kChunkSize, kChunkData, kChunkEnd, kTrailers, kUntilClose, kDone };
+
+    void parseHeader(const char* begin, const char* end)
+    {
+        const char* colon = std::find(begin, end, ':');
+        if (colon == end)
+            return;
+        const char* value = colon + 1;
+        while (value < end && *value == ' ')
+            ++value;
+        std::string v(value, end);
+        if (iequals(begin, colon, "Content-Length"))
+            contentLength_ = atol(v.c_str());
+        else if (iequals(begin, colon, "Transfer-Encoding"))
+            chunked_ = strcasestr(v.c_str(), "chunked") != nullptr;
+        else if (iequals(begin, colon, "Connection"))
+            close_ = strcasecmp(v.c_str(), "close") == 0;
+        else if (iequals(begin, colon, "Set-Cookie"))
+            cookies_.push_back(v.substr(0, v.find(';')));
+    }
+
+    State                    state_ = kStatusLine;
+    int                      status_ = 0;
+    long                     remaining_ = 0;
+    long                     contentLength_ = -1;
+    bool                     chunked_ = false;
+    bool                     close_ = false;
+    std::vector<std::string> cookies_;
+};
+
+// SSE 事件流解析，事件以空行分隔，只关心 event 和 data 两个字段
+class SseParser
+{
+public:
+    using EventCallback = std::function<void(const std::string& event, const std::string& data)>;
+
+    void reset()
+    {
+        pending_.clear();
+        event_.clear();
+        data_.clear();
+    }
+
+    void feed(const char* data, size_t len, const EventCallback& onEvent)
+    {
+        pending_.append(data, len);
+        size_t start = 0;
+        size_t nl;
+        while ((nl = pending_.find('\n', start)) != std::string::npos)
+        {
+            size_t end = nl > start && pending_[nl - 1] == '\r' ? nl - 1 : nl;
+            if (end == start)
+            {
+                if (!event_.empty() || !data_.empty())
+                    onEvent(event_.empty() ? "message" : event_, data_);
+                event_.clear();
+                data_.clear();
+            }
+            else if (pending_.compare(start, 6, "event:") == 0)
+                event_ = trim(pending_.substr(start + 6, end - start - 6));
+            else if (pending_.compare(start, 5, "data:") == 0)
+            {
+                if (!data_.empty())
+                    data_ += '\n';
+                data_ += trim(pending_.substr(start + 5, end - start - 5));
+            }
+            start = nl + 1;
+        }
+        pending_.erase(0, start);
+    }
+
+private:
+    static std::string trim(const std::string& s)
+    {
+        return !s.empty() && s[0] == ' ' ? s.substr(1) : s;
+    }
+
+    std::string pending_;
+    std::string event_;
+    std::string data_;
+};
+
+// 一个虚拟用户：注册 -> 登录 -> 循环发送流式对话，每 turnsPerSession 轮换一个新会话
+// 所有状态只在所属 IO 线程中访问
+class VirtualUser : muduo::noncopyable
+{
+public:
+    VirtualUser(muduo::net::EventLoop* loop, const muduo::net::InetAddress& addr, int index,
+                Stats* stats, const std::atomic<bool>* running, std::atomic<int>* active)
+        : client_(loop, addr, "vu" + std::to_string(index)),
+          username_(gOptions.userPrefix + std::to_string(index)),
+          stats_(stats),
+          running_(running),
+          active_(active)
+    {
+        client_.enableRetry();
+        client_.setConnectionCallback(
+            [this](const muduo::net::TcpConnectionPtr& conn) { onConnection(conn); });
+        client_.setMessageCallback(
+            [this](const muduo::net::TcpConnectionPtr& conn, muduo::net::Buffer* buf, muduo::Timestamp) {
+                onMessage(conn, buf);
+            });
+    }
+
+    void start() { client_.connect(); }
+
+private:
+    enum Stage { kRegister, kLogin, kChat, kStopped };
+
+    void onConnection(const muduo::net::TcpConnectionPtr& conn)
+    {
+        if (conn->connected())
+        {
+            conn->setTcpNoDelay(true);
+            if (stage_ != kStopped)
+                sendCurrent(conn);
+            return;
+        }
+
+        if (inFlight_)
+        {
+            inFlight_ = false;
+            if (parser_.completesOnClose())
+                onResponseComplete(nullptr);
+            else
+                fail("disconnect");
+        }
+        // 断开后由 TcpClient 自动重连，重连成功时重发当前阶段的请求
+    }
+
+    void onMessage(const muduo::net::TcpConnectionPtr& conn, muduo::net::Buffer* buf)
+    {
+        if (!inFlight_)
+        {
+            buf->retrieveAll();
+            return;
+        }
+        ResponseParser::Result result = parser_.parse(buf, [this](const char* data, size_t len) { onBody(data, len); });
+        if (result == ResponseParser::kError)
+        {
+            inFlight_ = false;
+            fail("bad_response");
+            conn->forceClose();
+        }
+        else if (result == ResponseParser::kComplete)
+        {
+            inFlight_ = false;
+            onResponseComplete(conn);
+        }
+    }
+
+    void onBody(const char* data, size_t len)
+    {
+        if (stage_ == kChat && parser_.status() == 200)
+            sse_.feed(data, len, [this](const std::string& event, const std::string& payload) { onEvent(event, payload); });
+        else
+            body_.append(data, len);
+    }
+
+    void onEvent(const std::string& event, const std::string& data)
+    {
+        if (event == "session")
+        {
+            sessionId_ = jsonStringField(data, "sessionId");
+        }
+        else if (event == "result")
+        {
+            int64_t now = nowMicros();
+            if (firstTokenAt_ == 0)
+                firstTokenAt_ = now;
+            else
+                gaps_.push_back(now - lastTokenAt_);
+            lastTokenAt_ = now;
+            ++tokens_;
+        }
+        else if (event == "end")
+            gotEnd_ = true;
+        else if (event == "error")
+            gotError_ = true;
+    }
+
+    void sendCurrent(const muduo::net::TcpConnectionPtr& conn)
+    {
+        std::string body;
+        const char* path;
+        switch (stage_)
+        {
+        case kRegister:
+        case kLogin:
+            path = stage_ == kRegister ? "/register" : "/login";
+            body = "{\"username\":\"" + jsonEscape(username_) + "\",\"password\":\"" +
+                   jsonEscape(gOptions.password) + "\"}";
+            break;
+        case kChat:
+            path = "/chat/send-stream";
+            body = "{\"question\":\"" + jsonEscape(gOptions.question) + "\",\"modelType\":\"" +
+                   jsonEscape(gOptions.model) + "\"";
+            if (!sessionId_.empty())
+                body += ",\"sessionId\":\"" + jsonEscape(sessionId_) + "\"";
+            body += "}";
+            break;
+        default:
+            return;
+        }
+
+        std::string request;
+        request.reserve(256 + body.size());
+        request += "POST ";
+        request += path;
+        request += " HTTP/1.1\r\nHost: " + gOptions.host + "\r\nContent-Type: application/json\r\n";
+        if (!cookie_.empty())
+            request += "Cookie: " + cookie_ + "\r\n";
+        request += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+        request += body;
+
+        parser_.reset();
+        sse_.reset();
+        body_.clear();
+        firstTokenAt_ = 0;
+        lastTokenAt_ = 0;
+        gaps_.clear();
+        tokens_ = 0;
+        gotEnd_ = false;
+        gotError_ = false;
+        inFlight_ = true;
+        sentAt_ = nowMicros();
+        conn->send(request);
+    }
+
+    // conn 为空表示响应以连接关闭结束，等待重连后再发下一个请求
+    void onResponseComplete(const muduo::net::TcpConnectionPtr& conn)
+    {
+        switch (stage_)
+        {
+        case kRegister:
+            // 用户已存在时注册失败，直接登录
+            stage_ = kLogin;
+            break;
+        case kLogin:
+            if (parser_.status() != 200 || parser_.cookies().empty())
+            {
+                fail("login");
+                stop();
+                return;
+            }
+            cookie_.clear();
+            for (const auto& c : parser_.cookies())
+            {
+                if (!cookie_.empty())
+                    cookie_ += "; ";
+                cookie_ += c;
+            }
+            stage_ = kChat;
+            break;
+        case kChat:
+            finishTurn();
+            break;
+        default:
+            return;
+        }
+
+        if (!running_->load(std::memory_order_relaxed) && stage_ == kChat)
+        {
+            stop();
+            return;
+        }
+        if (conn && conn->connected() && !parser_.closeConnection())
+            sendCurrent(conn);
+    }
+
+    void finishTurn()
+    {
+        if (parser_.status() != 200)
+            fail("status_" + std::to_string(parser_.status()));
+        else if (gotError_)
+            fail("sse_error");
+        else if (!gotEnd_)
+            fail("incomplete");
+        else
+            stats_->addTurn(firstTokenAt_ ? firstTokenAt_ - sentAt_ : -1, nowMicros() - sentAt_, gaps_, tokens_);
+
+        // 会话失效（如服务端重启、登录过期）时重新登录
+        if (parser_.status() == 401)
+        {
+            stage_ = kLogin;
+            cookie_.clear();
+            return;
+        }
+        if (++turnsInSession_ >= gOptions.turnsPerSession)
+        {
+            turnsInSession_ = 0;
+            sessionId_.clear();
+        }
+    }
+
+    void fail(const std::string& reason)
+    {
+        stats_->addError(reason);
+        // 对话中途失败时换一个新会话，避免服务端残留状态影响后续轮次
+        if (stage_ == kChat)
+        {
+            sessionId_.clear();
+            turnsInSession_ = 0;
+        }
+    }
+
+    void stop()
+    {
+        if (stage_ == kStopped)
+            return;
+        stage_ = kStopped;
+        client_.stop();
+        client_.disconnect();
+        active_->fetch_sub(1);
+    }
+
+    muduo::net::TcpClient     client_;
+    std::string               username_;
+    Stats*                    stats_;
+    const std::atomic<bool>*  running_;
+    std::atomic<int>*         active_;
+
+    Stage                     stage_ = kRegister;
+    bool                      inFlight_ = false;
+    ResponseParser            parser_;
+    SseParser                 sse_;
+    std::string               body_;
+    std::string               cookie_;
+    std::string               sessionId_;
+    int                       turnsInSession_ = 0;
+
+    int64_t                   sentAt_ = 0;
+    int64_t                   firstTokenAt_ = 0;
+    int64_t                   lastTokenAt_ = 0;
+    std::vector<int64_t>      gaps_;
+    size_t                    tokens_ = 0;
+    bool                      gotEnd_ = false;
+    bool                      gotError_ = false;
+};
+
+void usage(const char* prog)
+{
+    fprintf(stderr,
+            "Usage: %s [--host addr] [-p port] [-c users] [-t threads] [-d seconds]\n"
+            "          [--turns-per-session N] [--model type] [--question text] [--server-pid pid]\n"
+            "          [--user-prefix name] [--password pwd]\n",
+            prog);
+}
+
+bool parseOptions(int argc, char* argv[])
+{
+    static const option longOptions[] = {
+        {"host", required_argument, nullptr, 'H'},
+        {"turns-per-session", required_argument, nullptr, 'n'},
+        {"model", required_argument, nullptr, 'm'},
+        {"question", required_argument, nullptr, 'q'},
+        {"server-pid", required_argument, nullptr, 'P'},
+        {"user-prefix", required_argument, nullptr, 'u'},
+        {"password", required_argument, nullptr, 'w'},
+        {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:c:t:d:", longOptions, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+        case 'H': gOptions.host = optarg; break;
+        case 'p': gOptions.port = atoi(optarg); break;
+        case 'c': gOptions.users = atoi(optarg); break;
+        case 't': gOptions.threads = atoi(optarg); break;
+        case 'd': gOptions.durationSeconds = atof(optarg); break;
+        case 'n': gOptions.turnsPerSession = atoi(optarg); break;
+        case 'm': gOptions.model = optarg; break;
+        case 'q': gOptions.question = optarg; break;
+        case 'P': gOptions.serverPid = atoi(optarg); break;
+        case 'u': gOptions.userPrefix = optarg; break;
+        case 'w': gOptions.password = optarg; break;
+        default:
+            return false;
+        }
+    }
+    return gOptions.users > 0 && gOptions.threads > 0 && gOptions.durationSeconds > 0 &&
+           gOptions.turnsPerSession > 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (!parseOptions(argc, argv))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    muduo::Logger::setLogLevel(muduo::Logger::WARN);
+
+    muduo::net::EventLoop loop;
+    muduo::net::EventLoopThreadPool pool(&loop, "load");
+    pool.setThreadNum(gOptions.threads);
+    pool.start();
+
+    muduo::net::InetAddress addr(gOptions.host, static_cast<uint16_t>(gOptions.port));
+    Stats stats;
+    std::atomic<bool> running(true);
+    std::atomic<int> active(gOptions.users);
+    ProcSampler sampler(gOptions.serverPid);
+
+    // 虚拟用户在进程退出时有意不析构：TcpClient 必须在所属 IO 线程中销毁，而此时各线程即将随进程结束
+    for (int i = 0; i < gOptions.users; ++i)
+    {
+        muduo::net::EventLoop* ioLoop = pool.getNextLoop();
+        VirtualUser* user = new VirtualUser(ioLoop, addr, i, &stats, &running, &active);
+        ioLoop->runInLoop([user]() { user->start(); });
+    }
+
+    sampler.start();
+    int64_t startUs = nowMicros();
+    int64_t stopUs = 0;
+
+    loop.runEvery(1.0, [&]() {
+        sampler.sample();
+        uint64_t turns, tokens, errors;
+        stats.snapshot(&turns, &tokens, &errors);
+        fprintf(stderr, "[%5.1fs] turns %lu, tokens %lu, errors %lu, active users %d",
+                (nowMicros() - startUs) / 1e6, static_cast<unsigned long>(turns),
+                static_cast<unsigned long>(tokens), static_cast<unsigned long>(errors), active.load());
+        if (sampler.enabled())
+            fprintf(stderr, ", server rss %ldMB", sampler.lastRssKb() / 1024);
+        fprintf(stderr, "\n");
+    });
+    loop.runAfter(gOptions.durationSeconds, [&]() {
+        // 停止发起新一轮对话，等待进行中的对话结束
+        running = false;
+        stopUs = nowMicros();
+    });
+    loop.runEvery(0.1, [&]() {
+        const int64_t kDrainTimeoutUs = 30 * 1000 * 1000;
+        if (stopUs > 0 && (active.load() == 0 || nowMicros() - stopUs > kDrainTimeoutUs))
+            loop.quit();
+    });
+    loop.loop();
+
+    stats.report((nowMicros() - startUs) / 1e6);
+    if (sampler.enabled())
+    {
+        sampler.sample();
+        printf("server     cpu %.1f%%, rss %ldMB, peak rss %ldMB\n",
+               sampler.cpuPercent(), sampler.lastRssKb() / 1024, sampler.peakRssKb() / 1024);
+    }
+    fflush(stdout);
+    // 各 IO 线程上仍有未结束的连接，跳过析构直接退出
+    _exit(0);
+}
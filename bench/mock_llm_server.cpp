@@ -0,0 +1,305 @@
+// 模拟大模型上游：按配置的首 token 延迟、token 速率和错误模式返回流式 / 非流式响应，
+// 线路格式与 DashScope 兼容模式、豆包（OpenAI 兼容）以及 DashScope 应用（RAG）接口一致，
+// 把 config.json 中的模型地址指向本服务即可在单机上复现端到端负载
+//
+// 用法：mock_llm_server [-p 端口] [-t IO线程数] [--ttft-ms 200] [--ttft-jitter-ms 50]
+//                       [--rate 50] [--tokens 100] [--error-rate 0] [--error-mode status|disconnect|truncate]
+//                       [--seed 1]
+
+#include <getopt.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+
+#include "http/HttpServer.h"
+#include "http/StreamWriter.h"
+
+namespace
+{
+
+enum class ErrorMode { kStatus, kDisconnect, kTruncate };
+
+struct Options
+{
+    int       port = 9000;
+    int       threads = 0;
+    double    ttftMs = 200;
+    double    ttftJitterMs = 50;
+    double    tokensPerSecond = 50;
+    int       tokens = 100;
+    double    errorRate = 0;
+    ErrorMode errorMode = ErrorMode::kStatus;
+    unsigned  seed = 1;
+};
+
+enum class WireFormat { kDashScope, kDoubao, kDashScopeApp };
+
+Options gOptions;
+
+// 随机数只在处理请求的线程中使用，加锁即可
+std::mutex   gRandomMutex;
+std::mt19937 gRandom;
+
+double uniform(double low, double high)
+{
+    std::lock_guard<std::mutex> lock(gRandomMutex);
+    return std::uniform_real_distribution<double>(low, high)(gRandom);
+}
+
+std::atomic<uint64_t> gRequestSeq{0};
+
+// 固定词表轮流输出，每个 token 都是一个独立的增量事件
+const char* const kWords[] = {"The ", "quick ", "brown ", "fox ", "jumps ", "over ", "the ", "lazy ", "dog. "};
+
+std::string tokenText(int index)
+{
+    return kWords[index % (sizeof kWords / sizeof kWords[0])];
+}
+
+std::string fullText(int tokens)
+{
+    std::string text;
+    for (int i = 0; i < tokens; ++i)
+        text += tokenText(i);
+    return text;
+}
+
+std::string chunkEvent(WireFormat format, const std::string& requestId, const std::string& text, bool last)
+{
+    std::string data;
+    switch (format)
+    {
+    case WireFormat::kDashScope:
+        data = "{\"id\":\"" + requestId + "\",\"object\":\"chat.completion.chunk\",\"model\":\"mock\","
+               "\"choices\":[{\"index\":0,\"delta\":{\"content\":\"" + text + "\"},\"finish_reason\":" +
+               (last ? "\"stop\"" : "null") + "}]}";
+        break;
+    case WireFormat::kDoubao:
+        data = "{\"id\":\"" + requestId + "\",\"object\":\"chat.completion.chunk\",\"model\":\"mock\","
+               "\"service_tier\":\"default\",\"choices\":[{\"index\":0,\"delta\":{\"role\":\"assistant\",\"content\":\"" +
+               text + "\"},\"finish_reason\":" + (last ? "\"stop\"" : "null") + "}]}";
+        break;
+    case WireFormat::kDashScopeApp:
+        data = "{\"output\":{\"text\":\"" + text + "\",\"finish_reason\":\"" + (last ? "stop" : "null") +
+               "\"},\"request_id\":\"" + requestId + "\"}";
+        break;
+    }
+    return "data: " + data + "\n\n";
+}
+
+std::string completionBody(WireFormat format, const std::string& requestId, int tokens)
+{
+    std::string text = fullText(tokens);
+    std::string usage = "{\"input_tokens\":16,\"output_tokens\":" + std::to_string(tokens) + "}";
+    if (format == WireFormat::kDashScopeApp)
+    {
+        return "{\"output\":{\"text\":\"" + text + "\",\"finish_reason\":\"stop\"},\"usage\":" + usage +
+               ",\"request_id\":\"" + requestId + "\"}";
+    }
+    return "{\"id\":\"" + requestId + "\",\"object\":\"chat.completion\",\"model\":\"mock\","
+           "\"choices\":[{\"index\":0,\"message\":{\"role\":\"assistant\",\"content\":\"" + text + "\"},"
+           "\"finish_reason\":\"stop\"}],\"usage\":" + usage + "}";
+}
+
+// 一次上游响应的推送进度，定时器回调之间共享
+struct MockStream
+{
+    http::StreamWriterPtr writer;
+    WireFormat            format;
+    std::string           requestId;
+    int                   sent = 0;
+    int                   total = 0;
+    int                   truncateAt = -1; // >= 0 时发送到该位置后直接断开
+    bool                  stream = true;
+};
+
+void pushNext(muduo::net::EventLoop* loop, const std::shared_ptr<MockStream>& s)
+{
+    if (!s->writer->connected())
+        return;
+
+    if (!s->stream)
+    {
+        s->writer->write(completionBody(s->format, s->requestId, s->total));
+        s->writer->end();
+        return;
+    }
+
+    if (s->sent == s->truncateAt)
+    {
+        // 非 chunked、带 Connection: close 的响应，end() 会直接关闭连接，客户端看到的是没有结束标记的流
+        s->writer->end();
+        return;
+    }
+
+    bool last = s->sent + 1 >= s->total;
+    s->writer->write(chunkEvent(s->format, s->requestId, tokenText(s->sent), last));
+    ++s->sent;
+    if (last)
+    {
+        if (s->format != WireFormat::kDashScopeApp)
+            s->writer->write("data: [DONE]\n\n");
+        s->writer->end();
+        return;
+    }
+    loop->runAfter(1.0 / gOptions.tokensPerSecond, [loop, s]() { pushNext(loop, s); });
+}
+
+void handleCompletion(muduo::net::EventLoop* loop, WireFormat format,
+                      const http::HttpRequest& req, http::HttpResponse* resp)
+{
+    const std::string& body = req.getBody();
+    // 兼容模式以 "stream":true 开启流式，应用接口以 X-DashScope-SSE: enable 开启
+    bool stream = body.find("\"stream\":true") != std::string::npos ||
+                  req.getHeader("X-DashScope-SSE") == "enable";
+
+    auto s = std::make_shared<MockStream>();
+    s->format = format;
+    s->requestId = "mock-" + std::to_string(gRequestSeq.fetch_add(1));
+    s->total = gOptions.tokens;
+    s->stream = stream;
+
+    bool fail = gOptions.errorRate > 0 && uniform(0, 1) < gOptions.errorRate;
+    if (fail && gOptions.errorMode == ErrorMode::kStatus)
+    {
+        std::string error = format == WireFormat::kDoubao
+            ? "{\"error\":{\"code\":\"InternalServiceError\",\"message\":\"mock failure\",\"type\":\"server_error\"}}"
+            : "{\"code\":\"InternalError\",\"message\":\"mock failure\",\"request_id\":\"" + s->requestId + "\"}";
+        resp->setStatusLine(req.getVersion(), http::HttpResponse::k500InternalServerError, "Internal Server Error");
+        resp->setCloseConnection(false);
+        resp->setContentType("application/json");
+        resp->setContentLength(error.size());
+        resp->setBody(error);
+        return;
+    }
+
+    // disconnect：响应头发出后不发送任何数据即关闭；truncate：流式响应发送一半后关闭
+    bool disconnect = fail && gOptions.errorMode == ErrorMode::kDisconnect;
+    if (fail && gOptions.errorMode == ErrorMode::kTruncate && stream)
+        s->truncateAt = std::max(1, gOptions.tokens / 2);
+    bool dropConnection = disconnect || s->truncateAt >= 0;
+
+    resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
+    resp->setCloseConnection(dropConnection);
+    if (stream)
+    {
+        resp->setContentType("text/event-stream");
+        resp->addHeader("Cache-Control", "no-cache");
+        resp->setChunked(!dropConnection);
+    }
+    else
+    {
+        resp->setContentType("application/json");
+        resp->setContentLength(completionBody(format, s->requestId, s->total).size());
+    }
+
+    double ttft = std::max(0.0, gOptions.ttftMs + uniform(-gOptions.ttftJitterMs, gOptions.ttftJitterMs)) / 1000;
+    // 非流式响应在生成完所有 token 后才返回
+    double delay = stream ? ttft : ttft + s->total / gOptions.tokensPerSecond;
+
+    resp->setStreamStartCallback([loop, s, delay, disconnect](const http::StreamWriterPtr& writer) {
+        s->writer = writer;
+        loop->runAfter(delay, [loop, s, disconnect]() {
+            if (disconnect)
+                s->writer->end();
+            else
+                pushNext(loop, s);
+        });
+    });
+}
+
+void usage(const char* prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-p port] [-t threads] [--ttft-ms N] [--ttft-jitter-ms N] [--rate tokens/s]\n"
+            "          [--tokens N] [--error-rate 0~1] [--error-mode status|disconnect|truncate] [--seed N]\n",
+            prog);
+}
+
+bool parseOptions(int argc, char* argv[])
+{
+    static const option longOptions[] = {
+        {"ttft-ms", required_argument, nullptr, 'f'},
+        {"ttft-jitter-ms", required_argument, nullptr, 'j'},
+        {"rate", required_argument, nullptr, 'r'},
+        {"tokens", required_argument, nullptr, 'n'},
+        {"error-rate", required_argument, nullptr, 'e'},
+        {"error-mode", required_argument, nullptr, 'm'},
+        {"seed", required_argument, nullptr, 's'},
+        {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:t:", longOptions, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+        case 'p': gOptions.port = atoi(optarg); break;
+        case 't': gOptions.threads = atoi(optarg); break;
+        case 'f': gOptions.ttftMs = atof(optarg); break;
+        case 'j': gOptions.ttftJitterMs = atof(optarg); break;
+        case 'r': gOptions.tokensPerSecond = atof(optarg); break;
+        case 'n': gOptions.tokens = atoi(optarg); break;
+        case 'e': gOptions.errorRate = atof(optarg); break;
+        case 's': gOptions.seed = static_cast<unsigned>(atoi(optarg)); break;
+        case 'm':
+            if (strcmp(optarg, "status") == 0)
+                gOptions.errorMode = ErrorMode::kStatus;
+            else if (strcmp(optarg, "disconnect") == 0)
+                gOptions.errorMode = ErrorMode::kDisconnect;
+            else if (strcmp(optarg, "truncate") == 0)
+                gOptions.errorMode = ErrorMode::kTruncate;
+            else
+                return false;
+            break;
+        default:
+            return false;
+        }
+    }
+    return gOptions.tokens > 0 && gOptions.tokensPerSecond > 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (!parseOptions(argc, argv))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    muduo::Logger::setLogLevel(muduo::Logger::WARN);
+    gRandom.seed(gOptions.seed);
+
+    http::HttpServer server(gOptions.port, "MockLLM");
+    server.setThreadNum(gOptions.threads);
+    // 所有流的 token 定时器都挂在主循环上，写操作由 StreamWriter 投递到各连接的 IO 线程
+    muduo::net::EventLoop* loop = server.getLoop();
+
+    server.Post("/compatible-mode/v1/chat/completions",
+                [loop](const http::HttpRequest& req, http::HttpResponse* resp) {
+                    handleCompletion(loop, WireFormat::kDashScope, req, resp);
+                });
+    server.Post("/api/v3/chat/completions",
+                [loop](const http::HttpRequest& req, http::HttpResponse* resp) {
+                    handleCompletion(loop, WireFormat::kDoubao, req, resp);
+                });
+    server.addRoute(http::HttpRequest::kPost, "/api/v1/apps/:appId/completion",
+                    [loop](const http::HttpRequest& req, http::HttpResponse* resp) {
+                        handleCompletion(loop, WireFormat::kDashScopeApp, req, resp);
+                    });
+
+    fprintf(stderr, "mock LLM listening on %d: ttft %.0fms +-%.0fms, %.0f tokens/s, %d tokens, error rate %.3f\n",
+            gOptions.port, gOptions.ttftMs, gOptions.ttftJitterMs, gOptions.tokensPerSecond, gOptions.tokens,
+            gOptions.errorRate);
+    server.start();
+    return 0;
+}
@@ -0,0 +1,124 @@
+// 限流中间件单次 before() 的开销：1 千 / 10 万个活跃用户，1~16 线程并发
+//
+// ./ratelimit_bench
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+#include "middleware/ratelimit/RateLimitMiddleware.h"
+
+using namespace http;
+using namespace http::middleware;
+
+namespace
+{
+
+// 预先构造的请求数，线程按步长轮流使用
+const size_t kMaxRequestPool = 1 << 16;
+
+struct Fixture
+{
+    std::unique_ptr<RateLimitMiddleware> middleware;
+    std::vector<HttpRequest>             requests;
+};
+
+HttpRequest makeRequest(const std::string& path, const std::string& user, const std::string& ip)
+{
+    HttpRequest req;
+    req.setPath(path.data(), path.data() + path.size());
+    req.setPeerIp(ip);
+    req.setReceiveTime(muduo::Timestamp::now());
+    if (!user.empty())
+    {
+        std::string line = "X-User: " + user;
+        const char* begin = line.data();
+        req.addHeader(begin, begin + line.find(':'), begin + line.size());
+    }
+    return req;
+}
+
+// 限额足够大，测量的是放行路径；键提取只读一个请求头，不含业务侧的会话查找
+Fixture* buildFixture(size_t users)
+{
+    auto* fixture = new Fixture;
+    RateLimit unlimitedInPractice;
+    unlimitedInPractice.rate = 1e9;
+    unlimitedInPractice.burst = 1e9;
+    fixture->middleware = std::make_unique<RateLimitMiddleware>(unlimitedInPractice,
+        [](const HttpRequest& req) { return req.getHeader("X-User"); });
+    fixture->middleware->addClass("chat", unlimitedInPractice, {"/chat/send", "/chat/send-stream"});
+
+    const char* paths[] = {"/chat/send-stream", "/chat/sessions", "/chat/history"};
+    size_t poolSize = std::min(users * 4, kMaxRequestPool);
+    fixture->requests.reserve(poolSize);
+    for (size_t i = 0; i < poolSize; ++i)
+    {
+        size_t user = (i * 2654435761u) % users;
+        // 四分之一请求未登录，按 IP 计数
+        std::string userKey = i % 4 == 0 ? std::string() : "user:" + std::to_string(user);
+        std::string ip = "10.0." + std::to_string(user % 256) + "." + std::to_string(user / 256 % 256);
+        fixture->requests.push_back(makeRequest(paths[i % 3], userKey, ip));
+    }
+    // 预热：所有用户的桶都已存在
+    HttpResponse resp;
+    for (auto& req : fixture->requests)
+        fixture->middleware->before(req, &resp);
+    return fixture;
+}
+
+// 各线程同时进入时只构造一次
+Fixture& fixture(size_t users)
+{
+    static std::mutex mutex;
+    static std::map<size_t, Fixture*> instances;
+    std::lock_guard<std::mutex> lock(mutex);
+    Fixture*& instance = instances[users];
+    if (!instance)
+        instance = buildFixture(users);
+    return *instance;
+}
+
+void BM_RateLimitBefore(benchmark::State& state)
+{
+    Fixture& f = fixture(static_cast<size_t>(state.range(0)));
+    const size_t poolSize = f.requests.size();
+    size_t index = static_cast<size_t>(state.thread_index()) * 7919 % poolSize;
+    HttpResponse resp;
+    for (auto _ : state)
+    {
+        Middleware::Action action = f.middleware->before(f.requests[index], &resp);
+        benchmark::DoNotOptimize(action);
+        index = index + 1 == poolSize ? 0 : index + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+// 1 千用户时请求和令牌桶都在缓存中；10 万用户时每次查找基本都是缓存缺失
+BENCHMARK(BM_RateLimitBefore)->Arg(1000)->Arg(100000)->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+
+// 单个热点用户的全部请求落在同一分片上，锁竞争最激烈的情形
+void BM_RateLimitSingleKey(benchmark::State& state)
+{
+    static RateLimiter limiter(RateLimit{1e9, 1e9});
+    const std::string key = "user:42";
+    int64_t now = 0;
+    double retryAfter = 0;
+    for (auto _ : state)
+    {
+        bool ok = limiter.tryAcquire(key, ++now, &retryAfter);
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RateLimitSingleKey)->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
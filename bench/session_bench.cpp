@@ -0,0 +1,97 @@
+// SessionManager::getSession 吞吐：1M 活跃会话，1~16 线程并发
+//
+// ./session_bench --benchmark_filter=GetSession
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+#include "session/SessionManager.h"
+#include "session/ShardedSessionStorage.h"
+
+using namespace http;
+using namespace http::session;
+
+namespace
+{
+
+const size_t kLiveSessions = 1000000;
+// 预先构造的请求数，线程按步长轮流使用
+const size_t kRequestPool = 1 << 16;
+
+struct Fixture
+{
+    std::unique_ptr<SessionManager> manager;
+    std::vector<HttpRequest>        requests;
+};
+
+HttpRequest makeRequestWithCookie(const std::string& sessionId)
+{
+    HttpRequest req;
+    std::string line = "Cookie: sessionId=" + sessionId;
+    const char* begin = line.data();
+    const char* colon = begin + line.find(':');
+    req.addHeader(begin, colon, begin + line.size());
+    return req;
+}
+
+template <typename Storage>
+Fixture* buildFixture()
+{
+    auto* fixture = new Fixture;
+    fixture->manager = std::make_unique<SessionManager>(std::make_unique<Storage>());
+
+    HttpRequest empty;
+    std::vector<std::string> ids;
+    ids.reserve(kLiveSessions);
+    for (size_t i = 0; i < kLiveSessions; ++i)
+    {
+        HttpResponse resp;
+        ids.push_back(fixture->manager->getSession(empty, &resp)->getId());
+    }
+
+    fixture->requests.reserve(kRequestPool);
+    for (size_t i = 0; i < kRequestPool; ++i)
+    {
+        // 均匀分布在全部会话上
+        fixture->requests.push_back(makeRequestWithCookie(ids[(i * 2654435761u) % kLiveSessions]));
+    }
+    return fixture;
+}
+
+template <typename Storage>
+Fixture& fixture()
+{
+    // 只构造一次，所有线程共享
+    static Fixture* instance = buildFixture<Storage>();
+    return *instance;
+}
+
+template <typename Storage>
+void BM_GetSession(benchmark::State& state)
+{
+    Fixture& f = fixture<Storage>();
+    size_t index = static_cast<size_t>(state.thread_index()) * 7919;
+    HttpResponse resp;
+    for (auto _ : state)
+    {
+        auto session = f.manager->getSession(f.requests[index++ & (kRequestPool - 1)], &resp);
+        benchmark::DoNotOptimize(session);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+// 旧实现：单锁哈希表
+BENCHMARK_TEMPLATE(BM_GetSession, MemorySessionStorage)
+    ->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+// 分片存储 + 时间轮
+BENCHMARK_TEMPLATE(BM_GetSession, ShardedSessionStorage)
+    ->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,312 @@
+// 语音流水线自检：用进程内的 MockSpeechService 驱动 SpeechJobManager + SpeechPipeline，检查
+//   1. nextSentence 的切句：中英文句末标点、没有句末标点的长句、结束时剩余内容的处理
+//   2. 合成结果乱序完成时，语音片段仍按句子顺序交付
+//   3. 同时在途的句子数不超过 window
+// 全部通过时退出码为 0，否则输出失败项并返回 1
+//
+// ./speech_pipeline_check
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThread.h>
+
+#include "AIUtil/MockSpeechService.h"
+#include "AIUtil/SpeechJobManager.h"
+#include "AIUtil/SpeechPipeline.h"
+
+namespace
+{
+
+int gFailures = 0;
+
+#define CHECK(cond) \
+    do { if (!(cond)) { ++gFailures; fprintf(stderr, "FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond); } } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        if (!((actual) == (expected))) \
+        { \
+            ++gFailures; \
+            fprintf(stderr, "FAILED %s:%d: %s == %s\n  actual:   \"%s\"\n  expected: \"%s\"\n", \
+                    __FILE__, __LINE__, #actual, #expected, std::string(actual).c_str(), std::string(expected).c_str()); \
+        } \
+    } while (0)
+
+// 按 nextSentence 切出全部句子，flush 决定是否把剩余内容作为最后一句
+std::vector<std::string> split(std::string text, const SpeechPipelineOptions& options, bool flush, std::string* rest)
+{
+    std::vector<std::string> sentences;
+    std::string sentence;
+    while (SpeechPipeline::nextSentence(&text, options, flush, &sentence))
+        sentences.push_back(sentence);
+    if (rest)
+        *rest = text;
+    return sentences;
+}
+
+void checkSplitting()
+{
+    SpeechPipelineOptions options;
+    std::string rest;
+
+    // 中文句末标点
+    std::vector<std::string> s = split("今天北京天气晴朗。明天可能会下雨！要带伞吗？", options, false, &rest);
+    CHECK(s.size() == 3);
+    if (s.size() == 3)
+    {
+        CHECK_EQ(s[0], "今天北京天气晴朗。");
+        CHECK_EQ(s[1], "明天可能会下雨！");
+        CHECK_EQ(s[2], "要带伞吗？");
+    }
+    CHECK(rest.empty());
+
+    // 英文句末标点；'.' 后面不是空白时不切，以免切开小数
+    s = split("The price is 3.14 dollars today. Is that right? Fine", options, false, &rest);
+    CHECK(s.size() == 2);
+    if (s.size() == 2)
+    {
+        CHECK_EQ(s[0], "The price is 3.14 dollars today.");
+        CHECK_EQ(s[1], "Is that right?");
+    }
+    CHECK_EQ(rest, " Fine");
+
+    // 结束时剩余内容作为最后一句
+    s = split(rest, options, true, &rest);
+    CHECK(s.size() == 1);
+    if (s.size() == 1)
+        CHECK_EQ(s[0], "Fine");
+    CHECK(rest.empty());
+
+    // 短于 minSentenceBytes 的句子与下一句合并
+    s = split("好的。我马上为你查询天气。", options, false, &rest);
+    CHECK(s.size() == 1);
+    if (s.size() == 1)
+        CHECK_EQ(s[0], "好的。我马上为你查询天气。");
+
+    // 没有句末标点：未超过 maxSentenceBytes 时等待更多文本，超过时在逗号处切分
+    SpeechPipelineOptions small;
+    small.maxSentenceBytes = 40;
+    s = split("没有句末标点的文本", small, false, &rest);
+    CHECK(s.empty());
+    CHECK_EQ(rest, "没有句末标点的文本");
+    s = split("第一部分内容比较长，第二部分内容也比较长，第三部分", small, false, &rest);
+    CHECK(!s.empty());
+    if (!s.empty())
+    {
+        CHECK_EQ(s[0], "第一部分内容比较长，");
+        CHECK(s[0].size() <= small.maxSentenceBytes);
+    }
+
+    // 连逗号都没有的长句在 UTF-8 字符边界处硬切
+    s = split(std::string(20, 'x') + "一二三四五六七八九十", small, false, &rest);
+    CHECK(!s.empty());
+    if (!s.empty())
+    {
+        CHECK(s[0].size() <= small.maxSentenceBytes);
+        CHECK((static_cast<unsigned char>(rest[0]) & 0xC0) != 0x80);
+    }
+
+    // flush 时没有句末标点的文本整体作为一句
+    s = split("没有句末标点的文本", options, true, &rest);
+    CHECK(s.size() == 1);
+    CHECK(rest.empty());
+}
+
+// 在 MockSpeechService 之上按句子追加完成耗时，使后提交的句子先合成完；同时记录同时在途的任务数
+class ReorderingSpeechService : public SpeechService
+{
+public:
+    explicit ReorderingSpeechService(std::map<std::string, double> extraLatency)
+        : mock_(0.02)
+        , extraLatency_(std::move(extraLatency))
+    {}
+
+    std::string recognize(const std::string& speechData, const std::string& format, int rate, int channel) override
+    { return mock_.recognize(speechData, format, rate, channel); }
+
+    std::string synthesize(const std::string& text, const std::string& format, const std::string& lang,
+                           int speed, int pitch, int volume) override
+    { return mock_.synthesize(text, format, lang, speed, pitch, volume); }
+
+    std::string createSynthesisTask(const std::string& text, const std::string& format, const std::string& lang,
+                                    int speed, int pitch, int volume) override
+    {
+        std::string taskId = mock_.createSynthesisTask(text, format, lang, speed, pitch, volume);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = extraLatency_.find(text);
+        double extra = it != extraLatency_.end() ? it->second : 0;
+        readyAt_[taskId] = Clock::now() + std::chrono::microseconds(static_cast<int64_t>(extra * 1000000));
+        texts_[taskId] = text;
+        ++inflight_;
+        maxInflight_ = std::max(maxInflight_, inflight_);
+        return taskId;
+    }
+
+    SynthesisTaskStatus querySynthesisTask(const std::string& taskId) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = readyAt_.find(taskId);
+            if (it != readyAt_.end() && Clock::now() < it->second)
+                return SynthesisTaskStatus();
+        }
+        SynthesisTaskStatus status = mock_.querySynthesisTask(taskId);
+        if (status.state != SynthesisTaskStatus::kRunning)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            readyAt_.erase(taskId);
+            --inflight_;
+            completionOrder_.push_back(texts_[taskId]);
+            texts_.erase(taskId);
+        }
+        return status;
+    }
+
+    size_t maxInflight()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return maxInflight_;
+    }
+
+    std::vector<std::string> completionOrder()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return completionOrder_;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    MockSpeechService mock_;
+    std::map<std::string, double> extraLatency_;
+    std::mutex mutex_;
+    std::map<std::string, Clock::time_point> readyAt_;
+    std::map<std::string, std::string> texts_;
+    std::vector<std::string> completionOrder_;
+    size_t inflight_ = 0;
+    size_t maxInflight_ = 0;
+};
+
+// 逐句喂入 sentences，返回按交付顺序收到的片段
+std::vector<SpeechSegment> runPipeline(muduo::net::EventLoop* loop, std::shared_ptr<ReorderingSpeechService> service,
+                                       const std::vector<std::string>& sentences, size_t window)
+{
+    SpeechJobOptions jobOptions;
+    jobOptions.threads = 4;
+    jobOptions.pollInterval = 0.01;
+    jobOptions.maxPollInterval = 0.02;
+    jobOptions.timeout = 10;
+    jobOptions.cacheTtl = 0;
+    auto jobs = std::make_shared<SpeechJobManager>(loop, service, jobOptions);
+
+    SpeechPipelineOptions options;
+    options.window = window;
+    std::mutex mutex;
+    std::vector<SpeechSegment> segments;
+    auto pipeline = std::make_shared<SpeechPipeline>(jobs, options, [&](const SpeechSegment& segment) {
+        std::lock_guard<std::mutex> lock(mutex);
+        segments.push_back(segment);
+    });
+
+    // 模拟大模型的增量输出，每句拆成两段送入
+    for (const auto& sentence : sentences)
+    {
+        size_t half = sentence.size() / 2;
+        while (half > 0 && (static_cast<unsigned char>(sentence[half]) & 0xC0) == 0x80)
+            --half;
+        pipeline->feed(sentence.substr(0, half));
+        pipeline->feed(sentence.substr(half));
+    }
+    std::promise<void> done;
+    pipeline->finish([&done]() { done.set_value(); });
+    if (done.get_future().wait_for(std::chrono::seconds(10)) != std::future_status::ready)
+    {
+        ++gFailures;
+        fprintf(stderr, "FAILED: pipeline did not finish within 10s\n");
+    }
+
+    // 等 loop 线程处理完剩余回调后再释放 jobs
+    std::promise<void> drained;
+    loop->runInLoop([&drained]() { drained.set_value(); });
+    drained.get_future().wait();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return segments;
+}
+
+void checkOrderingAndWindow(muduo::net::EventLoop* loop)
+{
+    const std::vector<std::string> sentences = {
+        "第一句话，合成最慢。",
+        "第二句话，合成稍快。",
+        "第三句话，合成更快。",
+        "第四句话，几乎立即完成。",
+        "第五句话，也是立即完成。",
+        "第六句话，最后一句。",
+    };
+    // 越靠前的句子额外耗时越长，窗口内的结果必然乱序完成
+    std::map<std::string, double> extra;
+    for (size_t i = 0; i < sentences.size(); ++i)
+        extra[sentences[i]] = 0.05 * static_cast<double>(sentences.size() - i);
+
+    const size_t window = 3;
+    auto service = std::make_shared<ReorderingSpeechService>(extra);
+    std::vector<SpeechSegment> segments = runPipeline(loop, service, sentences, window);
+
+    CHECK(segments.size() == sentences.size());
+    for (size_t i = 0; i < segments.size() && i < sentences.size(); ++i)
+    {
+        CHECK(segments[i].index == i);
+        CHECK(segments[i].success);
+        CHECK_EQ(segments[i].text, sentences[i]);
+        CHECK(!segments[i].url.empty());
+    }
+
+    // 完成顺序确实与提交顺序不同，否则上面的顺序检查没有意义
+    std::vector<std::string> completed = service->completionOrder();
+    CHECK(completed.size() == sentences.size());
+    CHECK(!completed.empty() && completed.front() != sentences.front());
+
+    CHECK(service->maxInflight() <= window);
+    CHECK(service->maxInflight() >= 2);
+    printf("ordering: %zu segments delivered, max in flight %zu (window %zu)\n",
+           segments.size(), service->maxInflight(), window);
+
+    // window 为 1 时逐句合成
+    auto serial = std::make_shared<ReorderingSpeechService>(extra);
+    segments = runPipeline(loop, serial, sentences, 1);
+    CHECK(segments.size() == sentences.size());
+    CHECK(serial->maxInflight() == 1);
+    printf("window 1: max in flight %zu\n", serial->maxInflight());
+}
+
+} // namespace
+
+int main()
+{
+    muduo::Logger::setLogLevel(muduo::Logger::WARN);
+
+    checkSplitting();
+    printf("splitting: done\n");
+
+    muduo::net::EventLoopThread loopThread;
+    checkOrderingAndWindow(loopThread.startLoop());
+
+    if (gFailures > 0)
+    {
+        fprintf(stderr, "%d check(s) failed\n", gFailures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,297 @@
+// TLS 发送吞吐：明文、用户态 TLS、内核 TLS（kTLS）对比，以及 SslConnection 写路径的合并效果
+//
+// ./tls_bench --benchmark_filter=Send
+// kTLS 需要内核加载 tls 模块（modprobe tls）且 OpenSSL 编译时启用 ktls，否则该项跳过
+
+#include <benchmark/benchmark.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+namespace
+{
+
+// 每次迭代发送的数据量，相当于一段 SSE 响应或一个中等大小的静态文件
+const size_t kBlockSize = 256 * 1024;
+
+enum Mode
+{
+    kPlain,
+    kUserTls,
+    kKtls,
+};
+
+struct SocketPair
+{
+    int client = -1;
+    int server = -1;
+
+    ~SocketPair()
+    {
+        if (client >= 0) ::close(client);
+        if (server >= 0) ::close(server);
+    }
+};
+
+// kTLS 只支持 TCP，这里用回环连接
+bool makeLoopbackPair(SocketPair* pair)
+{
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listener, 1) < 0 ||
+        ::getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) < 0)
+    {
+        ::close(listener);
+        return false;
+    }
+    pair->client = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (::connect(pair->client, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        ::close(listener);
+        return false;
+    }
+    pair->server = ::accept(listener, nullptr, nullptr);
+    ::close(listener);
+
+    int one = 1;
+    ::setsockopt(pair->server, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return pair->server >= 0;
+}
+
+// 进程内生成自签名证书，避免依赖外部文件
+struct Credentials
+{
+    EVP_PKEY* key = nullptr;
+    X509*     cert = nullptr;
+
+    Credentials()
+    {
+        key = EVP_PKEY_Q_keygen(nullptr, nullptr, "EC", "P-256");
+        cert = X509_new();
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+        X509_set_pubkey(cert, key);
+        X509_NAME* name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                   reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+        X509_sign(cert, key, EVP_sha256());
+    }
+
+    ~Credentials()
+    {
+        X509_free(cert);
+        EVP_PKEY_free(key);
+    }
+};
+
+const Credentials& credentials()
+{
+    static Credentials creds;
+    return creds;
+}
+
+SSL_CTX* newServerContext(bool ktls)
+{
+    SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+    SSL_CTX_use_certificate(ctx, credentials().cert);
+    SSL_CTX_use_PrivateKey(ctx, credentials().key);
+    // kTLS 当前只支持 AES-GCM / ChaCha20 这几种套件，两种模式使用同一套件保证可比
+    SSL_CTX_set_ciphersuites(ctx, "TLS_AES_128_GCM_SHA256");
+#ifdef SSL_OP_ENABLE_KTLS
+    if (ktls)
+        SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+#else
+    (void)ktls;
+#endif
+    return ctx;
+}
+
+// 客户端：完成握手后一直读到对端关闭，只负责把数据消费掉
+void runClient(int fd, bool tls)
+{
+    char buf[64 * 1024];
+    if (!tls)
+    {
+        while (::read(fd, buf, sizeof(buf)) > 0) {}
+        return;
+    }
+
+    SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+    SSL* ssl = SSL_new(ctx);
+    SSL_set_fd(ssl, fd);
+    if (SSL_connect(ssl) == 1)
+    {
+        while (SSL_read(ssl, buf, sizeof(buf)) > 0) {}
+    }
+    SSL_free(ssl);
+    SSL_CTX_free(ctx);
+}
+
+void BM_Send(benchmark::State& state)
+{
+    Mode mode = static_cast<Mode>(state.range(0));
+    SocketPair pair;
+    if (!makeLoopbackPair(&pair))
+    {
+        state.SkipWithError("failed to create loopback connection");
+        return;
+    }
+
+    bool tls = mode != kPlain;
+    std::thread client(runClient, pair.client, tls);
+
+    SSL_CTX* ctx = nullptr;
+    SSL* ssl = nullptr;
+    if (tls)
+    {
+        ctx = newServerContext(mode == kKtls);
+        ssl = SSL_new(ctx);
+        SSL_set_fd(ssl, pair.server);
+        if (SSL_accept(ssl) != 1)
+        {
+            ::shutdown(pair.server, SHUT_RDWR);
+            client.join();
+            SSL_free(ssl);
+            SSL_CTX_free(ctx);
+            state.SkipWithError("TLS handshake failed");
+            return;
+        }
+        if (mode == kKtls && !BIO_get_ktls_send(SSL_get_wbio(ssl)))
+        {
+            SSL_shutdown(ssl);
+            ::shutdown(pair.server, SHUT_RDWR);
+            client.join();
+            SSL_free(ssl);
+            SSL_CTX_free(ctx);
+            state.SkipWithError("kTLS unavailable (kernel tls module or OpenSSL ktls support missing)");
+            return;
+        }
+    }
+
+    std::string block(kBlockSize, 'x');
+    for (auto _ : state)
+    {
+        size_t off = 0;
+        while (off < block.size())
+        {
+            int n = tls ? SSL_write(ssl, block.data() + off, static_cast<int>(block.size() - off))
+                        : static_cast<int>(::write(pair.server, block.data() + off, block.size() - off));
+            if (n <= 0)
+            {
+                state.SkipWithError("write failed");
+                break;
+            }
+            off += n;
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * kBlockSize);
+
+    if (ssl)
+        SSL_shutdown(ssl);
+    ::shutdown(pair.server, SHUT_WR);
+    client.join();
+    SSL_free(ssl);
+    SSL_CTX_free(ctx);
+}
+
+// SslConnection 的写路径：内存 BIO 加密后，按 flushChunk 大小分多次 send（旧实现为 4KB），
+// 0 表示把一次写入产生的全部记录合并为一次 send
+void BM_MemoryBioFlush(benchmark::State& state)
+{
+    size_t flushChunk = static_cast<size_t>(state.range(0));
+    SocketPair pair;
+    if (!makeLoopbackPair(&pair))
+    {
+        state.SkipWithError("failed to create loopback connection");
+        return;
+    }
+    // 对端只消费原始字节
+    std::thread drain(runClient, pair.client, false);
+
+    SSL_CTX* serverCtx = newServerContext(false);
+    SSL_CTX* clientCtx = SSL_CTX_new(TLS_client_method());
+    SSL* server = SSL_new(serverCtx);
+    SSL* client = SSL_new(clientCtx);
+    BIO* serverRead = BIO_new(BIO_s_mem());
+    BIO* serverWrite = BIO_new(BIO_s_mem());
+    BIO* clientRead = BIO_new(BIO_s_mem());
+    BIO* clientWrite = BIO_new(BIO_s_mem());
+    BIO_set_mem_eof_return(serverRead, -1);
+    BIO_set_mem_eof_return(clientRead, -1);
+    SSL_set_bio(server, serverRead, serverWrite);
+    SSL_set_bio(client, clientRead, clientWrite);
+    SSL_set_accept_state(server);
+    SSL_set_connect_state(client);
+
+    // 内存中完成握手
+    std::string tmp(64 * 1024, '\0');
+    for (int i = 0; i < 16 && !(SSL_is_init_finished(server) && SSL_is_init_finished(client)); ++i)
+    {
+        SSL_do_handshake(client);
+        int n;
+        while ((n = BIO_read(clientWrite, &tmp[0], static_cast<int>(tmp.size()))) > 0)
+            BIO_write(serverRead, tmp.data(), n);
+        SSL_do_handshake(server);
+        while ((n = BIO_read(serverWrite, &tmp[0], static_cast<int>(tmp.size()))) > 0)
+            BIO_write(clientRead, tmp.data(), n);
+    }
+
+    std::string block(kBlockSize, 'x');
+    std::string out;
+    for (auto _ : state)
+    {
+        SSL_write(server, block.data(), static_cast<int>(block.size()));
+        size_t pending = BIO_ctrl_pending(serverWrite);
+        out.resize(pending);
+        BIO_read(serverWrite, &out[0], static_cast<int>(pending));
+
+        size_t chunk = flushChunk == 0 ? pending : flushChunk;
+        for (size_t off = 0; off < pending; )
+        {
+            ssize_t n = ::write(pair.server, out.data() + off, std::min(chunk, pending - off));
+            if (n <= 0)
+                break;
+            off += static_cast<size_t>(n);
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * kBlockSize);
+
+    ::shutdown(pair.server, SHUT_WR);
+    drain.join();
+    SSL_free(server);
+    SSL_free(client);
+    SSL_CTX_free(serverCtx);
+    SSL_CTX_free(clientCtx);
+}
+
+} // namespace
+
+BENCHMARK(BM_Send)
+    ->Arg(kPlain)->Arg(kUserTls)->Arg(kKtls)
+    ->ArgName("mode(0=plain,1=tls,2=ktls)")
+    ->UseRealTime();
+
+BENCHMARK(BM_MemoryBioFlush)
+    ->Arg(4096)->Arg(0)
+    ->ArgName("flushChunk")
+    ->UseRealTime();
+
+BENCHMARK_MAIN();